@@ -53,6 +53,12 @@ popd > /dev/null
 #                          END DO NOT MODIFY                                 #
 ##############################################################################
 
+# Build with the precision Bullet was set up with, see conf/bullet.conf
+if [ -f "$CONF_DIR/bullet.conf" ]; then
+    source_conf "bullet.conf"
+fi
+use_double_precision="${BULLET_DOUBLE_PRECISION:-ON}"
+
 function usage
 {
     echo "usage: $0 [-h] [-c] [-w] [-t/r/i/g] [build_path]"
@@ -85,6 +91,7 @@ function cmake_cross_platform()
         -DCMAKE_EXE_LINKER_FLAGS="-fPIC" \
         -DCMAKE_MODULE_LINKER_FLAGS="-fPIC" \
         -DCMAKE_SHARED_LINKER_FLAGS="-fPIC" \
+        -DUSE_DOUBLE_PRECISION="$use_double_precision" \
         || { echo "- ERROR: CMake for Bullet Physics failed."; exit 1; }
 }
 
@@ -157,7 +157,8 @@ function build_bullet()
     pushd "$BULLET_BUILD_DIR" > /dev/null
 
     # Perform the build
-    # If you turn double precision on, turn it on in inc.CMakeBullet.txt as well for the NTRT build
+    # Precision is set by BULLET_DOUBLE_PRECISION in bullet.conf; build.sh
+    # builds NTRT to match
     "$ENV_DIR/bin/cmake" . -G "Unix Makefiles" \
         -DBUILD_SHARED_LIBS=OFF \
         -DBUILD_EXTRAS=ON \
@@ -169,9 +170,8 @@ function build_bullet()
         -DCMAKE_EXE_LINKER_FLAGS="-fPIC" \
         -DCMAKE_MODULE_LINKER_FLAGS="-fPIC" \
         -DCMAKE_SHARED_LINKER_FLAGS="-fPIC" \
-        -DUSE_DOUBLE_PRECISION=ON \
+        -DUSE_DOUBLE_PRECISION="${BULLET_DOUBLE_PRECISION:-ON}" \
         -DCMAKE_INSTALL_NAME_DIR="$BULLET_INSTALL_PREFIX" || { echo "- ERROR: CMake for Bullet Physics failed."; exit 1; }
-    #If you turn this on, turn it on in inc.CMakeBullet.txt as well for the NTRT build
     # Additional bullet options: 
     # -DFRAMEWORK=ON
     # -DBUILD_DEMOS=ON
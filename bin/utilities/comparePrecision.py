@@ -0,0 +1,178 @@
+# Copyright 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+# 
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+# 
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+# Runs the integration tests of a double precision and a single precision
+# build and reports how far the single precision trajectories drift and
+# how much faster they run.
+#
+# Build each from its own checkout, with BULLET_DOUBLE_PRECISION set to
+# "ON" or "OFF" in conf/bullet.conf before setup, then bin/build.sh -i.
+#
+# Usage: python comparePrecision.py DOUBLE_BUILD FLOAT_BUILD [TOLERANCE]
+#   where the builds are the build_test_integration directories and
+#   TOLERANCE (default 1.0, in world length units) is the largest final
+#   divergence considered safe.
+#
+# Each test runs twice per build: once timed with logging off, then once
+# recording its trajectories, so the CSV output does not dilute the
+# speedup. Test outcomes are not compared: several tests check exact
+# values that only hold in double precision.
+
+from __future__ import print_function
+
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+# The suffix all test files must have. We match this case-insensitively.
+TEST_SUFFIX = "_test"
+
+def findTests(buildDir):
+    """Map from path relative to buildDir to absolute path of each test."""
+    tests = {}
+    for root, subFolders, files in os.walk(buildDir):
+        for file in files:
+            filePath = os.path.join(root, file)
+            if (file.lower().endswith(TEST_SUFFIX) and
+                os.path.isfile(filePath) and os.access(filePath, os.X_OK)):
+                tests[os.path.relpath(filePath, buildDir)] = filePath
+    return tests
+
+def runTest(filePath, trajectoryDir=None):
+    """Run a test, recording trajectories if trajectoryDir is given,
+    return the wall time."""
+    env = dict(os.environ)
+    if trajectoryDir is None:
+        env.pop("NTRT_TRAJECTORY_DIR", None)
+    else:
+        env["NTRT_TRAJECTORY_DIR"] = trajectoryDir
+    devnull = open(os.devnull, "w")
+    start = time.time()
+    # Run from the test's directory, as runAllTests.py does
+    subprocess.call([filePath], cwd=os.path.dirname(filePath), env=env,
+                    stdout=devnull, stderr=subprocess.STDOUT)
+    elapsed = time.time() - start
+    devnull.close()
+    return elapsed
+
+def readTrajectory(filePath):
+    """Map from (trial, row in trial) to (time, positions)."""
+    rows = {}
+    counts = {}
+    for line in open(filePath):
+        fields = line.strip().split(",")
+        if len(fields) < 2:
+            continue
+        trial = int(fields[0])
+        index = counts.get(trial, 0)
+        counts[trial] = index + 1
+        values = [float(x) for x in fields[1:]]
+        rows[(trial, index)] = (values[0], values[1:])
+    return rows
+
+def distance(a, b):
+    """Largest distance between matching bodies, inf if they differ."""
+    if len(a) != len(b):
+        return float("inf")
+    worst = 0.0
+    for i in range(0, len(a), 3):
+        d = math.sqrt(sum((a[i + j] - b[i + j]) ** 2 for j in range(3)))
+        if math.isnan(d):
+            return float("inf")
+        worst = max(worst, d)
+    return worst
+
+def compareTrajectories(doubleFile, floatFile):
+    """Return (max divergence, final divergence, rows compared)."""
+    doubleRows = readTrajectory(doubleFile)
+    floatRows = readTrajectory(floatFile)
+    keys = sorted(set(doubleRows.keys()) & set(floatRows.keys()))
+    worst = 0.0
+    final = 0.0
+    for key in keys:
+        final = distance(doubleRows[key][1], floatRows[key][1])
+        worst = max(worst, final)
+    if len(doubleRows) != len(floatRows):
+        # One of them stopped early
+        worst = float("inf")
+    return worst, final, len(keys)
+
+def main(argv):
+    if len(argv) < 3:
+        print("usage: %s DOUBLE_BUILD FLOAT_BUILD [TOLERANCE]" % argv[0])
+        return 2
+    doubleBuild = os.path.abspath(argv[1])
+    floatBuild = os.path.abspath(argv[2])
+    tolerance = float(argv[3]) if len(argv) > 3 else 1.0
+
+    doubleTests = findTests(doubleBuild)
+    floatTests = findTests(floatBuild)
+    names = sorted(set(doubleTests.keys()) & set(floatTests.keys()))
+    if not names:
+        print("No tests found in both %s and %s" % (doubleBuild, floatBuild))
+        return 1
+
+    workDir = tempfile.mkdtemp(prefix="ntrt_precision_")
+    unsafe = False
+    try:
+        print("%-50s %10s %10s %12s %12s" %
+              ("scenario", "double s", "speedup", "max diverg.", "final"))
+        for name in names:
+            doubleDir = os.path.join(workDir, "double", name)
+            floatDir = os.path.join(workDir, "float", name)
+            os.makedirs(doubleDir)
+            os.makedirs(floatDir)
+            doubleTime = runTest(doubleTests[name])
+            floatTime = runTest(floatTests[name])
+            runTest(doubleTests[name], doubleDir)
+            runTest(floatTests[name], floatDir)
+            speedup = doubleTime / floatTime if floatTime > 0.0 else 0.0
+
+            logs = sorted(f for f in os.listdir(doubleDir) if f.endswith(".csv"))
+            if not logs:
+                print("%-50s %10.2f %9.2fx %12s %12s" %
+                      (name, doubleTime, speedup, "no log", "-"))
+                continue
+            for log in logs:
+                floatLog = os.path.join(floatDir, log)
+                scenario = "%s:%s" % (name, log[:-len(".csv")])
+                if not os.path.exists(floatLog):
+                    print("%-50s %10.2f %9.2fx %12s %12s" %
+                          (scenario, doubleTime, speedup, "missing", "-"))
+                    unsafe = True
+                    continue
+                worst, final, rows = compareTrajectories(
+                    os.path.join(doubleDir, log), floatLog)
+                print("%-50s %10.2f %9.2fx %12.4g %12.4g" %
+                      (scenario, doubleTime, speedup, worst, final))
+                if not (final <= tolerance) or rows == 0:
+                    unsafe = True
+    finally:
+        shutil.rmtree(workDir)
+
+    if unsafe:
+        print("\nSingle precision diverged beyond %g in some scenarios." %
+              tolerance)
+        return 1
+    print("\nSingle precision stayed within %g in every scenario." % tolerance)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
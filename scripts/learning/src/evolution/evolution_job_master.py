@@ -46,6 +46,14 @@ class EvolutionJobMaster(NTRTJobMaster):
             if not os.path.isdir(self.path + '/logs'):
                 raise NTRTMasterError("Please create logs directory at" + self.path)
 
+        # Optional: the controllers append every trial to one ResultsStore,
+        # which AppResultsQuery reads
+        if self.jConf['learningParams'].get('resultsStore', False):
+            self.resultsStore = os.path.abspath(self.path + '/logs/results.trials')
+        else:
+            self.resultsStore = None
+        self.generationNumber = 0
+
         
         # Consider seeding random, using default (system time) now
         #random.seed(5)
@@ -471,6 +479,12 @@ class EvolutionJobMaster(NTRTJobMaster):
             obj[p + "Vals"] = self.currentGeneration[p][self.getParamID(self.currentGeneration[p], paramNum)]
 
 	obj["metrics"] = [] # Added to store tension and COM data. 
+
+        # Where and as what the controller records the trial
+        if self.resultsStore:
+            obj["resultsStore"] = self.resultsStore
+            obj["generation"] = self.generationNumber
+            obj["scenario"] = os.path.basename(self.jConf['executable'])
         
 	outFile = self.path + self.jConf['filePrefix'] + "_" + str(jobNum) + self.jConf['fileSuffix']
 
@@ -524,6 +538,7 @@ class EvolutionJobMaster(NTRTJobMaster):
         scoreDump = open('scoreDump.txt', 'w')
         scoreDump.close()
         for n in range(numGenerations):
+            self.generationNumber = n
             # Create the generation'
             for p in self.prefixes:
                 self.currentGeneration[p] = self.generationGenerator(self.currentGeneration[p], p + 'Vals')
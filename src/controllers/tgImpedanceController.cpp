@@ -184,6 +184,22 @@ tgImpedanceController::controlTension(tgBasicActuator& mBasicActuator,
     return setTension;
 }
 
+double
+tgImpedanceController::restLength(const tgBasicActuator& mBasicActuator,
+                                 double newPosition,
+                                 double offsetVel) const
+{
+    const double actualLength = mBasicActuator.getCurrentLength();
+    const double vel = mBasicActuator.getVelocity();
+
+    const double setTension = 
+      determineSetTension(m_offsetTension,
+                m_lengthStiffness * (actualLength - newPosition),
+                m_velStiffness * (vel - offsetVel));
+
+    return tgTensionController::restLength(mBasicActuator, setTension);
+}
+
 void tgImpedanceController::setOffsetTension(double offsetTension)
 {
         // Precondition
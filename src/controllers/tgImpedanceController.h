@@ -92,6 +92,15 @@ class tgImpedanceController
                     double newPosition,
                     double offsetTension,
                     double offsetVel = 0);
+
+    /**
+     * The rest length control(mLocalController, dt, newPosition,
+     * offsetVel) would command, without commanding it, so one call to
+     * tgActuatorGroup::setRestLengths can move many actuators
+     */
+    double restLength(const tgBasicActuator& mLocalController,
+                    double newPosition,
+                    double offsetVel = 0) const;
     /**
      * Set the value of the offset tension property.
      * @param[in] the new value for the offset tension property
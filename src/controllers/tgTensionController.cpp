@@ -94,6 +94,11 @@ void tgTensionController::control(tgBasicActuator& sca, double dt, double setPoi
 		throw std::runtime_error ("Timestep must be positive.");
 	}	
 	
+	sca.setControlInput(restLength(sca, setPoint), dt);
+}
+
+double tgTensionController::restLength(const tgBasicActuator& sca, double setPoint)
+{
     const tgSpringCable* m_springCable = sca.getSpringCable();
     
     const double stiffness = m_springCable->getCoefK();
@@ -103,12 +108,9 @@ void tgTensionController::control(tgBasicActuator& sca, double dt, double setPoi
     const double currentTension = m_springCable->getTension();
     const double delta = setPoint - currentTension;
     double diff = delta / stiffness; 
-    const double currentLength = m_springCable->getRestLength();
     
     double newLength = sca.getRestLength() - diff;
     
     // Safety check
-    newLength = newLength < 0.1 ? 0.1 : newLength;
-    
-	sca.setControlInput(newLength, dt);
+    return newLength < 0.1 ? 0.1 : newLength;
 }
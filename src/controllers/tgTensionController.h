@@ -81,6 +81,16 @@ public:
      * @param[in] setPoint, the desired tension.
      */
     static void control(tgBasicActuator& sca, double dt, double setPoint);
+
+    /**
+     * The control input that control(sca, dt, setPoint) would pass to
+     * setControlInput, for controllers that command a whole
+     * tgActuatorGroup at once
+     * @param[in] sca, a reference the tgBasicActuator to be controlled
+     * @param[in] setPoint, the desired tension.
+     * @return the rest length that produces setPoint
+     */
+    static double restLength(const tgBasicActuator& sca, double setPoint);
 private:
     /**
      * The tgBasicActuator this class controls. We do not own this
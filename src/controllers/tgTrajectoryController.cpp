@@ -0,0 +1,457 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTrajectoryController.cpp
+ * @brief Contains the implementation of class tgTrajectoryPlayback
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgTrajectoryController.h"
+// This library
+#include "tgTensionController.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgCheckpoint.h"
+#include "core/tgModel.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /** Starts every binary table */
+    const char magic[8] = {'N', 'T', 'R', 'T', 'T', 'R', 'A', 'J'};
+
+    /** Reads back differently on a machine of the other byte order */
+    const unsigned int byteOrder = 0x01020304u;
+
+    /**
+     * The fixed part of a binary table's header. The column tags follow,
+     * each its length then its characters, and the rows start at
+     * dataOffset, which keeps them aligned for doubles.
+     */
+    struct BinaryHeader
+    {
+        char magic[8];
+        unsigned int byteOrder;
+        unsigned int columns;
+        unsigned int rows;
+        unsigned int dataOffset;
+    };
+
+    /** Strip leading and trailing whitespace */
+    std::string trim(const std::string& s)
+    {
+        const char* const space = " \t\r\n";
+        const std::string::size_type first = s.find_first_not_of(space);
+        if (first == std::string::npos)
+        {
+            return std::string();
+        }
+        const std::string::size_type last = s.find_last_not_of(space);
+        return s.substr(first, last - first + 1);
+    }
+}
+
+tgTrajectoryPlayback::Config::Config(Mode m, bool l) :
+    mode(m),
+    loop(l)
+{
+}
+
+tgTrajectoryPlayback::tgTrajectoryPlayback(const std::string& filename,
+                                           const Config& config) :
+    m_config(config),
+    m_rows(0),
+    m_pData(NULL),
+    m_pMap(NULL),
+    m_mapSize(0),
+    m_time(0.0),
+    m_cursor(0)
+{
+    try
+    {
+        if (!mapBinary(filename))
+        {
+            readCSV(filename);
+        }
+        checkTimes();
+    }
+    catch (...)
+    {
+        // The destructor does not run for a throwing constructor, and a
+        // mapped table can still fail checkTimes
+        unmap();
+        throw;
+    }
+    m_setPoints.assign(m_columns.size(), 0.0);
+    sample(0.0);
+
+    assert(invariant());
+}
+
+tgTrajectoryPlayback::~tgTrajectoryPlayback()
+{
+    unmap();
+}
+
+void tgTrajectoryPlayback::setup(tgModel& model)
+{
+    const std::vector<tgBasicActuator*> actuators =
+        tgCast::filter<tgModel, tgBasicActuator>(model.getDescendants());
+
+    m_targets.clear();
+    for (std::size_t i = 0; i < m_columns.size(); i++)
+    {
+        bool found = false;
+        for (std::size_t j = 0; j < actuators.size(); j++)
+        {
+            if (actuators[j]->hasAllTags(m_columns[i]))
+            {
+                const Target target = { actuators[j], i };
+                m_targets.push_back(target);
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            throw std::runtime_error("No actuator has the tags '" +
+                                     m_columns[i] + "'");
+        }
+    }
+
+    m_time = 0.0;
+    m_cursor = 0;
+    sample(0.0);
+
+    assert(invariant());
+}
+
+void tgTrajectoryPlayback::step(double dt)
+{
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgTrajectoryPlayback::step");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    m_time += dt;
+    sample(m_time);
+
+    const std::size_t n = m_targets.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const Target& target = m_targets[i];
+        const double setPoint = m_setPoints[target.column];
+        if (m_config.mode == eTension)
+        {
+            tgTensionController::control(*target.pActuator, dt, setPoint);
+        }
+        else
+        {
+            target.pActuator->setControlInput(setPoint, dt);
+        }
+    }
+}
+
+void tgTrajectoryPlayback::saveState(std::ostream& os) const
+{
+    tgCheckpoint::write(os, m_time);
+}
+
+void tgTrajectoryPlayback::loadState(std::istream& is)
+{
+    tgCheckpoint::read(is, m_time);
+    // The cursor only moves forward, so start it over
+    m_cursor = 0;
+    sample(m_time);
+}
+
+void tgTrajectoryPlayback::save(const std::string& filename) const
+{
+    std::ofstream os(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!os)
+    {
+        throw std::runtime_error("Cannot write trajectory " + filename);
+    }
+
+    std::size_t offset = sizeof(BinaryHeader);
+    for (std::size_t i = 0; i < m_columns.size(); i++)
+    {
+        offset += sizeof(unsigned int) + m_columns[i].size();
+    }
+    offset = (offset + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+
+    BinaryHeader header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.byteOrder = byteOrder;
+    header.columns = static_cast<unsigned int>(m_columns.size());
+    header.rows = static_cast<unsigned int>(m_rows);
+    header.dataOffset = static_cast<unsigned int>(offset);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::size_t written = sizeof(header);
+    for (std::size_t i = 0; i < m_columns.size(); i++)
+    {
+        const unsigned int length =
+            static_cast<unsigned int>(m_columns[i].size());
+        os.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        os.write(m_columns[i].data(), length);
+        written += sizeof(length) + length;
+    }
+    const std::string padding(offset - written, '\0');
+    os.write(padding.data(), padding.size());
+
+    os.write(reinterpret_cast<const char*>(m_pData),
+             m_rows * (m_columns.size() + 1) * sizeof(double));
+    if (!os)
+    {
+        throw std::runtime_error("Cannot write trajectory " + filename);
+    }
+}
+
+double tgTrajectoryPlayback::getDuration() const
+{
+    return rowTime(m_rows - 1) - rowTime(0);
+}
+
+void tgTrajectoryPlayback::readCSV(const std::string& filename)
+{
+    std::ifstream is(filename.c_str());
+    if (!is)
+    {
+        throw std::runtime_error("Cannot read trajectory " + filename);
+    }
+
+    std::string line;
+    if (!std::getline(is, line))
+    {
+        throw std::runtime_error("Trajectory " + filename + " is empty");
+    }
+    std::istringstream header(line);
+    std::string field;
+    // The first field names the time column
+    std::getline(header, field, ',');
+    while (std::getline(header, field, ','))
+    {
+        field = trim(field);
+        if (field.empty())
+        {
+            throw std::runtime_error("Trajectory " + filename +
+                                     " has a column with no tags");
+        }
+        m_columns.push_back(field);
+    }
+    if (m_columns.empty())
+    {
+        throw std::runtime_error("Trajectory " + filename + " has no columns");
+    }
+
+    const std::size_t stride = m_columns.size() + 1;
+    while (std::getline(is, line))
+    {
+        if (trim(line).empty())
+        {
+            continue;
+        }
+        std::istringstream row(line);
+        std::size_t fields = 0;
+        while (std::getline(row, field, ','))
+        {
+            std::istringstream value(field);
+            double x;
+            if (!(value >> x) || fields == stride)
+            {
+                fields = 0;
+                break;
+            }
+            m_table.push_back(x);
+            fields++;
+        }
+        if (fields != stride)
+        {
+            std::ostringstream message;
+            message << "Trajectory " << filename << " row " << m_rows + 1
+                    << " does not have " << stride << " numbers";
+            throw std::runtime_error(message.str());
+        }
+        m_rows++;
+    }
+    if (m_rows == 0)
+    {
+        throw std::runtime_error("Trajectory " + filename + " has no rows");
+    }
+    m_pData = &m_table[0];
+}
+
+bool tgTrajectoryPlayback::mapBinary(const std::string& filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Cannot read trajectory " + filename);
+    }
+
+    struct stat status;
+    BinaryHeader header;
+    if (fstat(fd, &status) != 0 ||
+        static_cast<std::size_t>(status.st_size) < sizeof(header) ||
+        read(fd, &header, sizeof(header)) !=
+            static_cast<ssize_t>(sizeof(header)) ||
+        std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(status.st_size);
+    const std::size_t dataSize =
+        static_cast<std::size_t>(header.rows) * (header.columns + 1) *
+        sizeof(double);
+    if (header.byteOrder != byteOrder ||
+        header.columns == 0 || header.rows == 0 ||
+        header.dataOffset % sizeof(double) != 0 ||
+        header.dataOffset > size || size - header.dataOffset != dataSize)
+    {
+        close(fd);
+        throw std::runtime_error("Trajectory " + filename +
+                                 " is not a valid binary table");
+    }
+
+    m_pMap = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m_pMap == MAP_FAILED)
+    {
+        m_pMap = NULL;
+        throw std::runtime_error("Cannot map trajectory " + filename);
+    }
+    m_mapSize = size;
+
+    const char* const pBytes = static_cast<const char*>(m_pMap);
+    std::size_t offset = sizeof(header);
+    for (unsigned int i = 0; i < header.columns; i++)
+    {
+        unsigned int length = 0;
+        if (offset + sizeof(length) <= header.dataOffset)
+        {
+            std::memcpy(&length, pBytes + offset, sizeof(length));
+            offset += sizeof(length);
+        }
+        if (length == 0 || offset + length > header.dataOffset)
+        {
+            unmap();
+            throw std::runtime_error("Trajectory " + filename +
+                                     " has a malformed column");
+        }
+        m_columns.push_back(std::string(pBytes + offset, length));
+        offset += length;
+    }
+
+    m_rows = header.rows;
+    m_pData = reinterpret_cast<const double*>(pBytes + header.dataOffset);
+    return true;
+}
+
+void tgTrajectoryPlayback::unmap()
+{
+    if (m_pMap != NULL)
+    {
+        munmap(m_pMap, m_mapSize);
+        m_pMap = NULL;
+        m_mapSize = 0;
+        m_pData = NULL;
+        m_rows = 0;
+    }
+}
+
+void tgTrajectoryPlayback::checkTimes() const
+{
+    for (std::size_t i = 1; i < m_rows; i++)
+    {
+        if (!(rowTime(i) > rowTime(i - 1)))
+        {
+            std::ostringstream message;
+            message << "Trajectory times are not increasing at row " << i + 1;
+            throw std::runtime_error(message.str());
+        }
+    }
+}
+
+void tgTrajectoryPlayback::sample(double t)
+{
+    const std::size_t stride = m_columns.size() + 1;
+    const double start = rowTime(0);
+    const double duration = getDuration();
+
+    t += start;
+    if (m_config.loop && duration > 0.0 && t > start + duration)
+    {
+        t = start + std::fmod(t - start, duration);
+        if (t < rowTime(m_cursor))
+        {
+            m_cursor = 0;
+        }
+    }
+
+    while (m_cursor + 1 < m_rows && rowTime(m_cursor + 1) <= t)
+    {
+        m_cursor++;
+    }
+
+    const double* const pRow = m_pData + m_cursor * stride;
+    if (m_cursor + 1 == m_rows || t <= pRow[0])
+    {
+        // Hold the first or last row
+        for (std::size_t i = 0; i < m_setPoints.size(); i++)
+        {
+            m_setPoints[i] = pRow[i + 1];
+        }
+        return;
+    }
+
+    const double* const pNext = pRow + stride;
+    const double alpha = (t - pRow[0]) / (pNext[0] - pRow[0]);
+    for (std::size_t i = 0; i < m_setPoints.size(); i++)
+    {
+        m_setPoints[i] = pRow[i + 1] + alpha * (pNext[i + 1] - pRow[i + 1]);
+    }
+}
+
+bool tgTrajectoryPlayback::invariant() const
+{
+    return (m_rows > 0) &&
+        (m_pData != NULL) &&
+        (m_setPoints.size() == m_columns.size()) &&
+        (m_cursor < m_rows) &&
+        (m_time >= 0.0);
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CONTROLLERS_TG_TRAJECTORY_CONTROLLER_H
+#define SRC_CONTROLLERS_TG_TRAJECTORY_CONTROLLER_H
+
+/**
+ * @file tgTrajectoryController.h
+ * @brief Contains the definitions of class tgTrajectoryPlayback and
+ * class template tgTrajectoryController
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This library
+#include "core/tgObserver.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgBasicActuator;
+class tgModel;
+
+/**
+ * Plays back a table of setpoints, such as a trajectory recorded on
+ * hardware, on the actuators of a model. Each column of the table
+ * holds the rest lengths or tensions of the actuators that have all of
+ * its tags; the setpoint between two rows is linearly interpolated.
+ * Attach a tgTrajectoryController, below, to the model to drive it.
+ *
+ * The table is read once, when the controller is constructed, into one
+ * contiguous time-major array. Playback keeps a cursor on the current
+ * row, so a step costs one interpolation per column with no searching
+ * and no allocation.
+ *
+ * Two file formats are read:
+ * - CSV: a header line "time,tags,tags,...", where each tags field is
+ *   a space separated list of tags, then one line per row starting
+ *   with its time in seconds.
+ * - Binary, recognised by its leading magic "NTRTTRAJ" and written by
+ *   save(). The rows are memory mapped in place rather than parsed, so
+ *   long recordings load at the cost of a page fault per page touched.
+ *   Values are in native byte order; files from a machine with the
+ *   other byte order are rejected.
+ *
+ * Times must be strictly increasing. Playback starts at the first
+ * row whatever its time, and after the last row the last row is held
+ * unless the playback loops.
+ */
+class tgTrajectoryPlayback
+{
+public:
+
+    /** What the columns of the table hold */
+    enum Mode
+    {
+        /** Passed to tgBasicActuator::setControlInput */
+        eRestLength,
+        /** Tracked with tgTensionController::control */
+        eTension
+    };
+
+    /**
+     * Playback parameters
+     */
+    struct Config
+    {
+        /**
+         * @param[in] m, what the columns hold
+         * @param[in] l, if true start over from the first row after the
+         * last one instead of holding it
+         */
+        Config(Mode m = eRestLength, bool l = false);
+
+        Mode mode;
+
+        bool loop;
+    };
+
+    /**
+     * Read the table.
+     * @param[in] filename, a CSV or binary table
+     * @param[in] config, the playback parameters
+     * @throw std::runtime_error if the file cannot be read or is not a
+     * valid table
+     */
+    tgTrajectoryPlayback(const std::string& filename,
+                         const Config& config = Config());
+
+    /** Unmaps a binary table */
+    virtual ~tgTrajectoryPlayback();
+
+    /**
+     * Find the actuators for each column and rewind to the start of
+     * the table
+     * @throw std::runtime_error if a column matches no tgBasicActuator
+     */
+    void setup(tgModel& model);
+
+    /**
+     * Advance playback by dt and send each actuator its setpoint
+     */
+    void step(double dt);
+
+    /** Saves the playback time */
+    void saveState(std::ostream& os) const;
+
+    /** Restores the playback time */
+    void loadState(std::istream& is);
+
+    /**
+     * Write the table in the binary format, so a CSV table can be
+     * converted once and mapped thereafter
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& filename) const;
+
+    /** Seconds played since setup */
+    double getTime() const { return m_time; }
+
+    /** Seconds from the first row to the last */
+    double getDuration() const;
+
+    std::size_t getRows() const { return m_rows; }
+
+    /** The tags of each column */
+    const std::vector<std::string>& getColumns() const { return m_columns; }
+
+    /** The setpoint of each column at the latest step */
+    const std::vector<double>& getSetPoints() const { return m_setPoints; }
+
+private:
+
+    /** An actuator and the column it follows */
+    struct Target
+    {
+        tgBasicActuator* pActuator;
+        std::size_t column;
+    };
+
+    /** Read a CSV table into m_table */
+    void readCSV(const std::string& filename);
+
+    /**
+     * Map a binary table. If it throws, nothing is left mapped.
+     * @return false if the file does not start with the magic
+     */
+    bool mapBinary(const std::string& filename);
+
+    /** Release the mapping of a binary table, if there is one */
+    void unmap();
+
+    /** @throw std::runtime_error if times are not strictly increasing */
+    void checkTimes() const;
+
+    /** The time of a row */
+    double rowTime(std::size_t row) const
+    {
+        return m_pData[row * (m_columns.size() + 1)];
+    }
+
+    /**
+     * Move the cursor to the row at or before time t and interpolate
+     * m_setPoints
+     */
+    void sample(double t);
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    /** Disable the copy constructor. */
+    tgTrajectoryPlayback(const tgTrajectoryPlayback&);
+
+    /** Disable the assignment operator. */
+    tgTrajectoryPlayback& operator=(const tgTrajectoryPlayback&);
+
+    const Config m_config;
+
+    std::vector<std::string> m_columns;
+
+    std::size_t m_rows;
+
+    /**
+     * The rows, each its time then one value per column: either
+     * m_table's storage or the mapped file's
+     */
+    const double* m_pData;
+
+    /** The rows of a CSV table */
+    std::vector<double> m_table;
+
+    /** The mapping of a binary table, or NULL */
+    void* m_pMap;
+    std::size_t m_mapSize;
+
+    std::vector<Target> m_targets;
+
+    std::vector<double> m_setPoints;
+
+    double m_time;
+
+    /** The row at or before the latest sample */
+    std::size_t m_cursor;
+};
+
+/**
+ * Observes a model of type T, which must be a tgModel and a
+ * tgSubject<T>, and plays a table back on it with tgTrajectoryPlayback.
+ * The model's checkpoints save and restore the playback time.
+ */
+template <class T>
+class tgTrajectoryController : public tgObserver<T>,
+                               public tgTrajectoryPlayback
+{
+public:
+
+    /** See tgTrajectoryPlayback::tgTrajectoryPlayback */
+    tgTrajectoryController(const std::string& filename,
+                           const Config& config = Config()) :
+        tgTrajectoryPlayback(filename, config)
+    {
+    }
+
+    virtual ~tgTrajectoryController() { }
+
+    virtual void onSetup(T& subject)
+    {
+        setup(subject);
+    }
+
+    virtual void onStep(T& subject, double dt)
+    {
+        step(dt);
+    }
+
+    virtual void onSaveState(T& subject, std::ostream& os)
+    {
+        saveState(os);
+    }
+
+    virtual void onLoadState(T& subject, std::istream& is)
+    {
+        loadState(is);
+    }
+
+private:
+
+    /** Disable the copy constructor. */
+    tgTrajectoryController(const tgTrajectoryController&);
+
+    /** Disable the assignment operator. */
+    tgTrajectoryController& operator=(const tgTrajectoryController&);
+};
+
+#endif  // SRC_CONTROLLERS_TG_TRAJECTORY_CONTROLLER_H
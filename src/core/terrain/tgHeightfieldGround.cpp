@@ -0,0 +1,228 @@
+/**
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+/**
+ * @file tgHeightfieldGround.cpp
+ * @brief Contains the implementation of class tgHeightfieldGround
+ * @author NTRT contributors
+ * $Id$
+ */
+
+//This Module
+#include "tgHeightfieldGround.h"
+
+//Bullet Physics
+#include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btTransform.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    typedef std::map<std::string, tgHeightfieldGround::HeightData*> HeightCache;
+
+    /** Height data generated from configs, shared by all instances */
+    HeightCache& heightCache()
+    {
+        static HeightCache cache;
+        return cache;
+    }
+
+    /** Only the parameters that change the heights belong in the key */
+    std::string cacheKey(const tgHeightfieldGround::Config& config)
+    {
+        std::ostringstream key;
+        key.precision(17);
+        key << config.m_nx << " " << config.m_ny << " "
+            << config.m_waveHeight << " " << config.m_offset;
+        return key.str();
+    }
+
+    void updateBounds(tgHeightfieldGround::HeightData& data)
+    {
+        assert(!data.heights.empty());
+        data.minHeight = data.heights[0];
+        data.maxHeight = data.heights[0];
+        for (std::size_t i = 1; i < data.heights.size(); i++)
+        {
+            data.minHeight = std::min(data.minHeight, data.heights[i]);
+            data.maxHeight = std::max(data.maxHeight, data.heights[i]);
+        }
+    }
+}
+
+tgHeightfieldGround::tgHeightfieldGround() :
+    m_config(Config()),
+    m_pHeightData(cachedHeights(m_config)),
+    m_ownsHeights(false)
+{
+    init();
+}
+
+tgHeightfieldGround::tgHeightfieldGround(const Config& config) :
+    m_config(config),
+    m_pHeightData(cachedHeights(m_config)),
+    m_ownsHeights(false)
+{
+    init();
+}
+
+tgHeightfieldGround::tgHeightfieldGround(const Config& config,
+                                         const std::vector<double>& heights) :
+    m_config(config),
+    m_pHeightData(NULL),
+    m_ownsHeights(true)
+{
+    if (heights.size() != m_config.m_nx * m_config.m_ny)
+    {
+        throw std::invalid_argument("Height grid does not match nx * ny");
+    }
+
+    HeightData* const pData = new HeightData();
+    pData->heights.assign(heights.begin(), heights.end());
+    updateBounds(*pData);
+    m_pHeightData = pData;
+
+    init();
+}
+
+tgHeightfieldGround::~tgHeightfieldGround()
+{
+    if (m_ownsHeights)
+    {
+        delete m_pHeightData;
+    }
+}
+
+void tgHeightfieldGround::clearCache()
+{
+    HeightCache& cache = heightCache();
+    for (HeightCache::iterator it = cache.begin(); it != cache.end(); ++it)
+    {
+        delete it->second;
+    }
+    cache.clear();
+}
+
+const tgHeightfieldGround::HeightData*
+tgHeightfieldGround::cachedHeights(const Config& config)
+{
+    HeightCache& cache = heightCache();
+    const std::string key = cacheKey(config);
+
+    HeightCache::iterator it = cache.find(key);
+    if (it != cache.end())
+    {
+        return it->second;
+    }
+
+    // Same hills as tgHillyGround::setVertices
+    HeightData* const pData = new HeightData();
+    pData->heights.resize(config.m_nx * config.m_ny);
+    for (std::size_t i = 0; i < config.m_nx; i++)
+    {
+        for (std::size_t j = 0; j < config.m_ny; j++)
+        {
+            pData->heights[i + (j * config.m_nx)] =
+                config.m_waveHeight * sin((double)i) * cos((double)j) +
+                config.m_offset;
+        }
+    }
+    updateBounds(*pData);
+
+    cache[key] = pData;
+    return pData;
+}
+
+void tgHeightfieldGround::init()
+{
+    assert(m_pHeightData);
+    assert(m_config.m_nx > 1 && m_config.m_ny > 1);
+
+    const btScalar heightScale = 1.0;
+    const int upAxis = 1;
+    // Split each quad along (i, j)-(i + 1, j + 1), as
+    // tgHillyGround::setIndices does, so the triangles match too
+    const bool flipQuadEdges = true;
+
+    btHeightfieldTerrainShape* const pShape =
+        new btHeightfieldTerrainShape(m_config.m_nx,
+                                      m_config.m_ny,
+                                      &m_pHeightData->heights[0],
+                                      heightScale,
+                                      m_pHeightData->minHeight,
+                                      m_pHeightData->maxHeight,
+                                      upAxis,
+                                      PHY_FLOAT,
+                                      flipQuadEdges);
+
+    pShape->setLocalScaling(btVector3(m_config.m_triangleSize,
+                                      1.0,
+                                      m_config.m_triangleSize));
+    pShape->setMargin(m_config.m_margin);
+
+    pGroundShape = pShape;
+}
+
+btRigidBody* tgHeightfieldGround::getGroundRigidBody() const
+{
+    const btScalar mass = 0.0;
+
+    btQuaternion orientation;
+    orientation.setEuler(m_config.m_eulerAngles[0], // Yaw
+                         m_config.m_eulerAngles[1], // Pitch
+                         m_config.m_eulerAngles[2]); // Roll
+
+    // Bullet centers the heightfield on its bounding box. Shift it so
+    // that the nodes land where tgHillyGround would put its vertices.
+    const btVector3 localOffset(-0.5 * m_config.m_triangleSize,
+                                0.5 * (m_pHeightData->minHeight +
+                                       m_pHeightData->maxHeight),
+                                -0.5 * m_config.m_triangleSize);
+
+    btTransform groundTransform;
+    groundTransform.setIdentity();
+    groundTransform.setOrigin(m_config.m_origin +
+                              quatRotate(orientation, localOffset));
+    groundTransform.setRotation(orientation);
+
+    // Using motionstate is recommended
+    // It provides interpolation capabilities, and only synchronizes 'active' objects
+    btDefaultMotionState* const pMotionState =
+        new btDefaultMotionState(groundTransform);
+
+    const btVector3 localInertia(0, 0, 0);
+
+    btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, pMotionState, pGroundShape, localInertia);
+    rbInfo.m_friction = m_config.m_friction;
+    rbInfo.m_restitution = m_config.m_restitution;
+
+    btRigidBody* const pGroundBody = new btRigidBody(rbInfo);
+
+    assert(pGroundBody);
+    return pGroundBody;
+}
@@ -0,0 +1,127 @@
+/**
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+#ifndef CORE_TERRAIN_TG_HEIGHTFIELD_GROUND_H
+#define CORE_TERRAIN_TG_HEIGHTFIELD_GROUND_H
+
+/**
+ * @file tgHeightfieldGround.h
+ * @brief Contains the definition of class tgHeightfieldGround.
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include "tgBulletGround.h"
+#include "tgHillyGround.h"
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+
+/**
+ * A regular grid ground backed by a btHeightfieldTerrainShape. Accepts
+ * the same configuration as tgHillyGround, so it can be swapped in
+ * wherever a hilly ground is used, or an external elevation grid.
+ * Unlike tgHillyGround no BVH is built, and the height data generated
+ * from a tgHillyGround::Config is cached and shared between all
+ * grounds with the same grid and wave parameters, so a new ground per
+ * trial costs almost nothing.
+ */
+class tgHeightfieldGround : public tgBulletGround
+{
+public:
+
+    /** The grid and wave parameters are those of a tgHillyGround */
+    typedef tgHillyGround::Config Config;
+
+    /**
+     * Default construction that uses the default values of config
+     */
+    tgHeightfieldGround();
+
+    /**
+     * Generate the same hills as a tgHillyGround with this config
+     */
+    tgHeightfieldGround(const Config& config);
+
+    /**
+     * Use an external elevation grid instead of the wave parameters.
+     * m_nx, m_ny, m_triangleSize and m_margin of config still apply,
+     * m_waveHeight and m_offset are ignored.
+     * @param[in] heights elevation of node (i, j) at
+     * heights[i + j * config.m_nx], must have m_nx * m_ny entries.
+     * The data is copied, so heights may be discarded after construction
+     */
+    tgHeightfieldGround(const Config& config,
+                        const std::vector<double>& heights);
+
+    /** Clean up the implementation. Cached height data is not deleted */
+    virtual ~tgHeightfieldGround();
+
+    /**
+     * Setup and return a return a rigid body based on the collision
+     * object
+     */
+    virtual btRigidBody* getGroundRigidBody() const;
+
+    /**
+     * Release the height data shared between grounds. Must only be
+     * called when no tgHeightfieldGround exists.
+     */
+    static void clearCache();
+
+    /**
+     * Height data and its bounds, in the layout Bullet expects
+     */
+    struct HeightData
+    {
+        std::vector<float> heights;
+        float minHeight;
+        float maxHeight;
+    };
+
+private:
+
+    /**
+     * Create the collision shape over m_pHeightData and store it in
+     * pGroundShape
+     */
+    void init();
+
+    /**
+     * Look up the height data for m_config in the cache, generating it
+     * on the first request.
+     */
+    static const HeightData* cachedHeights(const Config& config);
+
+    /** Store the configuration data for use later */
+    Config m_config;
+
+    /** Either shared through the cache, or owned if m_ownsHeights */
+    const HeightData* m_pHeightData;
+
+    /** True if m_pHeightData came from an external grid */
+    const bool m_ownsHeights;
+};
+
+#endif  // CORE_TERRAIN_TG_HEIGHTFIELD_GROUND_H
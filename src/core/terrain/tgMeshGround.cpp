@@ -0,0 +1,754 @@
+/**
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+/**
+ * @file tgMeshGround.cpp
+ * @brief Contains the implementation of class tgMeshGround
+ * @author NTRT contributors
+ * $Id$
+ */
+
+//This Module
+#include "tgMeshGround.h"
+
+//Bullet Physics
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btAlignedAllocator.h"
+#include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btTransform.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <stdint.h>
+
+// POSIX, for memory mapping the BVH file
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /**
+     * Everything that can be shared between grounds made from the same
+     * file. The mesh interface points at pVertices and pIndices, which
+     * are either the parsed vectors or arrays in the mapped sidecar, and
+     * the BVH either lives in its own allocation or in the mapping.
+     */
+    struct MeshData
+    {
+        MeshData() :
+            pVertices(NULL),
+            pIndices(NULL),
+            vertexCount(0),
+            triangleCount(0),
+            pMesh(NULL),
+            pBvh(NULL),
+            pMapped(NULL),
+            mappedSize(0)
+        { }
+
+        ~MeshData()
+        {
+            delete pMesh;
+            if (pMapped)
+            {
+                // The BVH was deserialized in place, nothing to delete
+                munmap(pMapped, mappedSize);
+            }
+            else
+            {
+                delete pBvh;
+            }
+        }
+
+        std::vector<btScalar> vertices;
+        std::vector<int> indices;
+        btScalar* pVertices;
+        int* pIndices;
+        std::size_t vertexCount;
+        std::size_t triangleCount;
+        btTriangleIndexVertexArray* pMesh;
+        btOptimizedBvh* pBvh;
+        void* pMapped;
+        std::size_t mappedSize;
+    };
+
+    typedef std::map<std::string, MeshData*> MeshCache;
+
+    MeshCache& meshCache()
+    {
+        static MeshCache cache;
+        return cache;
+    }
+
+    /**
+     * Fixed size header of the sidecar file. The vertices, the indices
+     * and the serialized BVH follow, each starting on a 16 byte
+     * boundary of the mapping.
+     */
+    struct BvhFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t scalarSize;
+        uint64_t checksum;
+        uint64_t triangleCount;
+        uint64_t vertexCount;
+        uint64_t bufferSize;
+        /** The mesh file's size and modification time when parsed */
+        uint64_t meshSize;
+        int64_t meshTime;
+        double scale;
+    };
+
+    const char kMagic[8] = "NTRTBVH";
+    const uint32_t kVersion = 3;
+    const std::size_t kHeaderSize = 96;
+    const std::size_t kAlignment = 16;
+
+    std::size_t aligned(std::size_t size)
+    {
+        return (size + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    std::size_t verticesSize(std::size_t vertexCount)
+    {
+        return aligned(vertexCount * 3 * sizeof(btScalar));
+    }
+
+    std::size_t indicesSize(std::size_t triangleCount)
+    {
+        return aligned(triangleCount * 3 * sizeof(int));
+    }
+
+    /** FNV-1a, enough to notice that the mesh file or scale changed */
+    uint64_t checksum(const void* data, std::size_t size, uint64_t hash)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * Identifies the parsed mesh without parsing it, for a mesh file
+     * whose modification time changed but whose contents may not have
+     */
+    uint64_t fileChecksum(const std::vector<char>& file, std::size_t size,
+                          double scale)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        hash = checksum(&file[0], size, hash);
+        hash = checksum(&scale, sizeof(scale), hash);
+        return hash;
+    }
+
+    /**
+     * Read the whole file, followed by a '\0' that the returned size
+     * excludes
+     */
+    std::size_t readFile(const std::string& filename, std::vector<char>& file)
+    {
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        if (!in)
+        {
+            throw std::runtime_error("Could not open mesh file " + filename);
+        }
+        file.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+        const std::size_t size = file.size();
+        file.push_back('\0');
+        return size;
+    }
+
+    std::string lowerExtension(const std::string& filename)
+    {
+        const std::size_t dot = filename.find_last_of('.');
+        if (dot == std::string::npos)
+        {
+            return "";
+        }
+        std::string ext = filename.substr(dot + 1);
+        for (std::size_t i = 0; i < ext.size(); i++)
+        {
+            ext[i] = std::tolower(static_cast<unsigned char>(ext[i]));
+        }
+        return ext;
+    }
+
+    void addVertex(MeshData& data, double x, double y, double z, double scale)
+    {
+        data.vertices.push_back(x * scale);
+        data.vertices.push_back(y * scale);
+        data.vertices.push_back(z * scale);
+    }
+
+    /**
+     * The ASCII parsers read the file buffer in place; it ends with a
+     * '\0' so strtod and strtol stop at the end.
+     */
+    const char* skipSpace(const char* p, const char* end)
+    {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p)))
+        {
+            p++;
+        }
+        return p;
+    }
+
+    const char* skipToken(const char* p, const char* end)
+    {
+        while (p < end && !std::isspace(static_cast<unsigned char>(*p)))
+        {
+            p++;
+        }
+        return p;
+    }
+
+    /**
+     * Read three numbers, which must all be before end
+     * @return false if they are not there
+     */
+    bool parseVector(const char*& p, const char* end,
+                     double& x, double& y, double& z)
+    {
+        double* const values[3] = { &x, &y, &z };
+        for (int i = 0; i < 3; i++)
+        {
+            char* next = NULL;
+            *values[i] = std::strtod(p, &next);
+            if (next == p || next > end)
+            {
+                return false;
+            }
+            p = next;
+        }
+        return true;
+    }
+
+    /** STL stores every triangle with its own three vertices */
+    void loadBinarySTL(const std::vector<char>& file, MeshData& data,
+                       double scale)
+    {
+        uint32_t triangleCount;
+        std::memcpy(&triangleCount, &file[80], sizeof(uint32_t));
+
+        data.vertices.reserve(triangleCount * 9);
+        data.indices.reserve(triangleCount * 3);
+
+        // Each record: normal, three vertices, attribute byte count
+        const char* record = &file[84];
+        for (uint32_t i = 0; i < triangleCount; i++, record += 50)
+        {
+            float v[9];
+            std::memcpy(v, record + 12, sizeof(v));
+            for (int k = 0; k < 3; k++)
+            {
+                data.indices.push_back(data.vertices.size() / 3);
+                addVertex(data, v[3 * k], v[3 * k + 1], v[3 * k + 2], scale);
+            }
+        }
+    }
+
+    void loadAsciiSTL(const char* p, const char* end, MeshData& data,
+                      double scale)
+    {
+        static const char vertex[] = "vertex";
+        const std::size_t length = sizeof(vertex) - 1;
+        while ((p = skipSpace(p, end)) < end)
+        {
+            const char* const tokenEnd = skipToken(p, end);
+            if (static_cast<std::size_t>(tokenEnd - p) == length &&
+                std::strncmp(p, vertex, length) == 0)
+            {
+                double x, y, z;
+                p = tokenEnd;
+                if (!parseVector(p, end, x, y, z))
+                {
+                    throw std::runtime_error("Malformed vertex in STL file");
+                }
+                data.indices.push_back(data.vertices.size() / 3);
+                addVertex(data, x, y, z, scale);
+            }
+            else
+            {
+                p = tokenEnd;
+            }
+        }
+    }
+
+    /** The file's bytes are followed by a '\0' that size excludes */
+    void loadSTL(const std::vector<char>& file, std::size_t size,
+                 MeshData& data, double scale)
+    {
+        // Binary files can start with "solid" too, so go by the size
+        bool binary = false;
+        if (size >= 84)
+        {
+            uint32_t triangleCount;
+            std::memcpy(&triangleCount, &file[80], sizeof(uint32_t));
+            binary = (size == 84 + 50 * (std::size_t)triangleCount);
+        }
+
+        if (binary)
+        {
+            loadBinarySTL(file, data, scale);
+        }
+        else
+        {
+            loadAsciiSTL(&file[0], &file[0] + size, data, scale);
+        }
+    }
+
+    /**
+     * Vertices and faces only. Polygons are triangulated as fans,
+     * texture and normal indices are ignored.
+     */
+    void loadOBJ(const std::vector<char>& file, std::size_t size,
+                 MeshData& data, double scale)
+    {
+        const char* p = &file[0];
+        const char* const end = p + size;
+        std::vector<int> face;
+        while (p < end)
+        {
+            const char* lineEnd =
+                static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (lineEnd == NULL)
+            {
+                lineEnd = end;
+            }
+
+            p = skipSpace(p, lineEnd);
+            const char* const typeEnd = skipToken(p, lineEnd);
+            const std::size_t typeLength = typeEnd - p;
+            if (typeLength == 1 && *p == 'v')
+            {
+                double x, y, z;
+                p = typeEnd;
+                if (!parseVector(p, lineEnd, x, y, z))
+                {
+                    throw std::runtime_error("Malformed vertex in OBJ file");
+                }
+                addVertex(data, x, y, z, scale);
+            }
+            else if (typeLength == 1 && *p == 'f')
+            {
+                const int vertexCount = data.vertices.size() / 3;
+                face.clear();
+                p = typeEnd;
+                while ((p = skipSpace(p, lineEnd)) < lineEnd)
+                {
+                    // "i", "i/t", "i//n" or "i/t/n", negative is relative
+                    int index = std::strtol(p, NULL, 10);
+                    index = index < 0 ? vertexCount + index : index - 1;
+                    if (index < 0 || index >= vertexCount)
+                    {
+                        throw std::runtime_error("OBJ face index out of range");
+                    }
+                    face.push_back(index);
+                    p = skipToken(p, lineEnd);
+                }
+                for (std::size_t i = 2; i < face.size(); i++)
+                {
+                    data.indices.push_back(face[0]);
+                    data.indices.push_back(face[i - 1]);
+                    data.indices.push_back(face[i]);
+                }
+            }
+            p = lineEnd + 1;
+        }
+    }
+
+    /**
+     * Map the sidecar, point the mesh at its vertices and indices and
+     * deserialize the BVH in place. Returns false if there is no usable
+     * file for this mesh, leaving data untouched.
+     *
+     * The sidecar is current if it was written for this scale and the
+     * mesh file still has the size and modification time it had then,
+     * so the mesh file itself is not read. Only if the size matches but
+     * the time does not, as after a copy or a touch, is the mesh file
+     * hashed and compared; a match refreshes the sidecar's time.
+     */
+    bool mapBvh(const std::string& filename, const std::string& bvhFilename,
+                const struct stat& meshInfo, double scale, MeshData& data)
+    {
+        const int fd = open(bvhFilename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        BvhFileHeader header;
+        const bool headerRead = (fstat(fd, &info) == 0) &&
+            ((std::size_t)info.st_size >= kHeaderSize) &&
+            (read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header));
+
+        bool matches = headerRead &&
+            (std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0) &&
+            (header.version == kVersion) &&
+            (header.scalarSize == sizeof(btScalar)) &&
+            (header.scale == scale) &&
+            (header.meshSize == (uint64_t)meshInfo.st_size) &&
+            (header.triangleCount > 0) &&
+            ((std::size_t)info.st_size ==
+                kHeaderSize + verticesSize(header.vertexCount) +
+                indicesSize(header.triangleCount) + header.bufferSize);
+
+        if (matches && header.meshTime != (int64_t)meshInfo.st_mtime)
+        {
+            std::vector<char> file;
+            try
+            {
+                const std::size_t size = readFile(filename, file);
+                matches = (header.checksum == fileChecksum(file, size, scale));
+            }
+            catch (...)
+            {
+                close(fd);
+                throw;
+            }
+            if (matches)
+            {
+                header.meshTime = meshInfo.st_mtime;
+                const int out = open(bvhFilename.c_str(), O_WRONLY);
+                if (out < 0 ||
+                    pwrite(out, &header, sizeof(header), 0) !=
+                        (ssize_t)sizeof(header))
+                {
+                    std::cerr << "Could not update BVH cache " << bvhFilename
+                              << std::endl;
+                }
+                if (out >= 0)
+                {
+                    close(out);
+                }
+            }
+        }
+
+        if (!matches)
+        {
+            close(fd);
+            return false;
+        }
+
+        // Private mapping: deserialization patches pointers in place,
+        // those writes must not go back to the file
+        void* const pMapped = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (pMapped == MAP_FAILED)
+        {
+            return false;
+        }
+
+        char* const pBytes = static_cast<char*>(pMapped);
+        char* const pVertices = pBytes + kHeaderSize;
+        char* const pIndices = pVertices + verticesSize(header.vertexCount);
+        char* const pBuffer = pIndices + indicesSize(header.triangleCount);
+        btOptimizedBvh* const pBvh =
+            btOptimizedBvh::deSerializeInPlace(pBuffer, header.bufferSize,
+                                               false);
+        if (pBvh == NULL)
+        {
+            munmap(pMapped, info.st_size);
+            return false;
+        }
+
+        data.pVertices = reinterpret_cast<btScalar*>(pVertices);
+        data.pIndices = reinterpret_cast<int*>(pIndices);
+        data.vertexCount = header.vertexCount;
+        data.triangleCount = header.triangleCount;
+        data.pBvh = pBvh;
+        data.pMapped = pMapped;
+        data.mappedSize = info.st_size;
+        return true;
+    }
+
+    /**
+     * Write the parsed mesh and the freshly built BVH. Goes through a
+     * temporary file so that parallel trials never map a partially
+     * written sidecar.
+     */
+    void writeBvh(const std::string& bvhFilename, const MeshData& data,
+                  const struct stat& meshInfo, double scale, uint64_t fileHash)
+    {
+        const unsigned bufferSize = data.pBvh->calculateSerializeBufferSize();
+        void* const pBuffer = btAlignedAlloc(bufferSize, kAlignment);
+        if (!data.pBvh->serializeInPlace(pBuffer, bufferSize, false))
+        {
+            btAlignedFree(pBuffer);
+            return;
+        }
+
+        BvhFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.scalarSize = sizeof(btScalar);
+        header.checksum = fileHash;
+        header.triangleCount = data.triangleCount;
+        header.vertexCount = data.vertexCount;
+        header.bufferSize = bufferSize;
+        header.meshSize = meshInfo.st_size;
+        header.meshTime = meshInfo.st_mtime;
+        header.scale = scale;
+
+        // Everything but the BVH, with the padding after each part
+        std::vector<char> head(kHeaderSize +
+                               verticesSize(data.vertexCount) +
+                               indicesSize(data.triangleCount), 0);
+        std::memcpy(&head[0], &header, sizeof(header));
+        std::memcpy(&head[kHeaderSize], data.pVertices,
+                    data.vertexCount * 3 * sizeof(btScalar));
+        std::memcpy(&head[kHeaderSize + verticesSize(data.vertexCount)],
+                    data.pIndices, data.triangleCount * 3 * sizeof(int));
+
+        std::ostringstream tmpFilename;
+        tmpFilename << bvhFilename << ".tmp" << getpid();
+        std::ofstream out(tmpFilename.str().c_str(), std::ios::binary);
+        out.write(&head[0], head.size());
+        out.write(static_cast<const char*>(pBuffer), bufferSize);
+        out.close();
+        btAlignedFree(pBuffer);
+
+        if (!out || std::rename(tmpFilename.str().c_str(), bvhFilename.c_str()) != 0)
+        {
+            std::remove(tmpFilename.str().c_str());
+            std::cerr << "Could not write BVH cache " << bvhFilename << std::endl;
+        }
+    }
+
+    /** Parse the mesh file into data's vectors */
+    void parseMesh(const std::string& filename, const std::vector<char>& file,
+                   std::size_t size, MeshData& data, double scale)
+    {
+        const std::string ext = lowerExtension(filename);
+        if (ext == "stl")
+        {
+            loadSTL(file, size, data, scale);
+        }
+        else if (ext == "obj")
+        {
+            loadOBJ(file, size, data, scale);
+        }
+        else
+        {
+            throw std::runtime_error("Unsupported mesh file " + filename);
+        }
+
+        if (data.indices.empty())
+        {
+            throw std::runtime_error("No triangles in " + filename);
+        }
+        data.pVertices = &data.vertices[0];
+        data.pIndices = &data.indices[0];
+        data.vertexCount = data.vertices.size() / 3;
+        data.triangleCount = data.indices.size() / 3;
+    }
+
+    MeshData* loadMesh(const std::string& filename,
+                       const tgMeshGround::Config& config)
+    {
+        struct stat meshInfo;
+        if (stat(filename.c_str(), &meshInfo) != 0)
+        {
+            throw std::runtime_error("Could not open mesh file " + filename);
+        }
+        const std::string bvhFilename = filename + ".bvh";
+
+        MeshData* const pData = new MeshData();
+        try
+        {
+            const bool mapped = config.m_useBvhFile &&
+                mapBvh(filename, bvhFilename, meshInfo, config.m_scale, *pData);
+            // Only read when the sidecar cannot be used
+            std::vector<char> file;
+            std::size_t size = 0;
+            if (!mapped)
+            {
+                size = readFile(filename, file);
+                parseMesh(filename, file, size, *pData, config.m_scale);
+            }
+
+            const int vertexStride = 3 * sizeof(btScalar);
+            const int indexStride = 3 * sizeof(int);
+            pData->pMesh =
+                new btTriangleIndexVertexArray(pData->triangleCount,
+                        pData->pIndices,
+                        indexStride,
+                        pData->vertexCount,
+                        pData->pVertices,
+                        vertexStride);
+
+            if (!mapped)
+            {
+                const bool useQuantizedAabbCompression = true;
+                btVector3 aabbMin;
+                btVector3 aabbMax;
+                pData->pMesh->calculateAabbBruteForce(aabbMin, aabbMax);
+
+                pData->pBvh = new btOptimizedBvh();
+                pData->pBvh->build(pData->pMesh, useQuantizedAabbCompression,
+                                   aabbMin, aabbMax);
+
+                if (config.m_useBvhFile)
+                {
+                    writeBvh(bvhFilename, *pData, meshInfo, config.m_scale,
+                             fileChecksum(file, size, config.m_scale));
+                }
+            }
+        }
+        catch (...)
+        {
+            delete pData;
+            throw;
+        }
+
+        return pData;
+    }
+}
+
+tgMeshGround::Config::Config( btVector3 eulerAngles,
+        btScalar friction,
+        btScalar restitution,
+        btVector3 origin,
+        double scale,
+        double margin,
+        bool useBvhFile ) :
+    m_eulerAngles(eulerAngles),
+    m_friction(friction),
+    m_restitution(restitution),
+    m_origin(origin),
+    m_scale(scale),
+    m_margin(margin),
+    m_useBvhFile(useBvhFile)
+{
+    assert((m_friction >= 0.0) && (m_friction <= 1.0));
+    assert((m_restitution >= 0.0) && (m_restitution <= 1.0));
+    assert(m_scale > 0.0);
+    assert(m_margin >= 0.0);
+}
+
+tgMeshGround::tgMeshGround(const std::string& filename) :
+    m_config(Config())
+{
+    init(filename);
+}
+
+tgMeshGround::tgMeshGround(const std::string& filename,
+                           const tgMeshGround::Config& config) :
+    m_config(config)
+{
+    init(filename);
+}
+
+void tgMeshGround::clearCache()
+{
+    MeshCache& cache = meshCache();
+    for (MeshCache::iterator it = cache.begin(); it != cache.end(); ++it)
+    {
+        delete it->second;
+    }
+    cache.clear();
+}
+
+void tgMeshGround::init(const std::string& filename)
+{
+    std::ostringstream key;
+    key.precision(17);
+    key << filename << " " << m_config.m_scale;
+
+    MeshCache& cache = meshCache();
+    MeshCache::iterator it = cache.find(key.str());
+    MeshData* pData = NULL;
+    if (it != cache.end())
+    {
+        pData = it->second;
+    }
+    else
+    {
+        pData = loadMesh(filename, m_config);
+        cache[key.str()] = pData;
+    }
+    assert(pData && pData->pMesh && pData->pBvh);
+
+    // The shape shares the BVH and will not delete it
+    const bool useQuantizedAabbCompression = true;
+    const bool buildBvh = false;
+    btBvhTriangleMeshShape* const pShape =
+        new btBvhTriangleMeshShape(pData->pMesh,
+                                   useQuantizedAabbCompression,
+                                   buildBvh);
+    pShape->setOptimizedBvh(pData->pBvh);
+    pShape->setMargin(m_config.m_margin);
+
+    pGroundShape = pShape;
+}
+
+btRigidBody* tgMeshGround::getGroundRigidBody() const
+{
+    const btScalar mass = 0.0;
+
+    btTransform groundTransform;
+    groundTransform.setIdentity();
+    groundTransform.setOrigin(m_config.m_origin);
+
+    btQuaternion orientation;
+    orientation.setEuler(m_config.m_eulerAngles[0], // Yaw
+                         m_config.m_eulerAngles[1], // Pitch
+                         m_config.m_eulerAngles[2]); // Roll
+    groundTransform.setRotation(orientation);
+
+    // Using motionstate is recommended
+    // It provides interpolation capabilities, and only synchronizes 'active' objects
+    btDefaultMotionState* const pMotionState =
+        new btDefaultMotionState(groundTransform);
+
+    const btVector3 localInertia(0, 0, 0);
+
+    btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, pMotionState, pGroundShape, localInertia);
+    rbInfo.m_friction = m_config.m_friction;
+    rbInfo.m_restitution = m_config.m_restitution;
+
+    btRigidBody* const pGroundBody = new btRigidBody(rbInfo);
+
+    assert(pGroundBody);
+    return pGroundBody;
+}
@@ -0,0 +1,145 @@
+/**
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+#ifndef CORE_TERRAIN_TG_MESH_GROUND_H
+#define CORE_TERRAIN_TG_MESH_GROUND_H
+
+/**
+ * @file tgMeshGround.h
+ * @brief Contains the definition of class tgMeshGround.
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include "tgBulletGround.h"
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <string>
+
+// Forward declarations
+class btRigidBody;
+
+/**
+ * A ground made from a triangle mesh file, such as a scanned site model.
+ * Binary and ASCII STL and Wavefront OBJ files are supported.
+ *
+ * The parsed mesh and its optimized BVH are built once and serialized
+ * next to the mesh file (mesh filename + ".bvh"). Later runs memory map
+ * the sidecar instead of parsing the mesh and rebuilding the tree. The
+ * sidecar is current while the mesh file keeps the size and
+ * modification time it had and the scale is the same, so the mesh file
+ * is not even read; it is only hashed when just its time has changed.
+ * Within one process the mesh and BVH are also kept in memory, so
+ * creating a new tgMeshGround for every trial only costs a new
+ * collision shape.
+ */
+class tgMeshGround : public tgBulletGround
+{
+public:
+
+    struct Config
+    {
+    public:
+        Config( btVector3 eulerAngles = btVector3(0.0, 0.0, 0.0),
+                btScalar friction = 0.5,
+                btScalar restitution = 0.0,
+                btVector3 origin = btVector3(0.0, 0.0, 0.0),
+                double scale = 1.0,
+                double margin = 0.05,
+                bool useBvhFile = true );
+      /**
+       * Euler angles are specified as yaw pitch and roll
+       */
+      btVector3 m_eulerAngles;
+
+      /**
+       * Friction value of the ground, must be between 0 to 1
+       */
+      btScalar  m_friction;
+
+       /**
+       * Restitution coefficient of the ground, must be between 0 to 1
+       */
+      btScalar  m_restitution;
+
+      /**
+       * Origin position of the ground
+       */
+      btVector3 m_origin;
+
+      /**
+       * Uniform scale applied to the mesh vertices, must be positive.
+       * Mesh units are often mm while the simulation is in dm or cm.
+       */
+      double m_scale;
+
+      /**
+       * See Bullet documentation on Collision Margin
+       */
+      double m_margin;
+
+      /**
+       * Read and write the serialized BVH sidecar file. If false the
+       * BVH is still shared within the process.
+       */
+      bool m_useBvhFile;
+    };
+
+    /**
+     * Load the mesh in filename with the default config
+     * @param[in] filename a .stl or .obj file.
+     * std::runtime_error is thrown if it cannot be read
+     */
+    tgMeshGround(const std::string& filename);
+
+    /**
+     * Load the mesh in filename with a user specified config
+     */
+    tgMeshGround(const std::string& filename,
+                 const tgMeshGround::Config& config);
+
+    /** Clean up the implementation. Cached meshes are not deleted */
+    virtual ~tgMeshGround() { }
+
+    /**
+     * Setup and return a return a rigid body based on the collision
+     * object
+     */
+    virtual btRigidBody* getGroundRigidBody() const;
+
+    /**
+     * Release the meshes and BVHs shared between grounds. Must only be
+     * called when no tgMeshGround exists.
+     */
+    static void clearCache();
+
+private:
+
+    /** Create pGroundShape from the cached mesh */
+    void init(const std::string& filename);
+
+    /**
+     * Store the configuration data for use later
+     */
+    Config m_config;
+};
+
+#endif  // CORE_TERRAIN_TG_MESH_GROUND_H
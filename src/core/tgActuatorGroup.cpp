@@ -0,0 +1,283 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgActuatorGroup.cpp
+ * @brief Contains the implementation of class tgActuatorGroup
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgActuatorGroup.h"
+// This library
+#include "tgBasicActuator.h"
+#include "tgKinematicActuator.h"
+#include "tgModel.h"
+#include "tgSpringCable.h"
+// The Bullet Physics Library
+#include "LinearMath/btQuickprof.h"
+
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+tgActuatorGroup::tgActuatorGroup()
+{
+    assert(invariant());
+}
+
+tgActuatorGroup::tgActuatorGroup(tgModel& model, const std::string& tags) :
+    m_basic(model.find<tgBasicActuator>(tags)),
+    m_kinematic(model.find<tgKinematicActuator>(tags))
+{
+    constructorAux();
+}
+
+tgActuatorGroup::tgActuatorGroup(const std::vector<tgBasicActuator*>& basic,
+                    const std::vector<tgKinematicActuator*>& kinematic) :
+    m_basic(basic),
+    m_kinematic(kinematic)
+{
+    constructorAux();
+}
+
+void tgActuatorGroup::constructorAux()
+{
+    const std::size_t n = m_basic.size();
+    m_restLengths.resize(n);
+    m_actualLengths.resize(n);
+    m_preferredLengths.resize(n);
+    m_stiffness.resize(n);
+    m_maxTension.resize(n);
+    m_targetVelocity.resize(n);
+    m_minActualLength.resize(n);
+    m_minRestLength.resize(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const tgBasicActuator* const pActuator = m_basic[i];
+        if (pActuator == NULL)
+        {
+            throw std::invalid_argument("Actuator group member is NULL");
+        }
+        const tgSpringCableActuator::Config& config = pActuator->m_config;
+        m_stiffness[i] = pActuator->m_springCable->getCoefK();
+        m_maxTension[i] = config.maxTens;
+        m_targetVelocity[i] = config.targetVelocity;
+        m_minActualLength[i] = config.minActualLength;
+        m_minRestLength[i] = config.minRestLength;
+    }
+
+    const std::size_t m = m_kinematic.size();
+    m_kinRestLengths.resize(m);
+    m_kinTensions.resize(m);
+    m_motorVel.resize(m);
+    m_motorAcc.resize(m);
+    m_appliedTorque.resize(m);
+    m_radius.resize(m);
+    m_motorFriction.resize(m);
+    m_motorInertia.resize(m);
+    m_kinMaxTension.resize(m);
+    m_kinTargetVelocity.resize(m);
+    m_kinMinRestLength.resize(m);
+    m_backdrivable.resize(m);
+    for (std::size_t i = 0; i < m; i++)
+    {
+        const tgKinematicActuator* const pActuator = m_kinematic[i];
+        if (pActuator == NULL)
+        {
+            throw std::invalid_argument("Actuator group member is NULL");
+        }
+        const tgKinematicActuator::Config& config = pActuator->m_config;
+        m_radius[i] = config.radius;
+        m_motorFriction[i] = config.motorFriction;
+        m_motorInertia[i] = config.motorInertia;
+        m_kinMaxTension[i] = config.maxTens;
+        m_kinTargetVelocity[i] = config.targetVelocity;
+        m_kinMinRestLength[i] = config.minRestLength;
+        m_backdrivable[i] = config.backdrivable ? 1 : 0;
+    }
+
+    assert(invariant());
+}
+
+void tgActuatorGroup::setRestLengths(const std::vector<double>& lengths,
+                                        double dt)
+{
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgActuatorGroup::setRestLengths");
+#endif //BT_NO_PROFILE
+    const std::size_t n = m_basic.size();
+    if (lengths.size() != n)
+    {
+        throw std::invalid_argument("Wrong number of rest lengths for group");
+    }
+    else if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive.");
+    }
+
+    // Gather. Lengths are cached by the cable after each world step
+    for (std::size_t i = 0; i < n; i++)
+    {
+        if (lengths[i] < 0.0)
+        {
+            throw std::invalid_argument("Rest length is negative.");
+        }
+        m_restLengths[i] = m_basic[i]->m_restLength;
+        m_actualLengths[i] = m_basic[i]->m_springCable->getActualLength();
+    }
+
+    // Same motor model as tgBasicActuator::moveMotors, for all members
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double stepSize = m_targetVelocity[i] * dt;
+        const double actualLength = m_actualLengths[i];
+        double preferredLength = lengths[i];
+
+        // First, change preferred length so we don't go over max tension
+        if ((actualLength - preferredLength) * m_stiffness[i] > m_maxTension[i])
+        {
+            preferredLength = actualLength - m_maxTension[i] / m_stiffness[i];
+        }
+
+        const double diff = preferredLength - m_restLengths[i];
+
+        // actualLength must be greater than minActualLength to shorten
+        if ((actualLength > m_minActualLength[i]) || (diff > 0))
+        {
+            if (std::abs(diff) > stepSize)
+            {
+                m_restLengths[i] += (diff > 0.0) ? stepSize : -stepSize;
+            }
+            else
+            {
+                m_restLengths[i] += diff;
+            }
+        }
+
+        m_restLengths[i] = (m_restLengths[i] > m_minRestLength[i]) ?
+                            m_restLengths[i] : m_minRestLength[i];
+        m_preferredLengths[i] = preferredLength;
+    }
+
+    // Scatter
+    for (std::size_t i = 0; i < n; i++)
+    {
+        tgBasicActuator* const pActuator = m_basic[i];
+        pActuator->m_preferredLength = m_preferredLengths[i];
+        pActuator->m_restLength = m_restLengths[i];
+        pActuator->m_springCable->setRestLength(m_restLengths[i]);
+    }
+}
+
+void tgActuatorGroup::setTorques(const std::vector<double>& torques,
+                                    double dt)
+{
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgActuatorGroup::setTorques");
+#endif //BT_NO_PROFILE
+    const std::size_t n = m_kinematic.size();
+    if (torques.size() != n)
+    {
+        throw std::invalid_argument("Wrong number of torques for group");
+    }
+    else if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive.");
+    }
+
+    // Gather
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const tgKinematicActuator* const pActuator = m_kinematic[i];
+        m_kinRestLengths[i] = pActuator->m_restLength;
+        m_kinTensions[i] = pActuator->m_springCable->getTension();
+        m_motorVel[i] = pActuator->m_motorVel;
+    }
+
+    // Same motor model as tgKinematicActuator::integrateRestLength
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double radius = m_radius[i];
+        double motorVel = m_motorVel[i];
+
+        // Linear torque-speed limit, as getAppliedTorque
+        double maxTorque = m_kinMaxTension[i] * radius *
+                    (1.0 - radius * std::abs(motorVel) / m_kinTargetVelocity[i]);
+        maxTorque = maxTorque < 0.0 ? 0.0 : maxTorque;
+        const double desiredTorque = torques[i];
+        const double appliedTorque = std::abs(desiredTorque) < maxTorque ?
+                    desiredTorque :
+                    desiredTorque / std::abs(desiredTorque) * maxTorque;
+
+        // motorVel will always cause opposite acc, but tension can only
+        // cause lengthening (positive Acc)
+        const double motorAcc = (appliedTorque - m_motorFriction[i] * motorVel
+                            + m_kinTensions[i] * radius) / m_motorInertia[i];
+
+        if (!m_backdrivable[i] && motorAcc * appliedTorque <= 0.0)
+        {
+            // Stop undesired lengthing if the motor is not backdrivable
+            motorVel = motorVel + motorAcc * dt > 0.0 ?
+                        0.0 : motorVel + motorAcc * dt;
+        }
+        else
+        {
+            motorVel += motorAcc * dt;
+        }
+
+        // semi-implicit Euler integration
+        double restLength = m_kinRestLengths[i] + radius * motorVel * dt;
+        restLength = (restLength > m_kinMinRestLength[i]) ?
+                        restLength : m_kinMinRestLength[i];
+
+        m_motorVel[i] = motorVel;
+        m_motorAcc[i] = motorAcc;
+        m_appliedTorque[i] = appliedTorque;
+        m_kinRestLengths[i] = restLength;
+    }
+
+    // Scatter
+    for (std::size_t i = 0; i < n; i++)
+    {
+        tgKinematicActuator* const pActuator = m_kinematic[i];
+        pActuator->m_desiredTorque = torques[i];
+        pActuator->m_motorVel = m_motorVel[i];
+        pActuator->m_motorAcc = m_motorAcc[i];
+        pActuator->m_appliedTorque = m_appliedTorque[i];
+        pActuator->m_restLength = m_kinRestLengths[i];
+        pActuator->m_springCable->setRestLength(m_kinRestLengths[i]);
+        pActuator->m_restLengthIntegrated = true;
+    }
+}
+
+bool tgActuatorGroup::invariant() const
+{
+    const std::size_t n = m_basic.size();
+    const std::size_t m = m_kinematic.size();
+    return (m_restLengths.size() == n) &&
+        (m_actualLengths.size() == n) &&
+        (m_preferredLengths.size() == n) &&
+        (m_stiffness.size() == n) &&
+        (m_minRestLength.size() == n) &&
+        (m_motorVel.size() == m) &&
+        (m_backdrivable.size() == m) &&
+        (m_kinMinRestLength.size() == m);
+}
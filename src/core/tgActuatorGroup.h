@@ -0,0 +1,153 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_ACTUATOR_GROUP_H_
+#define SRC_CORE_TG_ACTUATOR_GROUP_H_
+
+/**
+ * @file tgActuatorGroup.h
+ * @brief Contains the definition of class tgActuatorGroup
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgBasicActuator;
+class tgKinematicActuator;
+class tgModel;
+
+/**
+ * Controls a fixed set of actuators with one call per control tick.
+ * Open loop controllers hand the group one target per actuator instead
+ * of looping over the actuators themselves.
+ *
+ * The motor models of tgBasicActuator::moveMotors and
+ * tgKinematicActuator::integrateRestLength are run as a single pass
+ * over arrays held by the group, one array per quantity. The actuator
+ * configs are copied in once when the group is built; per tick the
+ * group gathers the cached lengths and tensions, integrates, and
+ * writes the rest lengths back.
+ *
+ * Actuators are recreated when a simulation resets, so build the group
+ * in a controller's onSetup.
+ */
+class tgActuatorGroup
+{
+public:
+
+    /** An empty group */
+    tgActuatorGroup();
+
+    /**
+     * All basic and kinematic actuators below model matching tags
+     * @param[in] model, the model to search
+     * @param[in] tags, a tag search such as "muscle cluster1"
+     */
+    tgActuatorGroup(tgModel& model, const std::string& tags);
+
+    /**
+     * A group of the given actuators, in the given order
+     * @param[in] basic, actuators controlled by setRestLengths
+     * @param[in] kinematic, actuators controlled by setTorques
+     */
+    explicit tgActuatorGroup(const std::vector<tgBasicActuator*>& basic,
+                const std::vector<tgKinematicActuator*>& kinematic =
+                    std::vector<tgKinematicActuator*>());
+
+    const std::vector<tgBasicActuator*>& getBasicActuators() const
+    {
+        return m_basic;
+    }
+
+    const std::vector<tgKinematicActuator*>& getKinematicActuators() const
+    {
+        return m_kinematic;
+    }
+
+    /**
+     * Equivalent to calling setControlInput(lengths[i], dt) on every
+     * basic actuator: sets the preferred lengths and moves the rest
+     * lengths toward them, limited by each actuator's target velocity
+     * and maximum tension.
+     * @param[in] lengths, one preferred rest length per basic actuator,
+     * each non-negative
+     * @param[in] dt, time elapsed since the last call, must be positive
+     * @throw std::invalid_argument if the sizes differ or a length is
+     * negative
+     */
+    void setRestLengths(const std::vector<double>& lengths, double dt);
+
+    /**
+     * Sets the desired motor torque of every kinematic actuator and
+     * integrates the motor dynamics for dt. The actuators skip their own
+     * integrateRestLength in their next step.
+     * @param[in] torques, one desired torque per kinematic actuator
+     * @param[in] dt, the step the actuators are about to take, must be
+     * positive
+     * @throw std::invalid_argument if the sizes differ
+     */
+    void setTorques(const std::vector<double>& torques, double dt);
+
+private:
+
+    /** Copy the configs of the actuators into the arrays below */
+    void constructorAux();
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    std::vector<tgBasicActuator*> m_basic;
+    std::vector<tgKinematicActuator*> m_kinematic;
+
+    /**
+     * Basic actuator motor state and parameters, one entry per member
+     * of m_basic
+     */
+    std::vector<double> m_restLengths;
+    std::vector<double> m_actualLengths;
+    std::vector<double> m_preferredLengths;
+    std::vector<double> m_stiffness;
+    std::vector<double> m_maxTension;
+    std::vector<double> m_targetVelocity;
+    std::vector<double> m_minActualLength;
+    std::vector<double> m_minRestLength;
+
+    /**
+     * Kinematic actuator motor state and parameters, one entry per
+     * member of m_kinematic
+     */
+    std::vector<double> m_kinRestLengths;
+    std::vector<double> m_kinTensions;
+    std::vector<double> m_motorVel;
+    std::vector<double> m_motorAcc;
+    std::vector<double> m_appliedTorque;
+    std::vector<double> m_radius;
+    std::vector<double> m_motorFriction;
+    std::vector<double> m_motorInertia;
+    std::vector<double> m_kinMaxTension;
+    std::vector<double> m_kinTargetVelocity;
+    std::vector<double> m_kinMinRestLength;
+    /** Stored as char, std::vector<bool> is not contiguous */
+    std::vector<char> m_backdrivable;
+};
+
+#endif  // SRC_CORE_TG_ACTUATOR_GROUP_H_
@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgActuatorRegistry.cpp
+ * @brief Contains the implementation of class tgActuatorRegistry
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgActuatorRegistry.h"
+// This library
+#include "tgBasicActuator.h"
+#include "tgBulletCompressionSpring.h"
+#include "tgBulletContactSpringCable.h"
+#include "tgBulletSpringCable.h"
+#include "tgBulletUnidirComprSpr.h"
+#include "tgCompressionSpringActuator.h"
+#include "tgKinematicActuator.h"
+#include "tgModel.h"
+#include "tgUnidirComprSprActuator.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+#include <typeinfo>
+
+tgActuatorRegistry::tgActuatorRegistry()
+{
+    assert(invariant());
+}
+
+tgActuatorRegistry::~tgActuatorRegistry()
+{
+    clear();
+}
+
+void tgActuatorRegistry::add(tgModel& model)
+{
+    std::vector<tgModel*> models = model.getDescendants();
+    models.push_back(&model);
+
+    for (std::size_t i = 0; i < models.size(); i++)
+    {
+        tgModel* const pModel = models[i];
+        // Only exact classes, a subclass may have a step of its own
+        const std::type_info& type = typeid(*pModel);
+        if (type == typeid(tgBasicActuator))
+        {
+            addSpringCable(static_cast<tgBasicActuator*>(pModel),
+                           m_basic, m_basicContact);
+        }
+        else if (type == typeid(tgKinematicActuator))
+        {
+            addSpringCable(static_cast<tgKinematicActuator*>(pModel),
+                           m_kinematic, m_kinematicContact);
+        }
+        else if (type == typeid(tgCompressionSpringActuator) ||
+                 type == typeid(tgUnidirComprSprActuator))
+        {
+            tgCompressionSpringActuator* const pActuator =
+                static_cast<tgCompressionSpringActuator*>(pModel);
+            const tgBulletCompressionSpring* const pSpring =
+                pActuator->getCompressionSpring();
+            if (pSpring == NULL)
+            {
+                continue;
+            }
+            else if (typeid(*pSpring) == typeid(tgBulletCompressionSpring))
+            {
+                m_compression.push_back(pActuator);
+            }
+            else if (typeid(*pSpring) == typeid(tgBulletUnidirComprSpr))
+            {
+                m_unidirCompression.push_back(pActuator);
+            }
+            else
+            {
+                continue;
+            }
+            pActuator->m_steppedByRegistry = true;
+        }
+    }
+
+    assert(invariant());
+}
+
+template <typename Actuator>
+bool tgActuatorRegistry::addSpringCable(Actuator* pActuator,
+                                        std::vector<Actuator*>& plain,
+                                        std::vector<Actuator*>& contact)
+{
+    const tgSpringCable* const pCable = pActuator->getSpringCable();
+    if (pCable == NULL)
+    {
+        return false;
+    }
+    else if (typeid(*pCable) == typeid(tgBulletSpringCable))
+    {
+        plain.push_back(pActuator);
+    }
+    else if (typeid(*pCable) == typeid(tgBulletContactSpringCable))
+    {
+        contact.push_back(pActuator);
+    }
+    else
+    {
+        return false;
+    }
+    pActuator->m_steppedByRegistry = true;
+    return true;
+}
+
+template <typename Actuator>
+void tgActuatorRegistry::release(std::vector<Actuator*>& actuators)
+{
+    for (std::size_t i = 0; i < actuators.size(); i++)
+    {
+        actuators[i]->m_steppedByRegistry = false;
+    }
+    actuators.clear();
+}
+
+template <typename Actuator, typename Part>
+void tgActuatorRegistry::stepEach(const std::vector<Actuator*>& actuators,
+                                  double dt)
+{
+    const std::size_t n = actuators.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        actuators[i]->template stepStatic<Part>(dt);
+    }
+}
+
+void tgActuatorRegistry::step(double dt) const
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgActuatorRegistry::step");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive.");
+    }
+    stepEach<tgBasicActuator, tgBulletSpringCable>(m_basic, dt);
+    stepEach<tgBasicActuator, tgBulletContactSpringCable>(m_basicContact, dt);
+    stepEach<tgKinematicActuator, tgBulletSpringCable>(m_kinematic, dt);
+    stepEach<tgKinematicActuator, tgBulletContactSpringCable>(
+        m_kinematicContact, dt);
+    stepEach<tgCompressionSpringActuator, tgBulletCompressionSpring>(
+        m_compression, dt);
+    stepEach<tgCompressionSpringActuator, tgBulletUnidirComprSpr>(
+        m_unidirCompression, dt);
+}
+
+void tgActuatorRegistry::clear()
+{
+    release(m_basic);
+    release(m_basicContact);
+    release(m_kinematic);
+    release(m_kinematicContact);
+    release(m_compression);
+    release(m_unidirCompression);
+
+    assert(invariant());
+}
+
+std::size_t tgActuatorRegistry::size() const
+{
+    return m_basic.size() + m_basicContact.size() + m_kinematic.size() +
+        m_kinematicContact.size() + m_compression.size() +
+        m_unidirCompression.size();
+}
+
+bool tgActuatorRegistry::invariant() const
+{
+    return true;
+}
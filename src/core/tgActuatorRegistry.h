@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ACTUATOR_REGISTRY_H
+#define TG_ACTUATOR_REGISTRY_H
+
+/**
+ * @file tgActuatorRegistry.h
+ * @brief Contains the definition of class tgActuatorRegistry
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgBasicActuator;
+class tgCompressionSpringActuator;
+class tgKinematicActuator;
+class tgModel;
+
+/**
+ * Steps the actuators of a set of models without virtual calls. Each
+ * actuator whose class, and whose cable or spring class, is known
+ * exactly is kept in an array of its own, one array per combination,
+ * and each array is stepped by a loop that calls the concrete step
+ * functions directly, so they can be inlined.
+ *
+ * The model tree is unchanged: registered actuators stay children of
+ * their models, but tgModel::step skips them, and their own step() does
+ * nothing, until clear() is called. The registry steps their children
+ * through tgModel::step. Actuators of other
+ * classes, including subclasses of the ones below, keep being stepped
+ * through the tree.
+ *
+ * Actuators are recreated when a simulation resets, so clear the
+ * registry before the models are torn down and add them again after
+ * they are set up. tgSimulation does this when
+ * Config::staticActuators is set.
+ */
+class tgActuatorRegistry
+{
+public:
+
+    tgActuatorRegistry();
+
+    /** Returns the registered actuators to being stepped by the tree */
+    ~tgActuatorRegistry();
+
+    /**
+     * Register the actuators among model and its descendants. The model
+     * must have been set up.
+     * @param[in] model, the model to search
+     */
+    void add(tgModel& model);
+
+    /**
+     * Step every registered actuator as its step() would: notify its
+     * observers, step its cable or spring, log history and step its
+     * children.
+     * @param[in] dt, the time since the actuators were last stepped,
+     * must be positive
+     * @throw std::invalid_argument if dt is not positive
+     */
+    void step(double dt) const;
+
+    /** Forget every actuator, which then steps itself again */
+    void clear();
+
+    /** The number of registered actuators */
+    std::size_t size() const;
+
+private:
+
+    /**
+     * Register pActuator in plain or contact by the class of its cable.
+     * Returns false if the class is neither.
+     */
+    template <typename Actuator>
+    static bool addSpringCable(Actuator* pActuator,
+                               std::vector<Actuator*>& plain,
+                               std::vector<Actuator*>& contact);
+
+    /** Return actuators to being stepped by the tree and empty it */
+    template <typename Actuator>
+    static void release(std::vector<Actuator*>& actuators);
+
+    /** Step each actuator of actuators, whose part is exactly a Part */
+    template <typename Actuator, typename Part>
+    static void stepEach(const std::vector<Actuator*>& actuators, double dt);
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    /** By actuator class, then cable class */
+    std::vector<tgBasicActuator*> m_basic;
+    std::vector<tgBasicActuator*> m_basicContact;
+    std::vector<tgKinematicActuator*> m_kinematic;
+    std::vector<tgKinematicActuator*> m_kinematicContact;
+
+    /**
+     * By spring class. tgUnidirComprSprActuator only differs from its
+     * base in the spring it builds, so both share these.
+     */
+    std::vector<tgCompressionSpringActuator*> m_compression;
+    std::vector<tgCompressionSpringActuator*> m_unidirCompression;
+};
+
+#endif  // TG_ACTUATOR_REGISTRY_H
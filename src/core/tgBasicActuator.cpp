@@ -26,6 +26,7 @@
 // This Module
 #include "tgBulletSpringCable.h"
 #include "tgBasicActuator.h"
+#include "tgCheckpoint.h"
 #include "tgModelVisitor.h"
 #include "tgWorld.h"
 // The Bullet Physics Library
@@ -84,13 +85,13 @@ void tgBasicActuator::setup(tgWorld& world)
 {
     // This needs to be called here in case the controller needs to cast
     notifySetup();
-    tgModel::setup(world);
+    tgSpringCableActuator::setup(world);
 }
 
 void tgBasicActuator::teardown()
 {
     // Do not notify teardown. The controller has already been deleted.
-    tgModel::teardown();
+    tgSpringCableActuator::teardown();
 }
     
 void tgBasicActuator::step(double dt) 
@@ -102,16 +103,32 @@ void tgBasicActuator::step(double dt)
     {
         throw std::invalid_argument("dt is not positive.");
     }
+    else if (m_steppedByRegistry)
+    {
+        return;
+    }
     else
     {   
         // Want to update any controls before applying forces
         notifyStep(dt); 
-        m_springCable->step(dt);
+        stepSpringCable(dt);
         logHistory();  
         tgModel::step(dt);
     }
 }
 
+void tgBasicActuator::saveState(std::ostream& os)
+{
+    tgCheckpoint::write(os, m_preferredLength);
+    tgSpringCableActuator::saveState(os);
+}
+
+void tgBasicActuator::loadState(std::istream& is)
+{
+    tgCheckpoint::read(is, m_preferredLength);
+    tgSpringCableActuator::loadState(is);
+}
+
 void tgBasicActuator::onVisit(const tgModelVisitor& r) const
 {
 #ifndef BT_NO_PROFILE 
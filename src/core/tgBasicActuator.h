@@ -41,6 +41,12 @@ class tgBasicActuator : public tgSpringCableActuator
 {
 public: 
 
+    // Runs moveMotors for many actuators at once
+    friend class tgActuatorGroup;
+
+    // Steps actuators through stepStatic
+    friend class tgActuatorRegistry;
+
     /**
      * Constructor using tags. Typically called in tgBasicActuatorInfo.cpp 
      * @param[in] muscle The muscle2P object that this controls and logs.
@@ -84,6 +90,12 @@ public:
      * @param[in] r, the visiting tgModelVisitor
      */
     virtual void onVisit(const tgModelVisitor& r) const;
+
+    /** Writes the preferred length, then the base class's state */
+    virtual void saveState(std::ostream& os);
+
+    /** Reads back what saveState() wrote */
+    virtual void loadState(std::istream& is);
     
     
     /** Functions for interfacing with higher level controllers */
@@ -116,6 +128,19 @@ private:
      */
     void constructorAux();
 
+    /**
+     * The work of step(dt) for an actuator whose cable is exactly a
+     * Cable, without the checks and virtual calls. dt must be positive.
+     */
+    template <typename Cable>
+    void stepStatic(double dt)
+    {
+        notifyStep(dt);
+        stepSpringCableAs<Cable>(dt);
+        logHistory();
+        tgModel::step(dt);
+    }
+
     /**
      * Append damping, rest length and tension values to the history member
      * variables.
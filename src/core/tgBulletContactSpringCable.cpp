@@ -31,6 +31,7 @@
 #include "tgcreator/tgUtil.h"
 #include "core/tgBulletSpringCableAnchor.h"
 #include "core/tgCast.h"
+#include "core/tgTrialFailure.h"
 #include "core/tgBulletUtil.h"
 #include "core/tgWorld.h"
 #include "core/tgWorldBulletPhysicsImpl.h"
@@ -81,9 +82,10 @@ tgBulletContactSpringCable::~tgBulletContactSpringCable()
     delete m_ghostObject;
 }
 
-const btScalar tgBulletContactSpringCable::getActualLength() const
+const double tgBulletContactSpringCable::getActualLength() const
 {
-    btScalar length = 0;
+    // Summed in double, as tgSpringCable declares, whatever btScalar is
+    double length = 0.0;
     
     std::size_t n = m_anchors.size() - 1;
     for (std::size_t i = 0; i < n; i++)
@@ -212,7 +214,7 @@ void tgBulletContactSpringCable::calculateAndApplyForce(double dt)
     if (!totalForce.fuzzyZero())
     {
         std::cout << "Total Force Error! " << totalForce << std::endl;
-        throw std::runtime_error("Total force did not sum to zero!");
+        throw tgTrialFailure("Total force did not sum to zero!");
     }
     
     // Finished calculating, so can store things
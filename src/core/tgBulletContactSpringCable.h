@@ -108,10 +108,16 @@ public:
     virtual void step(double dt);
     
     /**
-     * @return a btScalar of the string's actual length - the sum of the
-     * lengths between the anchors.
+     * @return the string's actual length - the sum of the lengths
+     * between the anchors.
      */
-    virtual const btScalar getActualLength() const;
+    virtual const double getActualLength() const;
+    
+    /**
+     * False: the sliding anchors are only updated in step, so the world
+     * must keep stepping this cable
+     */
+    virtual bool canApplyForceInTick() const { return false; }
     
 private:
     
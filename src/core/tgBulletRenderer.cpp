@@ -29,10 +29,12 @@
 #include "abstractMarker.h"
 #include "tgSpringCable.h"
 #include "tgBulletCompressionSpring.h"
+#include "tgBulletSpringCable.h"
 #include "tgSpringCableAnchor.h"
 #include "tgBulletUtil.h"
 #include "tgSpringCableActuator.h"
 #include "tgCompressionSpringActuator.h"
+#include "tgCordeModel.h"
 #include "tgWorld.h"
 #include "tgWorldBulletPhysicsImpl.h"
 
@@ -46,6 +48,7 @@
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
 // The C++ Standard Library
 #include <cassert>
+#include <vector>
 
 
 tgBulletRenderer::tgBulletRenderer(const tgWorld& world) : m_world(world)
@@ -75,24 +78,22 @@ void tgBulletRenderer::render(const tgSpringCableActuator& mSCA) const
     
     if(pDrawer && pSpringCable)
     {
-		const std::vector<const tgSpringCableAnchor*>& anchors = pSpringCable->getAnchors();
-		std::size_t n = anchors.size() - 1;
-		for (std::size_t i = 0; i < n; i++)
+	   // Should this be normalized??
+	  const double stretch = 
+		mSCA.getCurrentLength() - mSCA.getRestLength();
+	  const btVector3 color =
+		(stretch < 0.0) ?
+		btVector3(0.0, 0.0, 1.0) :
+		btVector3(0.5 + stretch / 3.0, 
+			  0.5 - stretch / 2.0, 
+			  0.0);
+		
+		// Cached once per step where the cable caches its state
+		std::vector<btVector3> positions;
+		pSpringCable->getAnchorWorldPositions(positions);
+		for (std::size_t i = 1; i < positions.size(); i++)
 		{
-			const btVector3 lineFrom =
-			anchors[i]->getWorldPosition();
-		  const btVector3 lineTo = 
-			anchors[i+1]->getWorldPosition();
-		   // Should this be normalized??
-		  const double stretch = 
-			mSCA.getCurrentLength() - mSCA.getRestLength();
-		  const btVector3 color =
-			(stretch < 0.0) ?
-			btVector3(0.0, 0.0, 1.0) :
-			btVector3(0.5 + stretch / 3.0, 
-				  0.5 - stretch / 2.0, 
-				  0.0);
-		  pDrawer->drawLine(lineFrom, lineTo, color);
+		  pDrawer->drawLine(positions[i-1], positions[i], color);
 		}
 	}
 }
@@ -176,6 +177,25 @@ void tgBulletRenderer::render(const tgCompressionSpringActuator& mCSA) const
 	}
 }
 
+void tgBulletRenderer::render(const tgCordeModel& rod) const
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgBulletRenderer::renderCorde");
+#endif //BT_NO_PROFILE 
+    btDynamicsWorld& dynamicsWorld =
+      tgBulletUtil::worldToDynamicsWorld(m_world);
+    btIDebugDraw* const pDrawer = dynamicsWorld.getDebugDrawer();
+    if (pDrawer)
+    {
+        const std::vector<btVector3>& positions = rod.getPositions();
+        const btVector3 color(0.5, 0.5, 0.0);
+        for (std::size_t i = 1; i < positions.size(); i++)
+        {
+            pDrawer->drawLine(positions[i - 1], positions[i], color);
+        }
+    }
+}
+
 void tgBulletRenderer::render(const tgModel& model) const
 {
 #ifndef BT_NO_PROFILE 
@@ -32,6 +32,7 @@
 // Forward declarations
 class tgSpringCableActuator;
 class tgCompressionSpringActuator;
+class tgCordeModel;
 class tgModel;
 class tgRod;
 class tgWorld;
@@ -66,6 +67,12 @@ public:
    * @param[in] rod a const reference to a tgRod to render
    */
   virtual void render(const tgRod& rod) const;
+
+  /**
+   * Render a tgCordeModel as the polyline through its mass points.
+   * @param[in] rod a const reference to a tgCordeModel to render
+   */
+  virtual void render(const tgCordeModel& rod) const;
         
   /**
    * Render a tgModel.
@@ -40,9 +40,19 @@ tgSpringCable(tgCast::filter<tgBulletSpringCableAnchor, tgSpringCableAnchor>(anc
                 coefK, dampingCoefficient, pretension),
 m_anchors(anchors),
 anchor1(anchors.front()),
-anchor2(anchors.back())
+anchor2(anchors.back()),
+m_sleepStretch(0.0),
+m_sleepVelocity(0.0),
+m_anchor1Position(0.0, 0.0, 0.0),
+m_anchor2Position(0.0, 0.0, 0.0),
+m_actualLength(0.0),
+m_tickForce(0.0, 0.0, 0.0),
+m_tickPosition1(0.0, 0.0, 0.0),
+m_tickPosition2(0.0, 0.0, 0.0),
+m_tickForceApplied(false)
 {
     assert(m_anchors.size() >= 2);
+    updateState();
     assert(invariant());
     // tgSpringCable does heavy lifting as far as determining rest length
 }
@@ -83,19 +93,70 @@ void tgBulletSpringCable::step(double dt)
         throw std::invalid_argument("dt is not positive!");
     }
 
+    if (!m_stateCached)
+    {
+        updateState();
+    }
     calculateAndApplyForce(dt);
     assert(invariant());
 }
 
 void tgBulletSpringCable::calculateAndApplyForce(double dt)
+{
+    bool quiescent = false;
+    const btVector3 force = calculateForce(dt, quiescent);
+
+    //Now Apply it to the connected two bodies
+    applyImpulses(force*dt, quiescent);
+}
+
+void tgBulletSpringCable::applyForceInTick(double dt, bool firstTick)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive!");
+    }
+
+    btRigidBody* const body1 = anchor1->attachedBody;
+    btRigidBody* const body2 = anchor2->attachedBody;
+
+    // Bullet clears forces only after all the ticks of a step
+    if (!firstTick && m_tickForceApplied)
+    {
+        body1->applyForce(-m_tickForce, m_tickPosition1);
+        body2->applyForce(m_tickForce, m_tickPosition2);
+    }
+    m_tickForceApplied = false;
+
+    updateState();
+    bool quiescent = false;
+    const btVector3 force = calculateForce(dt, quiescent);
+
+    if (prepareBodies(quiescent))
+    {
+        m_tickForce = force;
+        m_tickPosition1 = anchor1->getRelativePosition();
+        m_tickPosition2 = anchor2->getRelativePosition();
+        body1->applyForce(m_tickForce, m_tickPosition1);
+        body2->applyForce(-m_tickForce, m_tickPosition2);
+        m_tickForceApplied = true;
+    }
+    assert(invariant());
+}
+
+bool tgBulletSpringCable::canApplyForceInTick() const
+{
+    return true;
+}
+
+btVector3 tgBulletSpringCable::calculateForce(double dt, bool& quiescent)
 {
     btVector3 force(0.0, 0.0, 0.0);
     double magnitude = 0.0;
-    const btVector3 dist =
-      anchor2->getWorldPosition() - anchor1->getWorldPosition();
+    const btVector3 dist = m_anchor2Position - m_anchor1Position;
       
     // These computations should occur for history regardless of motion
-    const double currLength = dist.length();
+    const double currLength = m_actualLength;
     const btVector3 unitVector = dist / currLength;
     const double stretch = currLength - m_restLength;
     
@@ -118,7 +179,7 @@ void tgBulletSpringCable::calculateAndApplyForce(double dt)
     std::cout << "Length: " << dist.length() << " rl: " << m_restLength <<std::endl; 
     #endif
       
-    if (dist.length() > m_restLength)
+    if (currLength > m_restLength)
     {   
         force = unitVector * magnitude; 
     }
@@ -130,25 +191,121 @@ void tgBulletSpringCable::calculateAndApplyForce(double dt)
     // Finished calculating, so can store things
     m_prevLength = currLength;
 
-    //Now Apply it to the connected two bodies
-    btVector3 point1 = this->anchor1->getRelativePosition();
-    this->anchor1->attachedBody->activate();
-    this->anchor1->attachedBody->applyImpulse(force*dt,point1);
+    // In sleep mode a quiescent cable leaves the activation state of
+    // its bodies alone, so Bullet can deactivate a structure at rest
+    quiescent = sleepEnabled() &&
+                (stretch < m_sleepStretch) &&
+                (abs(m_velocity) < m_sleepVelocity);
+
+    return force;
+}
+
+void tgBulletSpringCable::applyImpulses(const btVector3& impulse,
+                                        bool quiescent)
+{
+    if (prepareBodies(quiescent))
+    {
+        anchor1->attachedBody->applyImpulse(impulse,
+                                            anchor1->getRelativePosition());
+        anchor2->attachedBody->applyImpulse(-impulse,
+                                            anchor2->getRelativePosition());
+    }
+}
+
+bool tgBulletSpringCable::prepareBodies(bool quiescent)
+{
+    btRigidBody* const body1 = anchor1->attachedBody;
+    btRigidBody* const body2 = anchor2->attachedBody;
+
+    if (quiescent)
+    {
+        // Bullet keeps static bodies inactive, and impulses do not move
+        // them or kinematic bodies, so only a dynamic one can be asleep
+        const bool asleep1 =
+            !body1->isActive() && !body1->isStaticOrKinematicObject();
+        const bool asleep2 =
+            !body2->isActive() && !body2->isStaticOrKinematicObject();
 
-    btVector3 point2 = this->anchor2->getRelativePosition();
-    this->anchor2->attachedBody->activate();
-    this->anchor2->attachedBody->applyImpulse(-force*dt,point2);
+        // The force goes to both ends or to neither, so the cable
+        // never adds momentum to the system
+        if (asleep1 || asleep2)
+        {
+            return false;
+        }
+        // activate() would restart the deactivation timers, and the
+        // structure could never fall asleep
+    }
+    else
+    {
+        // Bullet does not integrate sleeping bodies, so a force on a
+        // sleeper would only take effect whenever something else woke
+        // it. Wake both ends so the pair moves together.
+        body1->activate();
+        body2->activate();
+    }
+    return true;
+}
+
+void tgBulletSpringCable::setRestLength( const double newRestLength)
+{
+    const bool changed = (newRestLength != m_restLength);
+    
+    tgSpringCable::setRestLength(newRestLength);
+    
+    // Controllers must be able to wake a sleeping structure
+    if (changed && sleepEnabled())
+    {
+        anchor1->attachedBody->activate();
+        anchor2->attachedBody->activate();
+    }
+}
+
+void tgBulletSpringCable::setSleepThresholds(double stretchThreshold,
+                                                double velocityThreshold)
+{
+    if (stretchThreshold < 0.0 || velocityThreshold < 0.0)
+    {
+        throw std::invalid_argument("Sleep thresholds must be non-negative");
+    }
+    
+    m_sleepStretch = stretchThreshold;
+    m_sleepVelocity = velocityThreshold;
+}
+
+bool tgBulletSpringCable::sleepEnabled() const
+{
+    return (m_sleepStretch > 0.0) && (m_sleepVelocity > 0.0);
+}
+
+void tgBulletSpringCable::updateState()
+{
+    m_anchor1Position = anchor1->getWorldPosition();
+    m_anchor2Position = anchor2->getWorldPosition();
+    m_actualLength = (m_anchor2Position - m_anchor1Position).length();
 }
 
 const double tgBulletSpringCable::getActualLength() const
 {
-    const btVector3 dist =
-      this->anchor2->getWorldPosition() - this->anchor1->getWorldPosition();
-    return dist.length();
+    if (m_stateCached)
+    {
+        return m_actualLength;
+    }
+    return (anchor2->getWorldPosition() - anchor1->getWorldPosition()).length();
+}
+
+btVector3 tgBulletSpringCable::getAnchor1WorldPosition() const
+{
+    return m_stateCached ? m_anchor1Position : anchor1->getWorldPosition();
+}
+
+btVector3 tgBulletSpringCable::getAnchor2WorldPosition() const
+{
+    return m_stateCached ? m_anchor2Position : anchor2->getWorldPosition();
 }
 
 const double tgBulletSpringCable::getTension() const
 {
+    // Virtual, tgBulletContactSpringCable measures along its anchors
     double tension = (getActualLength() - m_restLength) * m_coefK;
     tension = (tension < 0.0) ? 0.0 : tension;
     return tension;
@@ -159,6 +316,19 @@ const std::vector<const tgSpringCableAnchor*> tgBulletSpringCable::getAnchors()
     return tgCast::constFilter<tgBulletSpringCableAnchor, const tgSpringCableAnchor>(m_anchors);
 }
 
+void tgBulletSpringCable::getAnchorWorldPositions(std::vector<btVector3>& positions) const
+{
+    // tgBulletContactSpringCable adds sliding anchors, which are not cached
+    if (m_anchors.size() != 2)
+    {
+        tgSpringCable::getAnchorWorldPositions(positions);
+        return;
+    }
+    positions.clear();
+    positions.push_back(getAnchor1WorldPosition());
+    positions.push_back(getAnchor2WorldPosition());
+}
+
 bool tgBulletSpringCable::invariant(void) const
 {
     return (m_coefK > 0.0 &&
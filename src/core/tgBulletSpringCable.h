@@ -67,17 +67,50 @@ public:
     virtual ~tgBulletSpringCable();
 
     /**
-     * Updates this object. Calls calculateAndApplyForce(dt)
+     * Updates this object. Calls calculateAndApplyForce(dt), using the
+     * anchor positions from the last updateState, or refreshing them
+     * first if no world caches this cable's state
      * @param[in] dt, must be positive
      */
     virtual void step(double dt);
     
     /**
-     * Finds the distance between anchor1 and anchor2, and returns
-     * the length between them
+     * Recomputes the world positions of anchor1 and anchor2 and the
+     * distance between them
+     */
+    virtual void updateState();
+    
+    /** True, see applyForceInTick */
+    virtual bool canApplyForceInTick() const;
+    
+    /**
+     * Refreshes the anchor positions and applies the current force with
+     * applyForce at anchor1 and its opposite at anchor2, removing the
+     * force applied on the previous tick of this step. Sleep mode
+     * applies as in step.
+     * @param[in] dt the length of the tick, must be positive
+     * @param[in] firstTick true if nothing has been applied this step
+     */
+    virtual void applyForceInTick(double dt, bool firstTick);
+    
+    /**
+     * Returns the distance between anchor1 and anchor2 as of the last
+     * updateState, or as of now if no world caches this cable's state
      */
     virtual const double getActualLength() const;
     
+    /**
+     * World position of anchor1 as of the last updateState, or as of
+     * now if no world caches this cable's state
+     */
+    btVector3 getAnchor1WorldPosition() const;
+    
+    /**
+     * World position of anchor2 as of the last updateState, or as of
+     * now if no world caches this cable's state
+     */
+    btVector3 getAnchor2WorldPosition() const;
+    
     /**
      * Returns the tension currently in the string by multiplying
      * the difference between the actual length and the rest length
@@ -93,6 +126,31 @@ public:
      */
     virtual const std::vector<const tgSpringCableAnchor*> getAnchors() const;
     
+    /**
+     * The cached positions of anchor1 and anchor2 while those are the
+     * only anchors, otherwise every anchor measured now
+     */
+    virtual void getAnchorWorldPositions(std::vector<btVector3>& positions) const;
+    
+    /**
+     * Sets m_restLength to newRestLength. In sleep mode a change in
+     * rest length wakes both attached bodies.
+     * @param[in] newRestLength, must be non-negative
+     */
+    virtual void setRestLength( const double newRestLength);
+    
+    /**
+     * Opt into sleep mode. While the stretch (actual - rest length) is
+     * below stretchThreshold and the magnitude of the length velocity
+     * is below velocityThreshold the cable is quiescent: it pushes its
+     * bodies without waking them, and applies nothing while either is
+     * asleep, so a structure at rest can be deactivated. Otherwise, or
+     * when the rest length changes, both ends are woken.
+     * Both thresholds must be positive to enable sleep mode, passing
+     * zero for either disables it (the default).
+     */
+    void setSleepThresholds(double stretchThreshold, double velocityThreshold);
+    
 protected:
     
     /**
@@ -123,6 +181,57 @@ private:
      * anchor2
      */
     virtual void calculateAndApplyForce(double dt);
+    
+    /**
+     * Calculates the force on anchor1 from the anchor positions of the
+     * last updateState, and updates the damping state
+     * @param[out] quiescent true if sleep mode may let the bodies sleep
+     */
+    btVector3 calculateForce(double dt, bool& quiescent);
+    
+    /**
+     * Applies impulse at anchor1 and its opposite at anchor2, if
+     * prepareBodies allows
+     */
+    void applyImpulses(const btVector3& impulse, bool quiescent);
+    
+    /**
+     * Wakes both bodies unless the cable is quiescent, since activating
+     * a body restarts its deactivation timer.
+     * @return false if the cable is quiescent and either end is asleep,
+     * and must then apply nothing
+     */
+    bool prepareBodies(bool quiescent);
+    
+    /** True if setSleepThresholds enabled sleep mode */
+    bool sleepEnabled() const;
+    
+    /** Stretch below which the cable may let its bodies sleep */
+    double m_sleepStretch;
+    
+    /** Length velocity below which the cable may let its bodies sleep */
+    double m_sleepVelocity;
+    
+    /** World position of anchor1, set by updateState */
+    btVector3 m_anchor1Position;
+    
+    /** World position of anchor2, set by updateState */
+    btVector3 m_anchor2Position;
+    
+    /** Distance between the anchors, set by updateState */
+    double m_actualLength;
+    
+    /** The force applyForceInTick applied on the last tick */
+    btVector3 m_tickForce;
+    
+    /** Where it applied m_tickForce, relative to anchor1's body */
+    btVector3 m_tickPosition1;
+    
+    /** Where it applied -m_tickForce, relative to anchor2's body */
+    btVector3 m_tickPosition2;
+    
+    /** False if nothing was applied on the last tick */
+    bool m_tickForceApplied;
 
 private: 
     /** Ensures integrity of member variables */
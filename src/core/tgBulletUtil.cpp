@@ -34,12 +34,14 @@
 #include "LinearMath/btTransform.h"
 #include "LinearMath/btDefaultMotionState.h"
 
+namespace
+{
 // @todo: Move this to the tgRigidInfo => tgModel step
-// NOTE: this is a copy of localCreateRigidBody from the bullet DemoApplication. 
-btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld, 
-                                           float mass, 
-                                           const btTransform& startTransform, 
-                                           btCollisionShape* shape)
+// NOTE: this is a copy of localCreateRigidBody from the bullet DemoApplication,
+// without adding the body to the world.
+btRigidBody* newRigidBody(float mass, 
+                          const btTransform& startTransform, 
+                          btCollisionShape* shape)
 {
 
     btAssert((!shape || shape->getShapeType() != INVALID_SHAPE_PROXYTYPE));
@@ -71,8 +73,29 @@ btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld,
     body->setWorldTransform(startTransform);
 #endif//
 
+    return body;
+}
+} // namespace
+
+btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld, 
+                                           float mass, 
+                                           const btTransform& startTransform, 
+                                           btCollisionShape* shape)
+{
+    btRigidBody* body = newRigidBody(mass, startTransform, shape);
     dynamicsWorld->addRigidBody(body);
+    return body;
+}
 
+btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld,
+                                           float mass,
+                                           const btTransform& startTransform,
+                                           btCollisionShape* shape,
+                                           short group,
+                                           short mask)
+{
+    btRigidBody* body = newRigidBody(mass, startTransform, shape);
+    dynamicsWorld->addRigidBody(body, group, mask);
     return body;
 }
 
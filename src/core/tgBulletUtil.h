@@ -46,6 +46,20 @@ public:
                                         float mass, 
                                         const btTransform& startTransform, 
                                         btCollisionShape* shape);
+
+    /**
+     * As above, but the body is added to the world with explicit
+     * collision filter bits instead of Bullet's defaults.
+     * @param[in] group, the btBroadphaseProxy filter bits of the body
+     * @param[in] mask, the groups the body collides with
+     */
+    static btRigidBody* createRigidBody(btDynamicsWorld* dynamicsWorld,
+                                        float mass,
+                                        const btTransform& startTransform,
+                                        btCollisionShape* shape,
+                                        short group,
+                                        short mask);
+
     /**
      * Assuming that world has a tgWorldBulletPhysicsImpl, return
      * its dynamics world.
@@ -0,0 +1,401 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCheckpoint.cpp
+ * @brief Contains the definitions of members of class tgCheckpoint
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgCheckpoint.h"
+// This library
+#include "tgBulletUtil.h"
+#include "tgWorld.h"
+#include "tgWorldBulletPhysicsImpl.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/NarrowPhaseCollision/btManifoldPoint.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace
+{
+    const char magic[8] = { 'N', 'T', 'R', 'T', 'C', 'K', 'P', 'T' };
+
+    /** Reads back as a different value on a machine of other endianness */
+    const unsigned int endianMarker = 0x01020304;
+
+    void writeVector(std::ostream& os, const btVector3& v)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            tgCheckpoint::write(os, v[i]);
+        }
+    }
+
+    btVector3 readVector(std::istream& is)
+    {
+        btScalar v[3];
+        for (int i = 0; i < 3; i++)
+        {
+            tgCheckpoint::read(is, v[i]);
+        }
+        return btVector3(v[0], v[1], v[2]);
+    }
+
+    /** The bodies a checkpoint covers, in the world's order */
+    btAlignedObjectArray<btRigidBody*> movableBodies(btDynamicsWorld& world)
+    {
+        btAlignedObjectArray<btRigidBody*> result;
+        const btCollisionObjectArray& objects = world.getCollisionObjectArray();
+        for (int i = 0; i < objects.size(); i++)
+        {
+            btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+            if (pBody && !pBody->isStaticObject())
+            {
+                result.push_back(pBody);
+            }
+        }
+        return result;
+    }
+
+    /** A contact manifold as written by writeWorld */
+    struct SavedManifold
+    {
+        /** Indices into the world's collision object array */
+        int object0;
+        int object1;
+        std::vector<btManifoldPoint> points;
+    };
+
+    void writePoint(std::ostream& os, const btManifoldPoint& point)
+    {
+        writeVector(os, point.m_localPointA);
+        writeVector(os, point.m_localPointB);
+        writeVector(os, point.m_positionWorldOnA);
+        writeVector(os, point.m_positionWorldOnB);
+        writeVector(os, point.m_normalWorldOnB);
+        writeVector(os, point.m_lateralFrictionDir1);
+        writeVector(os, point.m_lateralFrictionDir2);
+        tgCheckpoint::write(os, point.m_distance1);
+        tgCheckpoint::write(os, point.m_combinedFriction);
+        tgCheckpoint::write(os, point.m_combinedRollingFriction);
+        tgCheckpoint::write(os, point.m_combinedRestitution);
+        tgCheckpoint::write(os, point.m_partId0);
+        tgCheckpoint::write(os, point.m_partId1);
+        tgCheckpoint::write(os, point.m_index0);
+        tgCheckpoint::write(os, point.m_index1);
+        tgCheckpoint::write(os, point.m_appliedImpulse);
+        tgCheckpoint::write(os, point.m_lateralFrictionInitialized);
+        tgCheckpoint::write(os, point.m_appliedImpulseLateral1);
+        tgCheckpoint::write(os, point.m_appliedImpulseLateral2);
+        tgCheckpoint::write(os, point.m_contactMotion1);
+        tgCheckpoint::write(os, point.m_contactMotion2);
+        tgCheckpoint::write(os, point.m_contactCFM1);
+        tgCheckpoint::write(os, point.m_contactCFM2);
+        tgCheckpoint::write(os, point.m_lifeTime);
+    }
+
+    btManifoldPoint readPoint(std::istream& is)
+    {
+        btManifoldPoint point;
+        point.m_localPointA = readVector(is);
+        point.m_localPointB = readVector(is);
+        point.m_positionWorldOnA = readVector(is);
+        point.m_positionWorldOnB = readVector(is);
+        point.m_normalWorldOnB = readVector(is);
+        point.m_lateralFrictionDir1 = readVector(is);
+        point.m_lateralFrictionDir2 = readVector(is);
+        tgCheckpoint::read(is, point.m_distance1);
+        tgCheckpoint::read(is, point.m_combinedFriction);
+        tgCheckpoint::read(is, point.m_combinedRollingFriction);
+        tgCheckpoint::read(is, point.m_combinedRestitution);
+        tgCheckpoint::read(is, point.m_partId0);
+        tgCheckpoint::read(is, point.m_partId1);
+        tgCheckpoint::read(is, point.m_index0);
+        tgCheckpoint::read(is, point.m_index1);
+        tgCheckpoint::read(is, point.m_appliedImpulse);
+        tgCheckpoint::read(is, point.m_lateralFrictionInitialized);
+        tgCheckpoint::read(is, point.m_appliedImpulseLateral1);
+        tgCheckpoint::read(is, point.m_appliedImpulseLateral2);
+        tgCheckpoint::read(is, point.m_contactMotion1);
+        tgCheckpoint::read(is, point.m_contactMotion2);
+        tgCheckpoint::read(is, point.m_contactCFM1);
+        tgCheckpoint::read(is, point.m_contactCFM2);
+        tgCheckpoint::read(is, point.m_lifeTime);
+        return point;
+    }
+
+    /** Swap two manifolds of the dispatcher, keeping their indices right */
+    void swapManifolds(btPersistentManifold** manifolds, int i, int j)
+    {
+        btPersistentManifold* const pManifold = manifolds[i];
+        manifolds[i] = manifolds[j];
+        manifolds[j] = pManifold;
+        manifolds[i]->m_index1a = i;
+        manifolds[j]->m_index1a = j;
+    }
+
+    /**
+     * Put the saved contact points into the manifolds the dispatcher has
+     * for the same pairs of objects, and move those manifolds to the
+     * front in the saved order, so the solver warm starts and visits
+     * the contacts as it did before the checkpoint. Manifolds that were
+     * not saved are emptied. A saved manifold whose objects no longer
+     * overlap is dropped; the contact is found again if they touch.
+     */
+    void restoreManifolds(btDynamicsWorld& world,
+                          const std::vector<SavedManifold>& saved)
+    {
+        const btCollisionObjectArray& objects = world.getCollisionObjectArray();
+        btDispatcher* const pDispatcher = world.getDispatcher();
+        const int n = pDispatcher->getNumManifolds();
+        btPersistentManifold** const manifolds =
+            pDispatcher->getInternalManifoldPointer();
+
+        // Manifolds before next have been restored
+        int next = 0;
+        for (std::size_t i = 0; i < saved.size(); i++)
+        {
+            const btCollisionObject* const pObject0 = objects[saved[i].object0];
+            const btCollisionObject* const pObject1 = objects[saved[i].object1];
+            for (int j = next; j < n; j++)
+            {
+                if (manifolds[j]->getBody0() == pObject0 &&
+                    manifolds[j]->getBody1() == pObject1)
+                {
+                    swapManifolds(manifolds, next, j);
+                    btPersistentManifold* const pManifold = manifolds[next];
+                    pManifold->clearManifold();
+                    for (std::size_t k = 0; k < saved[i].points.size(); k++)
+                    {
+                        pManifold->addManifoldPoint(saved[i].points[k]);
+                    }
+                    next++;
+                    break;
+                }
+            }
+        }
+        for (int j = next; j < n; j++)
+        {
+            manifolds[j]->clearManifold();
+        }
+    }
+} // namespace
+
+const unsigned int tgCheckpoint::version = 4;
+
+void tgCheckpoint::writeHeader(std::ostream& os)
+{
+    os.write(magic, sizeof(magic));
+    write(os, version);
+    write(os, endianMarker);
+    const unsigned int scalarSize = sizeof(btScalar);
+    write(os, scalarSize);
+}
+
+void tgCheckpoint::readHeader(std::istream& is)
+{
+    char fileMagic[sizeof(magic)];
+    is.read(fileMagic, sizeof(fileMagic));
+    if (!is || std::memcmp(fileMagic, magic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error("Not an NTRT checkpoint");
+    }
+
+    unsigned int fileVersion = 0;
+    read(is, fileVersion);
+    if (fileVersion != version)
+    {
+        throw std::runtime_error("Unsupported checkpoint version");
+    }
+
+    unsigned int fileEndian = 0;
+    read(is, fileEndian);
+    if (fileEndian != endianMarker)
+    {
+        throw std::runtime_error("Checkpoint was written on a machine of "
+                                 "different byte order");
+    }
+
+    unsigned int scalarSize = 0;
+    read(is, scalarSize);
+    if (scalarSize != sizeof(btScalar))
+    {
+        throw std::runtime_error("Checkpoint was written with a different "
+                                 "btScalar precision");
+    }
+}
+
+void tgCheckpoint::writeWorld(const tgWorld& world, std::ostream& os)
+{
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
+    const btAlignedObjectArray<btRigidBody*> bodies =
+        movableBodies(dynamicsWorld);
+
+    const int n = bodies.size();
+    write(os, n);
+    for (int i = 0; i < n; i++)
+    {
+        const btRigidBody* const pBody = bodies[i];
+        const btTransform& transform = pBody->getWorldTransform();
+        const btMatrix3x3& basis = transform.getBasis();
+        for (int row = 0; row < 3; row++)
+        {
+            writeVector(os, basis[row]);
+        }
+        writeVector(os, transform.getOrigin());
+        writeVector(os, pBody->getLinearVelocity());
+        writeVector(os, pBody->getAngularVelocity());
+        write(os, pBody->getActivationState());
+        write(os, pBody->getDeactivationTime());
+    }
+
+    // The contacts, in the order the solver visits them
+    const btCollisionObjectArray& objects =
+        dynamicsWorld.getCollisionObjectArray();
+    std::map<const btCollisionObject*, int> objectIndices;
+    for (int i = 0; i < objects.size(); i++)
+    {
+        objectIndices[objects[i]] = i;
+    }
+    btDispatcher* const pDispatcher = dynamicsWorld.getDispatcher();
+    int nManifolds = 0;
+    for (int i = 0; i < pDispatcher->getNumManifolds(); i++)
+    {
+        if (pDispatcher->getManifoldByIndexInternal(i)->getNumContacts() > 0)
+        {
+            nManifolds++;
+        }
+    }
+    write(os, nManifolds);
+    for (int i = 0; i < pDispatcher->getNumManifolds(); i++)
+    {
+        const btPersistentManifold* const pManifold =
+            pDispatcher->getManifoldByIndexInternal(i);
+        const int nPoints = pManifold->getNumContacts();
+        if (nPoints == 0)
+        {
+            continue;
+        }
+        write(os, objectIndices[pManifold->getBody0()]);
+        write(os, objectIndices[pManifold->getBody1()]);
+        write(os, nPoints);
+        for (int j = 0; j < nPoints; j++)
+        {
+            writePoint(os, pManifold->getContactPoint(j));
+        }
+    }
+}
+
+void tgCheckpoint::readWorld(tgWorld& world, std::istream& is)
+{
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
+    const btAlignedObjectArray<btRigidBody*> bodies =
+        movableBodies(dynamicsWorld);
+
+    int n = 0;
+    read(is, n);
+    if (n != bodies.size())
+    {
+        throw std::runtime_error("Checkpoint has a different number of "
+                                 "bodies than the world");
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        btRigidBody* const pBody = bodies[i];
+
+        btMatrix3x3 basis;
+        for (int row = 0; row < 3; row++)
+        {
+            basis[row] = readVector(is);
+        }
+        const btTransform transform(basis, readVector(is));
+        const btVector3 linearVelocity = readVector(is);
+        const btVector3 angularVelocity = readVector(is);
+        int activationState = 0;
+        read(is, activationState);
+        btScalar deactivationTime = 0.0;
+        read(is, deactivationTime);
+
+        pBody->setWorldTransform(transform);
+        pBody->setInterpolationWorldTransform(transform);
+        if (pBody->getMotionState())
+        {
+            pBody->getMotionState()->setWorldTransform(transform);
+        }
+        pBody->setLinearVelocity(linearVelocity);
+        pBody->setAngularVelocity(angularVelocity);
+        pBody->setInterpolationLinearVelocity(linearVelocity);
+        pBody->setInterpolationAngularVelocity(angularVelocity);
+        pBody->clearForces();
+        pBody->forceActivationState(activationState);
+        pBody->setDeactivationTime(deactivationTime);
+    }
+
+    const int nObjects = dynamicsWorld.getCollisionObjectArray().size();
+    int nManifolds = 0;
+    read(is, nManifolds);
+    if (nManifolds < 0)
+    {
+        throw std::runtime_error("Checkpoint has a corrupt contact");
+    }
+    std::vector<SavedManifold> manifolds(nManifolds);
+    for (int i = 0; i < nManifolds; i++)
+    {
+        SavedManifold& manifold = manifolds[i];
+        read(is, manifold.object0);
+        read(is, manifold.object1);
+        if (manifold.object0 < 0 || manifold.object0 >= nObjects ||
+            manifold.object1 < 0 || manifold.object1 >= nObjects)
+        {
+            throw std::runtime_error("Checkpoint has a contact with an "
+                                     "object the world does not have");
+        }
+        int nPoints = 0;
+        read(is, nPoints);
+        if (nPoints < 0 || nPoints > MANIFOLD_CACHE_SIZE)
+        {
+            throw std::runtime_error("Checkpoint has a corrupt contact");
+        }
+        for (int j = 0; j < nPoints; j++)
+        {
+            manifold.points.push_back(readPoint(is));
+        }
+    }
+
+    // Find the overlapping pairs at the restored positions, so each
+    // saved contact has a manifold to go back into
+    dynamicsWorld.performDiscreteCollisionDetection();
+    restoreManifolds(dynamicsWorld, manifolds);
+
+    tgWorldBulletPhysicsImpl& impl =
+        static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+    impl.updateSpringCables();
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CHECKPOINT_H
+#define TG_CHECKPOINT_H
+
+/**
+ * @file tgCheckpoint.h
+ * @brief Contains the definition of class tgCheckpoint
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// Forward declarations
+class tgWorld;
+
+/**
+ * Helpers for the binary checkpoint format written by
+ * tgSimulation::saveCheckpoint. Values are stored in native byte order;
+ * the header records the format version, the byte order and the size
+ * of btScalar, and checkpoints that do not match are rejected.
+ *
+ * Models write their own state with tgModel::saveState, controllers
+ * with tgObserver::onSaveState, using write and read below.
+ */
+class tgCheckpoint
+{
+public:
+
+    /** Incremented whenever the layout of a checkpoint changes */
+    static const unsigned int version;
+
+    static void writeHeader(std::ostream& os);
+
+    /**
+     * @throw std::runtime_error if the stream does not start with a
+     * compatible header
+     */
+    static void readHeader(std::istream& is);
+
+    template <typename T>
+    static void write(std::ostream& os, const T& value)
+    {
+        os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * @throw std::runtime_error if the stream ends early
+     */
+    template <typename T>
+    static void read(std::istream& is, T& value)
+    {
+        is.read(reinterpret_cast<char*>(&value), sizeof(T));
+        if (!is)
+        {
+            throw std::runtime_error("Checkpoint is truncated");
+        }
+    }
+
+    /**
+     * Write the state of every non-static rigid body in world, in the
+     * order they were added to the world: transform, velocities and
+     * activation state. Then write the cached contact points with their
+     * accumulated impulses, in the order the solver visits them.
+     */
+    static void writeWorld(const tgWorld& world, std::ostream& os);
+
+    /**
+     * Restore the bodies and contact points written by writeWorld. The
+     * world must have been built the same way. Collision detection is
+     * run at the restored positions to find the manifolds the contact
+     * points go back into, so the solver warm starts as it would have.
+     * The broadphase's pair cache is rebuilt rather than restored, so
+     * contacts that appear after the checkpoint may be solved in a
+     * different order. The registered spring cables' cached state is
+     * refreshed.
+     * @throw std::runtime_error if the number of bodies differs or a
+     * contact names an object the world does not have
+     */
+    static void readWorld(tgWorld& world, std::istream& is);
+};
+
+#endif  // TG_CHECKPOINT_H
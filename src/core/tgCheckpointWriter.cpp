@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCheckpointWriter.cpp
+ * @brief Contains the definitions of members of class tgCheckpointWriter
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgCheckpointWriter.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+tgCheckpointWriter::tgCheckpointWriter(const std::string& filename) :
+    m_filename(filename),
+    m_hasPending(false),
+    m_writing(false),
+    m_stop(false),
+    m_thread(&tgCheckpointWriter::run, this)
+{
+}
+
+tgCheckpointWriter::~tgCheckpointWriter()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+void tgCheckpointWriter::submit(const std::string& data)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_pending = data;
+        m_hasPending = true;
+    }
+    m_condition.notify_all();
+}
+
+void tgCheckpointWriter::flush()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_hasPending || m_writing)
+    {
+        m_condition.wait(lock);
+    }
+}
+
+void tgCheckpointWriter::run()
+{
+    std::string data;
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (true)
+    {
+        while (!m_hasPending && !m_stop)
+        {
+            m_condition.wait(lock);
+        }
+        // Pending checkpoints are still written when stopping
+        if (!m_hasPending)
+        {
+            break;
+        }
+        data.swap(m_pending);
+        m_hasPending = false;
+        m_writing = true;
+
+        lock.unlock();
+        writeFile(data);
+        lock.lock();
+
+        m_writing = false;
+        m_condition.notify_all();
+    }
+}
+
+void tgCheckpointWriter::writeFile(const std::string& data) const
+{
+    const std::string tmpFilename = m_filename + ".tmp";
+    {
+        std::ofstream file(tmpFilename.c_str(),
+                           std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size());
+        if (!file)
+        {
+            // Nothing to throw to on this thread; keep the last good file
+            std::cerr << "Could not write checkpoint " << tmpFilename
+                      << std::endl;
+            std::remove(tmpFilename.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmpFilename.c_str(), m_filename.c_str()) != 0)
+    {
+        std::cerr << "Could not replace checkpoint " << m_filename
+                  << std::endl;
+    }
+}
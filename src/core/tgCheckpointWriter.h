@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CHECKPOINT_WRITER_H
+#define TG_CHECKPOINT_WRITER_H
+
+/**
+ * @file tgCheckpointWriter.h
+ * @brief Contains the definition of class tgCheckpointWriter
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// Boost
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+// The C++ Standard Library
+#include <string>
+
+/**
+ * Writes checkpoints to a file on a background thread, so the
+ * simulation only pays for serializing into memory. If a checkpoint
+ * arrives while the previous one is still being written, only the
+ * newest is kept. Each file is written next to the target and renamed
+ * over it, so a crash never leaves a partial checkpoint.
+ */
+class tgCheckpointWriter
+{
+public:
+
+    /**
+     * @param[in] filename, the checkpoint file to keep up to date, must
+     * not be empty
+     */
+    explicit tgCheckpointWriter(const std::string& filename);
+
+    /** Writes any pending checkpoint, then stops the thread */
+    ~tgCheckpointWriter();
+
+    /**
+     * Queue a serialized checkpoint for writing
+     * @param[in] data, the output of tgSimulation's checkpoint
+     */
+    void submit(const std::string& data);
+
+    /** Block until every submitted checkpoint is on disk */
+    void flush();
+
+private:
+
+    /** The background thread's loop */
+    void run();
+
+    /** Write data to m_filename through a temporary file */
+    void writeFile(const std::string& data) const;
+
+    const std::string m_filename;
+
+    boost::mutex m_mutex;
+
+    /** Signals a new checkpoint, completion or shutdown */
+    boost::condition_variable m_condition;
+
+    /** The newest checkpoint not yet taken by the thread */
+    std::string m_pending;
+
+    bool m_hasPending;
+
+    /** True while the thread is writing a checkpoint */
+    bool m_writing;
+
+    bool m_stop;
+
+    boost::thread m_thread;
+};
+
+#endif  // TG_CHECKPOINT_WRITER_H
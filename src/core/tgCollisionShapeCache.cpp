@@ -0,0 +1,183 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCollisionShapeCache.cpp
+ * @brief Contains the implementation of class tgCollisionShapeCache
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgCollisionShapeCache.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionShapes/btBoxShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+// The C++ Standard Library
+#include <cassert>
+#include <utility>
+
+tgCollisionShapeCache::Key::Key(Type t, const btVector3& d, btScalar m) :
+    type(t),
+    dimensions(d),
+    margin(m)
+{
+}
+
+bool tgCollisionShapeCache::Key::operator<(const Key& other) const
+{
+    if (type != other.type)
+    {
+        return type < other.type;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        if (dimensions[i] != other.dimensions[i])
+        {
+            return dimensions[i] < other.dimensions[i];
+        }
+    }
+    return margin < other.margin;
+}
+
+tgCollisionShapeCache::tgCollisionShapeCache()
+{
+    assert(invariant());
+}
+
+tgCollisionShapeCache::~tgCollisionShapeCache()
+{
+    clear();
+}
+
+btCollisionShape*
+tgCollisionShapeCache::getBox(const btVector3& halfExtents, btScalar margin)
+{
+    return acquire(Key(eBox, halfExtents, margin < 0.0 ? btScalar(-1.0) : margin));
+}
+
+btCollisionShape*
+tgCollisionShapeCache::getCylinder(const btVector3& halfExtents,
+                                   btScalar margin)
+{
+    return acquire(Key(eCylinder, halfExtents, margin < 0.0 ? btScalar(-1.0) : margin));
+}
+
+btCollisionShape* tgCollisionShapeCache::getSphere(btScalar radius)
+{
+    return acquire(Key(eSphere, btVector3(radius, radius, radius), radius));
+}
+
+btCollisionShape* tgCollisionShapeCache::acquire(const Key& key)
+{
+    std::map<Key, Entry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        btCollisionShape* pShape = NULL;
+        switch (key.type)
+        {
+        case eBox:
+            pShape = new btBoxShape(key.dimensions);
+            break;
+        case eCylinder:
+            pShape = new btCylinderShape(key.dimensions);
+            break;
+        case eSphere:
+            pShape = new btSphereShape(key.dimensions.x());
+            break;
+        }
+        assert(pShape != NULL);
+        // Boxes and cylinders keep their outer size when the margin
+        // changes
+        if (key.type != eSphere && key.margin >= 0.0)
+        {
+            pShape->setMargin(key.margin);
+        }
+        const Entry entry = { pShape, 0, false };
+        it = m_entries.insert(std::make_pair(key, entry)).first;
+        m_keys.insert(std::make_pair(pShape, key));
+    }
+    it->second.references++;
+    it->second.recent = true;
+
+    assert(invariant());
+    return it->second.pShape;
+}
+
+bool tgCollisionShapeCache::contains(const btCollisionShape* pShape) const
+{
+    return m_keys.find(pShape) != m_keys.end();
+}
+
+void tgCollisionShapeCache::release(const btCollisionShape* pShape)
+{
+    const std::map<const btCollisionShape*, Key>::const_iterator key =
+        m_keys.find(pShape);
+    if (key == m_keys.end())
+    {
+        return;
+    }
+    Entry& entry = m_entries.find(key->second)->second;
+    if (entry.references > 0)
+    {
+        entry.references--;
+    }
+}
+
+std::size_t tgCollisionShapeCache::purge()
+{
+    std::size_t result = 0;
+    std::map<Key, Entry>::iterator it = m_entries.begin();
+    while (it != m_entries.end())
+    {
+        if ((it->second.references == 0) && !it->second.recent)
+        {
+            m_keys.erase(it->second.pShape);
+            delete it->second.pShape;
+            m_entries.erase(it++);
+            result++;
+        }
+        else
+        {
+            it->second.recent = false;
+            ++it;
+        }
+    }
+
+    assert(invariant());
+    return result;
+}
+
+void tgCollisionShapeCache::clear()
+{
+    for (std::map<Key, Entry>::iterator it = m_entries.begin();
+         it != m_entries.end(); ++it)
+    {
+        delete it->second.pShape;
+    }
+    m_entries.clear();
+    m_keys.clear();
+
+    assert(invariant());
+}
+
+bool tgCollisionShapeCache::invariant() const
+{
+    return m_entries.size() == m_keys.size();
+}
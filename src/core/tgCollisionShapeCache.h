@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_COLLISION_SHAPE_CACHE_H
+#define TG_COLLISION_SHAPE_CACHE_H
+
+/**
+ * @file tgCollisionShapeCache.h
+ * @brief Contains the definition of class tgCollisionShapeCache
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+
+// Forward declarations
+class btCollisionShape;
+
+/**
+ * Shares the primitive collision shapes of a tgWorld's rigid bodies.
+ * Rods, spheres and boxes of the same dimensions get the same shape, so
+ * a model with one rod geometry has one btCylinderShape however many
+ * rods it has.
+ *
+ * The cache belongs to the tgWorld and outlives its implementation, so
+ * a simulation that resets rebuilds its bodies on the shapes of the
+ * previous trial. Each get counts a reference that release undoes.
+ * tgWorld::reset purges the cache, so a shape nobody references lives
+ * through one reset and is deleted at the next unless a body got it in
+ * between.
+ *
+ * Shapes handed out must not be modified, e.g. with setLocalScaling.
+ */
+class tgCollisionShapeCache
+{
+public:
+
+    tgCollisionShapeCache();
+
+    /** Deletes every shape */
+    ~tgCollisionShapeCache();
+
+    /**
+     * @param[in] halfExtents, half the box's size along each axis
+     * @param[in] margin, the collision margin; negative (the default)
+     * keeps Bullet's default for the size
+     */
+    btCollisionShape* getBox(const btVector3& halfExtents,
+                             btScalar margin = -1.0);
+
+    /**
+     * A cylinder along the y axis
+     * @param[in] halfExtents, the radius in x and z, half the length in y
+     * @param[in] margin, as for getBox
+     */
+    btCollisionShape* getCylinder(const btVector3& halfExtents,
+                                  btScalar margin = -1.0);
+
+    /**
+     * @param[in] radius, the sphere's radius, which is its margin
+     */
+    btCollisionShape* getSphere(btScalar radius);
+
+    /** True if pShape was made by this cache */
+    bool contains(const btCollisionShape* pShape) const;
+
+    /**
+     * Drop a reference taken by a get. Does nothing for shapes not
+     * made by this cache.
+     */
+    void release(const btCollisionShape* pShape);
+
+    /**
+     * Delete the shapes with no references that no get has returned
+     * since the previous purge
+     * @return the number deleted
+     */
+    std::size_t purge();
+
+    /**
+     * Delete every shape. Only call this when no collision object uses
+     * them, e.g. after the world implementation is deleted.
+     */
+    void clear();
+
+    /** The number of distinct shapes held */
+    std::size_t size() const
+    {
+        return m_entries.size();
+    }
+
+private:
+
+    enum Type
+    {
+        eBox,
+        eCylinder,
+        eSphere
+    };
+
+    /** What makes two shapes interchangeable */
+    struct Key
+    {
+        Key(Type t, const btVector3& d, btScalar m);
+
+        bool operator<(const Key& other) const;
+
+        Type type;
+        btVector3 dimensions;
+        btScalar margin;
+    };
+
+    struct Entry
+    {
+        btCollisionShape* pShape;
+        std::size_t references;
+        /** True if a get returned the shape since the last purge */
+        bool recent;
+    };
+
+    /** The shape for key, created if needed, with one more reference */
+    btCollisionShape* acquire(const Key& key);
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    std::map<Key, Entry> m_entries;
+
+    /** The key of each shape in m_entries, for release */
+    std::map<const btCollisionShape*, Key> m_keys;
+};
+
+#endif  // TG_COLLISION_SHAPE_CACHE_H
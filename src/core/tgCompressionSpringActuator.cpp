@@ -157,6 +157,10 @@ void tgCompressionSpringActuator::step(double dt)
     {
         throw std::invalid_argument("dt is not positive.");
     }
+    else if (m_steppedByRegistry)
+    {
+        return;
+    }
     else
     {   
         // Want to update any controls before applying forces
@@ -55,6 +55,9 @@ class tgCompressionSpringActuator : public tgModel, public tgControllable,
 {
 public: 
 
+  // Steps actuators through stepStatic
+  friend class tgActuatorRegistry;
+
   /**
    * The config struct.
    * As of 2016-08-02, since this compression spring is unactuated, the
@@ -257,6 +260,18 @@ protected:
 
 private:
 
+    /**
+     * The work of step(dt) for an actuator whose spring is exactly a
+     * Spring, without the checks and virtual calls. dt must be positive.
+     */
+    template <typename Spring>
+    void stepStatic(double dt)
+    {
+        notifyStep(dt);
+        static_cast<Spring*>(m_compressionSpring)->Spring::step(dt);
+        tgModel::step(dt);
+    }
+
     /**
      * Helper function to perform what is in common to all constructor bodies.
      */
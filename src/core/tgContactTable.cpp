@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactTable.cpp
+ * @brief Contains the implementation of class tgContactTable
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgContactTable.h"
+// This library
+#include "tgBulletUtil.h"
+#include "tgWorld.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <algorithm>
+
+tgContactTable::Contacts::Contacts() :
+    points(0),
+    normalImpulse(0.0),
+    frictionImpulse(0.0),
+    impulse(0.0, 0.0, 0.0),
+    center(0.0, 0.0, 0.0)
+{
+}
+
+tgContactTable::tgContactTable(const tgWorld& world) :
+    m_world(world),
+    m_revision(0),
+    m_valid(false),
+    m_timeStep(0.0),
+    m_none()
+{
+}
+
+const tgContactTable::Contacts&
+tgContactTable::getContacts(const btCollisionObject* pBody)
+{
+    update();
+    const int i = find(pBody);
+    return i < 0 ? m_none : m_contacts[i];
+}
+
+btVector3 tgContactTable::getForce(const btCollisionObject* pBody)
+{
+    const Contacts& contacts = getContacts(pBody);
+    return m_timeStep > 0.0 ?
+        contacts.impulse / m_timeStep : btVector3(0.0, 0.0, 0.0);
+}
+
+void tgContactTable::update()
+{
+    if (m_valid && m_revision == m_world.getRevision())
+    {
+        return;
+    }
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgContactTable::update");
+#endif //BT_NO_PROFILE
+
+    btDynamicsWorld& dynamicsWorld =
+        tgBulletUtil::worldToDynamicsWorld(m_world);
+
+    // Bodies come and go with resets; the vectors keep their capacity
+    const btCollisionObjectArray& objects =
+        dynamicsWorld.getCollisionObjectArray();
+    m_bodies.resize(objects.size());
+    for (int i = 0; i < objects.size(); i++)
+    {
+        m_bodies[i] = objects[i];
+    }
+    std::sort(m_bodies.begin(), m_bodies.end());
+    m_contacts.assign(m_bodies.size(), Contacts());
+
+    btDispatcher* const pDispatcher = dynamicsWorld.getDispatcher();
+    const int numManifolds = pDispatcher->getNumManifolds();
+    for (int i = 0; i < numManifolds; i++)
+    {
+        const btPersistentManifold* const pManifold =
+            pDispatcher->getManifoldByIndexInternal(i);
+        const btCollisionObject* const pBody0 = pManifold->getBody0();
+        const btCollisionObject* const pBody1 = pManifold->getBody1();
+        if (!pBody0->hasContactResponse() || !pBody1->hasContactResponse())
+        {
+            continue;
+        }
+        const int i0 = find(pBody0);
+        const int i1 = find(pBody1);
+
+        const int numContacts = pManifold->getNumContacts();
+        for (int j = 0; j < numContacts; j++)
+        {
+            const btManifoldPoint& pt = pManifold->getContactPoint(j);
+            const double normalImpulse = pt.m_appliedImpulse;
+            if (pt.getDistance() > 0.0 && normalImpulse <= 0.0)
+            {
+                continue;
+            }
+            // The solver pushes body 0 along the normal and body 1 back
+            const btVector3 friction =
+                pt.m_lateralFrictionDir1 * pt.m_appliedImpulseLateral1 +
+                pt.m_lateralFrictionDir2 * pt.m_appliedImpulseLateral2;
+            const btVector3 impulse =
+                pt.m_normalWorldOnB * normalImpulse + friction;
+            const double frictionImpulse = friction.length();
+            const btVector3 point =
+                (pt.getPositionWorldOnA() + pt.getPositionWorldOnB()) * 0.5;
+            if (i0 >= 0)
+            {
+                accumulate(m_contacts[i0], point, normalImpulse, impulse,
+                           frictionImpulse);
+            }
+            if (i1 >= 0)
+            {
+                accumulate(m_contacts[i1], point, normalImpulse, -impulse,
+                           frictionImpulse);
+            }
+        }
+    }
+
+    const std::size_t n = m_contacts.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        Contacts& contacts = m_contacts[i];
+        if (contacts.normalImpulse > 0.0)
+        {
+            contacts.center /= contacts.normalImpulse;
+        }
+    }
+
+    m_timeStep = dynamicsWorld.getSolverInfo().m_timeStep;
+    m_revision = m_world.getRevision();
+    m_valid = true;
+}
+
+int tgContactTable::find(const btCollisionObject* pBody) const
+{
+    const std::vector<const btCollisionObject*>::const_iterator it =
+        std::lower_bound(m_bodies.begin(), m_bodies.end(), pBody);
+    if (pBody == NULL || it == m_bodies.end() || *it != pBody)
+    {
+        return -1;
+    }
+    return static_cast<int>(it - m_bodies.begin());
+}
+
+void tgContactTable::accumulate(Contacts& contacts, const btVector3& point,
+                                double normalImpulse, const btVector3& impulse,
+                                double frictionImpulse)
+{
+    contacts.points++;
+    contacts.normalImpulse += normalImpulse;
+    contacts.frictionImpulse += frictionImpulse;
+    contacts.impulse += impulse;
+    contacts.center += point * normalImpulse;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTACT_TABLE_H
+#define TG_CONTACT_TABLE_H
+
+/**
+ * @file tgContactTable.h
+ * @brief Contains the definition of class tgContactTable
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class btCollisionObject;
+class tgWorld;
+
+/**
+ * The contacts of every body in a world at the latest step, read from
+ * the dispatcher's persistent manifolds in a single pass and bucketed
+ * per body in a flat array. Sensors and controllers that depend on
+ * contact share one table instead of each querying the collision world.
+ *
+ * The table refreshes itself on the first read after the world steps
+ * or resets (see tgWorld::getRevision), so it costs nothing on steps
+ * where nobody reads it and one pass however many readers there are.
+ *
+ * Impulses are those the solver applied in the latest step. Contacts
+ * with objects that have no contact response, such as the ghost objects
+ * of contact cables, are ignored.
+ */
+class tgContactTable
+{
+public:
+
+    /**
+     * The contacts of one body
+     */
+    struct Contacts
+    {
+        Contacts();
+
+        /**
+         * Contact points touching the body, or pushing on it although
+         * slightly apart
+         */
+        std::size_t points;
+
+        /** Sum of the normal impulses of the points */
+        double normalImpulse;
+
+        /** Sum of the magnitudes of the friction impulses of the points */
+        double frictionImpulse;
+
+        /** Net contact impulse on the body, in world coordinates */
+        btVector3 impulse;
+
+        /**
+         * Mean of the contact points weighted by normal impulse, in
+         * world coordinates; the center of pressure for a foot. Zero if
+         * normalImpulse is zero.
+         */
+        btVector3 center;
+    };
+
+    /**
+     * @param[in] world, the world to read, which must outlive the table
+     */
+    explicit tgContactTable(const tgWorld& world);
+
+    /**
+     * The contacts of a body at the latest step
+     * @param[in] pBody, a body in the world
+     * @return its contacts; empty if pBody is NULL or not in the world
+     */
+    const Contacts& getContacts(const btCollisionObject* pBody);
+
+    /**
+     * The net contact force on a body over the latest step, its impulse
+     * divided by the step size; for a foot, the ground reaction force
+     * @param[in] pBody, a body in the world
+     */
+    btVector3 getForce(const btCollisionObject* pBody);
+
+    /** Read the manifolds now, if the world changed since the last read */
+    void update();
+
+private:
+
+    /** Index of pBody in m_bodies, or -1 */
+    int find(const btCollisionObject* pBody) const;
+
+    /** Add the impulses of one contact point to a body's bucket */
+    static void accumulate(Contacts& contacts, const btVector3& point,
+                           double normalImpulse, const btVector3& impulse,
+                           double frictionImpulse);
+
+    const tgWorld& m_world;
+
+    /** The revision of m_world the buckets were read at */
+    std::size_t m_revision;
+
+    bool m_valid;
+
+    /** The size of the latest step, for forces */
+    double m_timeStep;
+
+    /** The world's collision objects, sorted for lookup */
+    std::vector<const btCollisionObject*> m_bodies;
+
+    /** One bucket per member of m_bodies */
+    std::vector<Contacts> m_contacts;
+
+    /** Returned for bodies that are not in the world */
+    const Contacts m_none;
+};
+
+#endif  // TG_CONTACT_TABLE_H
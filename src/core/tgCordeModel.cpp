@@ -0,0 +1,686 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeModel.cpp
+ * @brief Defines structure for the Corde softbody String Model
+ * @author Brian Mirletz
+ * $Id$
+ */
+
+// This module
+#include "tgCordeModel.h"
+// This library
+#include "tgBulletSpringCableAnchor.h"
+#include "tgCheckpoint.h"
+#include "tgModelVisitor.h"
+// The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    template <typename T>
+    void writeAll(std::ostream& os, const std::vector<T>& values)
+    {
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            tgCheckpoint::write(os, values[i]);
+        }
+    }
+
+    template <typename T>
+    void readAll(std::istream& is, std::vector<T>& values)
+    {
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            tgCheckpoint::read(is, values[i]);
+        }
+    }
+
+    /** The velocity of body at pos, in world coordinates */
+    btVector3 velocityAt(const btRigidBody& body, const btVector3& pos)
+    {
+        return body.getVelocityInLocalPoint(pos - body.getCenterOfMassPosition());
+    }
+} // namespace
+
+tgCordeModel::Config::Config(const std::size_t res,
+                            const double r, const double d,
+                            const double ym, const double shm,
+                            const double stm, const double csc,
+                            const double gt, const double gr,
+                            const std::size_t par) :
+    resolution(res),
+    radius(r),
+    density(d),
+    YoungMod(ym),
+    ShearMod(shm),
+    StretchMod(stm),
+    ConsSpringConst(csc),
+    gammaT(gt),
+    gammaR(gr),
+    minParallelSegments(par)
+{
+    if (res < 3)
+    {
+        throw std::invalid_argument("Corde string needs at least three mass points.");
+    }
+    else if (r <= 0.0)
+    {
+        throw std::invalid_argument("Corde string radius is not positive.");
+    }
+    else if (d <= 0.0)
+    {
+        throw std::invalid_argument("Corde String density is not positive.");
+    }
+    else if (ym < 0.0)
+    {
+        throw std::invalid_argument("String Young's Modulus is negative.");
+    }
+    else if (shm < 0.0)
+    {
+        throw std::invalid_argument("Shear Modulus is negative.");
+    }
+    else if (stm < 0.0)
+    {
+        throw std::invalid_argument("Stretch Modulus is negative.");
+    }
+    else if (csc < 0.0)
+    {
+        throw std::invalid_argument("Spring Constant is negative.");
+    }
+    else if (gt < 0.0)
+    {
+        throw std::invalid_argument("Damping Constant (position) is negative.");
+    }
+    else if (gr < 0.0)
+    {
+        throw std::invalid_argument("Damping Constant (rotation) is negative.");
+    }
+}
+
+tgCordeModel::tgCordeModel(btVector3 pos1, btVector3 pos2,
+                            btQuaternion quat1, btQuaternion quat2,
+                            const tgCordeModel::Config& config) :
+    m_config(config),
+    m_pAnchor1(NULL),
+    m_pAnchor2(NULL)
+{
+    computeConstants();
+    const double unitLength = (pos2 - pos1).length() /
+                                ((double) m_config.resolution - 1);
+    m_params = computeParameters(unitLength);
+    constructorAux(pos1, pos2, quat1, quat2);
+}
+
+tgCordeModel::tgCordeModel(btVector3 pos1, btVector3 pos2,
+                            btQuaternion quat1, btQuaternion quat2,
+                            const tgCordeModel::Config& config,
+                            ParametersPtr params) :
+    m_config(config),
+    m_pAnchor1(NULL),
+    m_pAnchor2(NULL)
+{
+    computeConstants();
+    setParameters(params);
+    constructorAux(pos1, pos2, quat1, quat2);
+}
+
+tgCordeModel::tgCordeModel(btRigidBody* body1, btVector3 pos1,
+                            btRigidBody* body2, btVector3 pos2,
+                            btQuaternion quat1, btQuaternion quat2,
+                            const tgCordeModel::Config& config,
+                            const tgTags& tags) :
+    tgModel(tags),
+    m_config(config),
+    m_pAnchor1(body1 ? new tgBulletSpringCableAnchor(body1, pos1) : NULL),
+    m_pAnchor2(body2 ? new tgBulletSpringCableAnchor(body2, pos2) : NULL)
+{
+    computeConstants();
+    const double unitLength = (pos2 - pos1).length() /
+                                ((double) m_config.resolution - 1);
+    m_params = computeParameters(unitLength);
+    constructorAux(pos1, pos2, quat1, quat2);
+
+    // Pinned ends move with their bodies, not with the rod's forces
+    if (m_pAnchor1)
+    {
+        m_inverseMasses.front() = 0.0;
+    }
+    if (m_pAnchor2)
+    {
+        m_inverseMasses.back() = 0.0;
+    }
+    pinEnds();
+}
+
+tgCordeModel::~tgCordeModel()
+{
+    delete m_pAnchor1;
+    delete m_pAnchor2;
+}
+
+void tgCordeModel::constructorAux(btVector3 pos1, btVector3 pos2,
+                                    btQuaternion quat1, btQuaternion quat2)
+{
+    const std::size_t n = m_config.resolution;
+
+    btVector3 unitLength( (pos2 - pos1) / ((double) n - 1) );
+    const double unitMass =  m_config.density * M_PI *
+                                pow( m_config.radius, 2) * unitLength.length();
+
+    m_positions.resize(n);
+    m_velocities.assign(n, btVector3(0.0, 0.0, 0.0));
+    m_forces.assign(n, btVector3(0.0, 0.0, 0.0));
+    m_inverseMasses.assign(n, 1.0 / unitMass);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_positions[i] = pos1 + unitLength * (double) i;
+    }
+
+    const std::size_t nq = n - 1;
+    m_quaternions.resize(nq);
+    m_qdots.assign(nq, btQuaternion(0.0, 0.0, 0.0, 0.0));
+    m_tprimes.assign(nq, btQuaternion(0.0, 0.0, 0.0, 0.0));
+    m_torques.assign(nq, btVector3(0.0, 0.0, 0.0));
+    m_omegas.assign(nq, btVector3(0.0, 0.0, 0.0));
+    m_quaternions[0] = quat1.normalize();
+    for (std::size_t i = 1; i < nq; i++)
+    {
+        m_quaternions[i] =
+            quat1.slerp(quat2, (double) i / (double) nq).normalize();
+    }
+
+    m_linkForces0.resize(nq);
+    m_linkForces1.resize(nq);
+    m_linkTprimes.resize(nq);
+    m_pairTprimes0.resize(nq - 1);
+    m_pairTprimes1.resize(nq - 1);
+
+    assert(invariant());
+}
+
+tgCordeModel::ParametersPtr
+tgCordeModel::computeParameters(double linkLength) const
+{
+    const double pir2 =  M_PI * pow(m_config.radius, 2);
+    const std::size_t nq = m_config.resolution - 1;
+
+    Parameters* const pParams = new Parameters();
+    // Introduce stretch here by scaling the link lengths
+    pParams->linkLengths.assign(nq, linkLength);
+    pParams->quaternionShapes.assign(nq - 1, linkLength);
+    pParams->stretchStiffness.assign(nq, m_config.StretchMod * pir2);
+    pParams->bendStiffness.assign(nq - 1,
+                                    btVector3(m_config.YoungMod * pir2 / 4.0,
+                                              m_config.YoungMod * pir2 / 4.0,
+                                              m_config.ShearMod * pir2 / 2.0));
+    return ParametersPtr(pParams);
+}
+
+void tgCordeModel::setParameters(ParametersPtr params)
+{
+    const std::size_t nq = m_config.resolution - 1;
+    if (!params ||
+        params->linkLengths.size() != nq ||
+        params->stretchStiffness.size() != nq ||
+        params->quaternionShapes.size() != nq - 1 ||
+        params->bendStiffness.size() != nq - 1)
+    {
+        throw std::invalid_argument("Corde parameters do not match the resolution.");
+    }
+    m_params = params;
+}
+
+void tgCordeModel::step(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("Timestep is not positive.");
+    }
+
+    pinEnds();
+    computeLinkForces();
+    computeBendingTorques();
+    gatherForces();
+    applyEndForces(dt);
+    unconstrainedMotion(dt);
+
+    tgModel::step(dt);
+
+    assert(invariant());
+}
+
+void tgCordeModel::onVisit(const tgModelVisitor& r) const
+{
+    r.render(*this);
+}
+
+void tgCordeModel::saveState(std::ostream& os)
+{
+    writeAll(os, m_positions);
+    writeAll(os, m_velocities);
+    writeAll(os, m_quaternions);
+    writeAll(os, m_qdots);
+    writeAll(os, m_omegas);
+    tgModel::saveState(os);
+}
+
+void tgCordeModel::loadState(std::istream& is)
+{
+    readAll(is, m_positions);
+    readAll(is, m_velocities);
+    readAll(is, m_quaternions);
+    readAll(is, m_qdots);
+    readAll(is, m_omegas);
+    tgModel::loadState(is);
+}
+
+void tgCordeModel::pinEnds()
+{
+    if (m_pAnchor1)
+    {
+        m_positions.front() = m_pAnchor1->getWorldPosition();
+        m_velocities.front() =
+            velocityAt(*m_pAnchor1->attachedBody, m_positions.front());
+    }
+    if (m_pAnchor2)
+    {
+        m_positions.back() = m_pAnchor2->getWorldPosition();
+        m_velocities.back() =
+            velocityAt(*m_pAnchor2->attachedBody, m_positions.back());
+    }
+}
+
+void tgCordeModel::applyEndForces(double dt)
+{
+    tgBulletSpringCableAnchor* const anchors[2] = { m_pAnchor1, m_pAnchor2 };
+    const std::size_t points[2] = { 0, m_positions.size() - 1 };
+    for (std::size_t i = 0; i < 2; i++)
+    {
+        if (anchors[i] == NULL)
+        {
+            continue;
+        }
+        btRigidBody* const body = anchors[i]->attachedBody;
+        const btVector3 impulse = m_forces[points[i]] * dt;
+        if (!impulse.fuzzyZero())
+        {
+            body->activate();
+            body->applyImpulse(impulse, m_positions[points[i]] -
+                                        body->getCenterOfMassPosition());
+        }
+    }
+}
+
+void tgCordeModel::computeConstants()
+{
+    const double pir2 =  M_PI * pow(m_config.radius, 2);
+
+    computedInertia.setValue(m_config.density * pir2 / 4.0,
+                     m_config.density * pir2 / 4.0,
+                     m_config.density * pir2 / 2.0);
+
+    // Can assume if one element is zero, all elements are zero and we've screwed up
+    // Should pass automatically based on exceptions in config constructor
+    assert(!computedInertia.fuzzyZero());
+
+    inverseInertia.setValue(1.0/computedInertia[0],
+                            1.0/computedInertia[1],
+                            1.0/computedInertia[2]);
+}
+
+bool tgCordeModel::parallel() const
+{
+    return m_config.minParallelSegments > 0 &&
+            m_config.resolution - 1 >= m_config.minParallelSegments;
+}
+
+void tgCordeModel::computeLinkForces()
+{
+    const Parameters& params = *m_params;
+    // Signed for OpenMP
+    const int n = (int) m_quaternions.size();
+    const double consSpring = m_config.ConsSpringConst;
+    const double gammaT = m_config.gammaT;
+
+    // Each link only writes its own entries, so links are independent
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel())
+#endif
+    for (int i = 0; i < n; i++)
+    {
+        const btVector3& r_0 = m_positions[i];
+        const btVector3& r_1 = m_positions[i + 1];
+        const btQuaternion& q_0 = m_quaternions[i];
+        const double linkLength = params.linkLengths[i];
+
+        // Get quaternion elements in standard variable names
+        const btScalar q11 = q_0[0];
+        const btScalar q12 = q_0[1];
+        const btScalar q13 = q_0[2];
+        const btScalar q14 = q_0[3];
+
+        // Setup common factors
+        const btVector3 posDiff = r_0 - r_1;
+        const btVector3 velDiff = m_velocities[i] - m_velocities[i + 1];
+        const btScalar posNorm   = posDiff.length();
+        const btScalar posNorm_2 = posDiff.length2();
+        const btVector3 director( (2.0 * (q11 * q13 + q12 * q14)),
+                        (2.0 * (q12 * q13 - q11 * q14)),
+           ( -1.0 * q11 * q11 - q12 * q12 + q13 * q13 + q14 * q14));
+
+        // Forces and torques below are minus the gradients of the
+        // stretch, constraint and bending energies, and minus those of
+        // the dissipation functions
+
+        // Spring common, positive when stretched
+        const btScalar spring_common = params.stretchStiffness[i] *
+            (posNorm - linkLength) / (linkLength * posNorm);
+
+        const btScalar diss_common = gammaT *
+                        posNorm_2 * posDiff.dot(velDiff) / pow (linkLength , 5);
+
+        // Gradient of the quaternion constraint energy
+        // ConsSpringConst * linkLength / 2 * |director - (r_1 - r_0) / |r_1 - r_0||^2
+        // with respect to r_0. It is minus that with respect to r_1.
+        const btVector3 consForce = consSpring * linkLength / posNorm *
+            (director - posDiff * (director.dot(posDiff) / posNorm_2));
+
+        const btVector3 linkForce = posDiff * (spring_common + diss_common);
+
+        /* Apply constraint equation with boundry conditions */
+        m_linkForces0[i] = (i == 0) ? -linkForce : -linkForce - consForce;
+        m_linkForces1[i] = (i == n - 1) ? linkForce : linkForce + consForce;
+
+        // quat_0->q.length2() should always be 1, but sometimes numerical precision renders it slightly greater
+        // The simulation is much more stable if we just assume its one.
+        const btScalar cons_common = -2.0 * consSpring * linkLength;
+        m_linkTprimes[i] = btQuaternion(
+            cons_common * ( q11 + (q13 * posDiff[0] -
+            q14 * posDiff[1] - q11 * posDiff[2]) / posNorm),
+            cons_common * ( q12 + (q14 * posDiff[0] +
+            q13 * posDiff[1] - q12 * posDiff[2]) / posNorm),
+            cons_common * ( q13 + (q11 * posDiff[0] +
+            q12 * posDiff[1] + q13 * posDiff[2]) / posNorm),
+            cons_common * ( q14 + (q12 * posDiff[0] -
+            q11 * posDiff[1] + q14 * posDiff[2]) / posNorm));
+    }
+}
+
+void tgCordeModel::computeBendingTorques()
+{
+    const Parameters& params = *m_params;
+    const int n = (int) m_pairTprimes0.size();
+
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel())
+#endif
+    for (int i = 0; i < n; i++)
+    {
+        const btQuaternion& quat_0 = m_quaternions[i];
+        const btQuaternion& quat_1 = m_quaternions[i + 1];
+        const btQuaternion& qdot_0 = m_qdots[i];
+        const btQuaternion& qdot_1 = m_qdots[i + 1];
+
+        /* Setup Variables */
+        const btScalar q11 = quat_0[0];
+        const btScalar q12 = quat_0[1];
+        const btScalar q13 = quat_0[2];
+        const btScalar q14 = quat_0[3];
+
+        const btScalar q21 = quat_1[0];
+        const btScalar q22 = quat_1[1];
+        const btScalar q23 = quat_1[2];
+        const btScalar q24 = quat_1[3];
+
+        const btScalar qdot11 = qdot_0[0];
+        const btScalar qdot12 = qdot_0[1];
+        const btScalar qdot13 = qdot_0[2];
+        const btScalar qdot14 = qdot_0[3];
+
+        const btScalar qdot21 = qdot_1[0];
+        const btScalar qdot22 = qdot_1[1];
+        const btScalar qdot23 = qdot_1[2];
+        const btScalar qdot24 = qdot_1[3];
+
+        const btScalar k1 = params.bendStiffness[i][0];
+        const btScalar k2 = params.bendStiffness[i][1];
+        const btScalar k3 = params.bendStiffness[i][2];
+
+        /* I apologize for the mess below - the derivatives involved
+         * here do not leave a lot of common factors. If you see
+         * any nice vector operations I missed, implement them and/or
+         * let me know! _Brian
+         */
+
+        /* Bending and torsional stiffness */
+        const btScalar stiffness_common = 4.0 / params.quaternionShapes[i] *
+        pow(params.quaternionShapes[i] - 1.0, 2);
+        
+        const btScalar q11_stiffness = stiffness_common * 
+        (k1 * q24 * (q11 * q24 + q12 * q23 - q13 * q22 - q14 * q21) +
+         k2 * q23 * (q11 * q23 - q12 * q24 - q13 * q21 + q14 * q22) +
+         k3 * q22 * (q11 * q22 - q12 * q21 + q13 * q24 - q14 * q23));
+         
+        const btScalar q12_stiffness = stiffness_common * 
+        (k1 * q23 * (q12 * q23 + q11 * q24 - q13 * q22 - q14 * q21) +
+         k2 * q24 * (q12 * q24 - q11 * q23 + q13 * q21 - q14 * q22) +
+         k3 * q21 * (q12 * q21 - q11 * q22 - q13 * q24 + q14 * q23));
+         
+        const btScalar q13_stiffness = stiffness_common * 
+        (k1 * q22 * (q13 * q22 - q11 * q24 - q12 * q23 + q14 * q21) +
+         k2 * q21 * (q13 * q21 - q11 * q23 + q12 * q24 - q14 * q22) +
+         k3 * q24 * (q13 * q24 + q11 * q22 - q12 * q21 - q14 * q23));
+         
+        const btScalar q14_stiffness = stiffness_common * 
+        (k1 * q21 * (q14 * q21 - q11 * q24 - q12 * q23 + q13 * q22) +
+         k2 * q22 * (q14 * q22 + q11 * q23 - q12 * q24 - q13 * q21) +
+         k3 * q23 * (q14 * q23 - q11 * q22 + q12 * q21 - q13 * q24));   
+        
+        const btScalar q21_stiffness = stiffness_common *
+        (k1 * q14 * (q14 * q21 - q11 * q24 - q12 * q23 + q13 * q22) +
+         k2 * q13 * (q13 * q21 - q11 * q23 + q12 * q24 - q14 * q22) +
+         k3 * q12 * (q12 * q21 - q11 * q22 + q14 * q23 - q13 * q24));
+        
+        const btScalar q22_stiffness = stiffness_common *
+        (k1 * q13 * (q13 * q22 - q11 * q24 - q12 * q23 + q14 * q21) + 
+         k2 * q14 * (q14 * q22 + q11 * q23 - q12 * q24 - q13 * q21) +
+         k3 * q11 * (q11 * q22 - q12 * q21 + q13 * q24 - q14 * q23));
+         
+        const btScalar q23_stiffness = stiffness_common *
+        (k1 * q12 * (q12 * q23 + q11 * q24 - q13 * q22 - q14 * q21) +
+         k2 * q11 * (q11 * q23 - q13 * q21 - q12 * q24 + q14 * q22) +
+         k3 * q14 * (q14 * q23 - q11 * q22 + q12 * q21 - q13 * q24));
+         
+        const btScalar q24_stiffness = stiffness_common *
+        (k1 * q11 * (q11 * q24 + q12 * q23 - q13 * q22 - q14 * q21) +
+         k2 * q12 * (q12 * q24 - q11 * q23 + q13 * q21 - q14 * q22) +
+         k3 * q13 * (q13 * q24 + q11 * q22 - q12 * q21 - q14 * q23));
+         
+        /* Torsional Damping */
+        const btScalar damping_common = 4.0 * m_config.gammaR / params.quaternionShapes[i];
+        
+        const btScalar q11_damping = damping_common *
+        (q12 * (q12 * qdot11 - q11 * qdot12 + q21 * qdot22 - q22 * qdot21 - q23 * qdot24 + q24 * qdot23) +
+         q13 * (q13 * qdot11 - q11 * qdot13 + q21 * qdot23 + q22 * qdot24 - q23 * qdot21 - q24 * qdot22) +
+         q14 * (q14 * qdot11 - q11 * qdot14 + q21 * qdot24 - q22 * qdot23 + q23 * qdot22 - q24 * qdot21));
+         
+        const btScalar q12_damping = damping_common *
+        (q11 * (q11 * qdot12 - q12 * qdot11 - q21 * qdot22 + q22 * qdot21 + q23 * qdot24 - q24 * qdot23) +
+         q13 * (q13 * qdot12 - q13 * qdot13 - q21 * qdot24 + q22 * qdot23 - q23 * qdot22 + q24 * qdot21) + 
+         q14 * (q14 * qdot12 - q14 * qdot14 + q21 * qdot23 + q22 * qdot24 - q23 * qdot21 - q24 * qdot22));
+         
+        const btScalar q13_damping = damping_common * 
+        (q11 * (q11 * qdot13 - q13 * qdot11 - q21 * qdot23 - q22 * qdot24 + q23 * qdot21 + q24 * qdot22) +
+         q12 * (q12 * qdot13 - q13 * qdot12 + q21 * qdot24 - q22 * qdot23 + q23 * qdot22 - q24 * qdot21) +
+         q14 * (q14 * qdot13 - q13 * qdot14 - q21 * qdot22 + q22 * qdot21 + q23 * qdot24 - q24 * qdot23));
+         
+        const btScalar q14_damping = damping_common *
+        (q11 * (q11 * qdot14 - q14 * qdot11 - q21 * qdot24 + q22 * qdot23 - q23 * qdot22 + q24 * qdot21) +
+         q12 * (q12 * qdot14 - q14 * qdot12 - q21 * qdot23 - q22 * qdot24 + q23 * qdot21 + q24 * qdot22) +
+         q13 * (q13 * qdot14 - q14 * qdot13 + q21 * qdot22 - q22 * qdot21 - q23 * qdot24 + q24 * qdot23));
+        
+        const btScalar q21_damping = damping_common *
+        (q22 * (q22 * qdot21 + q11 * qdot12 - q12 * qdot11 - q13 * qdot14 + q14 * qdot13 - q21 * qdot22) +
+         q23 * (q23 * qdot21 + q11 * qdot13 + q12 * qdot14 - q13 * qdot11 - q14 * qdot12 - q21 * qdot23) +
+         q24 * (q24 * qdot21 + q11 * qdot14 - q12 * qdot13 + q13 * qdot12 - q14 * qdot11 - q21 * qdot24));
+         
+        const btScalar q22_damping = damping_common *
+        (q21 * (q21 * qdot22 - q11 * qdot12 + q12 * qdot11 + q13 * qdot14 - q14 * qdot13 - q22 * qdot21) +
+         q23 * (q23 * qdot22 - q11 * qdot14 + q12 * qdot13 - q13 * qdot12 + q14 * qdot11 - q22 * qdot23) +
+         q24 * (q24 * qdot22 + q11 * qdot13 + q12 * qdot14 - q13 * qdot11 - q14 * qdot12 - q22 * qdot24));
+         
+        const btScalar q23_damping = damping_common *
+        (q21 * (q21 * qdot23 - q11 * qdot13 + q13 * qdot11 - q12 * qdot14 + q14 * qdot12 - q23 * qdot21) +
+         q22 * (q22 * qdot23 + q11 * qdot14 - q12 * qdot13 + q13 * qdot12 - q14 * qdot11 - q22 * qdot22) +
+         q24 * (q24 * qdot23 - q11 * qdot12 + q12 * qdot11 + q13 * qdot14 - q14 * qdot13 - q23 * qdot24));
+         
+        const btScalar q24_damping = damping_common *
+        (q21 * (q21 * qdot24 - q11 * qdot14 + q12 * qdot13 - q13 * qdot12 + q14 * qdot11 - q24 * qdot21) +
+         q22 * (q21 * qdot24 - q11 * qdot13 - q12 * qdot14 + q13 * qdot11 + q14 * qdot12 - q24 * qdot22) +
+         q23 * (q23 * qdot24 + q11 * qdot12 - q12 * qdot11 - q13 * qdot14 + q14 * qdot13 - q24 * qdot23));
+
+        /* Apply torques */
+        // The terms above are the gradients of the bending energy and
+        // of the dissipation function, so they are subtracted
+        m_pairTprimes0[i] = btQuaternion(-q11_stiffness - q11_damping,
+                                         -q12_stiffness - q12_damping,
+                                         -q13_stiffness - q13_damping,
+                                         -q14_stiffness - q14_damping);
+
+        m_pairTprimes1[i] = btQuaternion(-q21_stiffness - q21_damping,
+                                         -q22_stiffness - q22_damping,
+                                         -q23_stiffness - q23_damping,
+                                         -q24_stiffness - q24_damping);
+    }
+}
+
+void tgCordeModel::gatherForces()
+{
+    const int n = (int) m_positions.size();
+    const int nq = (int) m_quaternions.size();
+
+    // Mass point i is the second point of link i - 1 and the first of link i
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel())
+#endif
+    for (int i = 0; i < n; i++)
+    {
+        btVector3 force(0.0, 0.0, 0.0);
+        if (i > 0)
+        {
+            force += m_linkForces1[i - 1];
+        }
+        if (i < n - 1)
+        {
+            force += m_linkForces0[i];
+        }
+        m_forces[i] = force;
+    }
+
+    // Quaternion i is the second of pair i - 1 and the first of pair i
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel())
+#endif
+    for (int i = 0; i < nq; i++)
+    {
+        btQuaternion tprime = m_linkTprimes[i];
+        if (i > 0)
+        {
+            tprime += m_pairTprimes1[i - 1];
+        }
+        if (i < nq - 1)
+        {
+            tprime += m_pairTprimes0[i];
+        }
+        m_tprimes[i] = tprime;
+    }
+}
+
+void tgCordeModel::unconstrainedMotion(double dt)
+{
+    const int n = (int) m_positions.size();
+    // Flat loop over contiguous arrays, left to the compiler to vectorize
+    for (int i = 0; i < n; i++)
+    {
+        // Velocity update - semi-implicit Euler
+        m_velocities[i] += dt * m_inverseMasses[i] * m_forces[i];
+        // Position update, uses v(t + dt)
+        m_positions[i] += dt * m_velocities[i];
+    }
+
+    const int nq = (int) m_quaternions.size();
+#ifdef _OPENMP
+    #pragma omp parallel for if (parallel())
+#endif
+    for (int i = 0; i < nq; i++)
+    {
+        btQuaternion& q = m_quaternions[i];
+        btQuaternion& qdot = m_qdots[i];
+        const btQuaternion& tprime = m_tprimes[i];
+        btVector3& omega = m_omegas[i];
+
+        /* Transpose quaternion torques into Euclidean torques */
+        const btVector3 torques(
+            1.0/2.0 * (q[0] * tprime[2] - q[2] * tprime[0] - q[1] * tprime[3] + q[3] * tprime[1]),
+            1.0/2.0 * (q[1] * tprime[0] - q[0] * tprime[1] - q[2] * tprime[3] + q[3] * tprime[2]),
+            1.0/2.0 * (q[0] * tprime[0] + q[1] * tprime[1] + q[2] * tprime[2] + q[3] * tprime[3]));
+        m_torques[i] = torques;
+
+        const btVector3 omega_0 = omega;
+        // Since I is diagonal, we can use elementwise multiplication of vectors
+        omega += inverseInertia * (torques -
+            omega_0.cross(computedInertia * omega_0)) * dt;
+
+        qdot = btQuaternion(
+            1.0/2.0 * (q[0] * omega[2] + q[1] * omega[1] - q[2] * omega[0]),
+            1.0/2.0 * (q[1] * omega[2] - q[0] * omega[1] + q[3] * omega[0]),
+            1.0/2.0 * (q[0] * omega[0] + q[2] * omega[2] + q[3] * omega[1]),
+            1.0/2.0 * (q[3] * omega[2] - q[2] * omega[1] - q[1] * omega[0]));
+
+        q = (qdot * dt + q).normalize();
+    }
+}
+
+/// Checks lengths of vectors. @todo add additional invariants
+bool tgCordeModel::invariant() const
+{
+    const std::size_t n = m_positions.size();
+    return (n == m_config.resolution)
+        && (m_velocities.size() == n)
+        && (m_forces.size() == n)
+        && (m_inverseMasses.size() == n)
+        && (m_quaternions.size() == n - 1)
+        && (m_qdots.size() == n - 1)
+        && (m_tprimes.size() == n - 1)
+        && (m_torques.size() == n - 1)
+        && (m_omegas.size() == n - 1)
+        && (m_linkForces0.size() == n - 1)
+        && (m_linkForces1.size() == n - 1)
+        && (m_linkTprimes.size() == n - 1)
+        && (m_pairTprimes0.size() == n - 2)
+        && (m_pairTprimes1.size() == n - 2)
+        && m_params
+        && (m_params->linkLengths.size() == n - 1);
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CORDE_MODEL_H
+#define TG_CORDE_MODEL_H
+
+/**
+ * @file tgCordeModel.h
+ * @brief Defines structure for the Corde softbody String Model
+ * @author Brian Mirletz
+ * $Id$
+ */
+
+// This library
+#include "tgModel.h"
+
+// Bullet Linear Algebra
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btVector3.h"
+#include "LinearMath/btQuaternion.h"
+
+// Boost
+#include "boost/shared_ptr.hpp"
+
+// The C++ Standard Library
+#include <iostream>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgBulletSpringCableAnchor;
+class tgModelVisitor;
+
+/**
+ * A Cosserat rod (Corde) model of a string, after Spillmann and
+ * Teschner. Mass points carry position and velocity, the centerline
+ * quaternions between them carry orientation and angular velocity.
+ *
+ * Each state quantity is stored in its own contiguous array rather than
+ * in a heap allocated element per point, and the force kernel first
+ * computes per link and per quaternion pair contributions and then
+ * gathers them, so every loop is independent over segments. When built
+ * with OpenMP (USE_OPENMP) the loops are split across threads for rods
+ * with at least Config::minParallelSegments segments.
+ *
+ * Either end can be pinned to a rigid body. A pinned mass point follows
+ * its anchor, and the rod's force on it is applied to the body as an
+ * impulse every step, so the rod acts as a cable between the bodies.
+ * The orientation of the rod at a pinned end is left free.
+ */
+class tgCordeModel : public tgModel
+{
+public:
+	struct Config
+	{
+		Config(const std::size_t res,
+				const double r, const double d,
+				const double ym, const double shm,
+				const double stm, const double csc,
+				const double gt, const double gr,
+				const std::size_t par = 0);
+
+		const std::size_t resolution;
+		const double radius;
+		const double density;
+		const double YoungMod;
+		const double ShearMod;
+		const double StretchMod;
+		const double ConsSpringConst;
+		/**
+		 * For really short segments (< .001 length) consider decreasing
+		 * these further or changing length to cubic (currently ^5)
+		 */
+		const double gammaT;
+		const double gammaR;
+		/**
+		 * Number of segments at or above which the kernels run in
+		 * parallel when built with OpenMP. Zero never parallelizes.
+		 */
+		const std::size_t minParallelSegments;
+	};
+
+	/**
+	 * Rest geometry and stiffness of a rod. These never change during
+	 * a step, so rods with the same discretization can share one copy.
+	 */
+	struct Parameters
+	{
+		/**
+		 * Rest length of each link, length resolution - 1
+		 */
+		std::vector<double> linkLengths;
+		/**
+		 * Rest shape between neighboring quaternions, length
+		 * resolution - 2
+		 */
+		std::vector<double> quaternionShapes;
+		/**
+		 * Linear stiffness of each link, length resolution - 1
+		 */
+		std::vector<double> stretchStiffness;
+		/**
+		 * Bending (x, y) and torsion (z) stiffness between neighboring
+		 * quaternions, length resolution - 2
+		 */
+		std::vector<btVector3> bendStiffness;
+	};
+
+	typedef boost::shared_ptr<const Parameters> ParametersPtr;
+
+	/**
+	 * A constructor which assumes uniformally distributed mass
+	 * points and rotation
+	 * pos1 and pos2 specify the start and end points of the rod.
+	 * quat1 and quat2 need to be computed based on the torsion in the rod.
+	 * Note that if there is neither bending nor torsion one can say quat1 = quat2
+	 * = btQuaternion((pos2 - pos1).normalize, 0) (axis-angle constructor)
+	 * @todo develop a constructor that can handle more complex shapes
+	 * i.e. wrapped around a motor. This one maxes out at 1 - eps rotations
+	 */
+	tgCordeModel(btVector3 pos1, btVector3 pos2, btQuaternion quat1,
+				btQuaternion quat2, const tgCordeModel::Config& config);
+
+	/**
+	 * As above, but shares the rest lengths and stiffnesses of another
+	 * rod (see getParameters) instead of computing its own.
+	 * @throw std::invalid_argument if params does not match the resolution
+	 */
+	tgCordeModel(btVector3 pos1, btVector3 pos2, btQuaternion quat1,
+				btQuaternion quat2, const tgCordeModel::Config& config,
+				ParametersPtr params);
+
+	/**
+	 * A rod pinned to rigid bodies at its ends, with the rest length
+	 * of the straight line between pos1 and pos2
+	 * @param[in] body1, the body pos1 is on, or NULL for a free end;
+	 * must outlive the rod
+	 * @param[in] pos1, the start of the rod in world coordinates
+	 * @param[in] body2, the body pos2 is on, or NULL for a free end;
+	 * must outlive the rod
+	 * @param[in] pos2, the end of the rod in world coordinates
+	 */
+	tgCordeModel(btRigidBody* body1, btVector3 pos1,
+				btRigidBody* body2, btVector3 pos2,
+				btQuaternion quat1, btQuaternion quat2,
+				const tgCordeModel::Config& config,
+				const tgTags& tags = tgTags());
+
+	/** Deletes the anchors */
+	virtual ~tgCordeModel();
+
+	/**
+	 * Advance the rod by dt, pushing the bodies at pinned ends, then
+	 * step the children
+	 * @throw std::invalid_argument if dt is not positive
+	 */
+	virtual void step(double dt);
+
+	/** Render the rod, see tgModelVisitor::render */
+	virtual void onVisit(const tgModelVisitor& r) const;
+
+	/** Writes the mass point and quaternion state */
+	virtual void saveState(std::ostream& os);
+
+	/** Reads back what saveState wrote */
+	virtual void loadState(std::istream& is);
+
+	/**
+	 * The rest lengths and stiffnesses, for sharing with other rods
+	 */
+	ParametersPtr getParameters() const
+	{
+		return m_params;
+	}
+
+	/**
+	 * Replace the rest lengths and stiffnesses, for example to change
+	 * the rest length of the whole rod.
+	 * @throw std::invalid_argument if params does not match the resolution
+	 */
+	void setParameters(ParametersPtr params);
+
+	const std::vector<btVector3>& getPositions() const
+	{
+		return m_positions;
+	}
+
+	const std::vector<btVector3>& getVelocities() const
+	{
+		return m_velocities;
+	}
+
+	const std::vector<btQuaternion>& getQuaternions() const
+	{
+		return m_quaternions;
+	}
+
+	const std::vector<btVector3>& getTorques() const
+	{
+		return m_torques;
+	}
+
+private:
+
+	/**
+	 * Place the mass points and quaternions, shared by the constructors
+	 */
+	void constructorAux(btVector3 pos1, btVector3 pos2,
+						btQuaternion quat1, btQuaternion quat2);
+
+	/**
+	 * Move the pinned mass points to their anchors, with the velocity
+	 * of the body at that point
+	 */
+	void pinEnds();
+
+	/**
+	 * Apply the rod's force on each pinned mass point to its body
+	 */
+	void applyEndForces(double dt);
+
+	/**
+	 * Uniform rest lengths and stiffnesses computed from the config
+	 */
+	ParametersPtr computeParameters(double linkLength) const;
+
+	void computeConstants();
+
+	/**
+	 * Forces and quaternion constraint torques of each link
+	 */
+	void computeLinkForces();
+
+	/**
+	 * Bending and torsion between each pair of neighboring quaternions
+	 */
+	void computeBendingTorques();
+
+	/**
+	 * Sum the per link and per pair contributions on each element
+	 */
+	void gatherForces();
+
+	void unconstrainedMotion(double dt);
+
+	/** True if the kernels should be split across threads */
+	bool parallel() const;
+
+	/** Disable the copy constructor. */
+	tgCordeModel(const tgCordeModel&);
+
+	/** Disable the assignment operator. */
+	tgCordeModel& operator=(const tgCordeModel&);
+
+	const tgCordeModel::Config m_config;
+
+	ParametersPtr m_params;
+
+	/**
+	 * Where the first and the last mass point are pinned, or NULL for
+	 * a free end. Owned.
+	 */
+	tgBulletSpringCableAnchor* m_pAnchor1;
+	tgBulletSpringCableAnchor* m_pAnchor2;
+
+	/**
+	 * Mass point state, length resolution. Pinned mass points have an
+	 * inverse mass of zero.
+	 */
+	std::vector<btVector3> m_positions;
+	std::vector<btVector3> m_velocities;
+	std::vector<btVector3> m_forces;
+	std::vector<double> m_inverseMasses;
+
+	/**
+	 * Centerline quaternion state, length resolution - 1.
+	 * tprime is just a 4x1 vector, but easier to store this way.
+	 */
+	std::vector<btQuaternion> m_quaternions;
+	std::vector<btQuaternion> m_qdots;
+	std::vector<btQuaternion> m_tprimes;
+	std::vector<btVector3> m_torques;
+	std::vector<btVector3> m_omegas;
+
+	/**
+	 * Per link scratch: force on the first and the second mass point,
+	 * and the constraint torque on the link's quaternion
+	 */
+	std::vector<btVector3> m_linkForces0;
+	std::vector<btVector3> m_linkForces1;
+	std::vector<btQuaternion> m_linkTprimes;
+
+	/**
+	 * Per quaternion pair scratch: torque on the first and the second
+	 * quaternion
+	 */
+	std::vector<btQuaternion> m_pairTprimes0;
+	std::vector<btQuaternion> m_pairTprimes1;
+
+	/**
+	 * Computed based on the values in config.
+	 * Assuming products of inertia are negligible as in the paper
+	 */
+	btVector3 computedInertia;
+	btVector3 inverseInertia;
+
+	bool invariant() const;
+};
+
+
+#endif // TG_CORDE_MODEL_H
@@ -0,0 +1,219 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgFitnessMetrics.cpp
+ * @brief Contains the implementation of class tgFitnessMetrics
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgFitnessMetrics.h"
+// This library
+#include "tgBaseRigid.h"
+#include "tgBulletUtil.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgSpringCableActuator.h"
+#include "tgWorld.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuickprof.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+tgFitnessMetrics::Results::Results() :
+    elapsed(0.0),
+    steps(0),
+    startCOM(0.0, 0.0, 0.0),
+    currentCOM(0.0, 0.0, 0.0),
+    displacement(0.0),
+    horizontalDisplacement(0.0),
+    pathLength(0.0),
+    work(0.0),
+    peakTension(0.0),
+    contactPoints(0),
+    peakContactPoints(0)
+{
+}
+
+tgFitnessMetrics::tgFitnessMetrics() :
+    m_pWorld(NULL)
+{
+    assert(invariant());
+}
+
+void tgFitnessMetrics::setup(tgModel& model, const tgWorld* pWorld)
+{
+    const std::vector<tgModel*> descendants = model.getDescendants();
+
+    m_actuators = tgCast::filter<tgModel, tgSpringCableActuator>(descendants);
+    const std::size_t n = m_actuators.size();
+    m_prevRestLengths.resize(n);
+    m_prevTensions.resize(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_prevRestLengths[i] = m_actuators[i]->getRestLength();
+        m_prevTensions[i] = m_actuators[i]->getTension();
+    }
+
+    const std::vector<tgBaseRigid*> rigids =
+        tgCast::filter<tgModel, tgBaseRigid>(descendants);
+    m_rigids.clear();
+    m_bodies.clear();
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        tgBaseRigid* const pRigid = rigids[i];
+        if (pRigid->getPRigidBody() == NULL)
+        {
+            continue;
+        }
+        if (pRigid->mass() > 0.0)
+        {
+            m_rigids.push_back(pRigid);
+        }
+        m_bodies.push_back(pRigid->getPRigidBody());
+    }
+    // Rods of a compound share one body
+    std::sort(m_bodies.begin(), m_bodies.end());
+    m_bodies.erase(std::unique(m_bodies.begin(), m_bodies.end()),
+                   m_bodies.end());
+
+    m_pWorld = pWorld;
+
+    m_results = Results();
+    m_results.startCOM = centerOfMass();
+    m_results.currentCOM = m_results.startCOM;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_results.peakTension = std::max(m_results.peakTension,
+                                         m_prevTensions[i]);
+    }
+
+    assert(invariant());
+}
+
+void tgFitnessMetrics::step(double dt)
+{
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgFitnessMetrics::step");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    m_results.elapsed += dt;
+    m_results.steps++;
+
+    // Work is charged at the tension of the previous step, as the
+    // controllers that summed actuator history did
+    const std::size_t n = m_actuators.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const tgSpringCableActuator* const pActuator = m_actuators[i];
+        const double restLength = pActuator->getRestLength();
+        const double tension = pActuator->getTension();
+        const double shortened = m_prevRestLengths[i] - restLength;
+        if (shortened > 0.0)
+        {
+            m_results.work += m_prevTensions[i] * shortened;
+        }
+        m_results.peakTension = std::max(m_results.peakTension, tension);
+        m_prevRestLengths[i] = restLength;
+        m_prevTensions[i] = tension;
+    }
+
+    if (!m_rigids.empty())
+    {
+        const btVector3 com = centerOfMass();
+        m_results.pathLength += (com - m_results.currentCOM).length();
+        m_results.currentCOM = com;
+
+        const btVector3 moved = com - m_results.startCOM;
+        m_results.displacement = moved.length();
+        m_results.horizontalDisplacement =
+            std::sqrt(moved.x() * moved.x() + moved.z() * moved.z());
+    }
+
+    if (m_pWorld)
+    {
+        const std::size_t contacts = countContacts();
+        m_results.contactPoints += contacts;
+        m_results.peakContactPoints =
+            std::max(m_results.peakContactPoints, contacts);
+    }
+}
+
+btVector3 tgFitnessMetrics::centerOfMass() const
+{
+    btVector3 weighted(0.0, 0.0, 0.0);
+    double totalMass = 0.0;
+    const std::size_t n = m_rigids.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const tgBaseRigid* const pRigid = m_rigids[i];
+        const double mass = pRigid->mass();
+        weighted += pRigid->centerOfMass() * mass;
+        totalMass += mass;
+    }
+    return totalMass > 0.0 ? weighted / totalMass : weighted;
+}
+
+std::size_t tgFitnessMetrics::countContacts() const
+{
+    assert(m_pWorld != NULL);
+    btDispatcher* const pDispatcher =
+        tgBulletUtil::worldToDynamicsWorld(*m_pWorld).getDispatcher();
+
+    std::size_t result = 0;
+    const int numManifolds = pDispatcher->getNumManifolds();
+    for (int i = 0; i < numManifolds; i++)
+    {
+        const btPersistentManifold* const pManifold =
+            pDispatcher->getManifoldByIndexInternal(i);
+        const int numContacts = pManifold->getNumContacts();
+        if (numContacts == 0)
+        {
+            continue;
+        }
+        const bool ours0 = std::binary_search(m_bodies.begin(), m_bodies.end(),
+                                              pManifold->getBody0());
+        const bool ours1 = std::binary_search(m_bodies.begin(), m_bodies.end(),
+                                              pManifold->getBody1());
+        // Contacts within the model are not with the environment
+        if (ours0 != ours1)
+        {
+            result += numContacts;
+        }
+    }
+    return result;
+}
+
+bool tgFitnessMetrics::invariant() const
+{
+    return (m_prevRestLengths.size() == m_actuators.size()) &&
+        (m_prevTensions.size() == m_actuators.size());
+}
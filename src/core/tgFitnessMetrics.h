@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_FITNESS_METRICS_H
+#define TG_FITNESS_METRICS_H
+
+/**
+ * @file tgFitnessMetrics.h
+ * @brief Contains the definition of class tgFitnessMetrics
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class btCollisionObject;
+class tgBaseRigid;
+class tgModel;
+class tgSpringCableActuator;
+class tgWorld;
+
+/**
+ * Fitness measures of a model, accumulated as the simulation runs so
+ * they are ready at teardown without actuator history. A learning
+ * controller calls setup() in its onSetup, step() at the end of each
+ * onStep, and reads getResults() in its onTeardown.
+ *
+ * Each step costs one pass over the model's actuators and rigid bodies
+ * (plus one over the world's contact manifolds when contacts are
+ * counted) and allocates nothing.
+ */
+class tgFitnessMetrics
+{
+public:
+
+    /**
+     * The measures since setup()
+     */
+    struct Results
+    {
+        Results();
+
+        /** Time in seconds since setup */
+        double elapsed;
+
+        /** Calls of step() since setup */
+        std::size_t steps;
+
+        /** Mass weighted center of the rigid bodies at setup */
+        btVector3 startCOM;
+
+        /** Mass weighted center of the rigid bodies now */
+        btVector3 currentCOM;
+
+        /** Straight line distance from startCOM to currentCOM */
+        double displacement;
+
+        /**
+         * Distance from startCOM to currentCOM in the ground (x-z)
+         * plane, ignoring height
+         */
+        double horizontalDisplacement;
+
+        /** Length of the path travelled by the center of mass */
+        double pathLength;
+
+        /**
+         * Mechanical work done by the actuators reeling in cable, the
+         * sum over steps of tension times rest length shortened.
+         * Always non-negative.
+         */
+        double work;
+
+        /** Largest tension seen in any actuator */
+        double peakTension;
+
+        /**
+         * Contact points between the model's bodies and anything else,
+         * summed over steps. Zero unless setup() was given the world.
+         */
+        std::size_t contactPoints;
+
+        /** Most contact points seen in a single step */
+        std::size_t peakContactPoints;
+    };
+
+    tgFitnessMetrics();
+
+    /**
+     * Start measuring model, clearing the results. The model's actuators
+     * and rigid bodies are found once here, so call this again after
+     * the simulation resets, typically from the controller's onSetup.
+     * @param[in] model, the model to measure. Its bodies must have been
+     * built, which is the case when controllers are set up.
+     * @param[in] pWorld, the world the model is in, to count contacts;
+     * NULL (the default) skips counting them
+     */
+    void setup(tgModel& model, const tgWorld* pWorld = NULL);
+
+    /**
+     * Accumulate the measures for a step
+     * @param[in] dt, the time since the previous call, must be positive
+     * @throw std::invalid_argument if dt is not positive
+     */
+    void step(double dt);
+
+    const Results& getResults() const
+    {
+        return m_results;
+    }
+
+private:
+
+    /** The mass weighted center of m_rigids */
+    btVector3 centerOfMass() const;
+
+    /** Contact points of m_bodies this step */
+    std::size_t countContacts() const;
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    Results m_results;
+
+    std::vector<tgSpringCableActuator*> m_actuators;
+
+    /**
+     * Each actuator's rest length and tension at the previous step,
+     * parallel to m_actuators
+     */
+    std::vector<double> m_prevRestLengths;
+    std::vector<double> m_prevTensions;
+
+    /** The rigid bodies with mass, whose center is tracked */
+    std::vector<tgBaseRigid*> m_rigids;
+
+    /** The Bullet bodies of the whole model, sorted for lookup */
+    std::vector<const btCollisionObject*> m_bodies;
+
+    /** Where contacts are counted, NULL if they are not */
+    const tgWorld* m_pWorld;
+};
+
+#endif  // TG_FITNESS_METRICS_H
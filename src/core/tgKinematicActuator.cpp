@@ -27,6 +27,7 @@
 #include "tgKinematicActuator.h"
 // The NTRT Core libary
 #include "core/tgBulletSpringCable.h"
+#include "core/tgCheckpoint.h"
 #include "core/tgModelVisitor.h"
 #include "core/tgWorld.h"
 // The Bullet Physics Library
@@ -104,6 +105,7 @@ tgKinematicActuator::tgKinematicActuator(tgBulletSpringCable* muscle,
     m_motorVel(0.0),
     m_motorAcc(0.0),
     m_appliedTorque(0.0),
+    m_restLengthIntegrated(false),
     m_config(config),
     tgSpringCableActuator(muscle, tags, config)
 {
@@ -123,13 +125,13 @@ void tgKinematicActuator::setup(tgWorld& world)
 {
     // This needs to be called here in case the controller needs to cast
     notifySetup();
-    tgModel::setup(world);
+    tgSpringCableActuator::setup(world);
 }
 
 void tgKinematicActuator::teardown()
 {
     // Do not notify teardown. The controller has already been deleted.
-    tgModel::teardown();
+    tgSpringCableActuator::teardown();
 }
     
 void tgKinematicActuator::step(double dt) 
@@ -141,19 +143,45 @@ void tgKinematicActuator::step(double dt)
     {
         throw std::invalid_argument("dt is not positive.");
     }
+    else if (m_steppedByRegistry)
+    {
+        return;
+    }
     else
     {   
         // Want to update any controls before applying forces
         notifyStep(dt); 
         // Adjust rest length based on muscle dynamics
-        integrateRestLength(dt);
-        m_springCable->step(dt);
+        if (!m_restLengthIntegrated)
+        {
+            integrateRestLength(dt);
+        }
+        stepSpringCable(dt);
         logHistory();  
         tgModel::step(dt);
     }
     
     // Reset and wait for next control input
     m_desiredTorque = 0.0;
+    m_restLengthIntegrated = false;
+}
+
+void tgKinematicActuator::saveState(std::ostream& os)
+{
+    tgCheckpoint::write(os, m_motorVel);
+    tgCheckpoint::write(os, m_motorAcc);
+    tgCheckpoint::write(os, m_desiredTorque);
+    tgCheckpoint::write(os, m_appliedTorque);
+    tgSpringCableActuator::saveState(os);
+}
+
+void tgKinematicActuator::loadState(std::istream& is)
+{
+    tgCheckpoint::read(is, m_motorVel);
+    tgCheckpoint::read(is, m_motorAcc);
+    tgCheckpoint::read(is, m_desiredTorque);
+    tgCheckpoint::read(is, m_appliedTorque);
+    tgSpringCableActuator::loadState(is);
 }
 
 void tgKinematicActuator::onVisit(const tgModelVisitor& r) const
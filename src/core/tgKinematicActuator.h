@@ -40,6 +40,13 @@ class tgWorld;
 class tgKinematicActuator : public tgSpringCableActuator
 {
 public: 
+
+    // Runs integrateRestLength for many actuators at once
+    friend class tgActuatorGroup;
+
+    // Steps actuators through stepStatic
+    friend class tgActuatorRegistry;
+
 	struct Config : public tgSpringCableActuator::Config
 	{
 		Config(double s = 1000.0,
@@ -136,6 +143,12 @@ public:
      * @param[in] r, the visiting tgModelVisitor
      */
     virtual void onVisit(const tgModelVisitor& r) const;
+
+    /** Writes the motor state, then the base class's state */
+    virtual void saveState(std::ostream& os);
+
+    /** Reads back what saveState() wrote */
+    virtual void loadState(std::istream& is);
     
     /**
      * Functions for interfacing with muscle2P, and higher level controllers
@@ -176,6 +189,25 @@ private:
      */
     void constructorAux();
 
+    /**
+     * The work of step(dt) for an actuator whose cable is exactly a
+     * Cable, without the checks and virtual calls. dt must be positive.
+     */
+    template <typename Cable>
+    void stepStatic(double dt)
+    {
+        notifyStep(dt);
+        if (!m_restLengthIntegrated)
+        {
+            tgKinematicActuator::integrateRestLength(dt);
+        }
+        stepSpringCableAs<Cable>(dt);
+        logHistory();
+        tgModel::step(dt);
+        m_desiredTorque = 0.0;
+        m_restLengthIntegrated = false;
+    }
+
     /**
      * Append damping, rest length and tension values to the history member
      * variables.
@@ -207,6 +239,12 @@ private:
     
     double m_appliedTorque;
     
+    /**
+     * True if a tgActuatorGroup already integrated the rest length for
+     * the coming step, cleared by step
+     */
+    bool m_restLengthIntegrated;
+    
     /**
      * Override the base config to get the extra parameters
      */
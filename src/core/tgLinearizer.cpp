@@ -0,0 +1,466 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgLinearizer.cpp
+ * @brief Contains the implementation of class tgLinearizer
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgLinearizer.h"
+// This library
+#include "tgBaseRigid.h"
+#include "tgBulletSpringCableAnchor.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgSpringCable.h"
+#include "tgSpringCableActuator.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /** The cross product matrix: skew(a) * b == a.cross(b) */
+    btMatrix3x3 skew(const btVector3& a)
+    {
+        return btMatrix3x3(0.0, -a.z(), a.y(),
+                           a.z(), 0.0, -a.x(),
+                           -a.y(), a.x(), 0.0);
+    }
+
+    /** a b^T */
+    btMatrix3x3 outer(const btVector3& a, const btVector3& b)
+    {
+        return btMatrix3x3(a.x() * b.x(), a.x() * b.y(), a.x() * b.z(),
+                           a.y() * b.x(), a.y() * b.y(), a.y() * b.z(),
+                           a.z() * b.x(), a.z() * b.y(), a.z() * b.z());
+    }
+
+    /** a + s b */
+    btMatrix3x3 combine(const btMatrix3x3& a, double s, const btMatrix3x3& b)
+    {
+        btMatrix3x3 result;
+        for (int i = 0; i < 3; i++)
+        {
+            result[i] = a[i] + b[i] * s;
+        }
+        return result;
+    }
+
+    /** Velocities decay by (1 - damping) per second in Bullet */
+    double dampingRate(double damping)
+    {
+        return damping > 0.0 ? std::log(std::max(1.0 - damping, 1.0e-12)) : 0.0;
+    }
+}
+
+tgLinearizer::SparseMatrix::SparseMatrix() :
+    rows(0),
+    cols(0),
+    rowStart(1, 0)
+{
+}
+
+double tgLinearizer::SparseMatrix::operator()(std::size_t i, std::size_t j) const
+{
+    if (i >= rows || j >= cols)
+    {
+        throw std::out_of_range("Index outside the matrix");
+    }
+    const std::vector<std::size_t>::const_iterator begin =
+        columns.begin() + rowStart[i];
+    const std::vector<std::size_t>::const_iterator end =
+        columns.begin() + rowStart[i + 1];
+    const std::vector<std::size_t>::const_iterator it =
+        std::lower_bound(begin, end, j);
+    return (it != end && *it == j) ? values[it - columns.begin()] : 0.0;
+}
+
+tgLinearizer::tgLinearizer() :
+    m_skippedCables(0)
+{
+    assert(invariant());
+}
+
+void tgLinearizer::setup(tgModel& model)
+{
+    const std::vector<tgModel*> descendants = model.getDescendants();
+
+    m_actuators = tgCast::filter<tgModel, tgSpringCableActuator>(descendants);
+
+    const std::vector<tgBaseRigid*> rigids =
+        tgCast::filter<tgModel, tgBaseRigid>(descendants);
+    m_bodies.clear();
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        btRigidBody* const pBody = rigids[i]->getPRigidBody();
+        // Rods of a compound share one body; static ones have no state
+        if (pBody != NULL && pBody->getInvMass() > 0.0 &&
+            std::find(m_bodies.begin(), m_bodies.end(), pBody) == m_bodies.end())
+        {
+            m_bodies.push_back(pBody);
+        }
+    }
+
+    m_states.clear();
+    m_A = SparseMatrix();
+    m_B = SparseMatrix();
+    m_skippedCables = 0;
+
+    assert(invariant());
+}
+
+void tgLinearizer::linearize()
+{
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgLinearizer::linearize");
+#endif //BT_NO_PROFILE
+    m_K.clear();
+    m_D.clear();
+    m_U.clear();
+    m_skippedCables = 0;
+
+    const std::size_t n = m_bodies.size();
+    std::map<const btRigidBody*, int> index;
+    m_states.resize(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const btRigidBody* const pBody = m_bodies[i];
+        index[pBody] = static_cast<int>(i);
+        Body& state = m_states[i];
+        state.invMass = pBody->getInvMass();
+        state.invInertia = pBody->getInvInertiaTensorWorld();
+        state.angularVelocity = pBody->getAngularVelocity();
+        state.torque.setZero();
+        state.linearDamping = pBody->getLinearDamping();
+        state.angularDamping = pBody->getAngularDamping();
+    }
+
+    const std::size_t m = m_actuators.size();
+    for (std::size_t i = 0; i < m; i++)
+    {
+        const tgSpringCable* const pCable = m_actuators[i]->getSpringCable();
+        const std::vector<const tgSpringCableAnchor*> anchors =
+            pCable->getAnchors();
+        if (anchors.size() != 2)
+        {
+            m_skippedCables++;
+            continue;
+        }
+
+        End ends[2];
+        btVector3 points[2];
+        btVector3 velocities[2];
+        for (int e = 0; e < 2; e++)
+        {
+            const tgBulletSpringCableAnchor* const pAnchor =
+                tgCast::cast<tgSpringCableAnchor, tgBulletSpringCableAnchor>(anchors[e]);
+            assert(pAnchor != NULL);
+            const btRigidBody* const pBody = pAnchor->attachedBody;
+            const std::map<const btRigidBody*, int>::const_iterator it =
+                index.find(pBody);
+            ends[e].body = (it == index.end()) ? -1 : it->second;
+            ends[e].arm = pAnchor->getRelativePosition();
+            ends[e].angularVelocity = pBody->getAngularVelocity();
+            points[e] = pAnchor->getWorldPosition();
+            velocities[e] = pBody->getVelocityInLocalPoint(ends[e].arm);
+        }
+        addCable(ends[0], ends[1], points[1] - points[0],
+                 velocities[1] - velocities[0], pCable->getCoefK(),
+                 pCable->getCoefD(), pCable->getRestLength(), i);
+    }
+
+    assemble();
+
+    assert(invariant());
+}
+
+std::size_t tgLinearizer::stateIndex(std::size_t body, Quantity quantity,
+                                     std::size_t axis) const
+{
+    const std::size_t n = m_bodies.size();
+    if (body >= n || axis > 2)
+    {
+        throw std::out_of_range("No such body or axis");
+    }
+    switch (quantity)
+    {
+    case ePosition:
+        return 6 * body + axis;
+    case eRotation:
+        return 6 * body + 3 + axis;
+    case eVelocity:
+        return 6 * n + 6 * body + axis;
+    case eAngularVelocity:
+        return 6 * n + 6 * body + 3 + axis;
+    default:
+        throw std::invalid_argument("Unknown quantity");
+    }
+}
+
+void tgLinearizer::addCable(const End& from, const End& to,
+                            const btVector3& d, const btVector3& dDot,
+                            double stiffness, double damping,
+                            double restLength, std::size_t input)
+{
+    const double length = d.length();
+    const double stretch = length - restLength;
+    if (length <= 0.0 || stretch <= 0.0)
+    {
+        // Slack, so no force and no terms
+        return;
+    }
+    const btVector3 e = d / length;
+    const double lengthRate = e.dot(dDot);
+
+    // Tension and its derivatives by length, length rate and rest length
+    const double spring = stiffness * stretch;
+    const double dampingForce = damping * lengthRate;
+    double tension;
+    double dTdL;
+    double dTdRate;
+    double dTdRest;
+    if (std::fabs(spring) < std::fabs(dampingForce))
+    {
+        // Damping is limited to the spring force, and stops depending on
+        // the rate
+        const double factor = dampingForce > 0.0 ? 2.0 : 0.0;
+        tension = spring * factor;
+        dTdL = stiffness * factor;
+        dTdRate = 0.0;
+        dTdRest = -stiffness * factor;
+    }
+    else
+    {
+        tension = spring + dampingForce;
+        dTdL = stiffness;
+        dTdRate = damping;
+        dTdRest = -stiffness;
+    }
+
+    // The force on the from end is F = T e, with d = to - from. Its
+    // derivatives by d, by d' and by the rest length:
+    const btMatrix3x3 transverse = combine(btMatrix3x3::getIdentity(), -1.0,
+                                           outer(e, e));
+    const btVector3 rateGradient = (transverse * dDot) / length;
+    const btMatrix3x3 byD = combine(outer(e, e * dTdL + rateGradient * dTdRate),
+                                    tension / length, transverse);
+    btMatrix3x3 byRate = outer(e, e);
+    for (int k = 0; k < 3; k++)
+    {
+        byRate[k] *= dTdRate;
+    }
+    const btVector3 byRest = e * dTdRest;
+    const btVector3 force = e * tension;
+
+    // An end's point moves by J dq = dp - [arm]x dtheta, and its velocity
+    // by J dq' plus -[w]x[arm]x dtheta as the arm turns. The end's body
+    // gets generalized force J^T f, where J^T = [I; [arm]x].
+    const End* const ends[2] = {&from, &to};
+    const double signs[2] = {-1.0, 1.0};
+    for (int i = 0; i < 2; i++)
+    {
+        const End& endI = *ends[i];
+        if (endI.body < 0)
+        {
+            continue;
+        }
+        const std::size_t bodyI = endI.body;
+        const btMatrix3x3 armI = skew(endI.arm);
+        const btVector3 f = force * -signs[i];
+        m_states[bodyI].torque += endI.arm.cross(f);
+
+        // The arm turning changes the torque of the force
+        addBlock(m_K, bodyI, 3, bodyI, 3, skew(f) * armI);
+
+        const btVector3 fu = byRest * -signs[i];
+        const btVector3 tu = endI.arm.cross(fu);
+        for (int k = 0; k < 3; k++)
+        {
+            m_U[std::make_pair(6 * bodyI + k, input)] += fu[k];
+            m_U[std::make_pair(6 * bodyI + 3 + k, input)] += tu[k];
+        }
+
+        for (int j = 0; j < 2; j++)
+        {
+            const End& endJ = *ends[j];
+            if (endJ.body < 0)
+            {
+                continue;
+            }
+            const std::size_t bodyJ = endJ.body;
+            const double s = -signs[i] * signs[j];
+            const btMatrix3x3 armJ = skew(endJ.arm);
+            btMatrix3x3 stiff = byD;
+            btMatrix3x3 damp = byRate;
+            for (int k = 0; k < 3; k++)
+            {
+                stiff[k] *= s;
+                damp[k] *= s;
+            }
+            const btMatrix3x3 turning =
+                combine(damp * skew(endJ.angularVelocity) * armJ, 1.0,
+                        stiff * armJ);
+            // stiff J_j + damp [0, H_j], then J_i^T on the left
+            btMatrix3x3 rotational = turning;
+            for (int k = 0; k < 3; k++)
+            {
+                rotational[k] *= -1.0;
+            }
+            addBlock(m_K, bodyI, 0, bodyJ, 0, stiff);
+            addBlock(m_K, bodyI, 0, bodyJ, 3, rotational);
+            addBlock(m_K, bodyI, 3, bodyJ, 0, armI * stiff);
+            addBlock(m_K, bodyI, 3, bodyJ, 3, armI * rotational);
+
+            btMatrix3x3 dampRotational = damp * armJ;
+            for (int k = 0; k < 3; k++)
+            {
+                dampRotational[k] *= -1.0;
+            }
+            addBlock(m_D, bodyI, 0, bodyJ, 0, damp);
+            addBlock(m_D, bodyI, 0, bodyJ, 3, dampRotational);
+            addBlock(m_D, bodyI, 3, bodyJ, 0, armI * damp);
+            addBlock(m_D, bodyI, 3, bodyJ, 3, armI * dampRotational);
+        }
+    }
+}
+
+void tgLinearizer::addBlock(Entries& entries, std::size_t rowBody,
+                            std::size_t row, std::size_t colBody,
+                            std::size_t col, const btMatrix3x3& block)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            entries[std::make_pair(6 * rowBody + row + i,
+                                   6 * colBody + col + j)] += block[i][j];
+        }
+    }
+}
+
+void tgLinearizer::assemble()
+{
+    const std::size_t n = m_bodies.size();
+    const std::size_t half = 6 * n;
+    Entries a;
+    Entries b;
+
+    // Each generalized force row becomes accelerations through the
+    // inverse mass or world inverse inertia of its body
+    const Entries* const sources[3] = {&m_K, &m_D, &m_U};
+    Entries* const targets[3] = {&a, &a, &b};
+    const std::size_t offsets[3] = {0, half, 0};
+    for (int s = 0; s < 3; s++)
+    {
+        Entries& target = *targets[s];
+        for (Entries::const_iterator it = sources[s]->begin();
+             it != sources[s]->end(); ++it)
+        {
+            const std::size_t row = it->first.first;
+            const std::size_t col = it->first.second + offsets[s];
+            const Body& state = m_states[row / 6];
+            const std::size_t k = row % 6;
+            if (k < 3)
+            {
+                target[std::make_pair(half + row, col)] +=
+                    state.invMass * it->second;
+            }
+            else
+            {
+                const std::size_t first = half + row - k + 3;
+                for (int r = 0; r < 3; r++)
+                {
+                    target[std::make_pair(first + r, col)] +=
+                        state.invInertia[r][k - 3] * it->second;
+                }
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const Body& state = m_states[i];
+        const std::size_t p = 6 * i;
+        for (std::size_t k = 0; k < 6; k++)
+        {
+            a[std::make_pair(p + k, half + p + k)] += 1.0;
+        }
+
+        // Near the current orientation the rotation vector changes at
+        // w + w x theta / 2
+        addBlock(a, i, 3, i, 3, skew(state.angularVelocity * 0.5));
+
+        // The world inverse inertia turns with the body
+        const btVector3 angularAcceleration = state.invInertia * state.torque;
+        addBlock(a, n + i, 3, i, 3,
+                 combine(state.invInertia * skew(state.torque), -1.0,
+                         skew(angularAcceleration)));
+
+        const double linearRate = dampingRate(state.linearDamping);
+        const double angularRate = dampingRate(state.angularDamping);
+        for (std::size_t k = 0; k < 3; k++)
+        {
+            a[std::make_pair(half + p + k, half + p + k)] += linearRate;
+            a[std::make_pair(half + p + 3 + k, half + p + 3 + k)] += angularRate;
+        }
+    }
+
+    compress(a, 2 * half, 2 * half, m_A);
+    compress(b, 2 * half, m_actuators.size(), m_B);
+}
+
+void tgLinearizer::compress(const Entries& entries, std::size_t rows,
+                            std::size_t cols, SparseMatrix& matrix)
+{
+    matrix.rows = rows;
+    matrix.cols = cols;
+    matrix.rowStart.assign(rows + 1, 0);
+    matrix.columns.clear();
+    matrix.values.clear();
+    // The map is ordered by row, then column
+    for (Entries::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        if (it->second == 0.0)
+        {
+            continue;
+        }
+        matrix.rowStart[it->first.first + 1]++;
+        matrix.columns.push_back(it->first.second);
+        matrix.values.push_back(it->second);
+    }
+    for (std::size_t i = 0; i < rows; i++)
+    {
+        matrix.rowStart[i + 1] += matrix.rowStart[i];
+    }
+}
+
+bool tgLinearizer::invariant() const
+{
+    return (m_A.rowStart.size() == m_A.rows + 1) &&
+        (m_B.rowStart.size() == m_B.rows + 1) &&
+        (m_states.empty() || m_states.size() == m_bodies.size());
+}
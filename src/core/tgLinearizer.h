@@ -0,0 +1,224 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_LINEARIZER_H
+#define TG_LINEARIZER_H
+
+/**
+ * @file tgLinearizer.h
+ * @brief Contains the definition of class tgLinearizer
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btMatrix3x3.h"
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * A linear state-space model x' = A x + B u of a model's dynamics about
+ * its current state, assembled analytically from the spring cables'
+ * stiffness, damping and anchor geometry and the rigid bodies' masses
+ * and inertias. It costs one pass over the cables, instead of a rollout
+ * of the world per perturbed state and input.
+ *
+ * The state has 12 entries per free body (every distinct rigid body with
+ * mass; the rods of a compound share one): x = [q; q'] where q holds, in
+ * the order of getBodies(), each body's center of mass and a small
+ * rotation vector in world coordinates, and q' their linear and angular
+ * velocities. The inputs u are the rest lengths of the actuators, in the
+ * order of getActuators(). Use stateIndex() rather than counting.
+ *
+ * The model is what tgBulletSpringCable computes, in continuous time:
+ * tension k (L - L0) plus damping c L' (limited to the spring force)
+ * along the line between the cable's anchors, zero when slack. Bullet's
+ * per-body linear and angular damping are included; gravity adds
+ * nothing since it is constant. Contacts and the ground are not
+ * modelled, nor are actuator motor dynamics, so B is with respect to
+ * the rest lengths themselves. Cables that have picked up extra contact
+ * anchors are left out and counted by getSkippedCables().
+ */
+class tgLinearizer
+{
+public:
+
+    /**
+     * A sparse matrix in compressed sparse row form
+     */
+    struct SparseMatrix
+    {
+        SparseMatrix();
+
+        /**
+         * Element (i, j); zero if it is not stored
+         */
+        double operator()(std::size_t i, std::size_t j) const;
+
+        std::size_t rows;
+
+        std::size_t cols;
+
+        /** Where each row starts in columns and values; rows + 1 long */
+        std::vector<std::size_t> rowStart;
+
+        std::vector<std::size_t> columns;
+
+        std::vector<double> values;
+    };
+
+    /** What a state entry describes */
+    enum Quantity
+    {
+        ePosition = 0,
+        eRotation,
+        eVelocity,
+        eAngularVelocity
+    };
+
+    tgLinearizer();
+
+    /**
+     * Find the model's free bodies and actuators. Call this again after
+     * the simulation resets, typically from the controller's onSetup.
+     * @param[in] model, the model to linearize. Its bodies must have
+     * been built, which is the case when controllers are set up.
+     */
+    void setup(tgModel& model);
+
+    /**
+     * Assemble A and B at the model's current state
+     */
+    void linearize();
+
+    /** The state matrix from the last call of linearize() */
+    const SparseMatrix& getA() const
+    {
+        return m_A;
+    }
+
+    /** The input matrix from the last call of linearize() */
+    const SparseMatrix& getB() const
+    {
+        return m_B;
+    }
+
+    /**
+     * The index in x of one component of a body's state
+     * @param[in] body, an index into getBodies()
+     * @param[in] quantity, which vector of the body
+     * @param[in] axis, 0, 1 or 2 for x, y or z
+     */
+    std::size_t stateIndex(std::size_t body, Quantity quantity,
+                           std::size_t axis) const;
+
+    const std::vector<btRigidBody*>& getBodies() const
+    {
+        return m_bodies;
+    }
+
+    const std::vector<tgSpringCableActuator*>& getActuators() const
+    {
+        return m_actuators;
+    }
+
+    /** Cables left out of the last linearization */
+    std::size_t getSkippedCables() const
+    {
+        return m_skippedCables;
+    }
+
+private:
+
+    /** A body's state at the operating point */
+    struct Body
+    {
+        double invMass;
+        btMatrix3x3 invInertia;
+        btVector3 angularVelocity;
+        /** Net cable torque, which the world inertia turns with the body */
+        btVector3 torque;
+        double linearDamping;
+        double angularDamping;
+    };
+
+    /** One end of a cable at the operating point */
+    struct End
+    {
+        /** Index into m_bodies, or -1 if the body doesn't move */
+        int body;
+        /** From the center of mass to the anchor */
+        btVector3 arm;
+        btVector3 angularVelocity;
+    };
+
+    /** Sparse entries being summed, by (row, column) */
+    typedef std::map<std::pair<std::size_t, std::size_t>, double> Entries;
+
+    /**
+     * Add one cable's terms to the generalized force Jacobians
+     * @param[in] from, to, the ends, where the cable pulls from toward to
+     * @param[in] input, the cable's index into m_actuators
+     */
+    void addCable(const End& from, const End& to, const btVector3& d,
+                  const btVector3& dDot, double stiffness, double damping,
+                  double restLength, std::size_t input);
+
+    /** Add a 3 by 3 block at (6 * rowBody + row, 6 * colBody + col) */
+    static void addBlock(Entries& entries, std::size_t rowBody,
+                         std::size_t row, std::size_t colBody,
+                         std::size_t col, const btMatrix3x3& block);
+
+    /** Form A and B from the generalized force Jacobians */
+    void assemble();
+
+    static void compress(const Entries& entries, std::size_t rows,
+                         std::size_t cols, SparseMatrix& matrix);
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    std::vector<btRigidBody*> m_bodies;
+
+    std::vector<tgSpringCableActuator*> m_actuators;
+
+    std::vector<Body> m_states;
+
+    /** d generalized force / d q, d q' and d rest length */
+    Entries m_K;
+    Entries m_D;
+    Entries m_U;
+
+    SparseMatrix m_A;
+
+    SparseMatrix m_B;
+
+    std::size_t m_skippedCables;
+};
+
+#endif  // TG_LINEARIZER_H
@@ -26,18 +26,21 @@
 #include "tgModel.h"
 // This application
 #include "tgModelVisitor.h"
+#include "tgSubject.h"
 #include "abstractMarker.h"
 // The C++ Standard Library
 #include <stdexcept>
 
-tgModel::tgModel()
+tgModel::tgModel() :
+  m_steppedByRegistry(false)
 {
   // Postcondition
   assert(invariant());
 }
 
 tgModel::tgModel(const tgTags& tags) :
-        tgTaggable(tags)
+        tgTaggable(tags),
+        m_steppedByRegistry(false)
 {
   assert(invariant());
 }
@@ -96,7 +99,11 @@ void tgModel::step(double dt)
     {
       tgModel* const pChild = m_children[i];
       assert(pChild != NULL);
-      pChild->step(dt);
+      // Skip the virtual call for actuators a registry steps
+      if (!pChild->m_steppedByRegistry)
+      {
+        pChild->step(dt);
+      }
     }
   }
 
@@ -104,6 +111,41 @@ void tgModel::step(double dt)
   assert(invariant());
 }
 
+void tgModel::saveState(std::ostream& os)
+{
+  // Whatever the subject's type, its controllers are saved with it
+  tgBaseSubject* const pSubject = dynamic_cast<tgBaseSubject*>(this);
+  if (pSubject != NULL)
+  {
+    pSubject->notifySaveState(os);
+  }
+
+  const size_t n = m_children.size();
+  for (std::size_t i = 0; i < n; i++)
+  {
+    tgModel* const pChild = m_children[i];
+    assert(pChild != NULL);
+    pChild->saveState(os);
+  }
+}
+
+void tgModel::loadState(std::istream& is)
+{
+  tgBaseSubject* const pSubject = dynamic_cast<tgBaseSubject*>(this);
+  if (pSubject != NULL)
+  {
+    pSubject->notifyLoadState(is);
+  }
+
+  const size_t n = m_children.size();
+  for (std::size_t i = 0; i < n; i++)
+  {
+    tgModel* const pChild = m_children[i];
+    assert(pChild != NULL);
+    pChild->loadState(is);
+  }
+}
+
 void tgModel::onVisit(const tgModelVisitor& r) const
 {
   r.render(*this);
@@ -98,6 +98,24 @@ public:
     */
     virtual void onVisit(const tgModelVisitor& r) const;
 
+    /**
+     * Write the state that is not held by Bullet bodies, for a
+     * checkpoint. Overrides write their own state with
+     * tgCheckpoint::write and then call their parent's saveState.
+     * The default writes the state of the model's observers, if the
+     * model is a tgSubject, then the children's state.
+     * @param[out] os the checkpoint stream
+     */
+    virtual void saveState(std::ostream& os);
+
+    /**
+     * Read back exactly what saveState() wrote. The model must have been
+     * set up the same way as the one that was saved.
+     * @param[in] is the checkpoint stream
+     * @throw std::runtime_error if the checkpoint does not match
+     */
+    virtual void loadState(std::istream& is);
+
     /**
     * Add a sub-model to this model.
     * The model takes ownership of the child sub-model and is responsible for
@@ -163,8 +181,18 @@ public:
      */
     virtual std::vector<tgSenseable*> getSenseableDescendants() const;
 
+protected:
+
+    /**
+     * True while a tgActuatorRegistry steps this model. Its parent's
+     * step() then skips it, and its own step() should do nothing.
+     */
+    bool m_steppedByRegistry;
+
 private:
 
+    friend class tgActuatorRegistry;
+
     /** Integrity predicate. */
     bool invariant() const;
 
@@ -31,6 +31,7 @@ class tgSpringCableActuator;
 class tgModel;
 class tgRod;
 class tgCompressionSpringActuator;
+class tgCordeModel;
 
 /**
  * Interface for ModelVisitor.
@@ -60,6 +61,12 @@ public:
    */
   virtual void render(const tgCompressionSpringActuator& compressionSpringActuator) const {};
  
+  /**
+   * Render a tgCordeModel.
+   * @param[in] rod a const reference to a tgCordeModel to render
+   */
+  virtual void render(const tgCordeModel& rod) const {};
+
   /**
    * Render a tgModel.
    * @param[in] model a const reference to a tgModel to render.
@@ -27,6 +27,10 @@
  * $Id$
  */
 
+// The C++ Standard Library
+#include <istream>
+#include <ostream>
+
 /**
  * A mixin class which makes its derived class the Subject in the Obsever
  * design pattern. These are typically controllers.
@@ -65,6 +69,24 @@ public:
      * @param[in,out] subject the subject being observed
      */    
     virtual void onTeardown(Subject& subject) { }
+
+    /**
+     * Write any state needed to resume exactly, such as integrators or
+     * random number generator state, when a checkpoint is saved. Use
+     * tgCheckpoint::write. Observers with no such state need not
+     * override this.
+     * @param[in,out] subject the subject being observed
+     * @param[out] os the checkpoint stream
+     */
+    virtual void onSaveState(Subject& subject, std::ostream& os) { }
+
+    /**
+     * Read back exactly what onSaveState() wrote, when a checkpoint is
+     * loaded. Called after onSetup().
+     * @param[in,out] subject the subject being observed
+     * @param[in] is the checkpoint stream
+     */
+    virtual void onLoadState(Subject& subject, std::istream& is) { }
     
 };
    
@@ -0,0 +1,143 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgPartitionStepper.cpp
+ * @brief Contains the definitions of members of class tgPartitionStepper
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgPartitionStepper.h"
+// This application
+#include "tgWorld.h"
+// Boost
+#include "boost/bind.hpp"
+// The C++ Standard Library
+#include <cassert>
+#include <exception>
+#include <stdexcept>
+
+tgPartitionStepper::tgPartitionStepper(std::size_t threads) :
+    m_pWorlds(NULL),
+    m_dt(0.0),
+    m_next(0),
+    m_done(0),
+    m_generation(0),
+    m_stop(false)
+{
+    if (threads == 0)
+    {
+        throw std::invalid_argument("Number of threads is not positive");
+    }
+#ifndef BT_NO_PROFILE
+    throw std::runtime_error("Stepping worlds on threads needs Bullet and "
+                             "NTRT built with BT_NO_PROFILE");
+#endif //BT_NO_PROFILE
+    for (std::size_t i = 0; i < threads; i++)
+    {
+        m_threads.create_thread(boost::bind(&tgPartitionStepper::run, this));
+    }
+}
+
+tgPartitionStepper::~tgPartitionStepper()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_threads.join_all();
+}
+
+void tgPartitionStepper::step(const std::vector<const tgWorld*>& worlds,
+                                double dt)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    assert(m_pWorlds == NULL);
+    m_pWorlds = &worlds;
+    m_dt = dt;
+    m_next = 0;
+    m_done = 0;
+    m_error.clear();
+    ++m_generation;
+    m_condition.notify_all();
+
+    work(lock);
+    while (m_done < worlds.size())
+    {
+        m_condition.wait(lock);
+    }
+    m_pWorlds = NULL;
+
+    if (!m_error.empty())
+    {
+        throw std::runtime_error("Stepping a partition failed: " + m_error);
+    }
+}
+
+void tgPartitionStepper::run()
+{
+    unsigned long generation = 0;
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (true)
+    {
+        while (m_generation == generation && !m_stop)
+        {
+            m_condition.wait(lock);
+        }
+        if (m_stop)
+        {
+            break;
+        }
+        generation = m_generation;
+        work(lock);
+    }
+}
+
+void tgPartitionStepper::work(boost::mutex::scoped_lock& lock)
+{
+    // A thread that wakes after the call has returned finds no worlds
+    while (m_pWorlds != NULL && m_next < m_pWorlds->size())
+    {
+        const tgWorld* const pWorld = (*m_pWorlds)[m_next++];
+        const double dt = m_dt;
+
+        lock.unlock();
+        std::string error;
+        try
+        {
+            pWorld->step(dt);
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+        lock.lock();
+
+        if (!error.empty() && m_error.empty())
+        {
+            m_error = error;
+        }
+        if (++m_done == m_pWorlds->size())
+        {
+            m_condition.notify_all();
+        }
+    }
+}
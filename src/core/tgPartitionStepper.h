@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PARTITION_STEPPER_H
+#define TG_PARTITION_STEPPER_H
+
+/**
+ * @file tgPartitionStepper.h
+ * @brief Contains the definition of class tgPartitionStepper
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// Boost
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgWorld;
+
+/**
+ * Steps independent worlds at the same time on a pool of boost
+ * threads, for tgSimulation's partitions. The calling thread steps
+ * worlds too, and step() returns once every world has been stepped.
+ *
+ * Bullet 2.82 keeps a single, unsynchronized profile tree, which every
+ * stepSimulation resets and updates, so per-world profiling can only be
+ * disabled by building Bullet and NTRT with BT_NO_PROFILE. The
+ * constructor refuses to start threads in builds without it.
+ */
+class tgPartitionStepper
+{
+public:
+
+    /**
+     * Start the threads
+     * @param[in] threads, the number of threads besides the caller's,
+     * must be positive
+     * @throw std::invalid_argument if threads is not positive
+     * @throw std::runtime_error if this build profiles Bullet
+     */
+    explicit tgPartitionStepper(std::size_t threads);
+
+    /** Stops the threads */
+    ~tgPartitionStepper();
+
+    /**
+     * Step every world by dt and wait for all of them. No two entries
+     * may share a world, and no other thread may use them meanwhile.
+     * @param[in] worlds, the worlds to step, in any order
+     * @param[in] dt, must be positive
+     * @throw std::runtime_error if stepping any world threw
+     */
+    void step(const std::vector<const tgWorld*>& worlds, double dt);
+
+private:
+
+    /** The loop of each thread */
+    void run();
+
+    /**
+     * Step worlds of the current call until none are left. Called
+     * with m_mutex held by lock, which is released while stepping.
+     */
+    void work(boost::mutex::scoped_lock& lock);
+
+    boost::mutex m_mutex;
+
+    /** Signals a new call, its completion or shutdown */
+    boost::condition_variable m_condition;
+
+    /** The worlds of the current call, NULL between calls */
+    const std::vector<const tgWorld*>* m_pWorlds;
+
+    double m_dt;
+
+    /** Index of the next world to hand out */
+    std::size_t m_next;
+
+    /** Number of worlds stepped in the current call */
+    std::size_t m_done;
+
+    /** Counts calls, so a thread takes part in each only once */
+    unsigned long m_generation;
+
+    /** What the first world to fail threw, empty if none did */
+    std::string m_error;
+
+    bool m_stop;
+
+    boost::thread_group m_threads;
+
+    /** Not copyable */
+    tgPartitionStepper(const tgPartitionStepper&);
+    tgPartitionStepper& operator=(const tgPartitionStepper&);
+};
+
+#endif  // TG_PARTITION_STEPPER_H
@@ -144,7 +144,8 @@ void tgSimView::run(int steps)
         // This would normally run forever, but this is just for testing
         m_renderTime = 0;
         double totalTime = 0.0;
-        for (int i = 0; i < steps; i++) {
+        // Stop early if a watchdog has ended the trial
+        for (int i = 0; i < steps && !m_pSimulation->isTrialOver(); i++) {
             m_pSimulation->step(m_stepSize);    
             m_renderTime += m_stepSize;
             totalTime += m_stepSize;
@@ -30,8 +30,14 @@
 #include "tgSimulation.h"
 // Bullet OpenGL_FreeGlut (patched files)
 #include "tgGLDebugDrawer.h"
+// Bullet OpenGL_FreeGlut
+#include "GL_ShapeDrawer.h"
 // The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
+#include "LinearMath/btDefaultMotionState.h"
 
 tgSimViewGraphics::tgSimViewGraphics(tgWorld& world,
                      double stepSize,
@@ -148,6 +154,7 @@ void tgSimViewGraphics::clientMoveAndDisplay()
             // Doesn't appear to do anything yet...
             m_dynamicsWorld->debugDrawWorld();
             renderme();     
+            renderPartitions();
             // Camera is updated in renderme
             glFlush();
             swapBuffers();      
@@ -162,6 +169,7 @@ void tgSimViewGraphics::displayCallback()
     {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
         renderme();
+        renderPartitions();
         // optional but useful: debug drawing to detect problems
         if (m_dynamicsWorld)
         {
@@ -172,6 +180,64 @@ void tgSimViewGraphics::displayCallback()
     }
 }
 
+void tgSimViewGraphics::renderPartitions()
+{
+    if (m_pSimulation == NULL || m_shapeDrawer == NULL ||
+        (getDebugMode() & btIDebugDraw::DBG_DrawWireframe))
+    {
+        return;
+    }
+    // Partition 0 is the view's world, already drawn by renderme
+    for (std::size_t i = 1; i < m_pSimulation->getPartitionCount(); i++)
+    {
+        renderWorld(tgBulletUtil::worldToDynamicsWorld(
+                                    m_pSimulation->getPartitionWorld(i)));
+    }
+}
+
+void tgSimViewGraphics::renderWorld(btDynamicsWorld& world)
+{
+    // As DemoApplication::renderscene draws its own world, without shadows
+    btVector3 aabbMin;
+    btVector3 aabbMax;
+    world.getBroadphase()->getBroadphaseAabb(aabbMin, aabbMax);
+    aabbMin -= btVector3(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+    aabbMax += btVector3(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+    
+    const btCollisionObjectArray& objects = world.getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); i++)
+    {
+        const btCollisionObject* const pObject = objects[i];
+        const btRigidBody* const pBody = btRigidBody::upcast(pObject);
+        btScalar m[16];
+        if (pBody && pBody->getMotionState())
+        {
+            const btDefaultMotionState* const pMotionState =
+                static_cast<const btDefaultMotionState*>(pBody->getMotionState());
+            pMotionState->m_graphicsWorldTrans.getOpenGLMatrix(m);
+        }
+        else
+        {
+            pObject->getWorldTransform().getOpenGLMatrix(m);
+        }
+        
+        btVector3 color = (i & 1) ? btVector3(0.0, 0.0, 1.0) :
+                                    btVector3(1.0, 1.0, 0.5);
+        if (pObject->getActivationState() == ACTIVE_TAG)
+        {
+            color += (i & 1) ? btVector3(1.0, 0.0, 0.0) :
+                               btVector3(0.5, 0.0, 0.0);
+        }
+        else if (pObject->getActivationState() == ISLAND_SLEEPING)
+        {
+            color += (i & 1) ? btVector3(0.0, 1.0, 0.0) :
+                               btVector3(0.0, 0.5, 0.0);
+        }
+        m_shapeDrawer->drawOpenGL(m, pObject->getCollisionShape(), color,
+                                  getDebugMode(), aabbMin, aabbMax);
+    }
+}
+
 void tgSimViewGraphics::clientResetScene()
 {
     reset();
@@ -45,6 +45,7 @@
 #include <iostream>
 
 // Forward declarations
+class btDynamicsWorld;
 class tgGLDebugDrawer;
 
 
@@ -142,6 +143,15 @@ public:
     virtual void clientResetScene();
 
 private:    
+    /**
+     * Draw the bodies of the simulation's other partitions, which
+     * renderme does not see since it only draws the view's world
+     */
+    void renderPartitions();
+    
+    /** Draw the bodies of world with m_shapeDrawer */
+    void renderWorld(btDynamicsWorld& world);
+
     tgGLDebugDrawer*    gDebugDrawer;   
 };
 
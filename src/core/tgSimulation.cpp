@@ -26,19 +26,167 @@
 // This module
 #include "tgSimulation.h"
 // This application
+#include "tgCheckpoint.h"
+#include "tgCheckpointWriter.h"
 #include "tgModel.h"
+#include "tgPartitionStepper.h"
 #include "tgSimView.h"
 #include "tgSimViewGraphics.h"
+#include "tgSubject.h"
+#include "tgTrialFailure.h"
+#include "tgTrialWatchdog.h"
 #include "tgWorld.h"
+#include "tgBulletUtil.h"
 #include "sensors/tgDataManager.h" //for loggers etc.
 // The Bullet Physics Library
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletCollision/CollisionShapes/btCollisionShape.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "LinearMath/btAabbUtil2.h"
 #include "LinearMath/btQuickprof.h"
 
 // The C++ Standard Library
+#include <fstream>
+#include <sstream>
 #include <stdexcept>
 
+tgSimulation::Config::Config(int substeps, double mPeriod, double dmPeriod,
+                             double ckPeriod, const std::string& ckFile,
+                             bool staticAct, int partThreads) :
+  physicsSubsteps(substeps),
+  modelPeriod(mPeriod),
+  dataManagerPeriod(dmPeriod),
+  checkpointPeriod(ckPeriod),
+  checkpointFile(ckFile),
+  staticActuators(staticAct),
+  partitionThreads(partThreads)
+{
+    if (substeps < 1)
+    {
+        throw std::invalid_argument("physicsSubsteps is not positive");
+    }
+    else if (mPeriod < 0.0 || dmPeriod < 0.0 || ckPeriod < 0.0)
+    {
+        throw std::invalid_argument("Period is negative");
+    }
+    else if (ckPeriod > 0.0 && ckFile.empty())
+    {
+        throw std::invalid_argument("Checkpoint period without a file");
+    }
+    else if (partThreads < 0)
+    {
+        throw std::invalid_argument("partitionThreads is negative");
+    }
+#ifndef BT_NO_PROFILE
+    // Bullet's profiler is global and not thread safe
+    else if (partThreads > 0)
+    {
+        throw std::invalid_argument("partitionThreads needs a build with "
+                                    "BT_NO_PROFILE");
+    }
+#endif //BT_NO_PROFILE
+}
+
+namespace
+{
+    /**
+     * Add dt to elapsed and return true if the group is due, in which
+     * case elapsed holds the time to step it by. Due once less than half
+     * a step remains, to absorb round off.
+     */
+    bool isDue(double period, double dt, double& elapsed)
+    {
+        elapsed += dt;
+        return elapsed > period - 0.5 * dt;
+    }
+    
+    /**
+     * Set the minimum control period of model and of every descendant
+     * that is a tgSubject. Does nothing if period is zero.
+     */
+    void limitControlRate(tgModel& model, double period)
+    {
+        if (period <= 0.0)
+        {
+            return;
+        }
+        std::vector<tgModel*> models = model.getDescendants();
+        models.push_back(&model);
+        for (std::size_t i = 0; i < models.size(); i++)
+        {
+            tgBaseSubject* const pSubject =
+                dynamic_cast<tgBaseSubject*>(models[i]);
+            if (pSubject)
+            {
+                pSubject->setMinimumPeriod(period);
+            }
+        }
+    }
+    
+    /**
+     * Bounding box of the non-static bodies in world. Returns false if
+     * there are none.
+     */
+    bool movingBounds(const tgWorld& world, btVector3& aabbMin,
+                        btVector3& aabbMax)
+    {
+        const btCollisionObjectArray& objects =
+            tgBulletUtil::worldToDynamicsWorld(world).getCollisionObjectArray();
+        bool found = false;
+        for (int i = 0; i < objects.size(); i++)
+        {
+            const btCollisionObject* const pObject = objects[i];
+            if (pObject->isStaticOrKinematicObject())
+            {
+                continue;
+            }
+            btVector3 objMin;
+            btVector3 objMax;
+            pObject->getCollisionShape()->getAabb(pObject->getWorldTransform(),
+                                                    objMin, objMax);
+            if (found)
+            {
+                aabbMin.setMin(objMin);
+                aabbMax.setMax(objMax);
+            }
+            else
+            {
+                aabbMin = objMin;
+                aabbMax = objMax;
+                found = true;
+            }
+        }
+        return found;
+    }
+}
+
 tgSimulation::tgSimulation(tgSimView& view) :
-  m_view(view)
+  m_view(view),
+  m_config(),
+  m_dataManagerElapsed(0.0),
+  m_checkpointElapsed(0.0),
+  m_pCheckpointWriter(NULL),
+  m_pWatchdog(NULL),
+  m_pPartitionStepper(NULL)
+{
+        m_view.bindToSimulation(*this);
+
+    m_view.setup();
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgSimulation::tgSimulation(tgSimView& view, const Config& config) :
+  m_view(view),
+  m_config(config),
+  m_dataManagerElapsed(0.0),
+  m_checkpointElapsed(0.0),
+  m_pCheckpointWriter(config.checkpointPeriod > 0.0 ?
+                      new tgCheckpointWriter(config.checkpointFile) : NULL),
+  m_pWatchdog(NULL),
+  m_pPartitionStepper(config.partitionThreads > 0 ?
+                      new tgPartitionStepper(config.partitionThreads) : NULL)
 {
         m_view.bindToSimulation(*this);
 
@@ -50,16 +198,29 @@ tgSimulation::tgSimulation(tgSimView& view) :
 
 tgSimulation::~tgSimulation()
 {
+    // Finish writing the last checkpoint before anything is torn down
+    delete m_pCheckpointWriter;
+    delete m_pPartitionStepper;
     teardown();
     m_view.releaseFromSimulation();
     for (std::size_t i = 0; i < m_models.size(); i++)
     {
         delete m_models[i];
     }
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        Partition& partition = m_partitions[i];
+        for (std::size_t j = 0; j < partition.models.size(); j++)
+        {
+            delete partition.models[j];
+        }
+        delete partition.pWorld;
+    }
     // Delete the tgDataManagers here too.
     for (std::size_t i=0; i < m_dataManagers.size(); i++) {
       delete m_dataManagers[i];
     }
+    delete m_pWatchdog;
 }
 
 void tgSimulation::addModel(tgModel* pModel)
@@ -73,7 +234,12 @@ void tgSimulation::addModel(tgModel* pModel)
     {
 
         pModel->setup(m_view.world());
+        limitControlRate(*pModel, m_config.modelPeriod);
         m_models.push_back(pModel);
+        if (m_config.staticActuators)
+        {
+            m_actuators.add(*pModel);
+        }
     }
 
     // Postcondition
@@ -92,6 +258,7 @@ void tgSimulation::addObstacle(tgModel* pObstacle)
     {
 
         pObstacle->setup(m_view.world());
+        limitControlRate(*pObstacle, m_config.modelPeriod);
         m_obstacles.push_back(pObstacle);
     }
 
@@ -100,6 +267,119 @@ void tgSimulation::addObstacle(tgModel* pObstacle)
     assert(!m_obstacles.empty());
 }
 
+std::size_t tgSimulation::addPartition(tgWorld* pWorld)
+{
+    if (pWorld == NULL)
+    {
+        throw std::invalid_argument("NULL pointer to tgWorld");
+    }
+    
+    Partition partition;
+    partition.pWorld = pWorld;
+    m_partitions.push_back(partition);
+    
+    // Postcondition
+    assert(invariant());
+    return m_partitions.size();
+}
+
+void tgSimulation::addModel(tgModel* pModel, std::size_t partition)
+{
+    if (partition == 0)
+    {
+        addModel(pModel);
+    }
+    else if (pModel == NULL)
+    {
+        throw std::invalid_argument("NULL pointer to tgModel");
+    }
+    else if (partition > m_partitions.size())
+    {
+        throw std::invalid_argument("No such partition");
+    }
+    else
+    {
+        Partition& target = m_partitions[partition - 1];
+        pModel->setup(*target.pWorld);
+        limitControlRate(*pModel, m_config.modelPeriod);
+        target.models.push_back(pModel);
+        if (m_config.staticActuators)
+        {
+            m_actuators.add(*pModel);
+        }
+    }
+    
+    // Postcondition
+    assert(invariant());
+}
+
+void tgSimulation::addObstacle(tgModel* pObstacle, std::size_t partition)
+{
+    if (partition == 0)
+    {
+        addObstacle(pObstacle);
+    }
+    else if (pObstacle == NULL)
+    {
+        throw std::invalid_argument("NULL pointer to tgModel");
+    }
+    else if (partition > m_partitions.size())
+    {
+        throw std::invalid_argument("No such partition");
+    }
+    else
+    {
+        Partition& target = m_partitions[partition - 1];
+        pObstacle->setup(*target.pWorld);
+        limitControlRate(*pObstacle, m_config.modelPeriod);
+        target.obstacles.push_back(pObstacle);
+    }
+    
+    // Postcondition
+    assert(invariant());
+}
+
+tgWorld& tgSimulation::getPartitionWorld(std::size_t partition) const
+{
+    if (partition == 0)
+    {
+        return m_view.world();
+    }
+    else if (partition > m_partitions.size())
+    {
+        throw std::out_of_range("No such partition");
+    }
+    return *m_partitions[partition - 1].pWorld;
+}
+
+bool tgSimulation::partitionsOverlap(double margin) const
+{
+    const std::size_t n = getPartitionCount();
+    std::vector<btVector3> mins(n);
+    std::vector<btVector3> maxes(n);
+    std::vector<bool> moving(n);
+    const btVector3 expand(margin, margin, margin);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        moving[i] = movingBounds(getPartitionWorld(i), mins[i], maxes[i]);
+        mins[i] -= expand;
+        maxes[i] += expand;
+    }
+    
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = i + 1; j < n; j++)
+        {
+            if (moving[i] && moving[j] &&
+                TestAabbAgainstAabb2(mins[i], maxes[i], mins[j], maxes[j]))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 // Similar to models and obstacles, add a data manager.
 void tgSimulation::addDataManager(tgDataManager* pDataManager)
 {
@@ -118,6 +398,20 @@ void tgSimulation::addDataManager(tgDataManager* pDataManager)
   assert(!m_dataManagers.empty());
 }
 
+void tgSimulation::setWatchdog(tgTrialWatchdog* pWatchdog)
+{
+    if (pWatchdog != m_pWatchdog)
+    {
+        delete m_pWatchdog;
+        m_pWatchdog = pWatchdog;
+    }
+}
+
+bool tgSimulation::isTrialOver() const
+{
+    return (m_pWatchdog != NULL) && m_pWatchdog->isTripped();
+}
+
 void tgSimulation::onVisit(const tgModelVisitor& r) const
 {
 #ifndef BT_NO_PROFILE 
@@ -131,45 +425,93 @@ void tgSimulation::onVisit(const tgModelVisitor& r) const
         for (std::size_t i = 0; i < m_obstacles.size(); i++) {
             m_obstacles[i]->onVisit(r);
         }
+        for (std::size_t i = 0; i < m_partitions.size(); i++) {
+            const Partition& partition = m_partitions[i];
+            for (std::size_t j = 0; j < partition.models.size(); j++) {
+                partition.models[j]->onVisit(r);
+            }
+            for (std::size_t j = 0; j < partition.obstacles.size(); j++) {
+                partition.obstacles[j]->onVisit(r);
+            }
+        }
 }
 
 void tgSimulation::reset()
 {
 
     teardown();
-
-    m_view.setup();
-    for (std::size_t i = 0; i != m_models.size(); i++)
+    if (m_pWatchdog)
     {
-        
-        m_models[i]->setup(m_view.world());
-    }
-    // Also, need to set up the data managers again.
-    // Note that this MUST occur after calling setup on the models,
-    // otherwise the data manager will not create any sensors
-    // (since there are no tgRods, etc., inside the tgModel yet!)
-    for (std::size_t i = 0; i < m_dataManagers.size(); i++) {
-      // As in addDataManager: do the data managers need knowledge of the world?
-      m_dataManagers[i]->setup();
+        m_pWatchdog->reset();
     }
+
+    setupAfterReset();
     
     // Don't need to set up obstacles since they will be added after this
 }
 
 void tgSimulation::reset(tgGround* newGround)
 {
+    if (!m_partitions.empty())
+    {
+        throw std::invalid_argument("Partitions need a ground each, "
+                                    "reset with one ground per partition");
+    }
 
     teardown();
+    if (m_pWatchdog)
+    {
+        m_pWatchdog->reset();
+    }
     
     // This will reset the world twice (once in teardown, once here), but that shouldn't hurt anything
     m_view.world().reset(newGround);
     
+    setupAfterReset();
+    
+    // Don't need to set up obstacles since they were just added
+}
+
+void tgSimulation::reset(const std::vector<tgGround*>& newGrounds)
+{
+    if (newGrounds.size() != getPartitionCount())
+    {
+        throw std::invalid_argument("Need one ground per partition");
+    }
+
+    teardown();
+    if (m_pWatchdog)
+    {
+        m_pWatchdog->reset();
+    }
+    
+    for (std::size_t i = 0; i < newGrounds.size(); i++)
+    {
+        getPartitionWorld(i).reset(newGrounds[i]);
+    }
+    
+    setupAfterReset();
+}
+
+void tgSimulation::setupAfterReset()
+{
     m_view.setup();
     for (std::size_t i = 0; i != m_models.size(); i++)
     {
         
         m_models[i]->setup(m_view.world());
+        limitControlRate(*m_models[i], m_config.modelPeriod);
     }
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        Partition& partition = m_partitions[i];
+        for (std::size_t j = 0; j < partition.models.size(); j++)
+        {
+            partition.models[j]->setup(*partition.pWorld);
+            limitControlRate(*partition.models[j], m_config.modelPeriod);
+        }
+    }
+    registerActuators();
     // Also, need to set up the data managers again.
     // Note that this MUST occur after calling setup on the models,
     // otherwise the data manager will not create any sensors
@@ -178,8 +520,98 @@ void tgSimulation::reset(tgGround* newGround)
       // As in addDataManager: do the data managers need knowledge of the world?
       m_dataManagers[i]->setup();
     }
+}
+
+void tgSimulation::writeCheckpoint(std::ostream& os) const
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgSimulation::writeCheckpoint");
+#endif //BT_NO_PROFILE
+    tgCheckpoint::writeHeader(os);
+    tgCheckpoint::write(os, m_dataManagerElapsed);
     
-    // Don't need to set up obstacles since they were just added
+    const std::size_t partitionCount = getPartitionCount();
+    tgCheckpoint::write(os, partitionCount);
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_models[i]->saveState(os);
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_obstacles[i]->saveState(os);
+    }
+    tgCheckpoint::writeWorld(m_view.world(), os);
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        const Partition& partition = m_partitions[i];
+        for (std::size_t j = 0; j < partition.models.size(); j++)
+        {
+            partition.models[j]->saveState(os);
+        }
+        for (std::size_t j = 0; j < partition.obstacles.size(); j++)
+        {
+            partition.obstacles[j]->saveState(os);
+        }
+        tgCheckpoint::writeWorld(*partition.pWorld, os);
+    }
+}
+
+void tgSimulation::saveCheckpoint(const std::string& filename) const
+{
+    std::ofstream file(filename.c_str(),
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+    writeCheckpoint(file);
+    if (!file)
+    {
+        throw std::runtime_error("Could not write checkpoint " + filename);
+    }
+}
+
+void tgSimulation::loadCheckpoint(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Could not open checkpoint " + filename);
+    }
+    tgCheckpoint::readHeader(file);
+    tgCheckpoint::read(file, m_dataManagerElapsed);
+    
+    std::size_t partitionCount = 0;
+    tgCheckpoint::read(file, partitionCount);
+    if (partitionCount != getPartitionCount())
+    {
+        throw std::runtime_error("Checkpoint has a different number of "
+                                 "partitions");
+    }
+    // Models first, so the worlds refresh the cables' cached state
+    // against the restored bodies
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_models[i]->loadState(file);
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_obstacles[i]->loadState(file);
+    }
+    tgCheckpoint::readWorld(m_view.world(), file);
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        const Partition& partition = m_partitions[i];
+        for (std::size_t j = 0; j < partition.models.size(); j++)
+        {
+            partition.models[j]->loadState(file);
+        }
+        for (std::size_t j = 0; j < partition.obstacles.size(); j++)
+        {
+            partition.obstacles[j]->loadState(file);
+        }
+        tgCheckpoint::readWorld(*partition.pWorld, file);
+    }
+    m_checkpointElapsed = 0.0;
+
+    // Postcondition
+    assert(invariant());
 }
 
 /**
@@ -191,6 +623,26 @@ tgWorld& tgSimulation::getWorld() const
 }
 
 void tgSimulation::step(double dt) const
+{
+    if (m_pWatchdog == NULL)
+    {
+        stepAll(dt);
+    }
+    else if (!m_pWatchdog->isTripped())
+    {
+        // A failed trial ends here, for the learning layer to score
+        try
+        {
+            stepAll(dt);
+        }
+        catch (const tgTrialFailure& e)
+        {
+            m_pWatchdog->trip(tgTrialWatchdog::eException, 0.0, e.what());
+        }
+    }
+}
+
+void tgSimulation::stepAll(double dt) const
 {
 // Trying to profile here creates trouble for tgLinearString -  this is outside of the profile loop	
 	
@@ -200,32 +652,126 @@ void tgSimulation::step(double dt) const
     }
     else
     {
-        // Step the world.
-        // This can be done before or after stepping the models.
-        m_view.world().step(dt);
+        // The models, and so the cables, step with the world; only
+        // the controllers may run slower, see Config::modelPeriod
+        const double physicsDt = dt / m_config.physicsSubsteps;
+        for (int i = 0; i < m_config.physicsSubsteps; i++)
+        {
+            // Step the world.
+            // This can be done before or after stepping the models.
+            stepWorlds(physicsDt);
+
+            // Don't step models into a state the watchdog has rejected
+            if (m_pWatchdog && m_pWatchdog->step(*this, physicsDt))
+            {
+                return;
+            }
+
+            stepModels(physicsDt);
+        }
 
-        // Step the models
-        for (std::size_t i = 0; i < m_models.size(); i++)
+	// Step the data managers
+	if (isDue(m_config.dataManagerPeriod, dt, m_dataManagerElapsed))
+	{
+	  const double dataManagerDt = m_dataManagerElapsed;
+	  m_dataManagerElapsed = 0.0;
+	  for (std::size_t i = 0; i < m_dataManagers.size(); i++) {
+	    m_dataManagers[i]->step(dataManagerDt);
+	  }
+	}
+	
+        // Serialize in memory, the writer's thread does the I/O
+        if (m_pCheckpointWriter &&
+            isDue(m_config.checkpointPeriod, dt, m_checkpointElapsed))
         {
-            m_models[i]->step(dt);
+            m_checkpointElapsed = 0.0;
+            std::ostringstream os(std::ios::out | std::ios::binary);
+            writeCheckpoint(os);
+            m_pCheckpointWriter->submit(os.str());
         }
-        
-        // Step the obstacles
-        /// @todo determine if this is necessary
-        for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    }
+}
+  
+void tgSimulation::stepWorlds(double dt) const
+{
+    const std::size_t n = getPartitionCount();
+    
+    if (m_pPartitionStepper && n > 1)
+    {
+        std::vector<const tgWorld*> worlds(n);
+        for (std::size_t p = 0; p < n; p++)
         {
-            m_obstacles[i]->step(dt);
+            worlds[p] = &getPartitionWorld(p);
         }
+        m_pPartitionStepper->step(worlds, dt);
+        return;
+    }
+    
+    for (std::size_t p = 0; p < n; p++)
+    {
+        getPartitionWorld(p).step(dt);
+    }
+}
 
-	// Step the data managers
-	for (std::size_t i = 0; i < m_dataManagers.size(); i++) {
-	  m_dataManagers[i]->step(dt);
-	}
+void tgSimulation::stepModels(double dt) const
+{
+    // Step the models
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_models[i]->step(dt);
+    }
+    
+    // Step the obstacles
+    /// @todo determine if this is necessary
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_obstacles[i]->step(dt);
+    }
+    
+    // Controllers need not be thread safe, so partitions' models
+    // are stepped in turn
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        const Partition& partition = m_partitions[i];
+        for (std::size_t j = 0; j < partition.models.size(); j++)
+        {
+            partition.models[j]->step(dt);
+        }
+        for (std::size_t j = 0; j < partition.obstacles.size(); j++)
+        {
+            partition.obstacles[j]->step(dt);
+        }
+    }
+    
+    // Empty unless Config::staticActuators is set
+    m_actuators.step(dt);
+}
+  
+void tgSimulation::registerActuators()
+{
+    if (!m_config.staticActuators)
+    {
+        return;
+    }
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_actuators.add(*m_models[i]);
+    }
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        const Partition& partition = m_partitions[i];
+        for (std::size_t j = 0; j < partition.models.size(); j++)
+        {
+            m_actuators.add(*partition.models[j]);
+        }
     }
 }
   
 void tgSimulation::teardown()
 {
+    // The actuators are about to be deleted
+    m_actuators.clear();
+    
     const size_t n = m_models.size();
     for (std::size_t i = 0; i < n; i++)
     {
@@ -257,9 +803,30 @@ void tgSimulation::teardown()
       pDataManager->teardown();
     }
     
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        Partition& partition = m_partitions[i];
+        for (std::size_t j = 0; j < partition.models.size(); j++)
+        {
+            partition.models[j]->teardown();
+        }
+        while (!partition.obstacles.empty())
+        {
+            tgModel * const pModel = partition.obstacles.back();
+            pModel->teardown();
+            delete pModel;
+            partition.obstacles.pop_back();
+        }
+        partition.pWorld->reset();
+    }
+    
     // Reset the world after the models - models need world info for
     // their onTeardown() functions
     m_view.world().reset();
+    
+    // Start the next trial with every group due on schedule
+    m_dataManagerElapsed = 0.0;
+    m_checkpointElapsed = 0.0;
     // Postcondition
     assert(invariant());
 }
@@ -26,14 +26,21 @@
  * $Id$
  */
 
+// This library
+#include "tgActuatorRegistry.h"
+
 // The C++ Standard Library
 #include <iostream>
+#include <string>
 #include <vector>
 
 // Forward declarations
+class tgCheckpointWriter;
+class tgPartitionStepper;
 class tgModel;
 class tgModelVisitor;
 class tgSimView;
+class tgTrialWatchdog;
 class tgWorld;
 class tgGround;
 class tgDataManager;
@@ -47,15 +54,87 @@ class tgSimulation
 public:
 
     /**
-     * The only constructor.
+     * The rates at which step() runs each group of objects. Controllers
+     * get their own period when attached, see tgSubject::attach.
+     */
+    struct Config
+    {
+        Config(int substeps = 1, double mPeriod = 0.0, double dmPeriod = 0.0,
+                double ckPeriod = 0.0, const std::string& ckFile = "",
+                bool staticAct = false, int partThreads = 0);
+        
+        /**
+         * Number of physics steps per call of step(), each of
+         * dt / substeps. Each steps the worlds and then the models, so
+         * actuators and cable forces keep up with the bodies. Must be
+         * positive.
+         */
+        int physicsSubsteps;
+        
+        /**
+         * Minimum period in seconds of the controllers attached to the
+         * models and their descendants, see tgSubject::setMinimumPeriod.
+         * Models, actuators and cables are still stepped at the physics
+         * rate. Zero leaves the periods given to tgSubject::attach.
+         */
+        double modelPeriod;
+        
+        /**
+         * Period in seconds at which data managers sample. Zero samples
+         * on every call of step().
+         */
+        double dataManagerPeriod;
+        
+        /**
+         * Period in seconds at which a checkpoint is written to
+         * checkpointFile on a background thread, see saveCheckpoint.
+         * Zero (the default) never writes one.
+         */
+        double checkpointPeriod;
+        
+        /**
+         * The file periodic checkpoints replace. Must be given if
+         * checkpointPeriod is positive.
+         */
+        std::string checkpointFile;
+        
+        /**
+         * Step the basic, kinematic and compression spring actuators of
+         * the models with a tgActuatorRegistry, which avoids a virtual
+         * call per actuator and per cable, instead of through the model
+         * tree. The actuators are then stepped after every model's own
+         * step rather than during it, so this is off by default.
+         */
+        bool staticActuators;
+        
+        /**
+         * Threads besides the caller's that step the partitions' worlds
+         * at the same time, see tgPartitionStepper. Zero (the default)
+         * steps them in turn. Must not be negative, and positive only
+         * in builds with BT_NO_PROFILE.
+         */
+        int partitionThreads;
+    };
+
+    /**
+     * Construct with every group stepped at the same rate.
      * @param[in,out] view the way the world and its models are rendered.
      */
     tgSimulation(tgSimView& view);
 
+    /**
+     * Construct with separate rates for the groups in Config.
+     * @param[in,out] view the way the world and its models are rendered.
+     * @param[in] config the periods of each group
+     */
+    tgSimulation(tgSimView& view, const Config& config);
+
     ~tgSimulation();
 
     /**
-     * Advance the simulation.
+     * Advance the simulation. The worlds and models are stepped
+     * Config::physicsSubsteps times, data managers only when their
+     * period in Config has elapsed.
      * @param[in] dt the number of seconds since the previous call;
      * throw an exception if not positive
      * @throw std::invalid_argument if dt is not positive
@@ -90,6 +169,84 @@ public:
      * @throw std::invalid_argument if pModel is NULL
      */
     void addObstacle(tgModel* pObstacle);
+    
+    /**
+     * Add a physics partition: a world of its own that is stepped
+     * alongside the view's world, for robots (and the obstacles they
+     * could touch) that never interact with the rest of the simulation.
+     * The partitions' worlds are stepped in turn, or at the same time
+     * with Config::partitionThreads; their models always in turn. Each
+     * broadphase only sees its own bodies. Partitions are never merged
+     * or split, use partitionsOverlap to detect robots that drift too
+     * close.
+     * @param[in] pWorld the partition's world, owned by the simulation
+     * from now on. Typically created with the config of the view's world.
+     * @return the partition's index for addModel and addObstacle. The
+     * view's world is partition 0.
+     * @throw std::invalid_argument if pWorld is NULL
+     */
+    std::size_t addPartition(tgWorld* pWorld);
+    
+    /**
+     * Add a Tensegrity to the given partition, see addModel(tgModel*)
+     * @throw std::invalid_argument if pModel is NULL or partition
+     * does not exist
+     */
+    void addModel(tgModel* pModel, std::size_t partition);
+    
+    /**
+     * Add an obstacle to the given partition, see addObstacle(tgModel*)
+     * @throw std::invalid_argument if pObstacle is NULL or partition
+     * does not exist
+     */
+    void addObstacle(tgModel* pObstacle, std::size_t partition);
+    
+    /**
+     * The number of partitions, including the view's world
+     */
+    std::size_t getPartitionCount() const
+    {
+        return m_partitions.size() + 1;
+    }
+    
+    /**
+     * The world of a partition, the view's world for partition 0
+     * @throw std::out_of_range if partition does not exist
+     */
+    tgWorld& getPartitionWorld(std::size_t partition) const;
+    
+    /**
+     * True if the bounding boxes of the moving bodies of any two
+     * partitions come within margin of each other. Contacts between
+     * partitions are not simulated, so such a run is no longer valid.
+     * @param[in] margin, added to every bounding box
+     */
+    bool partitionsOverlap(double margin = 0.0) const;
+
+    /**
+     * Write a checkpoint: the time since each group was last stepped,
+     * the state of every model and controller (tgModel::saveState) and
+     * of every moving body and contact, in every partition. Versioned
+     * binary, for the same build on the same machine type.
+     * Writing one changes nothing in the simulation. The state of
+     * rand() cannot be read, so it is not saved: controllers that need
+     * the same random numbers after a resume keep their own generator
+     * and save it in tgObserver::onSaveState.
+     * @param[in] filename the file to write
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void saveCheckpoint(const std::string& filename) const;
+
+    /**
+     * Resume from a checkpoint written by this simulation's setup, that
+     * is with the same models, obstacles, controllers and partitions
+     * added in the same order. Typically called right after adding
+     * them, or after reset().
+     * @param[in] filename the file to read
+     * @throw std::runtime_error if the file cannot be read or does not
+     * match this simulation
+     */
+    void loadCheckpoint(const std::string& filename);
 
     /**
      * Add a data manager to the simulation.
@@ -100,6 +257,26 @@ public:
      */
     void addDataManager(tgDataManager* pDataManager);
     
+    /**
+     * Watch the trials for failure, see tgTrialWatchdog. Once it trips
+     * step() does nothing and run(steps) returns, until the next reset.
+     * While it is attached, tgTrialFailure thrown while
+     * stepping trips it instead of propagating. reset() clears it after
+     * the models' teardown, so controllers can read getStatus() there.
+     * @param[in] pWatchdog, owned by the simulation from now on and
+     * deleted with it or when replaced; NULL removes the watchdog
+     */
+    void setWatchdog(tgTrialWatchdog* pWatchdog);
+
+    /** The watchdog, NULL if none was set */
+    const tgTrialWatchdog* getWatchdog() const
+    {
+        return m_pWatchdog;
+    }
+
+    /** True if a watchdog has ended the current trial */
+    bool isTrialOver() const;
+    
     /**
      * Pass the tgModelVisitor to all of the models
      */
@@ -118,9 +295,20 @@ public:
      * calls setup on the models
      * Will delete and remake the dynamics world, the previous
      * ground will be deleted
+     * @throw std::invalid_argument if there are partitions, whose
+     * worlds need grounds of their own. newGround is not taken.
      */
     void reset(tgGround* newGround);
     
+    /**
+     * As reset(tgGround*), giving every partition a new ground
+     * @param[in] newGrounds one ground per partition, the view's world's
+     * first. Each world takes ownership of its ground.
+     * @throw std::invalid_argument if there is not one ground per
+     * partition. No ground is taken.
+     */
+    void reset(const std::vector<tgGround*>& newGrounds);
+    
     /**
      * Returns a reference to the world
      */
@@ -132,6 +320,34 @@ public:
      * Calls teardown on all of the models and reset on the world
      */
     void teardown();
+    
+    /**
+     * Set up the view, the models and the data managers after the
+     * worlds have been reset
+     */
+    void setupAfterReset();
+    
+    /**
+     * Register the actuators of every model with m_actuators, if
+     * Config::staticActuators is set
+     */
+    void registerActuators();
+    
+    /** The body of step(dt), without the watchdog's catch */
+    void stepAll(double dt) const;
+    
+    /**
+     * Step the physics of every partition
+     */
+    void stepWorlds(double dt) const;
+    
+    /**
+     * Step the models and obstacles of every partition
+     */
+    void stepModels(double dt) const;
+    
+    /** The body of a checkpoint, see saveCheckpoint */
+    void writeCheckpoint(std::ostream& os) const;
 
     /** Integrity predicate. */
     bool invariant() const;
@@ -141,6 +357,36 @@ private:
     /** The way the world and its models are rendered. */
     tgSimView& m_view;
 
+    /** The rates of each group */
+    const Config m_config;
+
+    /**
+     * Steps the models' actuators when Config::staticActuators is set,
+     * otherwise empty
+     */
+    tgActuatorRegistry m_actuators;
+
+    /** Time since the data managers last sampled */
+    mutable double m_dataManagerElapsed;
+
+    /** Time since the last periodic checkpoint */
+    mutable double m_checkpointElapsed;
+
+    /**
+     * Writes the periodic checkpoints, NULL unless
+     * Config::checkpointPeriod is positive. Owned.
+     */
+    tgCheckpointWriter* m_pCheckpointWriter;
+
+    /** Ends failed trials, NULL if none was set. Owned. */
+    tgTrialWatchdog* m_pWatchdog;
+
+    /**
+     * Steps the partitions' worlds on threads, NULL unless
+     * Config::partitionThreads is positive. Owned.
+     */
+    tgPartitionStepper* m_pPartitionStepper;
+
     /**
      * The Tensegrities.
      * All pointers are non-NULL.
@@ -162,6 +408,22 @@ private:
      * All pointers should be non-NULL.
      */
     std::vector<tgDataManager*> m_dataManagers;
+    
+    /**
+     * A world of its own with the models and obstacles set up in it
+     */
+    struct Partition
+    {
+        tgWorld* pWorld;
+        std::vector<tgModel*> models;
+        std::vector<tgModel*> obstacles;
+    };
+    
+    /**
+     * The partitions added by addPartition, partition i + 1 is stored
+     * at index i. Worlds and models are owned by the simulation.
+     */
+    std::vector<Partition> m_partitions;
 };
 
 #endif  // TG_SIMULATION_H
@@ -25,6 +25,7 @@
 // This module
 #include "tgSpringCable.h"
 #include "tgSpringCableAnchor.h"
+#include "tgCheckpoint.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -37,7 +38,8 @@ tgSpringCable::tgSpringCable( const std::vector<tgSpringCableAnchor*>& anchors,
 m_damping(0.0),
 m_velocity(0.0),
 m_coefK (coefK),
-m_dampingCoefficient(dampingCoefficient)
+m_dampingCoefficient(dampingCoefficient),
+m_stateCached(false)
 {
 	// Anchors will be stored in child classes
 	assert(anchors.size() >= 2);
@@ -63,6 +65,41 @@ tgSpringCable::~tgSpringCable()
 {
 }
 
+void tgSpringCable::setStateCached(bool cached)
+{
+    m_stateCached = cached;
+    if (cached)
+    {
+        updateState();
+    }
+}
+
+void tgSpringCable::saveState(std::ostream& os) const
+{
+    tgCheckpoint::write(os, m_restLength);
+    tgCheckpoint::write(os, m_prevLength);
+    tgCheckpoint::write(os, m_velocity);
+    tgCheckpoint::write(os, m_damping);
+}
+
+void tgSpringCable::loadState(std::istream& is)
+{
+    tgCheckpoint::read(is, m_restLength);
+    tgCheckpoint::read(is, m_prevLength);
+    tgCheckpoint::read(is, m_velocity);
+    tgCheckpoint::read(is, m_damping);
+}
+
+void tgSpringCable::getAnchorWorldPositions(std::vector<btVector3>& positions) const
+{
+    const std::vector<const tgSpringCableAnchor*> anchors = getAnchors();
+    positions.clear();
+    for (std::size_t i = 0; i < anchors.size(); i++)
+    {
+        positions.push_back(anchors[i]->getWorldPosition());
+    }
+}
+
 const double tgSpringCable::getRestLength() const
 {
     return m_restLength;
@@ -27,9 +27,12 @@
  */
 
 // The C++ Standard Library
+#include <istream>
+#include <ostream>
 #include <vector>
 
 // Forward references
+class btVector3;
 class tgSpringCableAnchor;
 
 /**
@@ -67,6 +70,51 @@ public:
      */
     virtual void step(double dt) = 0;
     
+    /**
+     * Refresh any state cached for readers. The world calls this once
+     * right after each physics step, so every controller, sensor and
+     * logger sees the same values within a step. Does nothing by default
+     */
+    virtual void updateState() { }
+
+    /**
+     * Called with true by the world when it starts calling updateState
+     * after each step, which also refreshes the state once, and with
+     * false when it stops. Until then the cable has nothing keeping a
+     * cache current, so it measures itself on every read instead.
+     */
+    void setStateCached(bool cached);
+
+    /**
+     * True if applyForceInTick can stand in for step, so a world
+     * configured with cableForcesInTick applies this cable's force
+     * itself. False by default
+     */
+    virtual bool canApplyForceInTick() const { return false; }
+
+    /**
+     * Called by such a world before each of its internal ticks: replace
+     * the force applied on the previous tick of the same step with the
+     * force at the current state. Does nothing by default
+     * @param[in] dt the length of the tick
+     * @param[in] firstTick true on the first tick of a step, when the
+     * world has already cleared the forces of the previous step
+     */
+    virtual void applyForceInTick(double dt, bool firstTick) { }
+
+    /**
+     * Write the rest length and the damping state for a checkpoint
+     * @param[out] os the checkpoint stream
+     */
+    virtual void saveState(std::ostream& os) const;
+
+    /**
+     * Read back what saveState() wrote. The cached state is refreshed
+     * by the world once the bodies are restored.
+     * @param[in] is the checkpoint stream
+     */
+    virtual void loadState(std::istream& is);
+    
     /**
      * Returns m_restLength
      */
@@ -126,6 +174,14 @@ public:
      * always define a way to return a vector of base anchors
      */
     virtual const std::vector<const tgSpringCableAnchor*> getAnchors() const = 0;
+    
+    /**
+     * The world positions of the anchors in order, for drawing. By
+     * default the anchors are measured now; cables that cache their
+     * state return the positions as of the last updateState.
+     * @param[out] positions replaced by one position per anchor
+     */
+    virtual void getAnchorWorldPositions(std::vector<btVector3>& positions) const;
 
 protected:
  
@@ -167,6 +223,9 @@ protected:
      */
     double m_prevLength;
 
+    /** True while a world refreshes this cable with updateState */
+    bool m_stateCached;
+
 };
 
 #endif  // SRC_CORE_TG_SPRING_CABLE_H_
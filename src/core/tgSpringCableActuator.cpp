@@ -25,8 +25,10 @@
 
 // This Module
 #include "tgSpringCableActuator.h"
+#include "tgCheckpoint.h"
 #include "tgSpringCable.h"
 #include "tgWorld.h"
+#include "tgWorldBulletPhysicsImpl.h"
 // The C++ Standard Library
 #include <cmath>
 #include <iostream>
@@ -44,7 +46,9 @@ tgSpringCableActuator::Config::Config(double s,
                    double mnRL,
 		   double rot,
    	           bool moveCPA,
-		   bool moveCPB) :
+		   bool moveCPB,
+		   double slpStr,
+		   double slpVel) :
   stiffness(s),
   damping(d),
   pretension(p),
@@ -55,7 +59,9 @@ tgSpringCableActuator::Config::Config(double s,
   minRestLength(mnRL),
   rotation(rot),
   moveCablePointAToEdge(moveCPA),
-  moveCablePointBToEdge(moveCPB)
+  moveCablePointBToEdge(moveCPB),
+  sleepStretch(slpStr),
+  sleepVelocity(slpVel)
 {
     ///@todo is this the right place for this, or the constructor of this class?
     if (s < 0.0)
@@ -85,6 +91,10 @@ tgSpringCableActuator::Config::Config(double s,
     {
          throw std::invalid_argument("Abs of rotation is greater than 2pi. Are you sure you're setting the right parameters?");
     }
+    else if (slpStr < 0.0 || slpVel < 0.0)
+    {
+        throw std::invalid_argument("sleep threshold is negative.");
+    }
 }
 
 void tgSpringCableActuator::Config::scale (double sf)
@@ -94,6 +104,8 @@ void tgSpringCableActuator::Config::scale (double sf)
   targetVelocity  *= sf;
   minActualLength *= sf;
   minRestLength   *= sf;
+  sleepStretch    *= sf;
+  sleepVelocity   *= sf;
 }
 
 
@@ -122,7 +134,9 @@ tgSpringCableActuator::tgSpringCableActuator(tgSpringCable* springCable,
     m_pHistory(new SpringCableActuatorHistory()),
     m_restLength(springCable->getRestLength()),
     m_startLength(springCable->getActualLength()),
-    m_prevVelocity(0.0)
+    m_prevVelocity(0.0),
+    m_pWorldImpl(NULL),
+    m_cableInTick(false)
 {
     constructorAux();
 
@@ -139,13 +153,35 @@ tgSpringCableActuator::~tgSpringCableActuator()
     
 void tgSpringCableActuator::setup(tgWorld& world)
 {
+    // Avoid dynamic_cast, as in tgBulletUtil::worldToDynamicsWorld
+    tgWorldBulletPhysicsImpl& impl =
+        static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+    m_cableInTick = impl.addSpringCable(m_springCable);
+    m_pWorldImpl = &impl;
+    
     tgModel::setup(world);
 }
 
 void tgSpringCableActuator::teardown()
 {
+    if (m_pWorldImpl)
+    {
+        m_pWorldImpl->removeSpringCable(m_springCable);
+        m_pWorldImpl = NULL;
+    }
+    m_cableInTick = false;
+    
     tgModel::teardown();
 }
+
+void tgSpringCableActuator::stepSpringCable(double dt)
+{
+    if (!m_cableInTick)
+    {
+        m_springCable->step(dt);
+    }
+}
+
     
 void tgSpringCableActuator::step(double dt) 
 {
@@ -159,6 +195,22 @@ void tgSpringCableActuator::step(double dt)
     }
 }
 
+void tgSpringCableActuator::saveState(std::ostream& os)
+{
+    tgCheckpoint::write(os, m_restLength);
+    tgCheckpoint::write(os, m_prevVelocity);
+    m_springCable->saveState(os);
+    tgModel::saveState(os);
+}
+
+void tgSpringCableActuator::loadState(std::istream& is)
+{
+    tgCheckpoint::read(is, m_restLength);
+    tgCheckpoint::read(is, m_prevVelocity);
+    m_springCable->loadState(is);
+    tgModel::loadState(is);
+}
+
 const double tgSpringCableActuator::getStartLength() const
 {
     return m_startLength;
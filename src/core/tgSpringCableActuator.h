@@ -35,6 +35,7 @@
 #include <deque> // For history
 // Forward declarations
 class tgWorld;
+class tgWorldBulletPhysicsImpl;
 class tgSpringCable;
 
 /**
@@ -66,7 +67,9 @@ public:
         double mnRL = 0.1,
 	double rot = 0,
 	bool moveCPA = true,
-	bool moveCPB = true);
+	bool moveCPB = true,
+	double slpStr = 0.0,
+	double slpVel = 0.0);
       
       /**
        * Scale parameters that depend on the length of the simulation.
@@ -176,6 +179,19 @@ public:
       bool moveCablePointAToEdge;
       bool moveCablePointBToEdge;
       
+      // Sleep parameters
+      /**
+       * Opt-in sleep mode for tgBulletSpringCable, disabled unless both
+       * are positive. While the stretch (actual length - rest length)
+       * stays below sleepStretch and the length velocity below
+       * sleepVelocity, the cable stops waking its bodies so Bullet can
+       * deactivate a structure at rest. Changing the rest length wakes
+       * the bodies again.
+       * Units are length and length/seconds. Must be nonnegative.
+       */
+      double sleepStretch;
+      double sleepVelocity;
+      
     };
     
     /** Encapsulate the history members. */
@@ -200,14 +216,30 @@ public:
     /** Deletes history and spring cable instantiation */
     virtual ~tgSpringCableActuator();
     
-    /** Just calls tgModel::setup(world) - sets up any children */
+    /**
+     * Registers the spring cable with the world, which refreshes its
+     * cached state after every step. Then calls tgModel::setup(world)
+     * - sets up any children
+     */
     virtual void setup(tgWorld& world);
     
-    /** Just calls tgModel::teardown(world) - sets up any children */
+    /**
+     * Takes the spring cable back from the world, then calls
+     * tgModel::teardown(world) - tears down any children
+     */
     virtual void teardown();
     
     /** Just calls tgModel::step(dt) - steps any children */
     virtual void step(double dt);
+
+    /**
+     * Writes the rest length, the cable's state and the observers'
+     * state, then the children's
+     */
+    virtual void saveState(std::ostream& os);
+
+    /** Reads back what saveState() wrote */
+    virtual void loadState(std::istream& is);
     
     /**
      * Functions for interfacing with tgSpringCable
@@ -267,6 +299,26 @@ public:
     
 protected: 
     
+    /**
+     * Steps m_springCable, whose type must be exactly Cable, with the
+     * step dispatched statically
+     */
+    template <typename Cable>
+    void stepSpringCableAs(double dt)
+    {
+        if (!m_cableInTick)
+        {
+            static_cast<Cable*>(m_springCable)->Cable::step(dt);
+        }
+    }
+    
+    /**
+     * Steps m_springCable, unless the world applies its force in its
+     * internal ticks
+     */
+    void stepSpringCable(double dt);
+
+    
     /**
      * Need to pass tags down to tgModel, but these should only be 
      * called by sub classes
@@ -312,6 +364,19 @@ protected:
      * history is off.
      */
     double m_prevVelocity;
+    
+    /**
+     * The world m_springCable is registered with. Set in setup,
+     * cleared in teardown
+     */
+    tgWorldBulletPhysicsImpl* m_pWorldImpl;
+    
+    /**
+     * True while m_pWorldImpl applies the force of m_springCable in its
+     * internal ticks, see tgWorld::Config::cableForcesInTick
+     */
+    bool m_cableInTick;
+    
 private:
 
     /**
@@ -28,10 +28,37 @@
  */
 
 // This application
+#include "tgCheckpoint.h"
 #include "tgObserver.h"
 // The C++ standard library
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 #include <vector>
 
+/**
+ * The checkpoint and rate hooks of tgSubject, which do not depend on
+ * its type parameter, so tgModel and tgSimulation can reach the
+ * observers of any model.
+ */
+class tgBaseSubject
+{
+public:
+
+    /** The virtual destructor has nothing to do. */
+    virtual ~tgBaseSubject() { }
+
+    /** See tgSubject<T>::notifySaveState */
+    virtual void notifySaveState(std::ostream& os) = 0;
+
+    /** See tgSubject<T>::notifyLoadState */
+    virtual void notifyLoadState(std::istream& is) = 0;
+
+    /** See tgSubject<T>::setMinimumPeriod */
+    virtual void setMinimumPeriod(double period) = 0;
+};
+
 /**
  * A mixin base class for the subject in the observer design pattern.
  * Observers are attached to the subject, and their onStep() member functions
@@ -41,12 +68,12 @@
  * or submodels such as a tgLinearString
  */
 template <typename T>
-class tgSubject
+class tgSubject : public tgBaseSubject
 {
 public:
 
     /** The consructor has nothing to do. */
-    tgSubject() { }
+    tgSubject() : m_minimumPeriod(0.0) { }
 
     /** The virtual destructor has nothing to do. */
     virtual ~tgSubject() { }
@@ -55,17 +82,30 @@ public:
      * Attach an observer to the subject of the observer.
      * @param[in,out] pObserver a pointer to an observer for the subject;
      * do nothing if the pointer is NULL
+     * @param[in] period the control period in seconds. If positive the
+     * observer's onStep() is only called once at least period seconds
+     * have passed, with the elapsed time as dt. Zero (the default)
+     * calls it on every step. Must not be negative.
      */
-    void attach(tgObserver<T>* pObserver);
+    void attach(tgObserver<T>* pObserver, double period = 0.0);
     
     /**
-     * Call tgObserver<T>::onStep() on all observers in the order in which they
-     * were attached.
+     * Call tgObserver<T>::onStep() on all observers that are due in the
+     * order in which they were attached.
      * @param[in] dt the number of seconds since the previous call; do nothing
      * if not positive
      */
     void notifyStep(double dt);
     
+    /**
+     * Call every observer at most once per period seconds, even if it
+     * was attached with a shorter period. Used by tgSimulation to run
+     * controllers slower than the physics.
+     * @param[in] period in seconds, zero (the default) leaves the
+     * attached periods alone; must not be negative
+     */
+    virtual void setMinimumPeriod(double period);
+    
     /**
      * Call tgObserver<T>::onSetup() on all observers in the order in which they
      * were attached.
@@ -77,6 +117,23 @@ public:
      * were attached.
      */
     void notifyTeardown();
+
+    /**
+     * Write the time since each observer's last onStep(), then call
+     * tgObserver<T>::onSaveState() on all observers in the order in which
+     * they were attached.
+     * @param[out] os the checkpoint stream
+     */
+    virtual void notifySaveState(std::ostream& os);
+
+    /**
+     * Read back what notifySaveState() wrote, calling
+     * tgObserver<T>::onLoadState() on all observers.
+     * @param[in] is the checkpoint stream
+     * @throw std::runtime_error if the checkpoint was saved with a
+     * different number of observers
+     */
+    virtual void notifyLoadState(std::istream& is);
     
 private:
 
@@ -85,12 +142,30 @@ private:
      * The subject does not own the observers and must not deallocate them.
      */
      std::vector<tgObserver<T> * > m_observers;
+
+    /** The control period of each observer, parallel to m_observers */
+    std::vector<double> m_periods;
+
+    /**
+     * Time elapsed since each observer's last onStep(), parallel to
+     * m_observers
+     */
+    std::vector<double> m_elapsed;
+
+    /** Lower bound on every entry of m_periods, see setMinimumPeriod */
+    double m_minimumPeriod;
 };
 
 template <typename Subject>
-void tgSubject<Subject>::attach(tgObserver<Subject>* pObserver)
+void tgSubject<Subject>::attach(tgObserver<Subject>* pObserver, double period)
 {
+    if (period < 0.0)
+    {
+        throw std::invalid_argument("Observer period is negative");
+    }
     if (pObserver) { m_observers.push_back(pObserver); 
+        m_periods.push_back(period);
+        m_elapsed.push_back(0.0);
         pObserver->onAttach(static_cast<Subject&>(*this));}
 }
 
@@ -103,17 +178,36 @@ void tgSubject<Subject>::notifyStep(double dt)
     for (std::size_t i = 0; i < n; ++i) 
     {
         tgObserver<Subject>* const pObserver = m_observers[i];
-        if (pObserver) { pObserver->onStep(static_cast<Subject&>(*this), dt); }
+        m_elapsed[i] += dt;
+        const double period = std::max(m_periods[i], m_minimumPeriod);
+        // Due once less than half a step remains, to absorb round off
+        if (pObserver && m_elapsed[i] > period - 0.5 * dt)
+        {
+            const double elapsed = m_elapsed[i];
+            m_elapsed[i] = 0.0;
+            pObserver->onStep(static_cast<Subject&>(*this), elapsed);
+        }
     }
     }
 }
 
+template <typename Subject>
+void tgSubject<Subject>::setMinimumPeriod(double period)
+{
+    if (period < 0.0)
+    {
+        throw std::invalid_argument("Observer period is negative");
+    }
+    m_minimumPeriod = period;
+}
+
 template <typename Subject>
 void tgSubject<Subject>::notifySetup()
 {
         const std::size_t n = m_observers.size();
     for (std::size_t i = 0; i < n; ++i) 
     {
+        m_elapsed[i] = 0.0;
         tgObserver<Subject>* const pObserver = m_observers[i];
         if (pObserver) { pObserver->onSetup(static_cast<Subject&>(*this)); }
     }
@@ -129,5 +223,42 @@ void tgSubject<Subject>::notifyTeardown()
         if (pObserver) { pObserver->onTeardown(static_cast<Subject&>(*this)); }
     }
 }
+
+template <typename Subject>
+void tgSubject<Subject>::notifySaveState(std::ostream& os)
+{
+    const std::size_t n = m_observers.size();
+    tgCheckpoint::write(os, n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        tgCheckpoint::write(os, m_elapsed[i]);
+        tgObserver<Subject>* const pObserver = m_observers[i];
+        if (pObserver)
+        {
+            pObserver->onSaveState(static_cast<Subject&>(*this), os);
+        }
+    }
+}
+
+template <typename Subject>
+void tgSubject<Subject>::notifyLoadState(std::istream& is)
+{
+    std::size_t n = 0;
+    tgCheckpoint::read(is, n);
+    if (n != m_observers.size())
+    {
+        throw std::runtime_error("Checkpoint has a different number of "
+                                 "observers");
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        tgCheckpoint::read(is, m_elapsed[i]);
+        tgObserver<Subject>* const pObserver = m_observers[i];
+        if (pObserver)
+        {
+            pObserver->onLoadState(static_cast<Subject&>(*this), is);
+        }
+    }
+}
 #endif  // TG_SUBJECT_H
 
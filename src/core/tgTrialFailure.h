@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TRIAL_FAILURE_H
+#define TG_TRIAL_FAILURE_H
+
+/**
+ * @file tgTrialFailure.h
+ * @brief Contains the definition of class tgTrialFailure
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <stdexcept>
+#include <string>
+
+/**
+ * Thrown by a model whose trial can not go on, such as CPG equations
+ * that need too many steps. tgSimulation::step catches it and trips
+ * its tgTrialWatchdog with eException; without a watchdog it propagates
+ * like any std::runtime_error. Other exceptions are bugs, and always
+ * propagate.
+ *
+ * This header depends on nothing else in NTRT, so libraries that only
+ * need to end a trial, such as util, can throw it without the
+ * simulation's headers.
+ */
+class tgTrialFailure : public std::runtime_error
+{
+public:
+    explicit tgTrialFailure(const std::string& message) :
+        std::runtime_error(message)
+    {
+    }
+};
+
+#endif  // TG_TRIAL_FAILURE_H
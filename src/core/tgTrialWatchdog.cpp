@@ -0,0 +1,259 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTrialWatchdog.cpp
+ * @brief Contains the implementation of class tgTrialWatchdog
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgTrialWatchdog.h"
+// This library
+#include "tgBulletUtil.h"
+#include "tgSimulation.h"
+#include "tgSpringCable.h"
+#include "tgWorld.h"
+#include "tgWorldBulletPhysicsImpl.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /** False for NaN and infinity, without C99's isfinite */
+    bool isFinite(double x)
+    {
+        return (x - x) == 0.0;
+    }
+
+    bool isFinite(const btVector3& v)
+    {
+        return isFinite(v.x()) && isFinite(v.y()) && isFinite(v.z());
+    }
+}
+
+tgTrialWatchdog::Config::Config(double period, double maxKE,
+                                double maxStrain) :
+    checkPeriod(period),
+    maxKineticEnergy(maxKE),
+    maxCableStrain(maxStrain)
+{
+}
+
+tgTrialWatchdog::Status::Status() :
+    reason(eNone),
+    time(0.0),
+    value(0.0)
+{
+}
+
+tgTrialWatchdog::tgTrialWatchdog(const Config& config) :
+    m_config(config),
+    m_time(0.0),
+    m_elapsed(0.0)
+{
+    if (config.checkPeriod < 0.0)
+    {
+        throw std::invalid_argument("checkPeriod is negative");
+    }
+    assert(invariant());
+}
+
+tgTrialWatchdog::~tgTrialWatchdog()
+{
+    for (std::size_t i = 0; i < m_predicates.size(); i++)
+    {
+        delete m_predicates[i];
+    }
+}
+
+std::size_t tgTrialWatchdog::addPredicate(Predicate* pPredicate)
+{
+    if (pPredicate == NULL)
+    {
+        throw std::invalid_argument("NULL pointer to predicate");
+    }
+    m_predicates.push_back(pPredicate);
+
+    assert(invariant());
+    return m_predicates.size() - 1;
+}
+
+void tgTrialWatchdog::reset()
+{
+    m_status = Status();
+    m_time = 0.0;
+    m_elapsed = 0.0;
+}
+
+bool tgTrialWatchdog::step(const tgSimulation& simulation, double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgTrialWatchdog::step");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    if (isTripped())
+    {
+        return true;
+    }
+
+    m_time += dt;
+    m_elapsed += dt;
+    // Due once less than half a step remains, as tgSimulation's groups
+    if (m_elapsed <= m_config.checkPeriod - 0.5 * dt)
+    {
+        return false;
+    }
+    m_elapsed = 0.0;
+
+    const std::size_t n = simulation.getPartitionCount();
+    for (std::size_t i = 0; i < n && !isTripped(); i++)
+    {
+        checkWorld(simulation.getPartitionWorld(i));
+    }
+    for (std::size_t i = 0; i < m_predicates.size() && !isTripped(); i++)
+    {
+        if (m_predicates[i]->failed(m_time))
+        {
+            trip(ePredicate, static_cast<double>(i));
+        }
+    }
+    return isTripped();
+}
+
+void tgTrialWatchdog::checkWorld(const tgWorld& world)
+{
+    const btCollisionObjectArray& objects =
+        tgBulletUtil::worldToDynamicsWorld(world).getCollisionObjectArray();
+    double energy = 0.0;
+    for (int i = 0; i < objects.size(); i++)
+    {
+        const btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+        if (pBody == NULL || pBody->isStaticOrKinematicObject())
+        {
+            continue;
+        }
+        const btVector3& linear = pBody->getLinearVelocity();
+        const btVector3& angular = pBody->getAngularVelocity();
+        if (!isFinite(pBody->getWorldTransform().getOrigin()) ||
+            !isFinite(linear) || !isFinite(angular))
+        {
+            trip(eNonFinite);
+            return;
+        }
+        if (m_config.maxKineticEnergy > 0.0)
+        {
+            energy += 0.5 * linear.length2() / pBody->getInvMass();
+            // Rotational energy in the body's principal frame
+            const btVector3 local =
+                pBody->getWorldTransform().getBasis().transpose() * angular;
+            const btVector3& invInertia = pBody->getInvInertiaDiagLocal();
+            for (int j = 0; j < 3; j++)
+            {
+                if (invInertia[j] > 0.0)
+                {
+                    energy += 0.5 * local[j] * local[j] / invInertia[j];
+                }
+            }
+        }
+    }
+    if (m_config.maxKineticEnergy > 0.0 &&
+        energy > m_config.maxKineticEnergy)
+    {
+        trip(eEnergy, energy);
+        return;
+    }
+
+    if (m_config.maxCableStrain > 0.0)
+    {
+        const tgWorldBulletPhysicsImpl& impl =
+            static_cast<const tgWorldBulletPhysicsImpl&>(world.implementation());
+        const std::vector<tgSpringCable*>& cables = impl.getSpringCables();
+        for (std::size_t i = 0; i < cables.size(); i++)
+        {
+            const double restLength = cables[i]->getRestLength();
+            if (restLength <= 0.0)
+            {
+                continue;
+            }
+            const double strain =
+                (cables[i]->getActualLength() - restLength) / restLength;
+            // NaN fails the comparison, so check it separately
+            if (!isFinite(strain))
+            {
+                trip(eNonFinite);
+                return;
+            }
+            else if (strain > m_config.maxCableStrain)
+            {
+                trip(eCableStrain, strain);
+                return;
+            }
+        }
+    }
+}
+
+void tgTrialWatchdog::trip(Reason reason, double value,
+                           const std::string& message)
+{
+    if (isTripped() || reason == eNone)
+    {
+        return;
+    }
+    m_status.reason = reason;
+    m_status.time = m_time;
+    m_status.value = value;
+    m_status.message = message;
+}
+
+const char* tgTrialWatchdog::reasonName(Reason reason)
+{
+    switch (reason)
+    {
+    case eNone:
+        return "none";
+    case eNonFinite:
+        return "non-finite state";
+    case eEnergy:
+        return "kinetic energy";
+    case eCableStrain:
+        return "cable strain";
+    case ePredicate:
+        return "predicate";
+    case eException:
+        return "exception";
+    }
+    return "unknown";
+}
+
+bool tgTrialWatchdog::invariant() const
+{
+    return (m_config.checkPeriod >= 0.0) &&
+        (m_time >= 0.0) &&
+        (m_elapsed >= 0.0);
+}
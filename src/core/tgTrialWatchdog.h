@@ -0,0 +1,212 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TRIAL_WATCHDOG_H
+#define TG_TRIAL_WATCHDOG_H
+
+/**
+ * @file tgTrialWatchdog.h
+ * @brief Contains the definition of class tgTrialWatchdog
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This library
+#include "tgTrialFailure.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgSimulation;
+class tgWorld;
+
+/**
+ * Ends trials that have failed, so learning runs do not spend the rest
+ * of a trial simulating a robot that has exploded or fallen over.
+ * Attach one with tgSimulation::setWatchdog. Once it trips, the
+ * simulation stops stepping until reset and tgSimView::run returns
+ * early. The status says why; it lasts until the reset has torn the
+ * models down, so controllers can read it in onTeardown and score the
+ * trial as a failure.
+ *
+ * Each check is one pass over the moving bodies and the spring cables
+ * of every partition, plus the user's predicates.
+ */
+class tgTrialWatchdog
+{
+public:
+
+    /** Why a trial ended early */
+    enum Reason
+    {
+        /** Still running */
+        eNone = 0,
+        /** A body's position or velocity is NaN or infinite */
+        eNonFinite,
+        /** The kinetic energy exceeded Config::maxKineticEnergy */
+        eEnergy,
+        /** A cable's strain exceeded Config::maxCableStrain */
+        eCableStrain,
+        /** A predicate added with addPredicate failed */
+        ePredicate,
+        /** A model threw tgTrialFailure while stepping */
+        eException
+    };
+
+    /**
+     * The limits checked
+     */
+    struct Config
+    {
+        Config(double period = 0.0, double maxKE = 0.0,
+                double maxStrain = 0.0);
+
+        /**
+         * Seconds of simulation between checks. Zero checks on every
+         * step of the simulation. Must not be negative.
+         */
+        double checkPeriod;
+
+        /**
+         * Largest total kinetic energy (translational plus rotational)
+         * of the moving bodies in a partition. Zero disables the check.
+         */
+        double maxKineticEnergy;
+
+        /**
+         * Largest (actual length - rest length) / rest length of any
+         * spring cable. Zero disables the check.
+         */
+        double maxCableStrain;
+    };
+
+    /** Thrown by a model whose trial can not go on, see tgTrialFailure */
+    typedef tgTrialFailure Failure;
+
+    /**
+     * A condition on the trial, such as the height of a model's center
+     * of mass. Holds whatever it needs, for example a tgModel*, which
+     * stays valid across resets.
+     */
+    class Predicate
+    {
+    public:
+        virtual ~Predicate() { }
+
+        /**
+         * @param[in] time, seconds since the trial started
+         * @return true if the trial has failed
+         */
+        virtual bool failed(double time) const = 0;
+    };
+
+    /**
+     * The state of the watchdog
+     */
+    struct Status
+    {
+        Status();
+
+        Reason reason;
+
+        /** Seconds into the trial at which it tripped */
+        double time;
+
+        /**
+         * The quantity that tripped it: the kinetic energy, the strain,
+         * or the index of the predicate
+         */
+        double value;
+
+        /** The exception's message, for eException */
+        std::string message;
+    };
+
+    /**
+     * @throw std::invalid_argument if the check period is negative
+     */
+    explicit tgTrialWatchdog(const Config& config = Config());
+
+    /** Deletes the predicates */
+    ~tgTrialWatchdog();
+
+    /**
+     * Check pPredicate too. Predicates are checked after the built in
+     * limits, in the order added.
+     * @param[in] pPredicate, owned by the watchdog from now on
+     * @return the predicate's index, reported as Status::value
+     * @throw std::invalid_argument if pPredicate is NULL
+     */
+    std::size_t addPredicate(Predicate* pPredicate);
+
+    /** Start a new trial: clear the status and the time */
+    void reset();
+
+    /**
+     * Advance the trial time and check the limits when due
+     * @param[in] simulation, whose partitions' worlds are checked
+     * @param[in] dt, seconds since the last call, must be positive
+     * @return true if the watchdog has tripped
+     */
+    bool step(const tgSimulation& simulation, double dt);
+
+    /**
+     * End the trial for a reason found outside of step. Does nothing if
+     * the watchdog has already tripped.
+     */
+    void trip(Reason reason, double value = 0.0,
+              const std::string& message = "");
+
+    bool isTripped() const
+    {
+        return m_status.reason != eNone;
+    }
+
+    const Status& getStatus() const
+    {
+        return m_status;
+    }
+
+    /** A short name for reason, for logs */
+    static const char* reasonName(Reason reason);
+
+private:
+
+    /** Check the bodies and cables of world, tripping on a failure */
+    void checkWorld(const tgWorld& world);
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    const Config m_config;
+
+    /** Owned, all non-NULL */
+    std::vector<Predicate*> m_predicates;
+
+    Status m_status;
+
+    /** Seconds since reset */
+    double m_time;
+
+    /** Seconds since the last check */
+    double m_elapsed;
+};
+
+#endif  // TG_TRIAL_WATCHDOG_H
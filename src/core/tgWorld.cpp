@@ -26,20 +26,27 @@
 // This module
 #include "tgWorld.h"
 // This application
+#include "tgCollisionShapeCache.h"
 #include "tgWorldBulletPhysicsImpl.h"
 #include "terrain/tgBoxGround.h"
 // The C++ Standard Library
 #include <cassert>
 #include <stdexcept>
 
-tgWorld::Config::Config(double g, double ws) :
+tgWorld::Config::Config(double g, double ws, bool tick, int ss) :
 gravity(g),
-worldSize(ws)
+worldSize(ws),
+cableForcesInTick(tick),
+substeps(ss)
 {
   if (ws <= 0.0)
   {
     throw std::invalid_argument("worldSize is not postive");
   }
+  else if (ss <= 0)
+  {
+    throw std::invalid_argument("substeps is not positive");
+  }
 }
 
 /**
@@ -49,7 +56,10 @@ worldSize(ws)
 tgWorld::tgWorld() :
   m_config(),
   m_pGround(new tgBoxGround()),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pShapeCache(new tgCollisionShapeCache()),
+  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround,
+                                       *m_pShapeCache)),
+  m_revision(0)
 {
   // Postcondition
   assert(invariant());
@@ -62,7 +72,10 @@ tgWorld::tgWorld() :
 tgWorld::tgWorld(const tgWorld::Config& config) :
   m_config(config),
   m_pGround(new tgBoxGround()),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pShapeCache(new tgCollisionShapeCache()),
+  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround,
+                                       *m_pShapeCache)),
+  m_revision(0)
 {
   // Postcondition
   assert(invariant());
@@ -75,7 +88,10 @@ tgWorld::tgWorld(const tgWorld::Config& config) :
 tgWorld::tgWorld(const tgWorld::Config& config, tgGround* ground) :
   m_config(config),
   m_pGround(ground),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pShapeCache(new tgCollisionShapeCache()),
+  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround,
+                                       *m_pShapeCache)),
+  m_revision(0)
 {
   // Postcondition
   assert(invariant());
@@ -83,14 +99,21 @@ tgWorld::tgWorld(const tgWorld::Config& config, tgGround* ground) :
 
 tgWorld::~tgWorld()
 {
+  // The bodies using the cached shapes go first
   delete m_pImpl;
+  delete m_pShapeCache;
   delete m_pGround;
 }
 
 void tgWorld::reset()
 {
   delete m_pImpl;
-  m_pImpl = new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround);
+  // Keep the shapes of the trial just ended for the next one, but not
+  // shapes the trial before it left behind
+  m_pShapeCache->purge();
+  m_pImpl = new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround,
+                                         *m_pShapeCache);
+  ++m_revision;
   // Postcondition
   assert(invariant());
 }
@@ -101,6 +124,8 @@ void tgWorld::reset(const tgWorld::Config& config)
   m_config = config;
   // Reset as usual
   reset();
+  // Nothing uses the cached shapes yet; start from a clean cache
+  m_pShapeCache->clear();
 
   // Postcondition
   assert(invariant());
@@ -126,6 +151,7 @@ void tgWorld::step(double dt) const
   {
     // Forward to the implementation
     m_pImpl->step(dt);
+    ++m_revision;
   }
 }
 
@@ -140,5 +166,5 @@ double tgWorld::getWorldGravity() const
 
 bool tgWorld::invariant() const
 {
-  return m_pImpl != 0;
+  return (m_pShapeCache != 0) && (m_pImpl != 0);
 }
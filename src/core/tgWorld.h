@@ -26,7 +26,11 @@
  * $Id$
  */
 
+// The C++ Standard Library
+#include <cstddef>
+
 // Forward declarations
+class tgCollisionShapeCache;
 class tgWorldImpl;
 class tgGround;
 
@@ -44,7 +48,8 @@ public:
    */
   struct Config
   {
-	Config(double g = 9.81, double ws = 1000);
+	Config(double g = 9.81, double ws = 1000, bool tick = false,
+           int ss = 1);
     /**
      * Gravitational acceleration.
      * The units are application depenent.
@@ -56,6 +61,20 @@ public:
      * the length of one side of the detection cube. Must be positive.
      */
     double worldSize;
+    /**
+     * Apply spring cable forces as forces inside Bullet's internal
+     * pre-tick callback, at the state of each tick and before the
+     * constraint solver runs, instead of as impulses after the world
+     * has stepped. Removes the one step lag of cable forces.
+     */
+    bool cableForcesInTick;
+    /**
+     * Number of Bullet internal ticks per step(), each of dt / substeps.
+     * With cableForcesInTick the cable forces are recomputed before
+     * every tick; without it they are applied once per step. Must be
+     * positive.
+     */
+    int substeps;
   };
 
   /** Construct with the default configuration. */
@@ -78,11 +97,15 @@ public:
   /** Delete the implementation. */
   ~tgWorld();
 
-  /** Replace the implementation. */
+  /**
+   * Replace the implementation. The collision shapes of the previous
+   * one stay cached for the next.
+   */
   void reset();
 
   /**
-   * Replace the implementation with a new config.
+   * Replace the implementation with a new config. The collision shape
+   * cache is emptied.
    * @param[in] config configuration POD
    */
   void reset(const Config& config);
@@ -114,6 +137,16 @@ public:
    * Returns the level of gravity in this world.
    */
   double getWorldGravity() const;
+
+  /**
+   * Changes every time the world is stepped or reset, so state derived
+   * from the world (such as a tgContactTable) can tell when it is out
+   * of date.
+   */
+  std::size_t getRevision() const
+  {
+    return m_revision;
+  }
  
 private:
 
@@ -130,8 +163,17 @@ private:
   /** Implementation of the ground, such as a box, hills or ramp */
   tgGround* m_pGround;
 
+  /**
+   * The rigid bodies' shared collision shapes, kept across resets.
+   * Declared before m_pImpl, which refers to it.
+   */
+  tgCollisionShapeCache* m_pShapeCache;
+
   /** The implementation of the tgWorld. */
   tgWorldImpl * m_pImpl;
+
+  /** See getRevision. Mutable since stepping is const. */
+  mutable std::size_t m_revision;
 };
 
 #endif //TG_BULLET_WORLD_H
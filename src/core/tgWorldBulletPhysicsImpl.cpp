@@ -29,6 +29,8 @@
 // This application
 #include "tgWorld.h"
 #include "tgCast.h"
+#include "tgCollisionShapeCache.h"
+#include "tgSpringCable.h"
 #include "terrain/tgBulletGround.h"
 #include "terrain/tgEmptyGround.h"
 // The Bullet Physics library
@@ -50,6 +52,12 @@
 #include "LinearMath/btTransform.h"
 #include "LinearMath/btVector3.h"
 #include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <set>
+#include <utility>
 
 // Ghost objects
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
@@ -65,6 +73,40 @@
 
 #endif //MLCP_SOLVER
 
+/**
+ * Bullet's default broadphase group and mask test, which also rejects
+ * the pairs of collision objects given to
+ * tgWorldBulletPhysicsImpl::excludeCollisionPair. Only installed once a
+ * pair is excluded, and only consulted when a new overlap is found.
+ */
+class CollisionPairFilter : public btOverlapFilterCallback
+{
+    public:
+        typedef std::pair<const void*, const void*> Pair;
+
+        static Pair makePair(const void* p0, const void* p1)
+        {
+            return std::less<const void*>()(p0, p1) ?
+                Pair(p0, p1) : Pair(p1, p0);
+        }
+
+        virtual bool needBroadphaseCollision(btBroadphaseProxy* proxy0,
+                                             btBroadphaseProxy* proxy1) const
+        {
+            const bool collides =
+                ((proxy0->m_collisionFilterGroup &
+                  proxy1->m_collisionFilterMask) != 0) &&
+                ((proxy1->m_collisionFilterGroup &
+                  proxy0->m_collisionFilterMask) != 0);
+            return collides &&
+                (excluded.find(makePair(proxy0->m_clientObject,
+                                        proxy1->m_clientObject)) ==
+                 excluded.end());
+        }
+
+        std::set<Pair> excluded;
+};
+
 /**
  * Helper class to bundle objects that have the same life cycle, so they can be
  * constructed and destructed together.
@@ -94,6 +136,7 @@ class IntermediateBuildProducts
   btSoftBodyRigidBodyCollisionConfiguration collisionConfiguration;
   btCollisionDispatcher dispatcher;
   btGhostPairCallback ghostCallback;
+  CollisionPairFilter pairFilter;
 #if (0) // Default broadphase
         btDbvtBroadphase broadphase;
 #else
@@ -112,16 +155,26 @@ class IntermediateBuildProducts
 };
 
 tgWorldBulletPhysicsImpl::tgWorldBulletPhysicsImpl(const tgWorld::Config& config,
-        tgBulletGround* ground) :
+        tgBulletGround* ground, tgCollisionShapeCache& shapeCache) :
     tgWorldImpl(config, ground),
     m_pIntermediateBuildProducts(new IntermediateBuildProducts(config.worldSize)),
-    m_pDynamicsWorld(createDynamicsWorld())
+    m_pDynamicsWorld(createDynamicsWorld()),
+    m_shapeCache(shapeCache),
+    m_cableForcesInTick(config.cableForcesInTick),
+    m_substeps(config.substeps),
+    m_firstTick(true)
 {
 
     // Gravitational acceleration is down on the Y axis
     const btVector3 gravityVector(0, -config.gravity, 0);
     m_pDynamicsWorld->setGravity(gravityVector);
 	
+	if (m_cableForcesInTick)
+	{
+		const bool isPreTick = true;
+		m_pDynamicsWorld->setInternalTickCallback(&preTickCallback, this, isPreTick);
+	}
+	
 	if (!tgCast::cast<tgBulletGround, tgEmptyGround>(ground) && ground != NULL)
 	{
 		m_pDynamicsWorld->addRigidBody(ground->getGroundRigidBody());
@@ -168,6 +221,8 @@ tgWorldBulletPhysicsImpl::~tgWorldBulletPhysicsImpl()
         {
             delete pRigidBody->getMotionState();
         }
+        // The shape itself stays cached for the next trial
+        m_shapeCache.release(pCollisionObject->getCollisionShape());
 
         // Remove the collision object from the dynamics world
         m_pDynamicsWorld->removeCollisionObject(pCollisionObject);
@@ -180,7 +235,20 @@ tgWorldBulletPhysicsImpl::~tgWorldBulletPhysicsImpl()
     // Delete all the collision shapes. This can be done at any time.
     const size_t ncs = m_collisionShapes.size();
     
-    for (size_t i = 0; i < ncs; ++i) { delete m_collisionShapes[i]; }
+    for (size_t i = 0; i < ncs; ++i)
+    {
+        // Compounds do not delete their children, which may be cached
+        const btCompoundShape* const pCompound =
+            tgCast::cast<btCollisionShape, btCompoundShape>(m_collisionShapes[i]);
+        if (pCompound)
+        {
+            for (int j = 0; j < pCompound->getNumChildShapes(); j++)
+            {
+                m_shapeCache.release(pCompound->getChildShape(j));
+            }
+        }
+        delete m_collisionShapes[i];
+    }
 
     delete m_pDynamicsWorld;
 
@@ -212,14 +280,32 @@ void tgWorldBulletPhysicsImpl::step(double dt)
     assert(dt > 0.0);
 
     const btScalar timeStep = dt;
-    const int maxSubSteps = 1;
-    const btScalar fixedTimeStep = dt;
+    const int maxSubSteps = m_substeps;
+    // Bullet takes int(accumulated time / fixedTimeStep) ticks. dt /
+    // substeps can round so that dt holds one tick fewer, so shorten
+    // the ticks by a negligible fraction; the remainder Bullet carries
+    // would take about 1e12 steps to add up to an extra tick.
+    const btScalar fixedTimeStep = (m_substeps == 1) ? dt :
+        dt / m_substeps * (1.0 - 1.0e-12);
+    m_firstTick = true;
     m_pDynamicsWorld->stepSimulation(timeStep, maxSubSteps, fixedTimeStep);
 
+    // Cache cable state once, rather than in every reader
+    updateSpringCables();
+
     // Postcondition
     assert(invariant());
 }
 
+void tgWorldBulletPhysicsImpl::updateSpringCables()
+{
+    const std::size_t n = m_springCables.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_springCables[i]->updateState();
+    }
+}
+
 void tgWorldBulletPhysicsImpl::addCollisionShape(btCollisionShape* pShape)
 {
 #ifndef BT_NO_PROFILE 
@@ -241,7 +327,11 @@ void tgWorldBulletPhysicsImpl::deleteCollisionShape(btCollisionShape* pShape)
     BT_PROFILE("deleteCollisionShape");
 #endif //BT_NO_PROFILE
 	
-    if (pShape)
+    if (pShape && m_shapeCache.contains(pShape))
+    {
+        m_shapeCache.release(pShape);
+    }
+    else if (pShape)
     {
 		btCompoundShape* cShape = tgCast::cast<btCollisionShape, btCompoundShape>(pShape);
 		if (cShape)
@@ -260,6 +350,89 @@ void tgWorldBulletPhysicsImpl::deleteCollisionShape(btCollisionShape* pShape)
       assert(invariant());
 }
 
+void tgWorldBulletPhysicsImpl::excludeCollisionPair(btCollisionObject* pObject0,
+                                                    btCollisionObject* pObject1)
+{
+    if (pObject0 == NULL || pObject1 == NULL || pObject0 == pObject1)
+    {
+        return;
+    }
+
+    CollisionPairFilter& filter = m_pIntermediateBuildProducts->pairFilter;
+    btOverlappingPairCache* const pPairCache =
+        m_pDynamicsWorld->getBroadphase()->getOverlappingPairCache();
+    if (filter.excluded.empty())
+    {
+        pPairCache->setOverlapFilterCallback(&filter);
+    }
+    filter.excluded.insert(CollisionPairFilter::makePair(pObject0, pObject1));
+
+    // The broadphase pairs objects as soon as they are added
+    btBroadphaseProxy* const pProxy0 = pObject0->getBroadphaseHandle();
+    btBroadphaseProxy* const pProxy1 = pObject1->getBroadphaseHandle();
+    if (pProxy0 && pProxy1)
+    {
+        pPairCache->removeOverlappingPair(pProxy0, pProxy1,
+                                          m_pDynamicsWorld->getDispatcher());
+    }
+}
+
+bool tgWorldBulletPhysicsImpl::addSpringCable(tgSpringCable* pCable)
+{
+    if (pCable == NULL)
+    {
+        return false;
+    }
+    
+    m_springCables.push_back(pCable);
+    pCable->setStateCached(true);
+    const bool inTick = m_cableForcesInTick && pCable->canApplyForceInTick();
+    if (inTick)
+    {
+        m_tickCables.push_back(pCable);
+    }
+    
+    // Postcondition
+    assert(invariant());
+    return inTick;
+}
+
+void tgWorldBulletPhysicsImpl::removeSpringCable(tgSpringCable* pCable)
+{
+    const std::vector<tgSpringCable*>::iterator it =
+        std::remove(m_springCables.begin(), m_springCables.end(), pCable);
+    if (it != m_springCables.end())
+    {
+        m_springCables.erase(it, m_springCables.end());
+        pCable->setStateCached(false);
+    }
+    m_tickCables.erase(std::remove(m_tickCables.begin(), m_tickCables.end(),
+                                   pCable),
+                       m_tickCables.end());
+    
+    // Postcondition
+    assert(invariant());
+}
+
+void tgWorldBulletPhysicsImpl::preTickCallback(btDynamicsWorld* world,
+                                                btScalar timeStep)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("preTickCallback");
+#endif //BT_NO_PROFILE
+    
+    tgWorldBulletPhysicsImpl* const pImpl =
+        static_cast<tgWorldBulletPhysicsImpl*>(world->getWorldUserInfo());
+    assert(pImpl);
+    
+    const std::size_t n = pImpl->m_tickCables.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        pImpl->m_tickCables[i]->applyForceInTick(timeStep, pImpl->m_firstTick);
+    }
+    pImpl->m_firstTick = false;
+}
+
 bool tgWorldBulletPhysicsImpl::invariant() const
 {
     return (m_pDynamicsWorld != 0);
@@ -31,10 +31,14 @@
 #include "tgWorld.h"
 #include "tgWorldImpl.h"
 #include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btScalar.h"
+// The C++ Standard Library
+#include <vector>
 
 
 
 // Forward declarations
+class btCollisionObject;
 class btCollisionShape;
 class btTypedConstraint;
 class btDynamicsWorld;
@@ -44,6 +48,8 @@ class btBroadphaseInterface;
 class btDispatcher;
 class tgBulletGround;
 class tgHillyGround;
+class tgCollisionShapeCache;
+class tgSpringCable;
 
 /**
  * Concrete class derived from tgWorldImpl for Bullet Physics
@@ -59,9 +65,12 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
    * @param[in] ground - a container class that holds a rigid body and
    * collsion object for the ground. tgEmptyGround can be used to create
    * a ground free simulation
+   * @param[in] shapeCache - the world's shared collision shapes, which
+   * must outlive this
    */
   tgWorldBulletPhysicsImpl(const tgWorld::Config& config,
-                           tgBulletGround* ground);
+                           tgBulletGround* ground,
+                           tgCollisionShapeCache& shapeCache);
 
   /** Clean up Bullet Physics state. */
   ~tgWorldBulletPhysicsImpl();
@@ -81,6 +90,16 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
   {
     return *m_pDynamicsWorld;
   }
+
+  /**
+   * The shared primitive collision shapes, which survive the
+   * implementation. The references of the bodies' shapes are released
+   * when the implementation is destroyed.
+   */
+  tgCollisionShapeCache& shapeCache() const
+  {
+    return m_shapeCache;
+  }
   
 	/**
 	 * Add a btCollisionShape the a collection for deletion upon
@@ -91,6 +110,7 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
 	
 	/**
 	 * Immediately delete a collision shape to avoid leaking memory during a rial
+	 * Shapes from shapeCache() are released instead.
 	 * @param[in] pShape a pointer to a btCollisionShape; do nothing if NULL
 	 */
 	void deleteCollisionShape(btCollisionShape* pShape);
@@ -101,8 +121,60 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
      * @param[in] pConstraint a pointer to a btTypedConstraint; do nothing if NULL
      */
         void addConstraint(btTypedConstraint* pConstaint);
+
+    /**
+     * Never pair two collision objects in the broadphase, so they do not
+     * collide, whatever their collision filter bits. Any pair already
+     * found is removed. Objects are only removed from the world when it
+     * is destroyed, so exclusions last as long as the world.
+     * @param[in] pObject0, a collision object in the world; do nothing
+     * if NULL
+     * @param[in] pObject1, a collision object in the world; do nothing
+     * if NULL or the same as pObject0
+     */
+    void excludeCollisionPair(btCollisionObject* pObject0,
+                              btCollisionObject* pObject1);
+    
+    /**
+     * Register a spring cable. Its cached state (tgSpringCable::updateState)
+     * is refreshed now and once right after every step. If the world
+     * was configured with cableForcesInTick and the cable supports it,
+     * its force is also applied in the internal pre-tick callback.
+     * @param[in] pCable a spring cable that must outlive its
+     * registration, see removeSpringCable
+     * @return true if the world will apply the cable's force, false if
+     * the caller must keep stepping it, as it must if pCable is NULL
+     */
+    bool addSpringCable(tgSpringCable* pCable);
+    
+    /**
+     * Stop updating and applying a spring cable, which then measures
+     * itself on every read. Does nothing if it was not added.
+     * @param[in] pCable a spring cable previously accepted by
+     * addSpringCable
+     */
+    void removeSpringCable(tgSpringCable* pCable);
+
+    /**
+     * Refresh the cached state of every registered spring cable. Called
+     * after each step, and after bodies are moved outside of a step
+     * such as when a checkpoint is loaded.
+     */
+    void updateSpringCables();
+
+    /** The spring cables registered with addSpringCable */
+    const std::vector<tgSpringCable*>& getSpringCables() const
+    {
+        return m_springCables;
+    }
 private:
 
+    /**
+     * Registered with Bullet as the internal pre-tick callback. Applies
+     * the force of every spring cable in m_tickCables for this tick.
+     */
+    static void preTickCallback(btDynamicsWorld* world, btScalar timeStep);
+
     /**
      * Delete all the collision objects. The dynamics world must exist.
      * Delete in reverse order of creation.
@@ -150,6 +222,24 @@ private:
      * world.
      */
     btAlignedObjectArray<btTypedConstraint*> m_constraints;
+    
+    /** Shared with the previous and next implementations of the world */
+    tgCollisionShapeCache& m_shapeCache;
+
+    /** The registered spring cables */
+    std::vector<tgSpringCable*> m_springCables;
+
+    /** True if spring cable forces are applied in the pre-tick callback */
+    const bool m_cableForcesInTick;
+
+    /** Bullet internal ticks per step */
+    const int m_substeps;
+
+    /** The registered spring cables whose forces are applied per tick */
+    std::vector<tgSpringCable*> m_tickCables;
+
+    /** True until the first tick of the current step has run */
+    bool m_firstTick;
 };
 
 #endif  // TG_WORLDBULLETPHYSICSIMPL_H
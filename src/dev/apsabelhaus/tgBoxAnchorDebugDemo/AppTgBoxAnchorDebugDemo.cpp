@@ -29,10 +29,12 @@
 #include "tgBoxAnchorDebugModel.h"
 // This library
 #include "core/terrain/tgBoxGround.h"
+#include "core/tgContactTable.h"
 #include "core/tgModel.h"
 #include "core/tgSimViewGraphics.h"
 #include "core/tgSimulation.h"
 #include "core/tgWorld.h"
+#include "sensors/tgContactSensorInfo.h"
 #include "sensors/tgDataLogger2.h"
 #include "sensors/tgRodSensorInfo.h"
 #include "sensors/tgSpringCableActuatorSensorInfo.h"
@@ -68,6 +70,11 @@ int main(int argc, char** argv)
 
     tgWorld world(config, ground);
 
+    // The contacts of every body, shared by the contact sensors. It reads
+    // the world once per step, however many sensors there are, and must
+    // outlive the simulation's data logger.
+    tgContactTable contactTable(world);
+
     // Second create the view
     const double timestep_physics = 0.001; // Seconds
     const double timestep_graphics = 1.f/60.f; // Seconds
@@ -96,9 +103,13 @@ int main(int argc, char** argv)
     tgRodSensorInfo* myRodSensorInfo = new tgRodSensorInfo();
     tgSpringCableActuatorSensorInfo* mySCASensorInfo =
       new tgSpringCableActuatorSensorInfo();
+    // Log how hard the boxes and rods press on the ground
+    tgContactSensorInfo* myContactSensorInfo =
+      new tgContactSensorInfo(contactTable);
     // Attach the sensor infos to the data logger
     myDataLogger->addSensorInfo(myRodSensorInfo);
     myDataLogger->addSensorInfo(mySCASensorInfo);
+    myDataLogger->addSensorInfo(myContactSensorInfo);
     // Next, attach it to the simulation
     simulation.addDataManager(myDataLogger);
     // and everything else should happen automatically.
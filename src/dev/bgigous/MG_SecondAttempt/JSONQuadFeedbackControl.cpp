@@ -317,6 +317,7 @@ void JSONQuadFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
     
     prevScores.append(subScores);
     root["scores"] = prevScores;
+    recordTrial(root);
     
     ofstream payloadLog;
     payloadLog.open(controlFilename.c_str(),ofstream::out);
@@ -24,9 +24,8 @@
  * $Id$
  */
 
-// This application
-#include "CordeModel.h"
 // This library
+#include "core/tgCordeModel.h"
 #include "core/tgModel.h"
 #include "core/tgSimViewGraphics.h"
 #include "core/tgSimulation.h"
@@ -72,10 +71,10 @@ int main(int argc, char** argv)
 	const double springConst = 100.0 * pow(10, 3);
 	const double gammaT = 10.0 * pow(10, -6);
 	const double gammaR = 1.0 * pow(10, -6);
-	CordeModel::Config config(resolution, radius, density, youngMod, shearMod,
+	tgCordeModel::Config config(resolution, radius, density, youngMod, shearMod,
 								stretchMod, springConst, gammaT, gammaR);
 	
-	CordeModel testString(startPos, endPos, startRot, endRot, config);
+	tgCordeModel testString(startPos, endPos, startRot, endRot, config);
 	
 	double t = 0.0;
 	double dt = 0.0001;
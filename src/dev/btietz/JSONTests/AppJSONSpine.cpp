@@ -32,6 +32,7 @@
 #include "core/tgSimView.h"
 #include "core/tgSimViewGraphics.h"
 #include "core/tgSimulation.h"
+#include "core/tgTrialWatchdog.h"
 #include "core/tgWorld.h"
 // The C++ Standard Library
 #include <iostream>
@@ -58,6 +59,11 @@ int main(int argc, char** argv)
 
     // Third create the simulation
     tgSimulation simulation(view);
+    
+    // End trials that blow up instead of running them out.
+    // Check every 10 ms; no energy limit; cables at most doubled.
+    const tgTrialWatchdog::Config watchdogConfig(0.01, 0.0, 1.0);
+    simulation.setWatchdog(new tgTrialWatchdog(watchdogConfig));
 
     // Fourth create the models with their controllers and add the models to the
     // simulation
@@ -89,6 +95,8 @@ int main(int argc, char** argv)
     JSONCPGControl* const myControl =
       new JSONCPGControl(control_config, suffix, "learningSpines/OctahedralComplex/");
     myModel->attach(myControl);
+    // Failed trials score -1 rather than the distance they reached
+    myControl->setWatchdog(simulation.getWatchdog());
     
     simulation.addModel(myModel);
     
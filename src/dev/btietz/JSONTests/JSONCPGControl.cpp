@@ -33,6 +33,7 @@
 // included from BaseSpineModelLearning. Perhaps we should move things
 // to a cpp over there
 #include "core/tgSpringCableActuator.h"
+#include "core/tgTrialWatchdog.h"
 #include "controllers/tgImpedanceController.h"
 #include "examples/learningSpines/tgCPGActuatorControl.h"
 #include "examples/learningSpines/tgCPGCableControl.h"
@@ -41,6 +42,8 @@
 
 #include "helpers/FileHelpers.h"
 
+#include "learning/ResultsStore/ResultsStore.h"
+
 #include "util/CPGEquations.h"
 #include "util/CPGNode.h"
 
@@ -53,6 +56,25 @@
 
 using namespace std;
 
+namespace
+{
+    /** Append every number in value, depth first */
+    void flatten(const Json::Value& value, std::vector<double>& result)
+    {
+        if (value.isArray())
+        {
+            for (Json::Value::ArrayIndex i = 0; i < value.size(); i++)
+            {
+                flatten(value[i], result);
+            }
+        }
+        else if (value.isNumeric())
+        {
+            result.push_back(value.asDouble());
+        }
+    }
+}
+
 JSONCPGControl::Config::Config(int ss,
 										int tm,
 										int om,
@@ -142,7 +164,9 @@ m_pCPGSys(NULL),
 m_config(config),
 m_dataObserver("logs/TCData"),
 m_updateTime(0.0),
-bogus(false)
+bogus(false),
+m_pWatchdog(NULL),
+m_trialStart(std::clock())
 {
 	if (resourcePath != "")
 	{
@@ -294,6 +318,15 @@ void JSONCPGControl::onTeardown(BaseSpineModelLearning& subject)
     const double distanceMoved = sqrt((newX-oldX) * (newX-oldX) + 
                                         (newZ-oldZ) * (newZ-oldZ));
     
+    if (m_pWatchdog && m_pWatchdog->isTripped())
+    {
+        const tgTrialWatchdog::Status& status = m_pWatchdog->getStatus();
+        std::cout << "Trial ended at " << status.time << " s: "
+                  << tgTrialWatchdog::reasonName(status.reason)
+                  << std::endl;
+        bogus = true;
+    }
+    
     if (bogus)
     {
 		scores.push_back(-1.0);
@@ -351,6 +384,7 @@ void JSONCPGControl::onTeardown(BaseSpineModelLearning& subject)
     
     prevScores.append(subScores);
     root["scores"] = prevScores;
+    recordTrial(root);
     
     ofstream payloadLog;
     payloadLog.open(controlFilename.c_str(),ofstream::out);
@@ -373,6 +407,38 @@ const double JSONCPGControl::getCPGValue(std::size_t i) const
 	return (*m_pCPGSys)[i];
 }
 
+void JSONCPGControl::recordTrial(const Json::Value& root)
+{
+    const std::clock_t trialStart = m_trialStart;
+    m_trialStart = std::clock();
+    if (!root.isMember("resultsStore"))
+    {
+        return;
+    }
+    // One parameter set per <prefix>Vals member, in name order
+    std::vector< std::vector<double> > parameters;
+    const Json::Value::Members members = root.getMemberNames();
+    for (std::size_t i = 0; i < members.size(); i++)
+    {
+        const std::string& name = members[i];
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, "Vals") == 0)
+        {
+            parameters.push_back(std::vector<double>());
+            flatten(root[name].get("params", Json::nullValue), parameters.back());
+        }
+    }
+    // The driver draws the parameters, so there is no seed to record
+    ResultsStore store(root["resultsStore"].asString());
+    store.append(ResultsStore::Trial(root.get("scenario", "").asString(),
+                                     root.get("generation", 0).asInt(),
+                                     0, trialStart, parameters, scores));
+}
+
+void JSONCPGControl::setWatchdog(const tgTrialWatchdog* pWatchdog)
+{
+    m_pWatchdog = pWatchdog;
+}
+
 double JSONCPGControl::getScore() const
 {
 	if (scores.size() == 2)
@@ -27,6 +27,7 @@
  * $Id$
  */
 
+#include <ctime>
 #include <vector>
 #include "boost/multi_array.hpp"
 
@@ -41,6 +42,7 @@ class tgImpedanceController;
 class tgCPGActuatorControl;
 class CPGEquations;
 class tgCPGLogger;
+class tgTrialWatchdog;
 class BaseSpineModelLearning;
 class BaseSpineCPGControl;
 
@@ -125,6 +127,13 @@ struct Config
 	
 	double getScore() const;
 	
+    /**
+     * Score trials that pWatchdog ends early as failures, as if the
+     * spine had left its height limits. pWatchdog must outlive the
+     * controller's use of it; NULL stops checking.
+     */
+    void setWatchdog(const tgTrialWatchdog* pWatchdog);
+	
 protected:
     /**
      * Takes a vector of parameters reported by learning, and then 
@@ -136,6 +145,14 @@ protected:
     
     virtual void setupCPGs(BaseSpineModelLearning& subject, array_2D nodeActions, array_4D edgeActions);
 
+    /**
+     * Append this trial's parameters and scores to the ResultsStore
+     * named by root's resultsStore member, if it has one. The learning
+     * driver that writes the file sets it, along with the generation
+     * and scenario. Call once per trial, when its scores are final.
+     */
+    void recordTrial(const Json::Value& root);
+
     CPGEquations* m_pCPGSys;
     
     std::vector<tgCPGActuatorControl*> m_allControllers;
@@ -154,6 +171,12 @@ protected:
     
     bool bogus;
     
+    /** Read in onTeardown, before the reset clears it */
+    const tgTrialWatchdog* m_pWatchdog;
+    
+    /** When the last trial was recorded, or the controller made */
+    std::clock_t m_trialStart;
+    
     std::string controlFilename;
     std::string controlFilePath;
 };
@@ -288,6 +288,7 @@ void JSONFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
     
     prevScores.append(subScores);
     root["scores"] = prevScores;
+    recordTrial(root);
     
     ofstream payloadLog;
     payloadLog.open(controlFilename.c_str(),ofstream::out);
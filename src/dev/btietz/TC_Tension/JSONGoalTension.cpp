@@ -261,6 +261,7 @@ void JSONGoalTension::onTeardown(BaseSpineModelLearning& subject)
     
     prevScores.append(subScores);
     root["scores"] = prevScores;
+    recordTrial(root);
     
     ofstream payloadLog;
     payloadLog.open(controlFilename.c_str(),ofstream::out);
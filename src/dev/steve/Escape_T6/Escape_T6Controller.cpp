@@ -81,6 +81,8 @@ void Escape_T6Controller::onSetup(Escape_T6Model& subject)
     }
 
     populateClusters(subject);
+    m_muscleGroup = tgActuatorGroup(muscles);
+    m_targetLengths.resize(muscles.size());
     initPosition = subject.getBallCOM();
     setupAdapter();
     initializeSineWaves(); // For muscle actuation
@@ -260,17 +262,12 @@ double Escape_T6Controller::totalEnergySpent(Escape_T6Model& subject) {
 void Escape_T6Controller::setPreferredMuscleLengths(Escape_T6Model& subject, double dt) {
     double phase = 0; // Phase of cluster1
     
-    int nMuscles = 24;
+    int nMuscles = m_targetLengths.size();
     int oldCluster = 0;
     int cluster = 0;
 
     for(int iMuscle=0; iMuscle < nMuscles; iMuscle++) {
 
-        const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
-        tgBasicActuator *const pMuscle = muscles[iMuscle];
-
-        assert(pMuscle != NULL);
-
         // Determine cluster
         oldCluster = cluster;
         if (iMuscle < 4) {
@@ -299,11 +296,12 @@ void Escape_T6Controller::setPreferredMuscleLengths(Escape_T6Model& subject, dou
         } else if (newLength >= maxLength) {
             newLength = maxLength;
         }
-        pMuscle->setControlInput(newLength, dt);
+        m_targetLengths[iMuscle] = newLength;
         if (oldCluster != cluster) {
             phase += phaseChange[cluster];
         }
     }
+    m_muscleGroup.setRestLengths(m_targetLengths, dt);
 }
 
 void Escape_T6Controller::populateClusters(Escape_T6Model& subject) {
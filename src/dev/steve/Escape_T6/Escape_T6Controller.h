@@ -29,6 +29,7 @@
 
 #include <vector>
 
+#include "core/tgActuatorGroup.h"
 #include "core/tgObserver.h"
 #include "learning/Adapters/AnnealAdapter.h"
 #include "learning/Configuration/configuration.h"
@@ -77,6 +78,10 @@ class Escape_T6Controller : public tgObserver<Escape_T6Model>
         int musclesPerCluster;
         /** A vector clusters, each of which contains a vector of muscles */
         std::vector<std::vector<tgBasicActuator*> > clusters; 
+        /** All muscles, in getAllMuscles order, driven in one call */
+        tgActuatorGroup m_muscleGroup;
+        /** Target lengths handed to m_muscleGroup each step */
+        std::vector<double> m_targetLengths;
 
         // Sine Wave Data
         double* amplitude;
@@ -69,7 +69,7 @@ int main(int argc, char** argv)
     // simulations, no controller is needed.
 
     VerticalSpinePassiveController* const controller = new VerticalSpinePassiveController();
-    //VerticalSpineBendingController* const controller = new VerticalSpineBendingController();
+    //VerticalSpineBendingController* const controller = new VerticalSpineBendingController(50.0);
     myModel->attach(controller);
 
     // Finally, add the model (with attached objects) to the simulation.
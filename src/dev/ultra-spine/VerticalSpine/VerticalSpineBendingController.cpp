@@ -33,13 +33,15 @@
 #include "core/tgString.h"
 #include "sensors/tgDataObserver.h"
 // The C++ Standard Library
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <stdexcept>
 #include <vector>
 
 #include "helpers/FileHelpers.h"
 
-VerticalSpineBendingController::VerticalSpineBendingController():
+VerticalSpineBendingController::VerticalSpineBendingController(double maxAngularAcceleration):
   verticalRLA1(4.0),
   verticalRLA2(4.0),
   verticalRLA3(4.0),
@@ -50,6 +52,8 @@ VerticalSpineBendingController::VerticalSpineBendingController():
   verticalRLB4(4.0),
   dL(0.002),        // Length Change, 0.01
   state(-1.0),
+  updateTime(0.0),
+  m_maxAngularAcceleration(maxAngularAcceleration),
   m_updateTime(0.0),
   m_dataObserver("logs/vertspine_1-2-3-4_")
 {
@@ -64,6 +68,65 @@ VerticalSpineBendingController::VerticalSpineBendingController():
 
 void VerticalSpineBendingController::onSetup(VerticalSpineModel& subject){
   m_dataObserver.onSetup(subject);
+  if (m_maxAngularAcceleration < 0.0)
+  {
+      throw std::invalid_argument("maxAngularAcceleration is negative");
+  }
+  else if (m_maxAngularAcceleration > 0.0)
+  {
+      m_linearizer.setup(subject);
+  }
+}
+
+double VerticalSpineBendingController::stepFraction(VerticalSpineModel& subject,
+                                                    double deltaA,
+                                                    double deltaB)
+{
+    if (m_maxAngularAcceleration == 0.0)
+    {
+        return 1.0;
+    }
+    m_linearizer.linearize();
+    const tgLinearizer::SparseMatrix& B = m_linearizer.getB();
+
+    // The planned change of each input
+    const std::vector<tgSpringCableActuator*>& actuators =
+        m_linearizer.getActuators();
+    const std::vector<tgSpringCableActuator*>& musclesA =
+        subject.getMuscles("vertical a");
+    const std::vector<tgSpringCableActuator*>& musclesB =
+        subject.getMuscles("vertical b");
+    std::vector<double> du(actuators.size(), 0.0);
+    for (std::size_t k = 0; k < actuators.size(); k++)
+    {
+        if (std::find(musclesA.begin(), musclesA.end(), actuators[k]) != musclesA.end())
+        {
+            du[k] = deltaA;
+        }
+        else if (std::find(musclesB.begin(), musclesB.end(), actuators[k]) != musclesB.end())
+        {
+            du[k] = deltaB;
+        }
+    }
+
+    // The largest predicted change in a vertebra's angular acceleration
+    double largest = 0.0;
+    for (std::size_t i = 0; i < m_linearizer.getBodies().size(); i++)
+    {
+        for (std::size_t axis = 0; axis < 3; axis++)
+        {
+            const std::size_t row =
+                m_linearizer.stateIndex(i, tgLinearizer::eAngularVelocity, axis);
+            double change = 0.0;
+            for (std::size_t k = 0; k < du.size(); k++)
+            {
+                change += B(row, k) * du[k];
+            }
+            largest = std::max(largest, std::fabs(change));
+        }
+    }
+    return largest > m_maxAngularAcceleration ?
+        m_maxAngularAcceleration / largest : 1.0;
 }
 
 
@@ -96,15 +159,17 @@ void VerticalSpineBendingController::onStep(VerticalSpineModel& subject, double
  		state = -1.0;
  	      }
 
+ 	    // Take less than dL where the spine would jerk
+ 	    const double step = dL * stepFraction(subject, state * dL, -state * dL);
  	    if (state == -1.0)
  	      {
- 		verticalRLA1 -= dL;
- 		verticalRLB1 += dL;
+ 		verticalRLA1 -= step;
+ 		verticalRLB1 += step;
  	      }
  	    else if (state == 1.0)
  	      {
- 		verticalRLA1 += dL;
- 		verticalRLB1 -= dL;
+ 		verticalRLA1 += step;
+ 		verticalRLB1 -= step;
  	      }
  	  }
 	
@@ -33,6 +33,8 @@
 
 // the data collection class
 #include "sensors/tgDataObserver.h"
+// the linear model, to limit how hard each step bends
+#include "core/tgLinearizer.h"
 #include <string>
 
 // Forward declarations
@@ -56,7 +58,13 @@ public:
    */
   
   // Note that currently this is calibrated for decimeters.
-  VerticalSpineBendingController();
+  /**
+   * @param[in] maxAngularAcceleration, if positive, shortens any step
+   * in rest length that a linearization of the spine predicts would
+   * change a vertebra's angular acceleration by more than this, in
+   * radians per second squared. Zero, the default, never shortens.
+   */
+  VerticalSpineBendingController(double maxAngularAcceleration = 0.0);
     
   /**
    * Nothing to delete, destructor must be virtual
@@ -64,8 +72,8 @@ public:
   virtual ~VerticalSpineBendingController() { }
 
   /**
-   * Apply the Bending controller. On setup, adjust the cable
-   * lengths one time.
+   * Apply the Bending controller. On setup, find the bodies and
+   * cables to linearize.
    * @param[in] subject - the SpineModel that is being controlled. Must
    * have a list of allMuscles populated
    */
@@ -98,6 +106,19 @@ private:
    double state;
    double updateTime;
 
+  /**
+   * The fraction of dL that keeps the predicted change in angular
+   * acceleration within m_maxAngularAcceleration
+   * @param[in] deltaA, deltaB, the changes in rest length planned
+   * for the vertical a and b cables
+   */
+  double stepFraction(VerticalSpineModel& subject, double deltaA,
+                      double deltaB);
+
+  const double m_maxAngularAcceleration;
+
+  tgLinearizer m_linearizer;
+
   // For data logging. TO-DO: implement this fully.
   tgDataObserver m_dataObserver;
   double m_updateTime;
@@ -30,6 +30,7 @@
 #include "examples/IROS_2015/TetraSpineStatic/TetraSpineStaticModel_hf.h"
 #include "LearningSpineSine.h"
 // This library
+#include "controllers/tgTrajectoryController.h"
 #include "core/tgModel.h"
 #include "core/tgSimView.h"
 #include "core/tgSimViewGraphics.h"
@@ -43,7 +44,8 @@
  * The entry point.
  * @param[in] argc the number of command-line arguments
  * @param[in] argv argv[0] is the executable name; argv[1], if supplied, is the
- * suffix for the controller
+ * suffix for the controller; argv[2], if supplied, is a table of rest lengths
+ * recorded on the hardware, which is played back once instead of learning
  * @return 0
  */
 int main(int argc, char** argv)
@@ -70,6 +72,17 @@ int main(int argc, char** argv)
     
     /* Required for setting up learning file input/output. */
     const std::string suffix((argc > 1) ? argv[1] : "default");
+
+    if (argc > 2)
+    {
+        // Each column's tags name muscles, such as "outer right seg1"
+        tgTrajectoryController<BaseSpineModelLearning>* const myPlayback =
+          new tgTrajectoryController<BaseSpineModelLearning>(argv[2]);
+        myModel->attach(myPlayback);
+        simulation.addModel(myModel);
+        simulation.run(static_cast<int>(myPlayback->getDuration() / stepSize) + 1);
+        return 0;
+    }
     
         const int segmentSpan = 3;
     const int numMuscles = 6;
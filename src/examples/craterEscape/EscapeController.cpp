@@ -81,7 +81,10 @@ void EscapeController::onSetup(EscapeModel& subject)
     }
 
     populateClusters(subject);
+    m_muscleGroup = tgActuatorGroup(muscles);
+    m_targetLengths.resize(muscles.size());
     initPosition = subject.getBallCOM();
+    m_metrics.setup(subject);
     setupAdapter();
     initializeSineWaves(); // For muscle actuation
 
@@ -105,7 +108,8 @@ void EscapeController::onStep(EscapeModel& subject, double dt)
     m_totalTime+=dt;
 
     setPreferredMuscleLengths(subject, dt);
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles =
+        m_muscleGroup.getBasicActuators();
     
     //Move motors for all the muscles
     for (size_t i = 0; i < muscles.size(); ++i)
@@ -114,6 +118,8 @@ void EscapeController::onStep(EscapeModel& subject, double dt)
         assert(pMuscle != NULL);
         pMuscle->moveMotors(dt);
     }
+
+    m_metrics.step(dt);
 }
 
 // So far, only score used for eventual fitness calculation of an Escape Model
@@ -121,7 +127,8 @@ void EscapeController::onStep(EscapeModel& subject, double dt)
 void EscapeController::onTeardown(EscapeModel& subject) {
     std::vector<double> scores; //scores[0] == displacement, scores[1] == energySpent
     double distance = displacement(subject);
-    double energySpent = totalEnergySpent(subject);
+    // Negative, as when it was summed from the muscle histories
+    double energySpent = -m_metrics.getResults().work;
 
     //Invariant: For now, scores must be of size 2 (as required by endEpisode())
     scores.push_back(distance);
@@ -216,46 +223,17 @@ void EscapeController::setupAdapter() {
     evolutionAdapter.initialize(evo, isLearning, configEvolutionAdapter);
 }
 
-double EscapeController::totalEnergySpent(EscapeModel& subject) {
-    double totalEnergySpent=0;
-
-    std::vector<tgBasicActuator* > tmpStrings = subject.getAllMuscles();
-    for(int i=0; i<tmpStrings.size(); i++)
-    {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-
-        for(int j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power         
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
-    }
-    return totalEnergySpent;
-}
-
 // Pre-condition: every element in muscles must be defined
 // Post-condition: every muscle will have a new target length
 void EscapeController::setPreferredMuscleLengths(EscapeModel& subject, double dt) {
     double phase = 0; // Phase of cluster1
     
-    int nMuscles = 24;
+    int nMuscles = m_targetLengths.size();
     int oldCluster = 0;
     int cluster = 0;
 
     for(int iMuscle=0; iMuscle < nMuscles; iMuscle++) {
 
-        const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
-        tgBasicActuator *const pMuscle = muscles[iMuscle];
-
-        assert(pMuscle != NULL);
-
         // Determine cluster
         oldCluster = cluster;
         if (iMuscle < 4) {
@@ -284,11 +262,12 @@ void EscapeController::setPreferredMuscleLengths(EscapeModel& subject, double dt
         } else if (newLength >= maxLength) {
             newLength = maxLength;
         }
-        pMuscle->setControlInput(newLength, dt);
+        m_targetLengths[iMuscle] = newLength;
         if (oldCluster != cluster) {
             phase += phaseChange[cluster];
         }
     }
+    m_muscleGroup.setRestLengths(m_targetLengths, dt);
 
     /*
     for(int cluster=0; cluster<nClusters; cluster++) {
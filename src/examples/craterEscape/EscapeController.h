@@ -29,6 +29,8 @@
 
 #include <vector>
 
+#include "core/tgActuatorGroup.h"
+#include "core/tgFitnessMetrics.h"
 #include "core/tgObserver.h"
 #include "learning/Adapters/AnnealAdapter.h"
 #include "learning/Configuration/configuration.h"
@@ -72,11 +74,18 @@ class EscapeController : public tgObserver<EscapeModel>
         AnnealAdapter evolutionAdapter;
         std::vector< std::vector<double> > actions; // For modifications between episodes
 
+        /** Energy spent by the muscles, accumulated every step */
+        tgFitnessMetrics m_metrics;
+
         // Muscle Clusters
         int nClusters;
         int musclesPerCluster;
         /** A vector clusters, each of which contains a vector of muscles */
         std::vector<std::vector<tgBasicActuator*> > clusters; 
+        /** All muscles, in getAllMuscles order, driven in one call */
+        tgActuatorGroup m_muscleGroup;
+        /** Target lengths handed to m_muscleGroup each step */
+        std::vector<double> m_targetLengths;
 
         // Sine Wave Data
         double* amplitude;
@@ -92,9 +101,6 @@ class EscapeController : public tgObserver<EscapeModel>
         /** Initialize the evolution adapter as well as its own parameters */
         void setupAdapter();
 
-        /** Returns amount of energy spent by each muscle in subject */
-        double totalEnergySpent(EscapeModel& subject);
-
         /** Sets target lengths for each muscle */
         void setPreferredMuscleLengths(EscapeModel& subject, double dt);
 
@@ -116,8 +116,31 @@ SerializedSineWaves::~SerializedSineWaves()
 {
 }
 
-void SerializedSineWaves::applyImpedanceControlInside(const std::vector<tgSpringCableActuator*> stringList,
-                                                            double dt,
+namespace
+{
+    /** The muscle sets, in the order onStep computes their targets */
+    const char* const muscleSets[] = {
+        "inner top", "inner left", "inner right",
+        "outer top", "outer left", "outer right"
+    };
+}
+
+void SerializedSineWaves::onSetup(BaseSpineModelLearning& subject)
+{
+    std::vector<tgBasicActuator*> muscles;
+    for (std::size_t i = 0; i < 6; i++)
+    {
+        const std::vector<tgBasicActuator*> muscleSet =
+            tgCast::filter<tgSpringCableActuator, tgBasicActuator>
+                (subject.getMuscles(muscleSets[i]));
+        muscles.insert(muscles.end(), muscleSet.begin(), muscleSet.end());
+    }
+    m_muscleGroup = tgActuatorGroup(muscles);
+    m_targetLengths.clear();
+    m_targetLengths.reserve(muscles.size());
+}
+
+void SerializedSineWaves::applyImpedanceControlInside(const std::vector<tgSpringCableActuator*>& stringList,
                                                             std::size_t phase)
 {
     std::vector<tgBasicActuator* > stringList_ba = tgCast::filter<tgSpringCableActuator, tgBasicActuator>(stringList);
@@ -129,21 +152,14 @@ void SerializedSineWaves::applyImpedanceControlInside(const std::vector<tgSpring
         target = m_config.offsetSpeed + cycle*m_config.cpgAmplitude;
         
 		
-        double setTension = m_config.in_controller->control(*(stringList_ba[i]),
-																dt,
+        m_targetLengths.push_back(m_config.in_controller->restLength(*(stringList_ba[i]),
 																m_config.insideLength,
 																m_config.insideMod * target
-																);
-        #if (0) // Conditional compile for verbose control
-        std::cout << "Inside String " << i << " tension " << setTension
-        << " act tension " << stringList[i]->getMuscle()->getTension()
-        << " length " << stringList[i]->getMuscle()->getActualLength() << std::endl;
-        #endif
+																));
     }    
 }
 
-void SerializedSineWaves::applyImpedanceControlOutside(const std::vector<tgSpringCableActuator*> stringList,
-                                                            double dt,
+void SerializedSineWaves::applyImpedanceControlOutside(const std::vector<tgSpringCableActuator*>& stringList,
                                                             std::size_t phase)
 {
     std::vector<tgBasicActuator* > stringList_ba = tgCast::filter<tgSpringCableActuator, tgBasicActuator>(stringList);
@@ -154,16 +170,10 @@ void SerializedSineWaves::applyImpedanceControlOutside(const std::vector<tgSprin
         cycle = sin(simTime * m_config.cpgFrequency + 2 * m_config.bodyWaves * M_PI * i / (segments) + m_config.phaseOffsets[phase]);
         target = m_config.offsetSpeed + cycle*m_config.cpgAmplitude;
         
-        double setTension = m_config.out_controller->control(*( stringList_ba[i]),
-																dt,
+        m_targetLengths.push_back(m_config.out_controller->restLength(*( stringList_ba[i]),
 																m_config.outsideLength,
 																target
-																);
-        #if(0) // Conditional compile for verbose control
-        std::cout << "Outside String " << i << " com tension " << setTension
-        << " act tension " << stringList[i]->getMuscle()->getTension()
-        << " length " << stringList[i]->getMuscle()->getActualLength() << std::endl;
-        #endif
+																));
     }    
 }
 
@@ -180,14 +190,15 @@ void SerializedSineWaves::onStep(BaseSpineModelLearning& subject, double dt)
 	
 	segments = subject.getSegments();
 	
-	applyImpedanceControlInside(subject.getMuscles("inner top"), dt, 0);
-	applyImpedanceControlInside(subject.getMuscles("inner left") , dt, 1);
-	applyImpedanceControlInside(subject.getMuscles("inner right"), dt, 2);
+	// Same order as the group built in onSetup
+	m_targetLengths.clear();
+	applyImpedanceControlInside(subject.getMuscles(muscleSets[0]), 0);
+	applyImpedanceControlInside(subject.getMuscles(muscleSets[1]), 1);
+	applyImpedanceControlInside(subject.getMuscles(muscleSets[2]), 2);
 	
-	applyImpedanceControlOutside(subject.getMuscles("outer top"), dt, 0);
-	applyImpedanceControlOutside(subject.getMuscles("outer left"), dt, 1);
-	applyImpedanceControlOutside(subject.getMuscles("outer right"), dt, 2);
+	applyImpedanceControlOutside(subject.getMuscles(muscleSets[3]), 0);
+	applyImpedanceControlOutside(subject.getMuscles(muscleSets[4]), 1);
+	applyImpedanceControlOutside(subject.getMuscles(muscleSets[5]), 2);
 
+	m_muscleGroup.setRestLengths(m_targetLengths, dt);
 }
-    
-
@@ -29,6 +29,7 @@
 
 // NTRTSim
 #include "core/tgObserver.h"
+#include "core/tgActuatorGroup.h"
 
 // The C++ Standard Library
 #include <vector>
@@ -107,32 +108,39 @@ public:
     ~SerializedSineWaves();
     
     /**
-     * Applies the impedance controllers using a velocity setpoint of 0.
+     * Builds the group of all six muscle sets, in the order onStep
+     * computes their targets
+     * @param[in] subject - the TetraSpineLearningModel that is being
+     * controlled. Subject must have a MuscleMap populated
+     */
+    virtual void onSetup(BaseSpineModelLearning& subject);
+    
+    /**
+     * Appends the rest lengths the inside impedance controller wants
+     * to m_targetLengths, using a velocity setpoint of 0.
      * Called during this classes onStep function.
      * @param[in] stringList a std::vector of strings taken from the
      * subject's MuscleMap
-     * @param[in] dt - a timestep. Must be positive.
      * @param[in] phase - reads the index out of the phaseOffsets vector
      */
-    void applyImpedanceControlInside(const std::vector<tgSpringCableActuator*> stringList,
-                                                            double dt,
+    void applyImpedanceControlInside(const std::vector<tgSpringCableActuator*>& stringList,
                                                             std::size_t phase);
     /**
-     * Applies the impedance controllers using a velocity setpoint determined.
-     * by the phase parameter and 
+     * Appends the rest lengths the outside impedance controller wants
+     * to m_targetLengths, using a velocity setpoint determined
+     * by the phase parameter.
      * Called during this classes onStep function.
      * @param[in] stringList a std::vector of strings taken from the
      * subject's MuscleMap
-     * @param[in] dt - a timestep. Must be positive.
      * @param[in] phase - reads the index out of the phaseOffsets vector
      */                                    
-    void applyImpedanceControlOutside(const std::vector<tgSpringCableActuator*> stringList,
-                                    double dt,
+    void applyImpedanceControlOutside(const std::vector<tgSpringCableActuator*>& stringList,
                                     std::size_t phase);
     
     /**
      * Apply the sineWave controller. Called my notifyStep(dt) of its
-     * subject. Calls the applyImpedanceControl functions of this class
+     * subject. Calls the applyImpedanceControl functions of this class,
+     * then moves all of the muscles at once
      * @param[in] subject - the TetraSpineLearningModel that is being 
      * Subject must have a MuscleMap populated
      * @param[in] dt, current timestep must be positive
@@ -154,6 +162,12 @@ private:
     double updateTime;
     double cycle;
     double target;
+    
+    /** The basic actuators of the six muscle sets, built in onSetup */
+    tgActuatorGroup m_muscleGroup;
+    
+    /** Rest lengths for m_muscleGroup, refilled each step */
+    std::vector<double> m_targetLengths;
 };
 
 #endif // MY_MODEL_CONTROLLER_H
@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef CMAESADAPTER_H_
+#define CMAESADAPTER_H_
+
+/**
+ * @file CMAESAdapter.h
+ * @brief Defines a class CMAESAdapter to pass parameters from CMAESEvolution to a controller.
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include <vector>
+#include "learning/CMAESEvolution/CMAESEvolution.h"
+#include "learning/Configuration/configuration.h"
+
+/**
+ * A drop in replacement for AnnealAdapter: the controller gets a vector
+ * of parameters per controller, scaled 0.0 to 1.0, from step()
+ */
+class CMAESAdapter
+{
+public:
+    CMAESAdapter();
+    ~CMAESAdapter();
+    /**
+     * Initialize needs to be called at the beginning of each trial
+     * For NTRT this means main or simulator needs to own the pointer to
+     * CMAESEvolution, we can't create it here
+     */
+    void initialize(CMAESEvolution *evo,bool isLearning,configuration config);
+    std::vector<std::vector<double> > step(double deltaTimeSeconds, std::vector<double> state);
+    void endEpisode(std::vector<double> state);
+
+private:
+    CMAESEvolution *cmaesEvo;
+    std::vector< std::vector<double> > currentControllers;
+    bool learning;
+    double totalTime;
+};
+
+#endif /* CMAESADAPTER_H_ */
@@ -27,6 +27,8 @@
  
 #include "AnnealEvolution.h"
 #include "learning/Configuration/configuration.h"
+#include "learning/EvaluationCache/EvaluationCache.h"
+#include "learning/ResultsStore/ResultsStore.h"
 #include "core/tgString.h"
 #include "helpers/FileHelpers.h"
 #include <iostream>
@@ -55,7 +57,11 @@ unsigned long long rdtsc(){
 
 AnnealEvolution::AnnealEvolution(std::string suff, std::string config, std::string path) :
 suffix(suff),
-Temp(1.0)
+Temp(1.0),
+selectedSubtest(0),
+evaluationCache(NULL),
+resultsStore(NULL),
+trialStart(0)
 {
     currentTest=0;
     subTests = 0;
@@ -84,9 +90,12 @@ Temp(1.0)
     seeded = myconfigdataaa.getintvalue("startSeed");
     
     bool learning = myconfigdataaa.getintvalue("learning");
+    scenario = myconfigdataaa.iskey("scenarioID") ?
+        myconfigdataaa.getStringValue("scenarioID") : suffix;
 
     srand(rdtsc());
-    eng.seed(rdtsc());
+    seed = rdtsc();
+    eng.seed(seed);
 
     for(int j=0;j<numberOfControllers;j++)
     {
@@ -111,11 +120,19 @@ Temp(1.0)
         {
 			throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
 		}
+
+        // Optional: skip candidates that were already simulated
+        evaluationCache = EvaluationCache::create(myconfigdataaa, scenario, numberOfSubtests,
+            resourcePath + "logs/evaluationCache-" + suffix + ".csv");
+        resultsStore = ResultsStore::create(myconfigdataaa,
+            resourcePath + "logs/results-" + suffix + ".trials");
     }
 }
 
 AnnealEvolution::~AnnealEvolution()
 {
+    delete evaluationCache;
+    delete resultsStore;
     // @todo - solve the invalid pointer that occurs here
     #if (0)
     for(std::size_t i = 0; i < populations.size(); i++)
@@ -185,6 +202,26 @@ double diffclock(clock_t clock1,clock_t clock2)
 #endif
 
 vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
+{
+    selectControllers();
+    if(evaluationCache)
+    {
+        // Hand back the scores of candidates that were simulated before.
+        // A population's worth at most, in case every candidate is known
+        const int maxReplays = populationSize * static_cast<int>(evaluationCache->getSamples());
+        vector<double> scores;
+        for(int i = 0; i < maxReplays &&
+            evaluationCache->lookup(selectedParameters(), selectedSubtest, scores); i++)
+        {
+            recordScores(scores);
+            selectControllers();
+        }
+    }
+    trialStart = std::clock();
+    return selectedControllers;
+}
+
+void AnnealEvolution::selectControllers()
 {
     int testsToDo=0;
     if(coevolution)
@@ -219,6 +256,7 @@ vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
         selectedControllers.push_back(populations.at(i)->getMember(selectedOne));
     }
     
+    selectedSubtest = subTests;
     subTests++;
     
     if (subTests == numberOfSubtests)
@@ -227,11 +265,33 @@ vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
         subTests = 0;
     }
 //  cout<<"currentTest:"<<currentTest<<endl;
+}
 
-    return selectedControllers;
+vector< vector<double> > AnnealEvolution::selectedParameters() const
+{
+    vector< vector<double> > parameters;
+    for(std::size_t i=0;i<selectedControllers.size();i++)
+    {
+        parameters.push_back(selectedControllers[i]->statelessParameters);
+    }
+    return parameters;
 }
 
 void AnnealEvolution::updateScores(vector <double> multiscore)
+{
+    if(evaluationCache)
+    {
+        evaluationCache->store(selectedParameters(), multiscore);
+    }
+    if(resultsStore)
+    {
+        resultsStore->append(ResultsStore::Trial(scenario, generationNumber, seed,
+            trialStart, selectedParameters(), multiscore));
+    }
+    recordScores(multiscore);
+}
+
+void AnnealEvolution::recordScores(vector <double> multiscore)
 {
     if(multiscore.size()==2)
         this->scoresOfTheGeneration.push_back(multiscore);
@@ -30,9 +30,14 @@
 
 #include "AnnealEvoPopulation.h"
 #include "AnnealEvoMember.h"
+#include <ctime>
 #include <fstream>
 #include <boost/iterator/iterator_concepts.hpp>
 
+// Forward declarations
+class EvaluationCache;
+class ResultsStore;
+
 class AnnealEvolution
 {
 public:
@@ -48,6 +53,13 @@ public:
     std::string resourcePath;
     
 private:
+    /// Start the next generation if due, and select the next candidate
+    void selectControllers();
+    /// The parameters of the selected controllers, for the cache
+    std::vector< std::vector<double> > selectedParameters() const;
+    /// Credit scores to the selected controllers and log them
+    void recordScores(std::vector<double> multiscore);
+
     int populationSize;
     int numberOfControllers;
     std::tr1::ranlux64_base_01 eng;
@@ -68,6 +80,18 @@ private:
     int numberOfElementsToMutate;
     int numberOfSubtests;
     int subTests;
+    /// The subtest the selected controllers are being tested in
+    int selectedSubtest;
+    /// NULL unless evaluationCache is set in the config
+    EvaluationCache* evaluationCache;
+    /// NULL unless resultsStore is set in the config
+    ResultsStore* resultsStore;
+    /// Identifies the scenario in the cache and the results store
+    std::string scenario;
+    /// The seed of eng
+    unsigned long long seed;
+    /// When the trial of the selected controllers began
+    std::clock_t trialStart;
 };
 
 #endif /* ANNEALEVOLUTION_H_ */
@@ -0,0 +1,584 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file CMAESEvolution.cpp
+ * @brief Contains the implementation of class CMAESEvolution.
+ * Covariance matrix adaptation evolution strategy
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include "CMAESEvolution.h"
+#include "learning/Configuration/configuration.h"
+#include "learning/ResultsStore/ResultsStore.h"
+#include "helpers/FileHelpers.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace
+{
+    // Distinct seeds for runs started at the same time
+    unsigned long long timeStampCounter()
+    {
+#ifdef _WIN32
+        return __rdtsc();
+#else
+        unsigned int lo,hi;
+        __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+        return ((unsigned long long)hi << 32) | lo;
+#endif
+    }
+
+    // For sorting candidates best first
+    bool compareScores(const pair<double, std::size_t>& a,
+                       const pair<double, std::size_t>& b)
+    {
+        return a.first > b.first;
+    }
+}
+
+CMAESEvolution::CMAESEvolution(std::string suff, std::string config, std::string path) :
+suffix(suff),
+eigenGeneration(0),
+currentCandidate(0),
+subTests(0),
+bestScore(0.0),
+seed(0),
+generationNumber(0),
+resultsStore(NULL),
+trialStart(0)
+{
+    if (path != "")
+    {
+        resourcePath = FileHelpers::getResourcePath(path);
+    }
+    else
+    {
+        resourcePath = "";
+    }
+
+    configuration myconfigdataaa;
+    myconfigdataaa.readFile(resourcePath + config);
+    numberOfControllers = myconfigdataaa.getintvalue("numberOfControllers");
+    numberOfActions = myconfigdataaa.getintvalue("numberOfActions");
+    numberOfSubtests = std::max(myconfigdataaa.getintvalue("numberOfSubtests"), 1);
+    const int populationSize = myconfigdataaa.getintvalue("populationSize");
+    sigma = myconfigdataaa.iskey("stepSize") ?
+        myconfigdataaa.getDoubleValue("stepSize") : 0.3;
+    const bool seeded = myconfigdataaa.getintvalue("startSeed");
+    const bool learning = myconfigdataaa.getintvalue("learning");
+    scenario = myconfigdataaa.iskey("scenarioID") ?
+        myconfigdataaa.getStringValue("scenarioID") : suffix;
+
+    if (numberOfControllers <= 0 || numberOfActions <= 0)
+    {
+        throw std::invalid_argument("CMA-ES needs at least one parameter");
+    }
+    else if (sigma <= 0.0)
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+
+    // Strategy parameters from Hansen's tutorial defaults
+    n = numberOfControllers * numberOfActions;
+    const double N = static_cast<double>(n);
+    lambda = populationSize > 0 ? populationSize :
+        4 + static_cast<std::size_t>(3.0 * std::log(N));
+    if (lambda < 2)
+    {
+        throw std::invalid_argument("CMA-ES needs a population of at least two");
+    }
+    mu = lambda / 2;
+    weights.resize(mu);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < mu; i++)
+    {
+        weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+        sum += weights[i];
+    }
+    double sumSquares = 0.0;
+    for (std::size_t i = 0; i < mu; i++)
+    {
+        weights[i] /= sum;
+        sumSquares += weights[i] * weights[i];
+    }
+    mueff = 1.0 / sumSquares;
+
+    cc = (4.0 + mueff / N) / (N + 4.0 + 2.0 * mueff / N);
+    cs = (mueff + 2.0) / (N + mueff + 5.0);
+    c1 = 2.0 / ((N + 1.3) * (N + 1.3) + mueff);
+    cmu = std::min(1.0 - c1,
+                   2.0 * (mueff - 2.0 + 1.0 / mueff) /
+                   ((N + 2.0) * (N + 2.0) + mueff));
+    damps = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (N + 1.0)) - 1.0) + cs;
+    chiN = std::sqrt(N) * (1.0 - 1.0 / (4.0 * N) + 1.0 / (21.0 * N * N));
+
+    mean.assign(n, 0.5);
+    pc.assign(n, 0.0);
+    ps.assign(n, 0.0);
+    C.assign(n * n, 0.0);
+    B.assign(n * n, 0.0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        C[i * n + i] = 1.0;
+        B[i * n + i] = 1.0;
+    }
+    D.assign(n, 1.0);
+    bestCandidate = mean;
+
+    seed = timeStampCounter();
+    eng.seed(seed);
+
+    // Start the search from the best parameters of an earlier run
+    if (seeded)
+    {
+        const vector< vector<double> > seed = loadBestControllers();
+        for (std::size_t i = 0; i < seed.size(); i++)
+        {
+            std::copy(seed[i].begin(), seed[i].end(),
+                      mean.begin() + i * numberOfActions);
+        }
+    }
+    if (learning)
+    {
+        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),ios::out);
+        if (!evolutionLog.is_open())
+        {
+            throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
+        }
+        resultsStore = ResultsStore::create(myconfigdataaa,
+            resourcePath + "logs/results-" + suffix + ".trials");
+    }
+
+    assert(invariant());
+}
+
+CMAESEvolution::~CMAESEvolution()
+{
+    delete resultsStore;
+}
+
+vector< vector<double> > CMAESEvolution::nextSetOfControllers()
+{
+    if (candidates.empty())
+    {
+        sampleGeneration();
+    }
+    else if (currentCandidate == lambda)
+    {
+        vector<double> scores(lambda);
+        for (std::size_t k = 0; k < lambda; k++)
+        {
+            scores[k] = scoreSums[k] / numberOfSubtests;
+        }
+        updateGeneration(scores);
+        sampleGeneration();
+    }
+    trialStart = std::clock();
+    return candidateControllers(currentCandidate);
+}
+
+void CMAESEvolution::updateScores(vector<double> multiscore)
+{
+    if (candidates.empty() || currentCandidate == lambda)
+    {
+        throw std::runtime_error("No candidate to score");
+    }
+    if (multiscore.size() < 2)
+    {
+        multiscore.resize(2, -1.0);
+    }
+
+    //Record it to the file
+    ofstream payloadLog;
+    payloadLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
+    payloadLog<<multiscore[0]<<","<<multiscore[1];
+    const double* const x = &candidates[currentCandidate * n];
+    for (std::size_t i = 0; i < n; i++)
+    {
+        payloadLog << "," << x[i];
+    }
+    payloadLog<<endl;
+    payloadLog.close();
+
+    if (resultsStore)
+    {
+        resultsStore->append(ResultsStore::Trial(scenario, generationNumber, seed,
+            trialStart, vector< vector<double> >(1, vector<double>(x, x + n)),
+            multiscore));
+    }
+
+    scoreSums[currentCandidate] += multiscore[0];
+    subTests++;
+    if (subTests == numberOfSubtests)
+    {
+        currentCandidate++;
+        subTests = 0;
+    }
+}
+
+vector< vector< vector<double> > > CMAESEvolution::nextGeneration()
+{
+    sampleGeneration();
+    vector< vector< vector<double> > > generation(lambda);
+    for (std::size_t k = 0; k < lambda; k++)
+    {
+        generation[k] = candidateControllers(k);
+    }
+    // Not for the sequential interface
+    currentCandidate = lambda;
+    return generation;
+}
+
+void CMAESEvolution::updateGeneration(const vector<double>& scores)
+{
+    if (candidates.empty() || scores.size() != lambda)
+    {
+        throw std::invalid_argument("Need one score per candidate of the generation");
+    }
+    logGeneration(scores);
+
+    vector< pair<double, std::size_t> > order(lambda);
+    for (std::size_t k = 0; k < lambda; k++)
+    {
+        order[k] = make_pair(scores[k], k);
+    }
+    std::sort(order.begin(), order.end(), compareScores);
+
+    // Steps of the best mu candidates from the old mean, in units of sigma
+    vector<double> steps(mu * n);
+    vector<double> meanStep(n, 0.0);
+    for (std::size_t i = 0; i < mu; i++)
+    {
+        const double* const x = &candidates[order[i].second * n];
+        double* const y = &steps[i * n];
+        for (std::size_t j = 0; j < n; j++)
+        {
+            y[j] = (x[j] - mean[j]) / sigma;
+            meanStep[j] += weights[i] * y[j];
+        }
+    }
+    for (std::size_t j = 0; j < n; j++)
+    {
+        mean[j] += sigma * meanStep[j];
+    }
+
+    // ps follows C^-1/2 meanStep = B D^-1 B^T meanStep
+    vector<double> rotated(n, 0.0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            rotated[j] += B[i * n + j] * meanStep[i];
+        }
+    }
+    for (std::size_t j = 0; j < n; j++)
+    {
+        rotated[j] /= D[j];
+    }
+    const double csFactor = std::sqrt(cs * (2.0 - cs) * mueff);
+    double psNorm = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double* const row = &B[i * n];
+        double whitened = 0.0;
+        for (std::size_t j = 0; j < n; j++)
+        {
+            whitened += row[j] * rotated[j];
+        }
+        ps[i] = (1.0 - cs) * ps[i] + csFactor * whitened;
+        psNorm += ps[i] * ps[i];
+    }
+    psNorm = std::sqrt(psNorm);
+
+    generationNumber++;
+    const double N = static_cast<double>(n);
+    const bool hsig = psNorm /
+        std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * generationNumber)) / chiN <
+        1.4 + 2.0 / (N + 1.0);
+    const double ccFactor = hsig ? std::sqrt(cc * (2.0 - cc) * mueff) : 0.0;
+    for (std::size_t j = 0; j < n; j++)
+    {
+        pc[j] = (1.0 - cc) * pc[j] + ccFactor * meanStep[j];
+    }
+
+    // Rank one and rank mu updates, on the upper triangle then mirrored
+    const double decay = 1.0 - c1 - cmu +
+        (hsig ? 0.0 : c1 * cc * (2.0 - cc));
+    for (std::size_t i = 0; i < n; i++)
+    {
+        double* const row = &C[i * n];
+        for (std::size_t j = i; j < n; j++)
+        {
+            row[j] = decay * row[j] + c1 * pc[i] * pc[j];
+        }
+    }
+    for (std::size_t k = 0; k < mu; k++)
+    {
+        const double* const y = &steps[k * n];
+        const double w = cmu * weights[k];
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double wy = w * y[i];
+            double* const row = &C[i * n];
+            for (std::size_t j = i; j < n; j++)
+            {
+                row[j] += wy * y[j];
+            }
+        }
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = i + 1; j < n; j++)
+        {
+            C[j * n + i] = C[i * n + j];
+        }
+    }
+
+    sigma *= std::exp((cs / damps) * (psNorm / chiN - 1.0));
+
+    // Decompose only as often as C changes appreciably: the tutorial
+    // counts evaluations, lambda per generation, since the last one
+    if (static_cast<double>((generationNumber - eigenGeneration) * lambda) >
+        lambda / (c1 + cmu) / N / 10.0)
+    {
+        decompose();
+        eigenGeneration = generationNumber;
+    }
+
+    candidates.clear();
+    currentCandidate = 0;
+    subTests = 0;
+
+    assert(invariant());
+}
+
+vector< vector<double> > CMAESEvolution::loadBestControllers() const
+{
+    vector< vector<double> > controllers;
+    for (int i = 0; i < numberOfControllers; i++)
+    {
+        stringstream ss;
+        ss << resourcePath << "logs/bestParameters-" << suffix << "-" << i << ".nnw";
+        controllers.push_back(loadFromFile(ss.str().c_str()));
+    }
+    return controllers;
+}
+
+void CMAESEvolution::sampleGeneration()
+{
+    std::tr1::normal_distribution<double> normal(0.0, 1.0);
+    candidates.resize(lambda * n);
+    scoreSums.assign(lambda, 0.0);
+    currentCandidate = 0;
+    subTests = 0;
+
+    vector<double> z(n);
+    for (std::size_t k = 0; k < lambda; k++)
+    {
+        // x = mean + sigma B D z
+        for (std::size_t j = 0; j < n; j++)
+        {
+            z[j] = D[j] * normal(eng);
+        }
+        double* const x = &candidates[k * n];
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double* const row = &B[i * n];
+            double y = 0.0;
+            for (std::size_t j = 0; j < n; j++)
+            {
+                y += row[j] * z[j];
+            }
+            const double newParam = mean[i] + sigma * y;
+            if(newParam < 0.0)
+                x[i] = 0.0;
+            else if(newParam > 1.0)
+                x[i] = 1.0;
+            else
+                x[i] = newParam;
+        }
+    }
+}
+
+void CMAESEvolution::decompose()
+{
+    // Rotate a copy of C to diagonal; B accumulates the rotations
+    vector<double> a(C);
+    B.assign(n * n, 0.0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        B[i * n + i] = 1.0;
+    }
+
+    for (int sweep = 0; sweep < 50; sweep++)
+    {
+        double offDiagonal = 0.0;
+        double diagonal = 0.0;
+        for (std::size_t p = 0; p < n; p++)
+        {
+            diagonal += a[p * n + p] * a[p * n + p];
+            for (std::size_t q = p + 1; q < n; q++)
+            {
+                offDiagonal += a[p * n + q] * a[p * n + q];
+            }
+        }
+        if (offDiagonal <= 1.0e-24 * diagonal)
+        {
+            break;
+        }
+
+        for (std::size_t p = 0; p < n; p++)
+        {
+            for (std::size_t q = p + 1; q < n; q++)
+            {
+                const double apq = a[p * n + q];
+                if (apq == 0.0)
+                {
+                    continue;
+                }
+                const double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+                const double t = (theta >= 0.0 ? 1.0 : -1.0) /
+                    (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+                for (std::size_t k = 0; k < n; k++)
+                {
+                    const double akp = a[k * n + p];
+                    const double akq = a[k * n + q];
+                    a[k * n + p] = c * akp - s * akq;
+                    a[k * n + q] = s * akp + c * akq;
+                }
+                for (std::size_t k = 0; k < n; k++)
+                {
+                    const double apk = a[p * n + k];
+                    const double aqk = a[q * n + k];
+                    a[p * n + k] = c * apk - s * aqk;
+                    a[q * n + k] = s * apk + c * aqk;
+                }
+                for (std::size_t k = 0; k < n; k++)
+                {
+                    const double bkp = B[k * n + p];
+                    const double bkq = B[k * n + q];
+                    B[k * n + p] = c * bkp - s * bkq;
+                    B[k * n + q] = s * bkp + c * bkq;
+                }
+            }
+        }
+    }
+
+    // Rounding can leave tiny negative eigenvalues
+    for (std::size_t i = 0; i < n; i++)
+    {
+        D[i] = std::sqrt(std::max(a[i * n + i], 1.0e-20));
+    }
+}
+
+vector< vector<double> > CMAESEvolution::candidateControllers(std::size_t k) const
+{
+    assert(k < lambda);
+    vector< vector<double> > controllers(numberOfControllers);
+    const double* const x = &candidates[k * n];
+    for (int i = 0; i < numberOfControllers; i++)
+    {
+        controllers[i].assign(x + i * numberOfActions, x + (i + 1) * numberOfActions);
+    }
+    return controllers;
+}
+
+void CMAESEvolution::logGeneration(const vector<double>& scores)
+{
+    double aveScore = 0.0;
+    std::size_t best = 0;
+    for (std::size_t k = 0; k < lambda; k++)
+    {
+        aveScore += scores[k];
+        if (scores[k] > scores[best])
+        {
+            best = k;
+        }
+    }
+    aveScore /= lambda;
+
+    if (generationNumber == 0 || scores[best] > bestScore)
+    {
+        bestScore = scores[best];
+        bestCandidate.assign(candidates.begin() + best * n,
+                             candidates.begin() + (best + 1) * n);
+    }
+
+    evolutionLog<<(generationNumber + 1)*lambda<<","<<aveScore<<","<<scores[best]<<",";
+    evolutionLog<<bestScore<<","<<sigma<<endl;
+
+    for (int i = 0; i < numberOfControllers; i++)
+    {
+        stringstream ss;
+        ss << resourcePath << "logs/bestParameters-" << suffix << "-" << i << ".nnw";
+        ofstream bestParameters(ss.str().c_str());
+        for (int j = 0; j < numberOfActions; j++)
+        {
+            bestParameters << bestCandidate[i * numberOfActions + j];
+            if (j != numberOfActions - 1)
+                bestParameters << ",";
+        }
+    }
+}
+
+vector<double> CMAESEvolution::loadFromFile(const char* inputFilename) const
+{
+    ifstream ss(inputFilename);
+    if (!ss.is_open())
+    {
+        cout << "File of name " << inputFilename << " does not exist" << std::endl;
+        cout << "Try turning learning on in config.ini to generate parameters" << std::endl;
+        throw std::invalid_argument("Parameter file does not exist");
+    }
+    vector<double> parameters;
+    string value;
+    while (getline(ss, value, ','))
+    {
+        parameters.push_back(atof(value.c_str()));
+    }
+    if (parameters.size() != static_cast<std::size_t>(numberOfActions))
+    {
+        throw std::invalid_argument("Parameter file does not match numberOfActions");
+    }
+    return parameters;
+}
+
+bool CMAESEvolution::invariant() const
+{
+    return (n > 0) &&
+        (mu > 0) && (mu <= lambda) &&
+        (sigma > 0.0) &&
+        (mean.size() == n) &&
+        (C.size() == n * n) &&
+        (B.size() == n * n) &&
+        (D.size() == n);
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef CMAESEVOLUTION_H_
+#define CMAESEVOLUTION_H_
+
+/**
+ * @file CMAESEvolution.h
+ * @brief Contains the definition of class CMAESEvolution.
+ * Covariance matrix adaptation evolution strategy
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <tr1/random>
+
+// Forward declarations
+class ResultsStore;
+
+/**
+ * CMA-ES over the parameters of every controller at once, with the same
+ * config files and logs as AnnealEvolution. Each generation samples
+ * populationSize candidates from a multivariate normal distribution,
+ * then moves the mean toward the best half and adapts the step size and
+ * covariance to the steps that paid off. On the smooth, correlated
+ * landscapes of CPG parameters it needs far fewer trials than mutation
+ * alone.
+ *
+ * Parameters are scaled 0.0 to 1.0 like AnnealEvoMember's; samples
+ * outside that range are clamped, and the clamped values are what the
+ * distribution learns from.
+ *
+ * A generation can be evaluated one trial at a time through
+ * nextSetOfControllers() and updateScores(), which CMAESAdapter uses, or
+ * all at once: take nextGeneration(), simulate its candidates in
+ * parallel, and pass their scores to updateGeneration().
+ *
+ * Config keys, besides the ones shared with AnnealEvolution:
+ * - populationSize: candidates per generation; zero or less for the
+ * default of 4 + 3 ln(number of parameters)
+ * - stepSize: optional, the initial standard deviation, default 0.3
+ * - numberOfSubtests: trials averaged per candidate in the sequential
+ * interface
+ * - resultsStore: optional, record each trial of the sequential
+ * interface in logs/results-<suffix>.trials (see ResultsStore)
+ */
+class CMAESEvolution
+{
+public:
+    CMAESEvolution(std::string suffix, std::string config = "config.ini", std::string path = "");
+    ~CMAESEvolution();
+
+    /**
+     * The candidate to simulate next, as parameters per controller.
+     * Starts a new generation once the last one is scored.
+     */
+    std::vector< std::vector<double> > nextSetOfControllers();
+
+    /**
+     * Score the candidate from the last call of nextSetOfControllers()
+     * @param[in] scores, the first is maximized; an empty or single
+     * score means the trial failed
+     */
+    void updateScores(std::vector<double> scores);
+
+    /**
+     * Sample a whole generation, for evaluation in parallel. Any partly
+     * scored generation from nextSetOfControllers() is dropped.
+     * @return populationSize candidates, each parameters per controller
+     */
+    std::vector< std::vector< std::vector<double> > > nextGeneration();
+
+    /**
+     * Update the distribution from the generation of the last call to
+     * nextGeneration()
+     * @param[in] scores, one per candidate, higher is better
+     * @throw std::invalid_argument if there isn't a score per candidate
+     */
+    void updateGeneration(const std::vector<double>& scores);
+
+    /**
+     * The parameters saved by the best candidate of an earlier learning
+     * run, for running without learning
+     * @throw std::invalid_argument if a parameter file does not exist
+     */
+    std::vector< std::vector<double> > loadBestControllers() const;
+
+    const std::string suffix;
+    /// @todo make this const if we decide to force everyone to put their logs in resources
+    std::string resourcePath;
+
+private:
+    /// Draw the candidates of a generation into candidates
+    void sampleGeneration();
+
+    /// Eigendecomposition of C into B and D, by cyclic Jacobi
+    void decompose();
+
+    /// One candidate of candidates, split per controller
+    std::vector< std::vector<double> > candidateControllers(std::size_t k) const;
+
+    /// Log the generation and save the best candidate so far
+    void logGeneration(const std::vector<double>& scores);
+
+    std::vector<double> loadFromFile(const char* inputFilename) const;
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    int numberOfControllers;
+    int numberOfActions;
+    int numberOfSubtests;
+
+    /// Number of parameters, lambda and mu
+    std::size_t n;
+    std::size_t lambda;
+    std::size_t mu;
+
+    /// Recombination weights of the best mu candidates
+    std::vector<double> weights;
+    double mueff;
+
+    /// Learning rates and the step size damping
+    double cc;
+    double cs;
+    double c1;
+    double cmu;
+    double damps;
+    /// Expected length of a standard normal vector
+    double chiN;
+
+    double sigma;
+    std::vector<double> mean;
+    /// Evolution paths of the covariance and the step size
+    std::vector<double> pc;
+    std::vector<double> ps;
+    /// Covariance, and its eigenvectors by column, both n by n row major
+    std::vector<double> C;
+    std::vector<double> B;
+    /// Square roots of the eigenvalues of C
+    std::vector<double> D;
+    int eigenGeneration;
+
+    /// The current generation, lambda by n row major
+    std::vector<double> candidates;
+    /// Scores summed over the subtests of each candidate so far
+    std::vector<double> scoreSums;
+    std::size_t currentCandidate;
+    int subTests;
+
+    std::vector<double> bestCandidate;
+    double bestScore;
+
+    std::tr1::ranlux64_base_01 eng;
+    /// The seed of eng
+    unsigned long long seed;
+    std::ofstream evolutionLog;
+    int generationNumber;
+
+    /// NULL unless resultsStore is set in the config
+    ResultsStore* resultsStore;
+    /// Identifies the scenario in the results store
+    std::string scenario;
+    /// When the trial of the current candidate began
+    std::clock_t trialStart;
+};
+
+#endif /* CMAESEVOLUTION_H_ */
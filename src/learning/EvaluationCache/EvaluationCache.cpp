@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file EvaluationCache.cpp
+ * @brief Scores of candidates that were already simulated, by parameters
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include "EvaluationCache.h"
+#include "learning/Configuration/configuration.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+EvaluationCache::EvaluationCache(const std::string& scenario,
+                                 std::size_t samples,
+                                 const std::string& filename) :
+m_scenario(scenario),
+m_samples(samples),
+m_filename(filename)
+{
+    if (scenario.find(',') != std::string::npos)
+    {
+        throw std::invalid_argument("Scenario ID contains a comma");
+    }
+    else if (samples == 0)
+    {
+        throw std::invalid_argument("Cache must keep at least one sample");
+    }
+    load();
+}
+
+EvaluationCache* EvaluationCache::create(configuration& config,
+                                         const std::string& scenario,
+                                         int numberOfSubtests,
+                                         const std::string& filename)
+{
+    if (!config.iskey("evaluationCache") || !config.getintvalue("evaluationCache"))
+    {
+        return NULL;
+    }
+    const bool deterministic = config.iskey("deterministicScenario") &&
+        config.getintvalue("deterministicScenario");
+    const std::size_t samples = deterministic ? 1 : std::max(numberOfSubtests, 1);
+    return new EvaluationCache(scenario, samples, filename);
+}
+
+bool EvaluationCache::lookup(const std::vector< std::vector<double> >& parameters,
+                             std::size_t sample,
+                             std::vector<double>& scores) const
+{
+    unsigned long long key;
+    if (!hash(parameters, key))
+    {
+        return false;
+    }
+    const std::map<unsigned long long,
+                   std::vector< std::vector<double> > >::const_iterator it =
+        m_entries.find(key);
+    // Each subtest of a deterministic scenario gets the same scores
+    const std::size_t i = m_samples == 1 ? 0 : sample;
+    if (it == m_entries.end() || i >= it->second.size())
+    {
+        return false;
+    }
+    scores = it->second[i];
+    return true;
+}
+
+void EvaluationCache::store(const std::vector< std::vector<double> >& parameters,
+                            const std::vector<double>& scores)
+{
+    unsigned long long key;
+    if (!hash(parameters, key))
+    {
+        return;
+    }
+    std::vector< std::vector<double> >& stored = m_entries[key];
+    if (stored.size() >= m_samples)
+    {
+        return;
+    }
+    stored.push_back(scores);
+
+    if (!m_filename.empty())
+    {
+        std::ofstream cacheLog(m_filename.c_str(), std::ios::app);
+        // Keys are written in hex and scores at full precision
+        cacheLog << m_scenario << "," << std::hex << key << std::dec;
+        cacheLog.precision(17);
+        for (std::size_t i = 0; i < scores.size(); i++)
+        {
+            cacheLog << "," << scores[i];
+        }
+        cacheLog << std::endl;
+    }
+}
+
+bool EvaluationCache::hash(const std::vector< std::vector<double> >& parameters,
+                           unsigned long long& key) const
+{
+    const unsigned long long prime = 1099511628211ULL;
+    key = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < m_scenario.size(); i++)
+    {
+        key = (key ^ static_cast<unsigned char>(m_scenario[i])) * prime;
+    }
+    if (parameters.empty())
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < parameters.size(); i++)
+    {
+        const std::vector<double>& controller = parameters[i];
+        if (controller.empty())
+        {
+            return false;
+        }
+        // Separate controllers so their boundaries are part of the key
+        key = (key ^ controller.size()) * prime;
+        for (std::size_t j = 0; j < controller.size(); j++)
+        {
+            // Clamping can give -0.0, which should match 0.0
+            const double value = controller[j] == 0.0 ? 0.0 : controller[j];
+            unsigned char bytes[sizeof(double)];
+            std::memcpy(bytes, &value, sizeof(double));
+            for (std::size_t k = 0; k < sizeof(double); k++)
+            {
+                key = (key ^ bytes[k]) * prime;
+            }
+        }
+    }
+    return true;
+}
+
+void EvaluationCache::load()
+{
+    if (m_filename.empty())
+    {
+        return;
+    }
+    // A missing file just means nothing was cached yet
+    std::ifstream cacheLog(m_filename.c_str());
+    std::string line;
+    while (std::getline(cacheLog, line))
+    {
+        std::istringstream ss(line);
+        std::string scenario;
+        std::string key;
+        if (!std::getline(ss, scenario, ',') || scenario != m_scenario ||
+            !std::getline(ss, key, ','))
+        {
+            continue;
+        }
+        std::vector<double> scores;
+        std::string value;
+        while (std::getline(ss, value, ','))
+        {
+            scores.push_back(std::atof(value.c_str()));
+        }
+        unsigned long long hashed;
+        if (!(std::istringstream(key) >> std::hex >> hashed))
+        {
+            continue;
+        }
+        std::vector< std::vector<double> >& stored = m_entries[hashed];
+        if (stored.size() < m_samples)
+        {
+            stored.push_back(scores);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef EVALUATIONCACHE_H_
+#define EVALUATIONCACHE_H_
+
+/**
+ * @file EvaluationCache.h
+ * @brief Scores of candidates that were already simulated, by parameters
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class configuration;
+
+/**
+ * Remembers the scores each candidate (the parameters of every selected
+ * controller) got in a scenario, so the evolution engines can hand them
+ * back instead of simulating the same candidate again. Elites, members
+ * that mutate left unchanged and seeded members all repeat candidates.
+ *
+ * A deterministic scenario keeps one set of scores per candidate. A
+ * stochastic one keeps a sample per subtest, and a candidate is only
+ * skipped once it has been simulated that many times.
+ *
+ * Candidates are keyed by a hash of their parameters and the scenario ID.
+ * Entries are appended to a csv file as they are stored and read back
+ * when the cache is constructed, so they carry over between runs.
+ * Candidates with an empty parameter vector, such as those with neural
+ * networks, are never cached.
+ */
+class EvaluationCache
+{
+public:
+    /**
+     * @param[in] scenario, identifies the scenario; entries of other
+     * scenarios in the file are left alone. May not contain a comma.
+     * @param[in] samples, the scores to keep per candidate: one for a
+     * deterministic scenario, the number of subtests otherwise
+     * @param[in] filename, the file entries persist in; empty to keep
+     * them in memory only
+     * @throw std::invalid_argument if scenario has a comma or samples is
+     * zero
+     */
+    EvaluationCache(const std::string& scenario, std::size_t samples,
+                    const std::string& filename = "");
+
+    /**
+     * The cache an evolution engine's config asks for: none unless the
+     * evaluationCache key is set, else one sample per candidate if the
+     * deterministicScenario key is set and one per subtest otherwise
+     * @param[in] config, the engine's learning configuration
+     * @param[in] scenario, as for the constructor
+     * @param[in] numberOfSubtests, the subtests each candidate runs
+     * @param[in] filename, as for the constructor
+     * @return a new cache owned by the caller, or NULL
+     */
+    static EvaluationCache* create(configuration& config,
+                                   const std::string& scenario,
+                                   int numberOfSubtests,
+                                   const std::string& filename);
+
+    /**
+     * @param[in] parameters, the parameters of each selected controller
+     * @param[in] sample, the subtest the scores are wanted for
+     * @param[out] scores, the stored scores, if there are any
+     * @return true if the candidate has scores for this sample
+     */
+    bool lookup(const std::vector< std::vector<double> >& parameters,
+                std::size_t sample, std::vector<double>& scores) const;
+
+    /**
+     * Keep the scores of a simulated candidate, unless it already has
+     * as many samples as the scenario needs
+     */
+    void store(const std::vector< std::vector<double> >& parameters,
+               const std::vector<double>& scores);
+
+    std::size_t getSamples() const
+    {
+        return m_samples;
+    }
+
+private:
+    /**
+     * FNV-1a over the scenario and the bits of each parameter
+     * @return false if the candidate can't be cached
+     */
+    bool hash(const std::vector< std::vector<double> >& parameters,
+              unsigned long long& key) const;
+
+    /** Read the entries of this scenario from m_filename */
+    void load();
+
+    const std::string m_scenario;
+
+    const std::size_t m_samples;
+
+    const std::string m_filename;
+
+    std::map<unsigned long long, std::vector< std::vector<double> > > m_entries;
+};
+
+#endif /* EVALUATIONCACHE_H_ */
@@ -26,6 +26,8 @@
 
 #include "NeuroEvolution.h"
 #include "learning/Configuration/configuration.h"
+#include "learning/EvaluationCache/EvaluationCache.h"
+#include "learning/ResultsStore/ResultsStore.h"
 #include "core/tgString.h"
 #include "helpers/FileHelpers.h"
 // The C++ Standard Library
@@ -54,9 +56,14 @@ unsigned long long rdtsc(){
 #endif
 
 NeuroEvolution::NeuroEvolution(std::string suff, std::string config, std::string path) :
-suffix(suff)
+suffix(suff),
+selectedSubtest(0),
+evaluationCache(NULL),
+resultsStore(NULL),
+trialStart(0)
 {
 	currentTest=0;
+	subTests=0;
 	generationNumber=0;
 	if (path != "")
 	{
@@ -82,6 +89,8 @@ suffix(suff)
     seeded = myconfigdataaa.getintvalue("startSeed");
     
     bool learning = myconfigdataaa.getintvalue("learning");
+	scenario = myconfigdataaa.iskey("scenarioID") ?
+		myconfigdataaa.getStringValue("scenarioID") : suffix;
     
     if (populationSize < numberOfElementsToMutate + numberOfChildren)
     {
@@ -89,7 +98,8 @@ suffix(suff)
     }
     
    srand(rdtsc());
-	eng.seed(rdtsc());
+	seed = rdtsc();
+	eng.seed(seed);
 
 	for(int j=0;j<numberOfControllers;j++)
 	{
@@ -115,11 +125,19 @@ suffix(suff)
 		{
 			throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
 		}
+
+		// Optional: skip candidates that were already simulated
+		evaluationCache = EvaluationCache::create(myconfigdataaa, scenario, numberOfSubtests,
+			resourcePath + "logs/evaluationCache-" + suffix + ".csv");
+		resultsStore = ResultsStore::create(myconfigdataaa,
+			resourcePath + "logs/results-" + suffix + ".trials");
     }
 }
 
 NeuroEvolution::~NeuroEvolution()
 {
+	delete evaluationCache;
+	delete resultsStore;
 	// @todo - solve the invalid pointer that occurs here
 	#if (0)
 	for(std::size_t i = 0; i < populations.size(); i++)
@@ -192,6 +210,26 @@ double diffclock(clock_t clock1,clock_t clock2)
 }
 
 vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
+{
+	selectControllers();
+	if(evaluationCache)
+	{
+		// Hand back the scores of candidates that were simulated before.
+		// A population's worth at most, in case every candidate is known
+		const int maxReplays = populationSize * static_cast<int>(evaluationCache->getSamples());
+		vector<double> scores;
+		for(int i = 0; i < maxReplays &&
+			evaluationCache->lookup(selectedParameters(), selectedSubtest, scores); i++)
+		{
+			recordScores(scores);
+			selectControllers();
+		}
+	}
+	trialStart = std::clock();
+	return selectedControllers;
+}
+
+void NeuroEvolution::selectControllers()
 {
 	int testsToDo=0;
 	if(coevolution)
@@ -231,6 +269,7 @@ vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
 //		cout<<"selected: "<<selectedOne<<endl;
 		selectedControllers.push_back(populations.at(i)->getMember(selectedOne));
 	}
+    selectedSubtest = subTests;
     subTests++;
     
     if (subTests == numberOfSubtests)
@@ -239,11 +278,33 @@ vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
         subTests = 0;
     }
 //	cout<<"currentTest:"<<currentTest<<endl;
+}
 
-	return selectedControllers;
+vector< vector<double> > NeuroEvolution::selectedParameters() const
+{
+	vector< vector<double> > parameters;
+	for(std::size_t i=0;i<selectedControllers.size();i++)
+	{
+		parameters.push_back(selectedControllers[i]->statelessParameters);
+	}
+	return parameters;
 }
 
 void NeuroEvolution::updateScores(vector <double> multiscore)
+{
+	if(evaluationCache)
+	{
+		evaluationCache->store(selectedParameters(), multiscore);
+	}
+	if(resultsStore)
+	{
+		resultsStore->append(ResultsStore::Trial(scenario, generationNumber, seed,
+			trialStart, selectedParameters(), multiscore));
+	}
+	recordScores(multiscore);
+}
+
+void NeuroEvolution::recordScores(vector <double> multiscore)
 {
 	if(multiscore.size()==2)
 		this->scoresOfTheGeneration.push_back(multiscore);
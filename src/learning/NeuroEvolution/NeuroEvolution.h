@@ -30,8 +30,13 @@
 
 #include "NeuroEvoPopulation.h"
 #include "NeuroEvoMember.h"
+#include <ctime>
 #include <fstream>
 
+// Forward declarations
+class EvaluationCache;
+class ResultsStore;
+
 class NeuroEvolution
 {
 public:
@@ -47,6 +52,13 @@ public:
     /// @todo make this const if we decide to force everyone to put their logs in resources
     std::string resourcePath;
 private:
+	/// Start the next generation if due, and select the next candidate
+	void selectControllers();
+	/// The parameters of the selected controllers, for the cache
+	std::vector< std::vector<double> > selectedParameters() const;
+	/// Credit scores to the selected controllers and log them
+	void recordScores(std::vector<double> multiscore);
+
 	int populationSize;
 	int numberOfControllers;
 	std::tr1::ranlux64_base_01 eng;
@@ -66,6 +78,18 @@ private:
     int numberOfChildren;
     int numberOfSubtests;
     int subTests;
+    /// The subtest the selected controllers are being tested in
+    int selectedSubtest;
+    /// NULL unless evaluationCache is set in the config
+    EvaluationCache* evaluationCache;
+    /// NULL unless resultsStore is set in the config
+    ResultsStore* resultsStore;
+    /// Identifies the scenario in the cache and the results store
+    std::string scenario;
+    /// The seed of eng
+    unsigned long long seed;
+    /// When the trial of the selected controllers began
+    std::clock_t trialStart;
 };
 
 #endif /* NEUROEVOLUTION_H_ */
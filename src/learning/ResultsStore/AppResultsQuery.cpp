@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file AppResultsQuery.cpp
+ * @brief Prints the trials of a ResultsStore file as CSV
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include "ResultsStore.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " <file> size\n"
+                  << "       " << name << " <file> best <k>\n"
+                  << "       " << name << " <file> generation <g>\n"
+                  << "Prints index,scenario,generation,seed,timestamp,duration,"
+                  << "scores,parameters for each trial, with the scores and "
+                  << "parameters separated by spaces" << std::endl;
+    }
+
+    void printList(const std::vector<double>& values)
+    {
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            std::cout << (i > 0 ? " " : "") << values[i];
+        }
+    }
+
+    void printTrials(ResultsStore& store, const std::vector<std::size_t>& indices)
+    {
+        std::cout.precision(17);
+        for (std::size_t i = 0; i < indices.size(); i++)
+        {
+            const ResultsStore::Trial trial = store.read(indices[i]);
+            std::cout << indices[i] << ","
+                      << trial.scenario << ","
+                      << trial.generation << ","
+                      << trial.seed << ","
+                      << trial.timestamp << ","
+                      << trial.duration << ",";
+            printList(trial.scores);
+            std::cout << ",";
+            printList(trial.parameters);
+            std::cout << "\n";
+        }
+    }
+}
+
+/**
+ * The entry point.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[1] is the store, argv[2] the query and argv[3]
+ * its argument
+ * @return 0 on success, 1 on bad arguments or an unreadable store
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    const std::string query(argv[2]);
+
+    try
+    {
+        ResultsStore store(argv[1]);
+        if (query == "size" && argc == 3)
+        {
+            std::cout << store.size() << std::endl;
+        }
+        else if (query == "best" && argc == 4)
+        {
+            printTrials(store, store.best(std::strtoul(argv[3], NULL, 10)));
+        }
+        else if (query == "generation" && argc == 4)
+        {
+            printTrials(store, store.generation(std::atoi(argv[3])));
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
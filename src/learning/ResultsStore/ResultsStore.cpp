@@ -0,0 +1,538 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file ResultsStore.cpp
+ * @brief Append-only store of learning trials with an index for queries
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include "ResultsStore.h"
+#include "learning/Configuration/configuration.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+// POSIX
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /** Starts the file */
+    const char fileMagic[8] = {'N', 'T', 'R', 'T', 'T', 'R', 'L', '1'};
+
+    /** Starts each record */
+    const unsigned long long recordMagic = 0x4e54525452454331ULL;
+
+    /** Starts the sidecar index, which is followed by its entries */
+    const char indexMagic[8] = {'N', 'T', 'R', 'T', 'I', 'D', 'X', '1'};
+
+    /**
+     * The fixed part of a record, which the index reads. All fields are
+     * eight bytes, so there is no padding. The parameters, scores and
+     * scenario follow it.
+     */
+    struct RecordHeader
+    {
+        unsigned long long magic;
+        /** The whole record, header included */
+        unsigned long long size;
+        long long generation;
+        unsigned long long seed;
+        unsigned long long parameters;
+        unsigned long long scores;
+        unsigned long long scenarioLength;
+        double timestamp;
+        double duration;
+        /** The first score, or -HUGE_VAL if there are none */
+        double score;
+    };
+
+    /** Holds an flock for its lifetime */
+    class FileLock
+    {
+    public:
+        FileLock(int fd, int operation) :
+            m_fd(fd)
+        {
+            while (flock(m_fd, operation) != 0)
+            {
+                if (errno != EINTR)
+                {
+                    throw std::runtime_error("Could not lock the results store");
+                }
+            }
+        }
+
+        ~FileLock()
+        {
+            flock(m_fd, LOCK_UN);
+        }
+
+    private:
+        const int m_fd;
+    };
+
+    bool readAt(int fd, void* buffer, std::size_t size, unsigned long long offset)
+    {
+        char* p = static_cast<char*>(buffer);
+        while (size > 0)
+        {
+            const ssize_t n = pread(fd, p, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (n <= 0)
+            {
+                return false;
+            }
+            p += n;
+            size -= n;
+            offset += n;
+        }
+        return true;
+    }
+
+    void writeAll(int fd, const char* buffer, std::size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t n = write(fd, buffer, size);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (n <= 0)
+            {
+                throw std::runtime_error("Could not write to the results store");
+            }
+            buffer += n;
+            size -= n;
+        }
+    }
+
+    bool writeAt(int fd, const void* buffer, std::size_t size,
+                 unsigned long long offset)
+    {
+        const char* p = static_cast<const char*>(buffer);
+        while (size > 0)
+        {
+            const ssize_t n = pwrite(fd, p, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (n <= 0)
+            {
+                return false;
+            }
+            p += n;
+            size -= n;
+            offset += n;
+        }
+        return true;
+    }
+
+    unsigned long long fileSize(int fd)
+    {
+        struct stat status;
+        if (fstat(fd, &status) != 0)
+        {
+            throw std::runtime_error("Could not stat the results store");
+        }
+        return status.st_size;
+    }
+
+    /** Orders indices by score, best first, then by position */
+    class ByScore
+    {
+    public:
+        ByScore(const std::vector<double>& scores) :
+            m_scores(scores)
+        {
+        }
+
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            if (m_scores[a] != m_scores[b])
+            {
+                return m_scores[a] > m_scores[b];
+            }
+            return a < b;
+        }
+
+    private:
+        const std::vector<double>& m_scores;
+    };
+}
+
+ResultsStore::Trial::Trial() :
+    generation(0),
+    seed(0),
+    timestamp(0.0),
+    duration(0.0)
+{
+}
+
+ResultsStore::Trial::Trial(const std::string& scenario,
+                           int generation,
+                           unsigned long long seed,
+                           std::clock_t start,
+                           const std::vector< std::vector<double> >& parameters,
+                           const std::vector<double>& scores) :
+    scenario(scenario),
+    generation(generation),
+    seed(seed),
+    timestamp(std::time(NULL)),
+    duration(double(std::clock() - start) / CLOCKS_PER_SEC),
+    scores(scores)
+{
+    for (std::size_t i = 0; i < parameters.size(); i++)
+    {
+        this->parameters.insert(this->parameters.end(),
+                                parameters[i].begin(), parameters[i].end());
+    }
+}
+
+ResultsStore::ResultsStore(const std::string& filename) :
+    m_filename(filename),
+    m_indexFilename(filename + ".index"),
+    m_fd(open(filename.c_str(), O_RDWR | O_APPEND | O_CREAT, 0644)),
+    m_indexFd(-1),
+    m_indexed(sizeof(fileMagic))
+{
+    if (m_fd < 0)
+    {
+        throw std::runtime_error("Could not open results store " + filename);
+    }
+    try
+    {
+        FileLock lock(m_fd, LOCK_EX);
+        if (fileSize(m_fd) == 0)
+        {
+            writeAll(m_fd, fileMagic, sizeof(fileMagic));
+        }
+        else
+        {
+            char magic[sizeof(fileMagic)];
+            if (!readAt(m_fd, magic, sizeof(magic), 0) ||
+                std::memcmp(magic, fileMagic, sizeof(magic)) != 0)
+            {
+                throw std::runtime_error(filename + " is not a results store");
+            }
+        }
+    }
+    catch (...)
+    {
+        close(m_fd);
+        throw;
+    }
+
+    // Without a sidecar the store indexes in memory only
+    m_indexFd = open(m_indexFilename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_indexFd >= 0)
+    {
+        FileLock lock(m_indexFd, LOCK_EX);
+        char magic[sizeof(indexMagic)];
+        if (!readAt(m_indexFd, magic, sizeof(magic), 0) ||
+            std::memcmp(magic, indexMagic, sizeof(magic)) != 0)
+        {
+            if (ftruncate(m_indexFd, 0) != 0 ||
+                !writeAt(m_indexFd, indexMagic, sizeof(indexMagic), 0))
+            {
+                close(m_indexFd);
+                m_indexFd = -1;
+            }
+        }
+    }
+}
+
+ResultsStore::~ResultsStore()
+{
+    if (m_indexFd >= 0)
+    {
+        close(m_indexFd);
+    }
+    close(m_fd);
+}
+
+ResultsStore* ResultsStore::create(configuration& config,
+                                   const std::string& filename)
+{
+    if (!config.iskey("resultsStore") || !config.getintvalue("resultsStore"))
+    {
+        return NULL;
+    }
+    return new ResultsStore(filename);
+}
+
+void ResultsStore::append(const Trial& trial)
+{
+    RecordHeader header;
+    header.magic = recordMagic;
+    header.generation = trial.generation;
+    header.seed = trial.seed;
+    header.parameters = trial.parameters.size();
+    header.scores = trial.scores.size();
+    header.scenarioLength = trial.scenario.size();
+    header.timestamp = trial.timestamp;
+    header.duration = trial.duration;
+    header.score = trial.scores.empty() ? -HUGE_VAL : trial.scores[0];
+    const std::size_t parameterBytes = trial.parameters.size() * sizeof(double);
+    const std::size_t scoreBytes = trial.scores.size() * sizeof(double);
+    header.size = sizeof(header) + parameterBytes + scoreBytes +
+        trial.scenario.size();
+
+    // One buffer, so the record goes out in a single write
+    std::vector<char> record(header.size);
+    char* p = &record[0];
+    std::memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    if (parameterBytes > 0)
+    {
+        std::memcpy(p, &trial.parameters[0], parameterBytes);
+        p += parameterBytes;
+    }
+    if (scoreBytes > 0)
+    {
+        std::memcpy(p, &trial.scores[0], scoreBytes);
+        p += scoreBytes;
+    }
+    std::copy(trial.scenario.begin(), trial.scenario.end(), p);
+
+    FileLock lock(m_fd, LOCK_EX);
+    writeAll(m_fd, &record[0], record.size());
+}
+
+std::size_t ResultsStore::size()
+{
+    refresh();
+    return m_entries.size();
+}
+
+ResultsStore::Trial ResultsStore::read(std::size_t index)
+{
+    if (index >= m_entries.size())
+    {
+        refresh();
+        if (index >= m_entries.size())
+        {
+            throw std::out_of_range("No such trial in the results store");
+        }
+    }
+    const unsigned long long offset = m_entries[index].offset;
+    RecordHeader header;
+    if (!readAt(m_fd, &header, sizeof(header), offset) ||
+        header.magic != recordMagic)
+    {
+        throw std::runtime_error("Could not read the results store");
+    }
+    std::vector<char> payload(header.size - sizeof(header));
+    if (!payload.empty() &&
+        !readAt(m_fd, &payload[0], payload.size(), offset + sizeof(header)))
+    {
+        throw std::runtime_error("Could not read the results store");
+    }
+
+    Trial trial;
+    trial.generation = static_cast<int>(header.generation);
+    trial.seed = header.seed;
+    trial.timestamp = header.timestamp;
+    trial.duration = header.duration;
+    trial.parameters.resize(header.parameters);
+    trial.scores.resize(header.scores);
+    const char* p = payload.empty() ? NULL : &payload[0];
+    if (header.parameters > 0)
+    {
+        std::memcpy(&trial.parameters[0], p, header.parameters * sizeof(double));
+        p += header.parameters * sizeof(double);
+    }
+    if (header.scores > 0)
+    {
+        std::memcpy(&trial.scores[0], p, header.scores * sizeof(double));
+        p += header.scores * sizeof(double);
+    }
+    trial.scenario.assign(p, header.scenarioLength);
+    return trial;
+}
+
+std::vector<std::size_t> ResultsStore::best(std::size_t k)
+{
+    refresh();
+    const std::size_t n = m_entries.size();
+    std::vector<double> scores(n);
+    std::vector<std::size_t> result(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        scores[i] = m_entries[i].score;
+        result[i] = i;
+    }
+    k = std::min(k, n);
+    std::partial_sort(result.begin(), result.begin() + k, result.end(),
+                      ByScore(scores));
+    result.resize(k);
+    return result;
+}
+
+std::vector<std::size_t> ResultsStore::generation(int g)
+{
+    refresh();
+    const std::map<int, std::vector<std::size_t> >::const_iterator it =
+        m_generations.find(g);
+    return it == m_generations.end() ? std::vector<std::size_t>() : it->second;
+}
+
+void ResultsStore::refresh()
+{
+    // Nothing was appended since the last look
+    if (m_indexed == fileSize(m_fd))
+    {
+        return;
+    }
+    else if (m_indexFd < 0)
+    {
+        scan();
+        return;
+    }
+
+    // One store at a time extends the sidecar; appends go on meanwhile
+    FileLock lock(m_indexFd, LOCK_EX);
+    loadIndex();
+    scan();
+    if (m_indexFd < 0)
+    {
+        return;
+    }
+    // Whatever the sidecar lacks, which is more than was just scanned if
+    // an earlier write failed
+    const unsigned long long indexSize = fileSize(m_indexFd);
+    const std::size_t stored = indexSize < sizeof(indexMagic) ? 0 :
+        std::min<std::size_t>(m_entries.size(),
+                              (indexSize - sizeof(indexMagic)) / sizeof(Entry));
+    if (m_entries.size() > stored)
+    {
+        // The sidecar is a cache, so a failed write only costs a scan
+        writeAt(m_indexFd, &m_entries[stored],
+                (m_entries.size() - stored) * sizeof(Entry),
+                sizeof(indexMagic) + stored * sizeof(Entry));
+    }
+}
+
+void ResultsStore::loadIndex()
+{
+    const unsigned long long position =
+        sizeof(indexMagic) + m_entries.size() * sizeof(Entry);
+    const unsigned long long end = fileSize(m_indexFd);
+    if (end < position + sizeof(Entry))
+    {
+        return;
+    }
+    std::vector<Entry> entries((end - position) / sizeof(Entry));
+    if (!readAt(m_indexFd, &entries[0], entries.size() * sizeof(Entry),
+                position))
+    {
+        return;
+    }
+
+    // Entries follow each other without gaps, within the file
+    const unsigned long long dataEnd = fileSize(m_fd);
+    unsigned long long offset = m_indexed;
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+        const Entry& entry = entries[i];
+        if (entry.offset != offset || entry.size < sizeof(RecordHeader) ||
+            entry.size > dataEnd - offset)
+        {
+            clearIndex();
+            return;
+        }
+        offset += entry.size;
+    }
+
+    // A file of the same name written since would have other records
+    // here, so one read of the last record's header tells them apart
+    const Entry& last = entries.back();
+    RecordHeader header;
+    if (!readAt(m_fd, &header, sizeof(header), last.offset) ||
+        header.magic != recordMagic || header.size != last.size ||
+        header.generation != last.generation ||
+        std::memcmp(&header.score, &last.score, sizeof(double)) != 0)
+    {
+        clearIndex();
+        return;
+    }
+
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+        addEntry(entries[i]);
+    }
+}
+
+void ResultsStore::scan()
+{
+    FileLock lock(m_fd, LOCK_SH);
+    const unsigned long long end = fileSize(m_fd);
+    RecordHeader header;
+    while (m_indexed + sizeof(header) <= end)
+    {
+        if (!readAt(m_fd, &header, sizeof(header), m_indexed) ||
+            header.magic != recordMagic || header.size < sizeof(header))
+        {
+            throw std::runtime_error(m_filename + " is corrupt");
+        }
+        else if (m_indexed + header.size > end)
+        {
+            break;
+        }
+        Entry entry;
+        entry.offset = m_indexed;
+        entry.size = header.size;
+        entry.generation = header.generation;
+        entry.score = header.score;
+        addEntry(entry);
+    }
+}
+
+void ResultsStore::addEntry(const Entry& entry)
+{
+    assert(entry.offset == m_indexed);
+    m_generations[static_cast<int>(entry.generation)].push_back(m_entries.size());
+    m_entries.push_back(entry);
+    m_indexed += entry.size;
+}
+
+void ResultsStore::clearIndex()
+{
+    m_entries.clear();
+    m_generations.clear();
+    m_indexed = sizeof(fileMagic);
+    if (ftruncate(m_indexFd, sizeof(indexMagic)) != 0)
+    {
+        close(m_indexFd);
+        m_indexFd = -1;
+    }
+}
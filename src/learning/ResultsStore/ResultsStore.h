@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef RESULTSSTORE_H_
+#define RESULTSSTORE_H_
+
+/**
+ * @file ResultsStore.h
+ * @brief Append-only store of learning trials with an index for queries
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#include <cstddef>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class configuration;
+
+/**
+ * Every trial of a learning run in one binary file: its parameters,
+ * scores, generation, seed, scenario and timing. Records are only ever
+ * appended, each with a single locked write, so parallel trials may
+ * share a file from separate processes.
+ *
+ * Appending never reads the file. Before each query the store indexes
+ * the records appended since it last looked, by this or other writers.
+ * Only their fixed size headers are read, so queries such as the top k
+ * by score or all trials of a generation over millions of records don't
+ * parse any parameters.
+ *
+ * The index is kept in a sidecar file, the store's name plus ".index",
+ * which every store on the file extends from the last record indexed.
+ * Opening a large store therefore reads only the records appended
+ * since anyone last queried it. The sidecar is only a cache: if it is
+ * missing, can't be written or belongs to an older file of the same
+ * name, the index is rebuilt from the records.
+ *
+ * The file is in the host's byte order, and is not meant to be moved
+ * between architectures. AppResultsQuery prints the results of these
+ * queries as CSV.
+ */
+class ResultsStore
+{
+public:
+    /**
+     * One simulated trial
+     */
+    struct Trial
+    {
+        Trial();
+
+        /**
+         * A trial that started at start and ends now
+         * @param[in] parameters, each controller's parameters, which
+         * are stored one after the other
+         */
+        Trial(const std::string& scenario,
+              int generation,
+              unsigned long long seed,
+              std::clock_t start,
+              const std::vector< std::vector<double> >& parameters,
+              const std::vector<double>& scores);
+
+        std::string scenario;
+
+        int generation;
+
+        /** The seed of the random number generator of the run */
+        unsigned long long seed;
+
+        /** Seconds since the epoch when the trial was recorded */
+        double timestamp;
+
+        /** Seconds the trial took */
+        double duration;
+
+        std::vector<double> parameters;
+
+        /** The first score is the one trials are ranked by */
+        std::vector<double> scores;
+    };
+
+    /**
+     * Open or create a store. Nothing is indexed until the first query.
+     * @param[in] filename, the file of the store
+     * @throw std::runtime_error if the file can't be opened, or isn't a
+     * store
+     */
+    explicit ResultsStore(const std::string& filename);
+
+    ~ResultsStore();
+
+    /**
+     * The store a learning configuration asks for: none unless the
+     * resultsStore key is set
+     * @param[in] config, the engine's learning configuration
+     * @param[in] filename, as for the constructor
+     * @return a new store owned by the caller, or NULL
+     */
+    static ResultsStore* create(configuration& config,
+                                const std::string& filename);
+
+    /**
+     * Append a trial. Concurrent appends from other stores on the same
+     * file, in this or other processes, never interleave.
+     * @throw std::runtime_error if the write fails
+     */
+    void append(const Trial& trial);
+
+    /**
+     * The number of trials in the file
+     * @throw std::runtime_error if a record is corrupt
+     */
+    std::size_t size();
+
+    /**
+     * @param[in] index, the position of the trial in the file
+     * @throw std::out_of_range if index is not less than size()
+     * @throw std::runtime_error if a record is corrupt
+     */
+    Trial read(std::size_t index);
+
+    /**
+     * The indices of the best k trials by their first score, best
+     * first. Trials without scores rank last.
+     * @throw std::runtime_error if a record is corrupt
+     */
+    std::vector<std::size_t> best(std::size_t k);
+
+    /**
+     * The indices of the trials of a generation, in the order appended
+     * @throw std::runtime_error if a record is corrupt
+     */
+    std::vector<std::size_t> generation(int g);
+
+private:
+    /** Disable the copy constructor. */
+    ResultsStore(const ResultsStore&);
+
+    /** Disable the assignment operator. */
+    ResultsStore& operator=(const ResultsStore&);
+
+    /**
+     * What the index keeps of each record, as stored in the sidecar.
+     * All fields are eight bytes, so there is no padding.
+     */
+    struct Entry
+    {
+        unsigned long long offset;
+        /** The whole record, header included */
+        unsigned long long size;
+        long long generation;
+        double score;
+    };
+
+    /**
+     * Index the records appended since the last refresh, taking those
+     * another store has indexed from the sidecar
+     */
+    void refresh();
+
+    /**
+     * Add the sidecar's entries past m_entries, if they match the file.
+     * The sidecar must be locked.
+     */
+    void loadIndex();
+
+    /** Index the records in the file past m_indexed */
+    void scan();
+
+    /** Add an entry for the record at m_indexed */
+    void addEntry(const Entry& entry);
+
+    /** Forget the index, in memory and in the sidecar */
+    void clearIndex();
+
+    const std::string m_filename;
+
+    const std::string m_indexFilename;
+
+    /** A POSIX file descriptor, open for reading and appending */
+    int m_fd;
+
+    /** The sidecar, open for reading and writing; -1 if it can't be */
+    int m_indexFd;
+
+    /** The bytes of the file that are indexed */
+    unsigned long long m_indexed;
+
+    std::vector<Entry> m_entries;
+
+    std::map<int, std::vector<std::size_t> > m_generations;
+};
+
+#endif /* RESULTSSTORE_H_ */
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBodyTrajectoryLogger.cpp
+ * @brief Contains the implementation of class tgBodyTrajectoryLogger
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgBodyTrajectoryLogger.h"
+// This application
+#include "core/tgBulletUtil.h"
+#include "core/tgWorld.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cstdlib> // for getenv
+#include <limits>
+#include <stdexcept>
+
+tgBodyTrajectoryLogger::tgBodyTrajectoryLogger(const tgWorld& world,
+                                               const std::string& fileName,
+                                               double timeInterval) :
+  tgDataManager(),
+  m_world(world),
+  m_timeInterval(timeInterval),
+  m_output(fileName.c_str(), std::ios::out | std::ios::trunc),
+  m_trial(-1),
+  m_totalTime(0.0),
+  m_updateTime(0.0)
+{
+  if (m_timeInterval < 0.0) {
+    throw std::invalid_argument("Time interval must be nonnegative.");
+  }
+  if (!m_output) {
+    throw std::invalid_argument("Could not open " + fileName);
+  }
+  // Enough digits to tell float and double trajectories apart
+  m_output.precision(std::numeric_limits<double>::digits10 + 2);
+}
+
+tgBodyTrajectoryLogger*
+tgBodyTrajectoryLogger::fromEnvironment(const tgWorld& world,
+                                        const std::string& name,
+                                        double timeInterval)
+{
+  const char* const dir = std::getenv("NTRT_TRAJECTORY_DIR");
+  if (dir == NULL) {
+    return NULL;
+  }
+  return new tgBodyTrajectoryLogger(world, std::string(dir) + "/" + name +
+                                    ".csv", timeInterval);
+}
+
+void tgBodyTrajectoryLogger::setup()
+{
+  m_trial++;
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+}
+
+void tgBodyTrajectoryLogger::teardown()
+{
+  m_output.flush();
+}
+
+void tgBodyTrajectoryLogger::step(double dt)
+{
+  if (dt <= 0.0) {
+    throw std::invalid_argument("dt is not positive");
+  }
+  m_totalTime += dt;
+  m_updateTime += dt;
+  if (m_updateTime < m_timeInterval) {
+    return;
+  }
+  m_updateTime = 0.0;
+
+  m_output << m_trial << "," << m_totalTime;
+  const btCollisionObjectArray& objects =
+    tgBulletUtil::worldToDynamicsWorld(m_world).getCollisionObjectArray();
+  for (int i = 0; i < objects.size(); i++) {
+    const btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+    if (pBody == NULL || pBody->isStaticOrKinematicObject()) {
+      continue;
+    }
+    const btVector3& origin = pBody->getCenterOfMassPosition();
+    m_output << "," << origin.x() << "," << origin.y() << "," << origin.z();
+  }
+  m_output << "\n";
+}
+
+std::string tgBodyTrajectoryLogger::toString() const
+{
+  return "tgBodyTrajectoryLogger";
+}
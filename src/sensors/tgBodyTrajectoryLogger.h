@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BODY_TRAJECTORY_LOGGER_H
+#define TG_BODY_TRAJECTORY_LOGGER_H
+
+/**
+ * @file tgBodyTrajectoryLogger.h
+ * @brief Contains the definition of class tgBodyTrajectoryLogger
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgDataManager.h"
+// The C++ Standard Library
+#include <fstream>
+#include <string>
+
+// Forward declarations
+class tgWorld;
+
+/**
+ * Logs the position of every moving body in a world, for comparing runs
+ * of the same scenario, for example between double and single precision
+ * builds (see bin/utilities/comparePrecision.py). Needs no sensors: the
+ * bodies are read from the world, so it works with any model.
+ *
+ * Each row of the CSV file is: trial, time, then x, y, z of each body in
+ * the order they were added to the world. The trial counts resets.
+ * Time is accumulated in double whatever the precision of btScalar.
+ */
+class tgBodyTrajectoryLogger : public tgDataManager
+{
+public:
+
+  /**
+   * @param[in] world, the world whose bodies are logged; must outlive
+   * the logger
+   * @param[in] fileName, the CSV file to write, replaced if it exists
+   * @param[in] timeInterval, seconds between rows, zero for every step
+   * @throw std::invalid_argument if the file cannot be opened or
+   * timeInterval is negative
+   */
+  tgBodyTrajectoryLogger(const tgWorld& world, const std::string& fileName,
+                         double timeInterval = 0.0);
+
+  /**
+   * A logger writing NAME.csv in the directory named by the
+   * NTRT_TRAJECTORY_DIR environment variable, or NULL if it is not set.
+   * Lets tests record trajectories only when a harness asks for them.
+   */
+  static tgBodyTrajectoryLogger* fromEnvironment(const tgWorld& world,
+                                                 const std::string& name,
+                                                 double timeInterval = 0.0);
+
+  /** Starts the next trial */
+  virtual void setup();
+
+  virtual void teardown();
+
+  /**
+   * Log the bodies if timeInterval has elapsed
+   * @throw std::invalid_argument if dt is not positive
+   */
+  virtual void step(double dt);
+
+  virtual std::string toString() const;
+
+private:
+
+  const tgWorld& m_world;
+
+  const double m_timeInterval;
+
+  std::ofstream m_output;
+
+  /** The number of times setup has been called */
+  int m_trial;
+
+  /** Seconds since setup */
+  double m_totalTime;
+
+  /** Seconds since the last row */
+  double m_updateTime;
+};
+
+#endif // TG_BODY_TRAJECTORY_LOGGER_H
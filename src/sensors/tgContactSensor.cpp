@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactSensor.cpp
+ * @brief Implementation of the tgContactSensor class.
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This class:
+#include "tgContactSensor.h"
+
+// Includes from NTRT:
+#include "core/tgBaseRigid.h"
+#include "core/tgCast.h"
+#include "core/tgContactTable.h"
+#include "core/tgSenseable.h"
+#include "core/tgTags.h"
+
+// Includes from the c++ standard library:
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+
+// Includes from Bullet Physics:
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+
+tgContactSensor::tgContactSensor(tgBaseRigid* pRigid, tgContactTable& table) :
+  tgSensor(pRigid),
+  m_table(table)
+{
+  if (pRigid == NULL) {
+    throw std::invalid_argument("Pointer to pRigid is NULL inside tgContactSensor.");
+  }
+}
+
+/**
+ * The rigid (tgSenseable) is managed by tgSensor, the table by its owner.
+ */
+tgContactSensor::~tgContactSensor()
+{
+}
+
+std::vector<std::string> tgContactSensor::getSensorDataHeadings() {
+  tgBaseRigid* m_pRigid = tgCast::cast<tgSenseable, tgBaseRigid>(m_pSens);
+  assert( m_pRigid != 0);
+
+  std::vector<std::string> headings;
+  const std::string prefix =
+    std::string("contact(") + m_pRigid->getTags() + ").";
+
+  headings.push_back( prefix + "points" );
+  headings.push_back( prefix + "normalImpulse" );
+  headings.push_back( prefix + "frictionImpulse" );
+  // The net contact force; the ground reaction force of a foot
+  headings.push_back( prefix + "FX" );
+  headings.push_back( prefix + "FY" );
+  headings.push_back( prefix + "FZ" );
+  // The center of pressure
+  headings.push_back( prefix + "CoPX" );
+  headings.push_back( prefix + "CoPY" );
+  headings.push_back( prefix + "CoPZ" );
+
+  return headings;
+}
+
+std::vector<std::string> tgContactSensor::getSensorData() {
+  tgBaseRigid* m_pRigid = tgCast::cast<tgSenseable, tgBaseRigid>(m_pSens);
+  assert( m_pRigid != 0);
+
+  // The first sensor to read after a step refreshes the table
+  const btRigidBody* const pBody = m_pRigid->getPRigidBody();
+  const tgContactTable::Contacts& contacts = m_table.getContacts(pBody);
+  const btVector3 force = m_table.getForce(pBody);
+
+  const double values[] = {
+    static_cast<double>(contacts.points),
+    contacts.normalImpulse,
+    contacts.frictionImpulse,
+    force[0], force[1], force[2],
+    contacts.center[0], contacts.center[1], contacts.center[2]
+  };
+  const std::size_t n = sizeof(values) / sizeof(values[0]);
+
+  std::vector<std::string> sensordata;
+  std::stringstream ss;
+  for (std::size_t i = 0; i < n; i++) {
+    ss.str("");
+    ss << values[i];
+    sensordata.push_back( ss.str() );
+  }
+  return sensordata;
+}
+
+//end.
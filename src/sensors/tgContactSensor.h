@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactSensor.h
+ * @brief Contains the definition of concrete class tgContactSensor.
+ * @author NTRT contributors
+ * $Id$
+ */
+
+#ifndef TG_CONTACT_SENSOR_H
+#define TG_CONTACT_SENSOR_H
+
+// Includes from the sensors directory:
+#include "tgSensor.h"
+
+// Forward declarations
+class tgBaseRigid;
+class tgContactTable;
+
+/**
+ * This class extends tgSensor to sense the contacts of a rigid body
+ * (a tgRod, tgBox, tgSphere...): how many contact points it has, the
+ * normal and friction impulses on it, the net contact force, which for
+ * a foot is the ground reaction force, and the center of pressure.
+ *
+ * The contacts are read from a tgContactTable shared by all contact
+ * sensors and any controllers, so the collision world is only queried
+ * once per step. Rigids in a compound share one body, and so report
+ * the contacts of the whole compound.
+ */
+class tgContactSensor : public tgSensor
+{
+public:
+
+  /**
+   * @param[in] pRigid a pointer to the rigid this sensor attaches to.
+   * @param[in] table the shared contacts, which must outlive the sensor.
+   */
+  tgContactSensor(tgBaseRigid* pRigid, tgContactTable& table);
+
+  // Classes with virtual member functions must also have virtual destructors.
+  virtual ~tgContactSensor();
+
+  /**
+   * The two data collection methods from tgSensor.
+   */
+  virtual std::vector<std::string> getSensorDataHeadings();
+  virtual std::vector<std::string> getSensorData();
+
+private:
+
+  tgContactTable& m_table;
+
+};
+
+#endif //TG_CONTACT_SENSOR_H
@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactSensorInfo.cpp
+ * @brief Contains the implementation of concrete class tgContactSensorInfo
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgContactSensorInfo.h"
+// Other includes from NTRTsim
+#include "tgContactSensor.h"
+#include "core/tgBaseRigid.h"
+#include "core/tgSenseable.h"
+#include "core/tgCast.h"
+// Other includes from the C++ standard library
+#include <stdexcept>
+
+tgContactSensorInfo::tgContactSensorInfo(tgContactTable& table) :
+  m_table(table)
+{
+}
+
+/**
+ * The table is not ours to delete.
+ */
+tgContactSensorInfo::~tgContactSensorInfo()
+{
+}
+
+bool tgContactSensorInfo::isThisMySenseable(tgSenseable* pSenseable)
+{
+  // The cast returns 0 if the senseable is not a rigid.
+  return tgCast::cast<tgSenseable, tgBaseRigid>(pSenseable) != 0;
+}
+
+std::vector<tgSensor*> tgContactSensorInfo::createSensorsIfAppropriate(tgSenseable* pSenseable)
+{
+  if (!isThisMySenseable(pSenseable)) {
+    throw std::invalid_argument("pSenseable is NOT a tgBaseRigid, inside tgContactSensorInfo.");
+  }
+  std::vector<tgSensor*> newSensors;
+  newSensors.push_back( new tgContactSensor(
+    tgCast::cast<tgSenseable, tgBaseRigid>(pSenseable), m_table ));
+  return newSensors;
+}
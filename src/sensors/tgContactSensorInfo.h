@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTACT_SENSOR_INFO_H
+#define TG_CONTACT_SENSOR_INFO_H
+
+/**
+ * @file tgContactSensorInfo.h
+ * @brief Definition of concrete class tgContactSensorInfo
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgSensorInfo.h"
+
+// Forward references
+class tgContactTable;
+class tgSenseable;
+class tgSensor;
+
+/**
+ * tgContactSensorInfo is a sensor info class that creates tgContactSensors
+ * for rigid bodies (tgBaseRigids). All of its sensors read the same
+ * tgContactTable, which controllers may share as well.
+ */
+class tgContactSensorInfo : public tgSensorInfo
+{
+ public:
+
+  /**
+   * @param[in] table the contacts the sensors read. It is not owned, and
+   * must outlive the sensors, e.g. by living as long as the tgWorld.
+   */
+  tgContactSensorInfo(tgContactTable& table);
+
+  ~tgContactSensorInfo();
+
+  /**
+   * True if pSenseable is a tgBaseRigid.
+   * @param[in] pSenseable a pointer to a tgSenseable object, that this sensor info
+   * may or may not be able to create a sensor for.
+   */
+  virtual bool isThisMySenseable(tgSenseable* pSenseable);
+
+  /**
+   * Create a contact sensor for a rigid. See tgSensorInfo for more... info.
+   * @param[in] pSenseable pointer to a senseable object. Sensor will be created
+   * for this pSenseable.
+   * @return a list of size 1 with a pointer to a tgContactSensor.
+   * @throws invalid_argument if pSenseable is not a tgBaseRigid.
+   */
+  virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
+
+ private:
+
+  tgContactTable& m_table;
+
+};
+
+#endif // TG_CONTACT_SENSOR_INFO_H
@@ -0,0 +1,138 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgDataFrameWriter.cpp
+ * @brief Implementation of class tgDataFrameWriter
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgDataFrameWriter.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+tgDataFrameWriter::tgDataFrameWriter(const std::string& fileName,
+                                     const std::string& header,
+                                     std::size_t width,
+                                     std::size_t capacity) :
+    m_output(fileName.c_str()),
+    m_width(width),
+    m_capacity(capacity),
+    m_frames(width * capacity),
+    m_head(0),
+    m_count(0),
+    m_writing(0),
+    m_stop(false)
+{
+    if (capacity == 0)
+    {
+        throw std::invalid_argument("capacity is not positive");
+    }
+    if (!m_output.is_open())
+    {
+        throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
+    }
+    m_output << header << std::endl;
+
+    // Only start the thread once nothing can throw
+    m_thread = boost::thread(&tgDataFrameWriter::run, this);
+}
+
+tgDataFrameWriter::~tgDataFrameWriter()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+    m_output.close();
+}
+
+void tgDataFrameWriter::submit(const double* frame)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_count + m_writing == m_capacity)
+    {
+        m_condition.wait(lock);
+    }
+    const std::size_t slot = (m_head + m_writing + m_count) % m_capacity;
+    std::copy(frame, frame + m_width, m_frames.begin() + slot * m_width);
+    m_count++;
+    m_condition.notify_all();
+}
+
+void tgDataFrameWriter::flush()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_count > 0 || m_writing > 0)
+    {
+        m_condition.wait(lock);
+    }
+}
+
+void tgDataFrameWriter::run()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (true)
+    {
+        while (m_count == 0 && !m_stop)
+        {
+            m_condition.wait(lock);
+        }
+        // Queued rows are still written when stopping
+        if (m_count == 0)
+        {
+            break;
+        }
+        // Take every queued row; submit() leaves them alone until
+        // m_writing is cleared
+        m_writing = m_count;
+        m_count = 0;
+        const std::size_t first = m_head;
+
+        lock.unlock();
+        for (std::size_t i = 0; i < m_writing; i++)
+        {
+            const double* const row =
+                &m_frames[((first + i) % m_capacity) * m_width];
+            for (std::size_t j = 0; j < m_width; j++)
+            {
+                m_output << row[j] << ",";
+            }
+            m_output << "\n";
+        }
+        // Keep the file readable while the simulation runs
+        m_output.flush();
+        if (!m_output)
+        {
+            // Nothing to throw to on this thread
+            std::cerr << "Could not write data log" << std::endl;
+            m_output.clear();
+        }
+        lock.lock();
+
+        m_head = (first + m_writing) % m_capacity;
+        m_writing = 0;
+        m_condition.notify_all();
+    }
+}
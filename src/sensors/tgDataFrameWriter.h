@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_DATA_FRAME_WRITER_H
+#define TG_DATA_FRAME_WRITER_H
+
+/**
+ * @file tgDataFrameWriter.h
+ * @brief Definition of class tgDataFrameWriter
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The Boost library
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+// The C++ Standard Library
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes rows of numbers to a CSV file on a background thread, so the
+ * simulation only pays for copying each row into a preallocated ring
+ * buffer. If the buffer is full, submit() waits for the thread to
+ * catch up rather than dropping rows.
+ */
+class tgDataFrameWriter
+{
+public:
+
+    /**
+     * Open the file, replacing it, and write the header line
+     * @param[in] fileName, the CSV file to write
+     * @param[in] header, the first line, without its newline
+     * @param[in] width, the numbers in each row
+     * @param[in] capacity, the rows the buffer holds; must be positive
+     * @throw std::runtime_error if the file cannot be opened
+     */
+    tgDataFrameWriter(const std::string& fileName, const std::string& header,
+                      std::size_t width, std::size_t capacity);
+
+    /** Writes any pending rows, then stops the thread */
+    ~tgDataFrameWriter();
+
+    /**
+     * Queue a row for writing
+     * @param[in] frame, width numbers, copied before this returns
+     */
+    void submit(const double* frame);
+
+    /** Block until every submitted row is in the file */
+    void flush();
+
+private:
+
+    /** The background thread's loop */
+    void run();
+
+    /** Disable the copy constructor. */
+    tgDataFrameWriter(const tgDataFrameWriter&);
+
+    /** Disable the assignment operator. */
+    tgDataFrameWriter& operator=(const tgDataFrameWriter&);
+
+    std::ofstream m_output;
+
+    const std::size_t m_width;
+
+    const std::size_t m_capacity;
+
+    /** m_capacity rows of m_width numbers */
+    std::vector<double> m_frames;
+
+    /** The oldest queued row, and the number queued */
+    std::size_t m_head;
+    std::size_t m_count;
+
+    /** Rows taken by the thread and not yet written */
+    std::size_t m_writing;
+
+    bool m_stop;
+
+    boost::mutex m_mutex;
+
+    /** Signals a new row, completion or shutdown */
+    boost::condition_variable m_condition;
+
+    boost::thread m_thread;
+};
+
+#endif
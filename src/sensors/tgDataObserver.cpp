@@ -18,15 +18,14 @@
 
 /**
  * @file tgDataObserver.cpp
- * @brief Implementation of tgObserver class
+ * @brief Implementation of tgDataObserver class
  * @author Brian Tietz
  * @date April 28, 2014
  * $Id$
  */
 
 #include "tgDataObserver.h"
-
-#include "tgDataLogger.h"
+#include "tgDataFrameWriter.h"
 
 #include "core/tgCast.h"
 #include "core/tgModel.h"
@@ -36,15 +35,44 @@
 
 #include "core/tgSpringCableActuator.h"
 
+#include "LinearMath/btQuickprof.h"
+#include "LinearMath/btVector3.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <iostream>
 #include <sstream>  
 #include <time.h>
 #include <stdexcept>
 
-tgDataObserver::tgDataObserver(std::string filePrefix) :
+tgDataObserver::Config::Config(std::size_t d, double db, std::size_t qf) :
+    decimation(d),
+    deadband(db),
+    queuedFrames(qf)
+{
+    if (decimation == 0)
+    {
+        throw std::invalid_argument("decimation is not positive");
+    }
+    else if (deadband < 0.0)
+    {
+        throw std::invalid_argument("deadband is negative");
+    }
+    else if (queuedFrames == 0)
+    {
+        throw std::invalid_argument("queuedFrames is not positive");
+    }
+}
+
+tgDataObserver::tgDataObserver(std::string filePrefix, const Config& config) :
+m_config(config),
+m_filePrefix(filePrefix),
 m_totalTime(0.0),
-m_dataLogger(NULL),
-m_filePrefix(filePrefix)
+m_steps(0),
+m_markers(0),
+m_first(true),
+m_pWriter(NULL)
 {
 
 }
@@ -52,11 +80,9 @@ m_filePrefix(filePrefix)
 /** A class with virtual member functions must have a virtual destructor. */
 tgDataObserver::~tgDataObserver()
 { 
-    delete m_dataLogger;
-    tgOutput.close();
+    delete m_pWriter;
 }
 
-/**@todo move functions to constructor when possible */
 void tgDataObserver::onSetup(tgModel& model)
 {
 	/*
@@ -65,7 +91,7 @@ void tgDataObserver::onSetup(tgModel& model)
 	*/
     time_t rawtime;
     tm* currentTime;
-    int fileTimeSize = 64;
+    const int fileTimeSize = 64;
     char fileTime [fileTimeSize];
     
     time (&rawtime);
@@ -74,23 +100,13 @@ void tgDataObserver::onSetup(tgModel& model)
     m_fileName = m_filePrefix + fileTime;
     std::cout << m_fileName << std::endl;
     
-    if (m_dataLogger != NULL)
-    {
-        // prevent leaks on loop behavior (better than teardown?)
-        delete m_dataLogger;
-    }
-    
-    m_dataLogger = new tgDataLogger(m_fileName);
+    // Finish the previous file on loop behavior (better than teardown?)
+    delete m_pWriter;
+    m_pWriter = NULL;
     
     m_totalTime = 0.0;
-    
-    // First time opening this, so nothing to append to
-    tgOutput.open(m_fileName.c_str());
-    
-	if (!tgOutput.is_open())
-	{
-		throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
-	}
+    m_steps = 0;
+    m_first = true;
     
     std::vector<tgModel*> children = model.getDescendants();
     
@@ -101,71 +117,166 @@ void tgDataObserver::onSetup(tgModel& model)
     int stringNum = 0;
     int rodNum = 0;
     
-    tgOutput << "Time" << ",";
+    std::ostringstream header;
+    header << "Time" << ",";
     
     // Markers are written first
     const std::vector<abstractMarker>& markers = model.getMarkers();
-    
-    const std::size_t n = 0;
-
+    m_markers = markers.size();
     
     for (std::size_t i = 0; i < markers.size(); i++)
     {
         std::stringstream name;
         
         name << "Marker " <<  " " << i;
-            tgOutput << name.str() << "_X" << ","
+            header << name.str() << "_X" << ","
             << name.str() << "_Y" << ","
             << name.str() << "_Z" << ",";
     }
     
+    m_components.clear();
+    std::size_t width = 1 + 3 * m_markers;
     for (std::size_t i = 0; i < children.size(); i++)
     {
         /* If its a type we'll be logging, record its name and the 
          * variable types we'll be logging later
          */
         std::stringstream name;
+        Component component = { NULL, NULL };
         
-        if(tgCast::cast<tgModel, tgSpringCableActuator>(children[i]) != 0) 
+        if((component.pActuator =
+            tgCast::cast<tgModel, tgSpringCableActuator>(children[i])) != 0) 
         {
             name << children[i]->getTags() <<  " " << stringNum;
-            tgOutput <<  name.str() << "_RL" << ","
+            header <<  name.str() << "_RL" << ","
             <<  name.str() << "_AL" << ","
             <<  name.str() << "_Ten" << ",";
             stringNum++;
+            width += 3;
         }
-        else if(tgCast::cast<tgModel, tgRod>(children[i]) != 0)
+        else if((component.pRod =
+                 tgCast::cast<tgModel, tgRod>(children[i])) != 0)
         {
             name << children[i]->getTags() <<  " " << rodNum;
-            tgOutput << name.str() << "_X" << ","
+            header << name.str() << "_X" << ","
             << name.str() << "_Y" << ","
             << name.str() << "_Z" << ","
             << name.str() << "_mass" << ",";
             rodNum++;
+            width += 4;
+        }
+        else
+        {
+            // Not a type we log
+            continue;
         }
-        // Else do nothing since tgDataLogger won't touch it
+        m_components.push_back(component);
     }
     
-    tgOutput << std::endl;
+    m_frame.assign(width, 0.0);
+    m_written.assign(width, 0.0);
     
-    tgOutput.close();
+    m_pWriter = new tgDataFrameWriter(m_fileName, header.str(), width,
+                                      m_config.queuedFrames);
 }
 
-/**
- * Dispatch the visitors to the given model and log data
- * @param[in] the number of seconds since the previous call; must be
- * positive
- */
 void tgDataObserver::onStep(tgModel& model, double dt)
 {  
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgDataObserver::onStep");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    else if (m_pWriter == NULL)
+    {
+        throw std::runtime_error("onStep called before onSetup");
+    }
     m_totalTime += dt;
-    tgOutput.open(m_fileName.c_str(), std::ios::app);
-    tgOutput << m_totalTime << ",";
-    tgOutput.close();
+    m_steps++;
+    if (m_steps % m_config.decimation != 0)
+    {
+        return;
+    }
+    
+    sample(model);
+    if (m_first || changed())
+    {
+        m_pWriter->submit(&m_frame[0]);
+        m_written.swap(m_frame);
+        m_first = false;
+    }
+}
+
+void tgDataObserver::flush()
+{
+    if (m_pWriter != NULL)
+    {
+        m_pWriter->flush();
+    }
+}
 
-    model.onVisit(*m_dataLogger);
+void tgDataObserver::sample(const tgModel& model)
+{
+    std::vector<double>::iterator it = m_frame.begin();
+    *it++ = m_totalTime;
     
-    tgOutput.open(m_fileName.c_str(), std::ios::app);
-    tgOutput << std::endl;
-    tgOutput.close();
+    // The model may have gained markers since setup; the columns may not
+    const std::vector<abstractMarker>& markers = model.getMarkers();
+    const std::size_t nm = std::min(m_markers, markers.size());
+    for (std::size_t i = 0; i < nm; i++)
+    {
+        const btVector3 worldPos = markers[i].getWorldPosition();
+        *it++ = worldPos[0];
+        *it++ = worldPos[1];
+        *it++ = worldPos[2];
+    }
+    for (std::size_t i = nm; i < m_markers; i++)
+    {
+        *it++ = 0.0;
+        *it++ = 0.0;
+        *it++ = 0.0;
+    }
+    
+    const std::size_t n = m_components.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const Component& component = m_components[i];
+        if (component.pActuator != NULL)
+        {
+            const tgSpringCableActuator& mSCA = *component.pActuator;
+            *it++ = mSCA.getRestLength();
+            *it++ = mSCA.getCurrentLength();
+            *it++ = mSCA.getTension();
+        }
+        else
+        {
+            const tgRod& rod = *component.pRod;
+            const btVector3 com = rod.centerOfMass();
+            *it++ = com[0];
+            *it++ = com[1];
+            *it++ = com[2];
+            *it++ = rod.mass();
+        }
+    }
+    assert(it == m_frame.end());
+}
+
+bool tgDataObserver::changed() const
+{
+    if (m_config.deadband == 0.0)
+    {
+        return true;
+    }
+    // Time always changes, so it is not compared
+    const std::size_t n = m_frame.size();
+    for (std::size_t i = 1; i < n; i++)
+    {
+        if (std::fabs(m_frame[i] - m_written[i]) > m_config.deadband)
+        {
+            return true;
+        }
+    }
+    return false;
 }
@@ -21,47 +21,107 @@
 
 /**
  * @file tgDataObserver.h
- * @brief Definition of tgObserver class
+ * @brief Definition of tgDataObserver class
  * @author Brian Tietz
  * @date April 28, 2014
  * $Id$
  */
 
-#include <fstream>
+// The C++ Standard Library
+#include <cstddef>
 #include <string>
+#include <vector>
 
+class tgDataFrameWriter;
 class tgModel;
-class tgDataLogger;
+class tgRod;
+class tgSpringCableActuator;
 
 /**
- * A class that dispatches data loggers. Should be included by observers,
- * since they will know when to step this, and we don't have any model
- * specific information here.
+ * Logs the rods, spring cable actuators and markers of a model to a
+ * timestamped CSV file. Should be included by observers, since they
+ * will know when to step this, and we don't have any model specific
+ * information here.
+ *
+ * The logged components are found once, in onSetup(). Each logged step
+ * samples them into a preallocated frame and hands it to a
+ * tgDataFrameWriter, so stepping neither walks the model nor touches
+ * the file. Each row is: the time, then x, y, z of each marker of the
+ * model, then for each actuator or rod in the order of
+ * tgModel::getDescendants, either the actuator's rest length, actual
+ * length and tension or the rod's x, y, z and mass.
  */
-
 class tgDataObserver
 {
 public:
-    tgDataObserver(std::string filePrefix);
+
+    /**
+     * Which steps are written
+     */
+    struct Config
+    {
+        /**
+         * @param[in] d, only every d-th step is sampled; 1 samples every
+         * step
+         * @param[in] db, a sampled frame is written only if some value
+         * differs by more than db from the last frame written; zero
+         * writes every sampled frame. The first frame after setup is
+         * always written.
+         * @param[in] qf, the frames the writer buffers
+         * @throw std::invalid_argument if d or qf is zero or db is
+         * negative
+         */
+        Config(std::size_t d = 1, double db = 0.0, std::size_t qf = 256);
+
+        std::size_t decimation;
+
+        double deadband;
+
+        std::size_t queuedFrames;
+    };
+
+    /**
+     * @param[in] filePrefix, the path the file name starts with; the
+     * date and time of setup are appended
+     * @param[in] config, which steps are written
+     */
+    tgDataObserver(std::string filePrefix, const Config& config = Config());
     
     /** A class with virtual member functions must have a virtual destructor. */
     virtual ~tgDataObserver();
     
-    /**@todo move functions to constructor when possible */
+    /**
+     * Start a new file and find the components to log
+     * @throw std::runtime_error if the file cannot be opened
+     */
     virtual void onSetup(tgModel& model);
     
     /**
-     * Dispatch the visitors to the given model and log data
+     * Sample the components and queue the frame, if this step is
+     * written
      * @param[in] the number of seconds since the previous call; must be
      * positive
      */
     virtual void onStep(tgModel& model, double dt);
-    
-    /** @todo add reset method so we can start a new file when
-     * the simulation resets */
+
+    /** Block until every queued frame is in the file */
+    void flush();
+
 private:
-    
-    std::ofstream tgOutput;
+
+    /** Fill m_frame from the components at the current time */
+    void sample(const tgModel& model);
+
+    /** True if the deadband lets m_frame through */
+    bool changed() const;
+
+    /** Disable the copy constructor. */
+    tgDataObserver(const tgDataObserver&);
+
+    /** Disable the assignment operator. */
+    tgDataObserver& operator=(const tgDataObserver&);
+
+    const Config m_config;
     
     std::string m_fileName;
     
@@ -69,8 +129,29 @@ private:
     std::string m_filePrefix;
     
     double m_totalTime;
+
+    /** Steps since setup, for decimation */
+    std::size_t m_steps;
+
+    /** A logged descendant; exactly one pointer is not NULL */
+    struct Component
+    {
+        const tgSpringCableActuator* pActuator;
+        const tgRod* pRod;
+    };
+
+    /** The components found at setup */
+    std::size_t m_markers;
+    std::vector<Component> m_components;
+
+    /** The frame being sampled, and the last one written */
+    std::vector<double> m_frame;
+    std::vector<double> m_written;
+
+    /** Nothing has been written since setup */
+    bool m_first;
     
-    tgDataLogger * m_dataLogger;
+    tgDataFrameWriter* m_pWriter;
 };
    
 #endif
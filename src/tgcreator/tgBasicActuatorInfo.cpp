@@ -81,12 +81,30 @@ tgBulletSpringCable* tgBasicActuatorInfo::createTgBulletSpringCable()
     btRigidBody* fromBody = getFromRigidBody();
     btRigidBody* toBody = getToRigidBody();
 
-    // This method can create the spring-cable either at the node location
-    // as specified, or it can automatically re-locate either anchor end
-    // to the edge of a rigid body.
     btVector3 from;
     btVector3 to;
+    getAnchorPoints(from, to);
+	
+    std::vector<tgBulletSpringCableAnchor*> anchorList;
+	
+    tgBulletSpringCableAnchor* anchor1 = new tgBulletSpringCableAnchor(fromBody, from);
+    anchorList.push_back(anchor1);
+	
+    tgBulletSpringCableAnchor* anchor2 = new tgBulletSpringCableAnchor(toBody, to);
+    anchorList.push_back(anchor2);
+	
+    tgBulletSpringCable* const springCable =
+        new tgBulletSpringCable(anchorList, m_config.stiffness, m_config.damping, m_config.pretension);
+    springCable->setSleepThresholds(m_config.sleepStretch, m_config.sleepVelocity);
+    
+    return springCable;
+}
 
+void tgBasicActuatorInfo::getAnchorPoints(btVector3& from, btVector3& to) const
+{
+    // This method can create the spring-cable either at the node location
+    // as specified, or it can automatically re-locate either anchor end
+    // to the edge of a rigid body.
     // Choose either the node location (as given by the tgConnectorInfo's point),
     // or the point returned by the attached rigid body's getConnectorInfo method.
     
@@ -112,15 +130,4 @@ tgBulletSpringCable* tgBasicActuatorInfo::createTgBulletSpringCable()
     // Older version of this code: always relocate the anchors.
     //btVector3 from = getFromRigidInfo()->getConnectionPoint(getFrom(), getTo(), m_config.rotation);
     //btVector3 to = getToRigidInfo()->getConnectionPoint(getTo(), getFrom(), m_config.rotation);
-	
-    std::vector<tgBulletSpringCableAnchor*> anchorList;
-	
-    tgBulletSpringCableAnchor* anchor1 = new tgBulletSpringCableAnchor(fromBody, from);
-    anchorList.push_back(anchor1);
-	
-    tgBulletSpringCableAnchor* anchor2 = new tgBulletSpringCableAnchor(toBody, to);
-    anchorList.push_back(anchor2);
-	
-    return new tgBulletSpringCable(anchorList, m_config.stiffness, m_config.damping, m_config.pretension);
 }
-    
@@ -79,6 +79,20 @@ public:
 
     double getMass();
 
+    const tgBasicActuator::Config& getConfig() const
+    {
+        return m_config;
+    }
+
+    /**
+     * Where the cable's ends attach: the pair's points, or the edges of
+     * the rigids if the config moves them there. The rigids must have
+     * been chosen.
+     * @param[out] from, the end on the from rigid
+     * @param[out] to, the end on the to rigid
+     */
+    void getAnchorPoints(btVector3& from, btVector3& to) const;
+
 protected:    
     
     tgBulletSpringCable* createTgBulletSpringCable();
@@ -72,3 +72,9 @@ void tgBuildSpec::addBuilder(std::string tag_search, tgConnectorInfo* infoFactor
     m_connectorAgents.push_back(new ConnectorAgent(tag_search, infoFactory));
 }
 
+void tgBuildSpec::addCollisionFilter(std::string tag_search, short group,
+                                     short mask)
+{
+    m_collisionFilterAgents.push_back(
+        CollisionFilterAgent(tag_search, group, mask));
+}
@@ -71,7 +71,25 @@ public:
         tgConnectorInfo* infoFactory;
     };
 
-    tgBuildSpec() {}
+    /**
+     * Explicit Bullet collision filter bits for the rigids matching a
+     * tag search, see tgRigidInfo::addCollisionFilter
+     */
+    struct CollisionFilterAgent
+    {
+    public:
+        CollisionFilterAgent(std::string s, short g, short m) :
+            tagSearch(tgTagSearch(s)), group(g), mask(m)
+        {}
+
+        tgTagSearch tagSearch;
+
+        short group;
+
+        short mask;
+    };
+
+    tgBuildSpec() : m_autoCollisionFilter(false) {}
     virtual ~tgBuildSpec();
 
     void addBuilder(std::string tag_search, tgRigidInfo* infoFactory);
@@ -87,10 +105,47 @@ public:
     {
         return m_connectorAgents;
     }
+
+    /**
+     * Add the given collision filter bits to every rigid matching
+     * tag_search. A rigid matching several searches gets the union of
+     * the groups and the intersection of the masks, as do the members
+     * of a compound, which share one body. A compound that mixes
+     * filtered and unfiltered members adds DefaultFilter to its group
+     * and collides with AllFilter, so the unfiltered members still
+     * collide as before.
+     * @param[in] tag_search, the rigids to filter, e.g. "rod leg"
+     * @param[in] group, btBroadphaseProxy filter bits of those rigids
+     * @param[in] mask, the groups those rigids collide with
+     */
+    void addCollisionFilter(std::string tag_search, short group, short mask);
+
+    const std::vector<CollisionFilterAgent>& getCollisionFilterAgents() const
+    {
+        return m_collisionFilterAgents;
+    }
+
+    /**
+     * If set, rigid bodies joined by a connector (a cable or spring)
+     * never collide with each other. Rigids sharing a node are already
+     * one compound body. Static bodies never pair with each other in
+     * any case. Off by default.
+     */
+    void setAutoCollisionFilter(bool enabled)
+    {
+        m_autoCollisionFilter = enabled;
+    }
+
+    bool getAutoCollisionFilter() const
+    {
+        return m_autoCollisionFilter;
+    }
     
 private:
     std::vector<RigidAgent*> m_rigidAgents;
     std::vector<ConnectorAgent*> m_connectorAgents;  
+    std::vector<CollisionFilterAgent> m_collisionFilterAgents;
+    bool m_autoCollisionFilter;
 };
 
 #endif
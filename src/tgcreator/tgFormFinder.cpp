@@ -0,0 +1,498 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgFormFinder.cpp
+ * @brief Contains the implementation of class tgFormFinder
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// This module
+#include "tgFormFinder.h"
+// This library
+#include "tgBasicActuatorInfo.h"
+#include "tgConnectorInfo.h"
+#include "tgRigidInfo.h"
+#include "tgStructureInfo.h"
+// The NTRT Core library
+#include "core/tgBaseRigid.h"
+#include "core/tgBulletUtil.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgWorld.h"
+#include "core/tgWorldBulletPhysicsImpl.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btQuickprof.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * Fictitious inertia per unit of attached stiffness. Two keeps a
+     * unit step stable for a cable pulling on both translation and
+     * rotation of a body.
+     */
+    const double inertiaPerStiffness = 2.0;
+} // namespace
+
+tgFormFinder::Config::Config(double g,
+                             double gh,
+                             double gk,
+                             double tol,
+                             std::size_t maxIter) :
+    gravity(g),
+    groundHeight(gh),
+    groundStiffness(gk),
+    tolerance(tol),
+    maxIterations(maxIter)
+{
+    if (g < 0.0)
+    {
+        throw std::invalid_argument("Gravity is negative");
+    }
+    else if (gk < 0.0)
+    {
+        throw std::invalid_argument("Ground stiffness is negative");
+    }
+    else if (tol <= 0.0)
+    {
+        throw std::invalid_argument("Tolerance is not positive");
+    }
+    else if (maxIter == 0)
+    {
+        throw std::invalid_argument("maxIterations is zero");
+    }
+}
+
+tgFormFinder::Result::Result() :
+    converged(false),
+    iterations(0),
+    residual(0.0),
+    ignoredConnectors(0)
+{
+}
+
+tgFormFinder::tgFormFinder(tgStructure& structure, tgBuildSpec& buildSpec,
+                           const Config& config) :
+    m_config(config),
+    m_ignoredConnectors(0)
+{
+    tgStructureInfo structureInfo(structure, buildSpec);
+    structureInfo.buildInfos();
+
+    // One body per compound, as when built
+    std::map<const tgRigidInfo*, std::size_t> bodyIndex;
+    const std::vector<tgRigidInfo*> rigids = structureInfo.getAllRigids();
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        const tgRigidInfo* pGroup = rigids[i]->getRigidInfoGroup();
+        if (pGroup == NULL)
+        {
+            pGroup = rigids[i];
+        }
+        if (bodyIndex.find(pGroup) != bodyIndex.end())
+        {
+            continue;
+        }
+        bodyIndex[pGroup] = m_bodies.size();
+
+        Body body;
+        body.mass = pGroup->getMass();
+        body.inertia = 0.0;
+        body.rotationalInertia = 0.0;
+        body.designPosition = pGroup->getCenterOfMass();
+        body.position = body.designPosition;
+        body.rotation = btQuaternion::getIdentity();
+        body.velocity = btVector3(0.0, 0.0, 0.0);
+        body.angularVelocity = btVector3(0.0, 0.0, 0.0);
+        body.force = btVector3(0.0, 0.0, 0.0);
+        body.torque = btVector3(0.0, 0.0, 0.0);
+        const std::set<btVector3> nodes = pGroup->getContainedNodes();
+        for (std::set<btVector3>::const_iterator it = nodes.begin();
+             it != nodes.end(); ++it)
+        {
+            body.nodes.push_back(*it - body.designPosition);
+        }
+        m_bodies.push_back(body);
+    }
+
+    const std::vector<tgConnectorInfo*> connectors =
+        structureInfo.getAllConnectors();
+    for (std::size_t i = 0; i < connectors.size(); i++)
+    {
+        const tgBasicActuatorInfo* const pInfo =
+            tgCast::cast<tgConnectorInfo, tgBasicActuatorInfo>(connectors[i]);
+        if (pInfo == NULL || pInfo->getFromRigidInfo() == NULL ||
+            pInfo->getToRigidInfo() == NULL)
+        {
+            m_ignoredConnectors++;
+            continue;
+        }
+        const tgRigidInfo* pFrom = pInfo->getFromRigidInfo()->getRigidInfoGroup();
+        const tgRigidInfo* pTo = pInfo->getToRigidInfo()->getRigidInfoGroup();
+        pFrom = pFrom ? pFrom : pInfo->getFromRigidInfo();
+        pTo = pTo ? pTo : pInfo->getToRigidInfo();
+        const std::map<const tgRigidInfo*, std::size_t>::const_iterator
+            fromIt = bodyIndex.find(pFrom);
+        const std::map<const tgRigidInfo*, std::size_t>::const_iterator
+            toIt = bodyIndex.find(pTo);
+        if (fromIt == bodyIndex.end() || toIt == bodyIndex.end())
+        {
+            m_ignoredConnectors++;
+            continue;
+        }
+
+        btVector3 fromPoint;
+        btVector3 toPoint;
+        pInfo->getAnchorPoints(fromPoint, toPoint);
+        const tgBasicActuator::Config& actuatorConfig = pInfo->getConfig();
+
+        Cable cable;
+        cable.from = fromIt->second;
+        cable.to = toIt->second;
+        cable.fromAnchor = fromPoint - m_bodies[cable.from].designPosition;
+        cable.toAnchor = toPoint - m_bodies[cable.to].designPosition;
+        cable.stiffness = actuatorConfig.stiffness;
+        // As tgSpringCable sets it
+        cable.restLength = fromPoint.distance(toPoint) -
+            actuatorConfig.pretension / actuatorConfig.stiffness;
+        if (cable.restLength <= 0.0)
+        {
+            throw std::invalid_argument("Pretension causes string to shorten "
+                                        "past rest length!");
+        }
+        m_cables.push_back(cable);
+
+        // Stable unit steps need inertia to match stiffness
+        m_bodies[cable.from].inertia += cable.stiffness;
+        m_bodies[cable.from].rotationalInertia +=
+            cable.stiffness * cable.fromAnchor.length2();
+        m_bodies[cable.to].inertia += cable.stiffness;
+        m_bodies[cable.to].rotationalInertia +=
+            cable.stiffness * cable.toAnchor.length2();
+    }
+
+    for (std::size_t i = 0; i < m_bodies.size(); i++)
+    {
+        Body& body = m_bodies[i];
+        if (m_config.groundStiffness > 0.0)
+        {
+            for (std::size_t j = 0; j < body.nodes.size(); j++)
+            {
+                body.inertia += m_config.groundStiffness;
+                body.rotationalInertia +=
+                    m_config.groundStiffness * body.nodes[j].length2();
+            }
+        }
+        // Bodies nothing pulls on only feel gravity
+        body.inertia = body.inertia > 0.0 ?
+            inertiaPerStiffness * body.inertia : 1.0;
+        body.rotationalInertia = body.rotationalInertia > 0.0 ?
+            inertiaPerStiffness * body.rotationalInertia : 1.0;
+    }
+
+    // Relaxation would only follow the fall, never converging
+    if (m_config.gravity > 0.0 && m_config.groundStiffness == 0.0 &&
+        !isAnchored())
+    {
+        throw std::invalid_argument("Gravity with no ground needs every "
+                                    "free body hung from a static rigid");
+    }
+
+    assert(invariant());
+}
+
+bool tgFormFinder::isAnchored() const
+{
+    std::vector<bool> anchored(m_bodies.size());
+    for (std::size_t i = 0; i < m_bodies.size(); i++)
+    {
+        anchored[i] = m_bodies[i].mass == 0.0;
+    }
+
+    // Spread along the cables until nothing changes
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (std::size_t i = 0; i < m_cables.size(); i++)
+        {
+            const Cable& cable = m_cables[i];
+            if (anchored[cable.from] != anchored[cable.to])
+            {
+                anchored[cable.from] = true;
+                anchored[cable.to] = true;
+                changed = true;
+            }
+        }
+    }
+    return std::find(anchored.begin(), anchored.end(), false) ==
+        anchored.end();
+}
+
+tgFormFinder::Result tgFormFinder::solve()
+{
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgFormFinder::solve");
+#endif //BT_NO_PROFILE
+    Result result;
+    result.ignoredConnectors = m_ignoredConnectors;
+
+    const std::size_t n = m_bodies.size();
+    double prevEnergy = 0.0;
+    while (true)
+    {
+        computeForces();
+
+        result.residual = 0.0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const Body& body = m_bodies[i];
+            if (body.mass > 0.0)
+            {
+                result.residual = std::max(result.residual,
+                    static_cast<double>(body.force.length()));
+                result.residual = std::max(result.residual,
+                    static_cast<double>(body.torque.length()));
+            }
+        }
+        if (result.residual <= m_config.tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+        if (result.iterations == m_config.maxIterations)
+        {
+            break;
+        }
+        result.iterations++;
+
+        // Unit steps; the fictitious inertias keep them stable
+        double energy = 0.0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            Body& body = m_bodies[i];
+            if (body.mass > 0.0)
+            {
+                body.velocity += body.force / body.inertia;
+                body.angularVelocity += body.torque / body.rotationalInertia;
+                energy += 0.5 * (body.inertia * body.velocity.length2() +
+                    body.rotationalInertia * body.angularVelocity.length2());
+            }
+        }
+
+        // Kinetic damping: past an energy peak, restart from rest
+        if (energy < prevEnergy)
+        {
+            for (std::size_t i = 0; i < n; i++)
+            {
+                m_bodies[i].velocity.setZero();
+                m_bodies[i].angularVelocity.setZero();
+            }
+            energy = 0.0;
+        }
+        prevEnergy = energy;
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            Body& body = m_bodies[i];
+            body.position += body.velocity;
+            const btScalar angle = body.angularVelocity.length();
+            if (angle > 0.0)
+            {
+                body.rotation =
+                    btQuaternion(body.angularVelocity / angle, angle) *
+                    body.rotation;
+                body.rotation.normalize();
+            }
+        }
+    }
+
+    assert(invariant());
+    return result;
+}
+
+std::vector<double> tgFormFinder::getTensions() const
+{
+    std::vector<double> result;
+    result.reserve(m_cables.size());
+    btVector3 fromPoint;
+    btVector3 toPoint;
+    for (std::size_t i = 0; i < m_cables.size(); i++)
+    {
+        result.push_back(tension(m_cables[i], fromPoint, toPoint));
+    }
+    return result;
+}
+
+void tgFormFinder::apply(tgModel& model, tgWorld& world) const
+{
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
+    btOverlappingPairCache* const pPairCache =
+        dynamicsWorld.getBroadphase()->getOverlappingPairCache();
+
+    // Rigids of a compound share one body
+    std::set<btRigidBody*> moved;
+    const std::vector<tgBaseRigid*> rigids =
+        tgCast::filter<tgModel, tgBaseRigid>(model.getDescendants());
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        btRigidBody* const pRigidBody = rigids[i]->getPRigidBody();
+        if (pRigidBody == NULL || pRigidBody->isStaticObject() ||
+            !moved.insert(pRigidBody).second)
+        {
+            continue;
+        }
+
+        // Bodies are built with their origin at the center of mass
+        const btTransform& built = pRigidBody->getWorldTransform();
+        const Body* pBody = NULL;
+        double closest = 0.0;
+        for (std::size_t j = 0; j < m_bodies.size(); j++)
+        {
+            const double distance =
+                m_bodies[j].designPosition.distance(built.getOrigin());
+            if (m_bodies[j].mass > 0.0 && (pBody == NULL || distance < closest))
+            {
+                pBody = &m_bodies[j];
+                closest = distance;
+            }
+        }
+        if (pBody == NULL ||
+            closest > 1.0e-4 * (1.0 + built.getOrigin().length()))
+        {
+            throw std::invalid_argument("Model has a body the structure "
+                                        "does not, or it has moved");
+        }
+
+        const btTransform transform(pBody->rotation * built.getRotation(),
+                                    pBody->position);
+        pRigidBody->setWorldTransform(transform);
+        pRigidBody->setInterpolationWorldTransform(transform);
+        if (pRigidBody->getMotionState())
+        {
+            pRigidBody->getMotionState()->setWorldTransform(transform);
+        }
+        const btVector3 zero(0.0, 0.0, 0.0);
+        pRigidBody->setLinearVelocity(zero);
+        pRigidBody->setAngularVelocity(zero);
+        pRigidBody->setInterpolationLinearVelocity(zero);
+        pRigidBody->setInterpolationAngularVelocity(zero);
+        pRigidBody->clearForces();
+
+        // Contact points cached for the design pose are no longer valid
+        if (pRigidBody->getBroadphaseHandle())
+        {
+            pPairCache->cleanProxyFromPairs(pRigidBody->getBroadphaseHandle(),
+                                            dynamicsWorld.getDispatcher());
+        }
+    }
+    dynamicsWorld.updateAabbs();
+
+    tgWorldBulletPhysicsImpl& impl =
+        static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+    impl.updateSpringCables();
+}
+
+void tgFormFinder::computeForces()
+{
+    const std::size_t n = m_bodies.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        Body& body = m_bodies[i];
+        body.force = btVector3(0.0, -m_config.gravity * body.mass, 0.0);
+        body.torque.setZero();
+    }
+
+    btVector3 fromPoint;
+    btVector3 toPoint;
+    for (std::size_t i = 0; i < m_cables.size(); i++)
+    {
+        const Cable& cable = m_cables[i];
+        const double t = tension(cable, fromPoint, toPoint);
+        if (t > 0.0)
+        {
+            const btVector3 f = (toPoint - fromPoint).normalized() * t;
+            Body& from = m_bodies[cable.from];
+            Body& to = m_bodies[cable.to];
+            from.force += f;
+            from.torque += (fromPoint - from.position).cross(f);
+            to.force -= f;
+            to.torque -= (toPoint - to.position).cross(f);
+        }
+    }
+
+    if (m_config.groundStiffness > 0.0)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            Body& body = m_bodies[i];
+            for (std::size_t j = 0; j < body.nodes.size(); j++)
+            {
+                const btVector3 arm = quatRotate(body.rotation, body.nodes[j]);
+                const double depth =
+                    m_config.groundHeight - (body.position + arm).y();
+                if (depth > 0.0)
+                {
+                    const btVector3 f(0.0, m_config.groundStiffness * depth,
+                                      0.0);
+                    body.force += f;
+                    body.torque += arm.cross(f);
+                }
+            }
+        }
+    }
+}
+
+double tgFormFinder::tension(const Cable& cable, btVector3& fromPoint,
+                             btVector3& toPoint) const
+{
+    const Body& from = m_bodies[cable.from];
+    const Body& to = m_bodies[cable.to];
+    fromPoint = from.position + quatRotate(from.rotation, cable.fromAnchor);
+    toPoint = to.position + quatRotate(to.rotation, cable.toAnchor);
+    const double length = fromPoint.distance(toPoint);
+    return length > cable.restLength ?
+        cable.stiffness * (length - cable.restLength) : 0.0;
+}
+
+bool tgFormFinder::invariant() const
+{
+    for (std::size_t i = 0; i < m_cables.size(); i++)
+    {
+        if (m_cables[i].from >= m_bodies.size() ||
+            m_cables[i].to >= m_bodies.size() ||
+            m_cables[i].restLength <= 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
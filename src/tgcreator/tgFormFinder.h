@@ -0,0 +1,235 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_FORM_FINDER_H
+#define TG_FORM_FINDER_H
+
+/**
+ * @file tgFormFinder.h
+ * @brief Contains the definition of class tgFormFinder
+ * @author NTRT contributors
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgBuildSpec;
+class tgModel;
+class tgStructure;
+class tgWorld;
+
+/**
+ * Finds the static equilibrium of a structure without simulating its
+ * dynamics. Rigids (compounded as they would be when built) are rigid
+ * bodies and cables are tension-only springs with the stiffness and rest
+ * length they would get from their tgSpringCableActuator::Config, so the
+ * result is the pose the built model would settle into.
+ *
+ * The solver is dynamic relaxation with kinetic damping: fictitious
+ * masses are chosen from the stiffness attached to each body so unit
+ * steps are stable, and all velocities are zeroed whenever the kinetic
+ * energy peaks. Each iteration is one pass over the cables and bodies;
+ * no matrix is assembled. This takes far fewer iterations than running
+ * Bullet until the structure is still, and each is much cheaper.
+ *
+ * Only connectors built by tgBasicActuatorInfo and its subclasses are
+ * modelled; others are counted in Result::ignoredConnectors. Static
+ * rigids (zero mass) stay put. There is no friction, and the optional
+ * ground only pushes up on the rigids' nodes.
+ *
+ * To start a simulation in the settled pose, build the model as usual
+ * and call apply() before the first step.
+ */
+class tgFormFinder
+{
+public:
+
+    /**
+     * Solver parameters
+     */
+    struct Config
+    {
+        /**
+         * @param[in] g, gravitational acceleration along -Y; the default
+         * of zero finds the self-stressed form. Under gravity each free
+         * body must be held up by the ground or by cables to a static
+         * rigid, or it would fall forever.
+         * @param[in] gh, the height of the ground plane
+         * @param[in] gk, the stiffness of the ground pushing up on nodes
+         * below gh; zero, the default, means no ground
+         * @param[in] tol, converged when no free body has a net force or
+         * torque larger than this
+         * @param[in] maxIter, the most iterations solve() takes
+         * @throw std::invalid_argument if a parameter is negative or tol
+         * or maxIter is zero
+         */
+        Config(double g = 0.0,
+               double gh = 0.0,
+               double gk = 0.0,
+               double tol = 1.0e-6,
+               std::size_t maxIter = 100000);
+
+        double gravity;
+
+        double groundHeight;
+
+        double groundStiffness;
+
+        double tolerance;
+
+        std::size_t maxIterations;
+    };
+
+    /**
+     * The outcome of solve()
+     */
+    struct Result
+    {
+        Result();
+
+        /** True if the residual is within the tolerance */
+        bool converged;
+
+        /** Iterations taken by this call of solve() */
+        std::size_t iterations;
+
+        /** Largest net force or torque on a free body */
+        double residual;
+
+        /** Connectors that are not spring cables, and were left out */
+        std::size_t ignoredConnectors;
+    };
+
+    /**
+     * Read the bodies and cables that buildSpec would build from
+     * structure. Nothing is built into a world.
+     * @param[in] structure, the structure in its design pose
+     * @param[in] buildSpec, the builders that would build it
+     * @param[in] config, the solver parameters
+     * @throw std::invalid_argument if there is gravity but no ground,
+     * and some free body is not joined by cables to a static rigid
+     */
+    tgFormFinder(tgStructure& structure, tgBuildSpec& buildSpec,
+                 const Config& config = Config());
+
+    /**
+     * Relax toward equilibrium from the current pose, which is the
+     * design pose on the first call
+     */
+    Result solve();
+
+    /**
+     * The tension of each modelled cable in the current pose, in the
+     * order of tgStructureInfo::getAllConnectors without the ignored ones
+     */
+    std::vector<double> getTensions() const;
+
+    /**
+     * Move the bodies of a model built from the same structure and
+     * build spec into the current pose, at rest. Call this after the
+     * model is set up and before the world is stepped; the cables keep
+     * the rest lengths they were built with, which are the ones solved
+     * for.
+     * @param[in] model, the built model
+     * @param[in,out] world, the world the model was built into
+     * @throw std::invalid_argument if a body of the model is not where
+     * any body of the structure was designed to be
+     */
+    void apply(tgModel& model, tgWorld& world) const;
+
+private:
+
+    /** A compound or single rigid */
+    struct Body
+    {
+        /** The real mass, zero if static */
+        double mass;
+
+        /** Fictitious translational and rotational inertia */
+        double inertia;
+        double rotationalInertia;
+
+        /** Center of mass in the design pose */
+        btVector3 designPosition;
+
+        /** The current center of mass, and rotation from the design pose */
+        btVector3 position;
+        btQuaternion rotation;
+
+        btVector3 velocity;
+        btVector3 angularVelocity;
+
+        /** Net force and torque at the current pose */
+        btVector3 force;
+        btVector3 torque;
+
+        /** The nodes, relative to the center of mass, for the ground */
+        std::vector<btVector3> nodes;
+    };
+
+    /** A tension-only spring between two bodies */
+    struct Cable
+    {
+        std::size_t from;
+        std::size_t to;
+
+        /** Anchors relative to each body's design center of mass */
+        btVector3 fromAnchor;
+        btVector3 toAnchor;
+
+        double stiffness;
+        double restLength;
+    };
+
+    /** Fill in each body's force and torque */
+    void computeForces();
+
+    /**
+     * True if every free body is joined through cables to a static
+     * one, so without a ground gravity can have an equilibrium
+     */
+    bool isAnchored() const;
+
+    /**
+     * Tension of a cable at the current pose
+     * @param[out] fromPoint, where the cable meets the from body
+     * @param[out] toPoint, where the cable meets the to body
+     */
+    double tension(const Cable& cable, btVector3& fromPoint,
+                   btVector3& toPoint) const;
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+    const Config m_config;
+
+    std::vector<Body> m_bodies;
+
+    std::vector<Cable> m_cables;
+
+    std::size_t m_ignoredConnectors;
+};
+
+#endif  // TG_FORM_FINDER_H
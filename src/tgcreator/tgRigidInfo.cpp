@@ -110,11 +110,33 @@ void tgRigidInfo::initRigidBody(tgWorld& world)
                 btTransform transform = rigid->getTransform();
                 btCollisionShape* shape = rigid->getCollisionShape(world);
                 
-                btRigidBody* body = 
+                btRigidBody* body = NULL;
+                if (rigid->hasCollisionFilter())
+                {
+                    // Static bodies never need to pair with each other
+                    short group = rigid->getCollisionGroup();
+                    short mask = rigid->getCollisionMask();
+                    if (mass == 0.0)
+                    {
+                        group |= btBroadphaseProxy::StaticFilter;
+                        mask &= ~btBroadphaseProxy::StaticFilter;
+                    }
+                    body = tgBulletUtil::createRigidBody(
+                            &tgBulletUtil::worldToDynamicsWorld(world),
+                            mass,
+                            transform,
+                            shape,
+                            group,
+                            mask);
+                }
+                else
+                {
+                    body = 
           tgBulletUtil::createRigidBody(&tgBulletUtil::worldToDynamicsWorld(world),
                         mass,
                         transform,
                         shape);
+                }
                 body->setFlags(BT_ENABLE_GYROPSCOPIC_FORCE);
                 rigid->setRigidBody(body);
             }
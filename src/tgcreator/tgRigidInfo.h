@@ -79,21 +79,30 @@ public:
         tgTaggable(),
         m_collisionShape(NULL), 
         m_rigidInfoGroup(NULL), 
-        m_collisionObject(NULL)
+        m_collisionObject(NULL),
+        m_hasCollisionFilter(false),
+        m_collisionGroup(0),
+        m_collisionMask(0)
     {}    
 
     tgRigidInfo(tgTags tags) : 
         tgTaggable(tags),
         m_collisionShape(NULL), 
         m_rigidInfoGroup(NULL), 
-        m_collisionObject(NULL)
+        m_collisionObject(NULL),
+        m_hasCollisionFilter(false),
+        m_collisionGroup(0),
+        m_collisionMask(0)
     {}    
 
     tgRigidInfo(const std::string& space_separated_tags) :
         tgTaggable(space_separated_tags),
         m_collisionShape(NULL), 
         m_rigidInfoGroup(NULL), 
-        m_collisionObject(NULL)        
+        m_collisionObject(NULL),
+        m_hasCollisionFilter(false),
+        m_collisionGroup(0),
+        m_collisionMask(0)
     {}    
     
     /** The destructor has nothing to do. */
@@ -165,6 +174,49 @@ public:
         m_rigidInfoGroup = rigidInfoGroup;
     }
 
+    /**
+     * Give the rigid body explicit Bullet collision filter bits instead
+     * of Bullet's defaults. If already set, the groups are combined and
+     * the masks intersected, which is how the members of a compound
+     * share one body, unless some members have no filter (see
+     * tgStructureInfo::autoCompoundRigids). Static bodies never pair
+     * with each other
+     * regardless. Contact cables only see bodies whose group has
+     * btBroadphaseProxy::DefaultFilter or StaticFilter and whose mask
+     * has CharacterFilter.
+     * @param[in] group, the btBroadphaseProxy filter bits of this body
+     * @param[in] mask, the groups this body collides with
+     */
+    void addCollisionFilter(short group, short mask)
+    {
+        if (m_hasCollisionFilter)
+        {
+            m_collisionGroup |= group;
+            m_collisionMask &= mask;
+        }
+        else
+        {
+            m_hasCollisionFilter = true;
+            m_collisionGroup = group;
+            m_collisionMask = mask;
+        }
+    }
+
+    bool hasCollisionFilter() const
+    {
+        return m_hasCollisionFilter;
+    }
+
+    short getCollisionGroup() const
+    {
+        return m_collisionGroup;
+    }
+
+    short getCollisionMask() const
+    {
+        return m_collisionMask;
+    }
+
     /**
      * Return a pointer to the corresponding btRigidBody.
      * @return a pointer to the corresponding btRigidBody
@@ -345,6 +397,14 @@ protected:  // Protected, not private -- subclasses need access
      * Typically a btRigidBody, but can also be a btGhostObject
      */
     mutable btCollisionObject* m_collisionObject;
+
+    /**
+     * Collision filter bits from the build spec, used when the rigid
+     * body is added to the world if m_hasCollisionFilter is set
+     */
+    bool m_hasCollisionFilter;
+    short m_collisionGroup;
+    short m_collisionMask;
     
 };
 
@@ -28,6 +28,7 @@
 #include "tgRodInfo.h"
 
 // The NTRT Core library
+#include "core/tgCollisionShapeCache.h"
 #include "core/tgWorldBulletPhysicsImpl.h"
 
 // The Bullet Physics Library
@@ -102,13 +103,11 @@ btCollisionShape* tgRodInfo::getCollisionShape(tgWorld& world) const
     {
         const double radius = m_config.radius;
         const double length = getLength();
-        m_collisionShape =
-            new btCylinderShape(btVector3(radius, length / 2.0, radius));
-    
-        // Add the collision shape to the array so we can delete it later
+        // Rods of the same size share a shape, owned by the world
         tgWorldBulletPhysicsImpl& bulletWorld =
       (tgWorldBulletPhysicsImpl&)world.implementation();
-        bulletWorld.addCollisionShape(m_collisionShape);
+        m_collisionShape = bulletWorld.shapeCache().getCylinder(
+            btVector3(radius, length / 2.0, radius));
     }
     return m_collisionShape;
 }
@@ -28,6 +28,7 @@
 #include "tgSphereInfo.h"
 
 // The NTRT Core library
+#include "core/tgCollisionShapeCache.h"
 #include "core/tgWorldBulletPhysicsImpl.h"
 
 // The Bullet Physics Library
@@ -102,13 +103,10 @@ btCollisionShape* tgSphereInfo::getCollisionShape(tgWorld& world) const
     if (m_collisionShape == NULL) 
     {
         const double radius = m_config.radius;
-        m_collisionShape =
-            new btSphereShape(radius);
-    
-        // Add the collision shape to the array so we can delete it later
+        // Spheres of the same size share a shape, owned by the world
         tgWorldBulletPhysicsImpl& bulletWorld =
       (tgWorldBulletPhysicsImpl&)world.implementation();
-        bulletWorld.addCollisionShape(m_collisionShape);
+        m_collisionShape = bulletWorld.shapeCache().getSphere(radius);
     }
     return m_collisionShape;
 }
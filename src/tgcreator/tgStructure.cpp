@@ -33,62 +33,177 @@
 #include <LinearMath/btQuaternion.h>
 #include <LinearMath/btVector3.h>
  
-tgStructure::tgStructure() : tgTaggable() 
+tgStructure::Geometry::Geometry()
+{
+}
+
+tgStructure::Geometry::Geometry(const Geometry& orig) :
+    nodes(orig.nodes),
+    pairs(orig.pairs),
+    children(orig.children.size())
+{
+    for (std::size_t i = 0; i < orig.children.size(); ++i) {
+        children[i] = new tgStructure(*orig.children[i]);
+    }
+}
+
+tgStructure::Geometry::~Geometry()
+{
+    for (std::size_t i = 0; i < children.size(); ++i)
+    {
+        delete children[i];
+    }
+}
+
+tgStructure::Transform::Transform() :
+    rotation(btQuaternion::getIdentity()),
+    translation(0.0, 0.0, 0.0),
+    scale(1.0)
+{
+}
+
+bool tgStructure::Transform::isIdentity() const
+{
+    return (scale == 1.0) &&
+        (rotation == btQuaternion::getIdentity()) &&
+        translation.isZero();
+}
+
+void tgStructure::Transform::then(const Transform& other)
+{
+    // other(this(p)) = s2 * R2(s1 * R1(p) + t1) + t2
+    translation = other.apply(translation);
+    rotation = other.rotation * rotation;
+    rotation.normalize();
+    scale *= other.scale;
+}
+
+btVector3 tgStructure::Transform::apply(const btVector3& p) const
+{
+    return scale * quatRotate(rotation, p) + translation;
+}
+ 
+tgStructure::tgStructure() : tgTaggable(), m_pGeometry(new Geometry()),
+        m_pinned(false)
 {
 }
 
 
 /**
- * Copy constructor
+ * Copy constructor. Shares the geometry, see materialize(), unless
+ * references into orig's have been handed out
  */
 tgStructure::tgStructure(const tgStructure& orig) : tgTaggable(orig.getTags()), 
-        m_children(orig.m_children.size()), m_nodes(orig.m_nodes), m_pairs(orig.m_pairs)
+        m_pGeometry(orig.m_pGeometry), m_transform(orig.m_transform),
+        m_pinned(false)
 {
-    
-    // Copy children
-    for (std::size_t i = 0; i < orig.m_children.size(); ++i) {
-        m_children[i] = new tgStructure(*orig.m_children[i]);
+    if (orig.m_pinned)
+    {
+        m_pGeometry.reset(new Geometry(*orig.m_pGeometry));
     }
 }
 
-tgStructure::tgStructure(const tgTags& tags) : tgTaggable(tags)
+tgStructure& tgStructure::operator=(const tgStructure& orig)
+{
+    if (this != &orig)
+    {
+        // Shares or copies orig's geometry as the copy constructor does
+        const tgStructure copy(orig);
+        tgTaggable::operator=(copy);
+        m_pGeometry = copy.m_pGeometry;
+        m_transform = copy.m_transform;
+        m_pinned = false;
+    }
+    return *this;
+}
+
+tgStructure::tgStructure(const tgTags& tags) : tgTaggable(tags),
+        m_pGeometry(new Geometry()), m_pinned(false)
 {
 }
 
-tgStructure::tgStructure(const std::string& space_separated_tags) : tgTaggable(space_separated_tags)
+tgStructure::tgStructure(const std::string& space_separated_tags) : tgTaggable(space_separated_tags),
+        m_pGeometry(new Geometry()), m_pinned(false)
 {
 }
 
 tgStructure::~tgStructure()
 {
-    for (std::size_t i = 0; i < m_children.size(); ++i)
+}
+
+void tgStructure::materialize() const
+{
+    if (!m_pGeometry.unique())
     {
-        delete m_children[i];
+        m_pGeometry.reset(new Geometry(*m_pGeometry));
+    }
+    if (!m_transform.isIdentity())
+    {
+        std::vector<tgNode>& nodes = m_pGeometry->nodes.getNodes();
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            const btVector3 p = m_transform.apply(nodes[i]);
+            nodes[i].setValue(p.x(), p.y(), p.z());
+        }
+        std::vector<tgPair>& pairs = m_pGeometry->pairs.getPairs();
+        for (std::size_t i = 0; i < pairs.size(); ++i)
+        {
+            pairs[i].getFrom() = m_transform.apply(pairs[i].getFrom());
+            pairs[i].getTo() = m_transform.apply(pairs[i].getTo());
+        }
+        std::vector<tgStructure*>& children = m_pGeometry->children;
+        for (std::size_t i = 0; i < children.size(); ++i)
+        {
+            tgStructure * const pStructure = children[i];
+            assert(pStructure != NULL);
+            pStructure->transform(m_transform);
+        }
+        m_transform = Transform();
+    }
+}
+
+void tgStructure::pin() const
+{
+    materialize();
+    m_pinned = true;
+}
+
+void tgStructure::transform(const Transform& t)
+{
+    m_transform.then(t);
+    if (m_pinned)
+    {
+        materialize();
     }
 }
 
 void tgStructure::addNode(double x, double y, double z, std::string tags)
 {
-    m_nodes.addNode(x, y, z, tags);
+    materialize();
+    m_pGeometry->nodes.addNode(x, y, z, tags);
 }
 
 void tgStructure::addNode(tgNode& newNode)
 {
-    m_nodes.addNode(newNode);
+    materialize();
+    m_pGeometry->nodes.addNode(newNode);
 }
 
 void tgStructure::addPair(int fromNodeIdx, int toNodeIdx, std::string tags)
 {
-    addPair(m_nodes[fromNodeIdx], m_nodes[toNodeIdx], tags);
+    materialize();
+    addPair(m_pGeometry->nodes[fromNodeIdx], m_pGeometry->nodes[toNodeIdx], tags);
 }
 
 void tgStructure::addPair(const btVector3& from, const btVector3& to, std::string tags)
 {
+    materialize();
+    tgPairs& pairs = m_pGeometry->pairs;
     // @todo: do we need to pass in tags here? might be able to save some proc time if not...
     tgPair p = tgPair(from, to);
-    if (!m_pairs.contains(p))
+    if (!pairs.contains(p))
     {
-        m_pairs.addPair(tgPair(from, to, tags));
+        pairs.addPair(tgPair(from, to, tags));
     }
     else
     {
@@ -99,22 +214,19 @@ void tgStructure::addPair(const btVector3& from, const btVector3& to, std::strin
 }
 
 void tgStructure::removePair(const tgPair& pair) {
-    m_pairs.removePair(pair);
-    for (unsigned int i = 0; i < m_children.size(); i++) {
-        m_children[i]->removePair(pair);
+    materialize();
+    m_pGeometry->pairs.removePair(pair);
+    std::vector<tgStructure*>& children = m_pGeometry->children;
+    for (unsigned int i = 0; i < children.size(); i++) {
+        children[i]->removePair(pair);
     }
 }
 
 void tgStructure::move(const btVector3& offset)
 {
-    m_nodes.move(offset);
-    m_pairs.move(offset);
-    for (size_t i = 0; i < m_children.size(); ++i)
-    {
-        tgStructure * const pStructure = m_children[i];
-    assert(pStructure != NULL);
-        pStructure->move(offset);
-    }
+    Transform t;
+    t.translation = offset;
+    transform(t);
 }
 
 void tgStructure::addRotation(const btVector3& fixedPoint,
@@ -137,15 +249,12 @@ void tgStructure::addRotation(const btVector3& fixedPoint,
 void tgStructure::addRotation(const btVector3& fixedPoint,
                  const btQuaternion& rotation)
 {
-    m_nodes.addRotation(fixedPoint, rotation);
-    m_pairs.addRotation(fixedPoint, rotation);
-
-    for (std::size_t i = 0; i < m_children.size(); ++i)
-    {
-        tgStructure * const pStructure = m_children[i];
-    assert(pStructure != NULL);
-        pStructure->addRotation(fixedPoint, rotation);
-    }
+    // Rotate about fixedPoint: p -> R(p - fixedPoint) + fixedPoint.
+    // As tgUtil::addRotation, only the axis and angle of rotation count
+    Transform t;
+    t.rotation = btQuaternion(rotation.getAxis(), rotation.getAngle());
+    t.translation = fixedPoint - quatRotate(t.rotation, fixedPoint);
+    transform(t);
 }
 
 void tgStructure::scale(double scaleFactor) {
@@ -154,14 +263,11 @@ void tgStructure::scale(double scaleFactor) {
 }
 
 void tgStructure::scale(const btVector3& referencePoint, double scaleFactor) {
-    m_nodes.scale(referencePoint, scaleFactor);
-    m_pairs.scale(referencePoint, scaleFactor);
-
-    for (int i = 0; i < m_children.size(); i++) {
-        tgStructure* const childStructure = m_children[i];
-        assert(childStructure != NULL);
-        childStructure->scale(referencePoint, scaleFactor);
-    }
+    // p -> (p - referencePoint) * scaleFactor + referencePoint
+    Transform t;
+    t.scale = scaleFactor;
+    t.translation = referencePoint - referencePoint * scaleFactor;
+    transform(t);
 }
 
 void tgStructure::addChild(tgStructure* pChild)
@@ -172,35 +278,52 @@ void tgStructure::addChild(tgStructure* pChild)
     /// structure may build the pairs, while another may not depending on its tags.
     if (pChild != NULL)
     {
-        m_children.push_back(pChild);
+        // The caller keeps the pointer, so neither may be shared. This
+        // also keeps pending transforms from applying to the new child.
+        pin();
+        pChild->pin();
+        m_pGeometry->children.push_back(pChild);
     }
 }
 
 void tgStructure::addChild(const tgStructure& child)
 {
-    m_children.push_back(new tgStructure(child));
+    materialize();
+    m_pGeometry->children.push_back(new tgStructure(child));
     
 }
 
 btVector3 tgStructure::getCentroid() const {
     btVector3 centroid = btVector3(0, 0, 0);
     int numNodes = 0;
-    std::queue< const tgStructure*> q;
-
-    q.push(this);
+    sumNodes(centroid, numNodes);
+    return centroid/numNodes;
+}
 
-    while (!q.empty()) {
-        const tgStructure* structure = q.front();
-        q.pop();
-        for (int i = 0; i < structure->m_nodes.size(); i++) {
-            centroid += structure->m_nodes[i];
-            numNodes++;
-        }
-        for (int i = 0; i < structure->m_children.size(); i++) {
-            q.push(structure->m_children[i]);
-        }
+void tgStructure::sumNodes(btVector3& sum, int& count) const
+{
+    // Nodes are transformed on the fly, so scale() keeps instances shared
+    const std::vector<tgNode>& nodes = m_pGeometry->nodes.getNodes();
+    btVector3 own(0.0, 0.0, 0.0);
+    for (std::size_t i = 0; i < nodes.size(); i++)
+    {
+        own += nodes[i];
+    }
+    int childCount = 0;
+    btVector3 childSum(0.0, 0.0, 0.0);
+    const std::vector<tgStructure*>& children = m_pGeometry->children;
+    for (std::size_t i = 0; i < children.size(); i++)
+    {
+        children[i]->sumNodes(childSum, childCount);
+    }
+    // Children have m_transform still to come as well. It is affine,
+    // so it can be applied to the sums.
+    const int n = nodes.size() + childCount;
+    if (n > 0)
+    {
+        sum += m_transform.apply((own + childSum) / n) * n;
+        count += n;
     }
-    return centroid/numNodes;
 }
 
 tgNode& tgStructure::findNode(const std::string& tags) {
@@ -211,13 +334,16 @@ tgNode& tgStructure::findNode(const std::string& tags) {
     while (!q.empty()) {
         tgStructure* structure = q.front();
         q.pop();
-        for (int i = 0; i < structure->m_nodes.size(); i++) {
-            if (structure->m_nodes[i].hasAllTags(tags)) {
-                return structure->m_nodes[i];
+        structure->pin();
+        tgNodes& nodes = structure->m_pGeometry->nodes;
+        for (int i = 0; i < nodes.size(); i++) {
+            if (nodes[i].hasAllTags(tags)) {
+                return nodes[i];
             }
         }
-        for (int i = 0; i < structure->m_children.size(); i++) {
-            q.push(structure->m_children[i]);
+        const std::vector<tgStructure*>& children = structure->m_pGeometry->children;
+        for (int i = 0; i < children.size(); i++) {
+            q.push(children[i]);
         }
     }
     throw std::invalid_argument("Node not found: " + tags);
@@ -231,14 +357,17 @@ tgPair& tgStructure::findPair(const btVector3& from, const btVector3& to) {
     while (!q.empty()) {
         tgStructure* structure = q.front();
         q.pop();
-        for (int i = 0; i < structure->m_pairs.size(); i++) {
-            if ((structure->m_pairs[i].getFrom() == from && structure->m_pairs[i].getTo() == to) ||
-                (structure->m_pairs[i].getFrom() == to && structure->m_pairs[i].getTo() == from)) {
-                return structure->m_pairs[i];
+        structure->pin();
+        tgPairs& pairs = structure->m_pGeometry->pairs;
+        for (int i = 0; i < pairs.size(); i++) {
+            if ((pairs[i].getFrom() == from && pairs[i].getTo() == to) ||
+                (pairs[i].getFrom() == to && pairs[i].getTo() == from)) {
+                return pairs[i];
             }
         }
-        for (int i = 0; i < structure->m_children.size(); i++) {
-            q.push(structure->m_children[i]);
+        const std::vector<tgStructure*>& children = structure->m_pGeometry->children;
+        for (int i = 0; i < children.size(); i++) {
+            q.push(children[i]);
         }
     }
     std::ostringstream pairString;
@@ -249,8 +378,9 @@ tgPair& tgStructure::findPair(const btVector3& from, const btVector3& to) {
 tgStructure& tgStructure::findChild(const std::string& tags) {
     std::queue<tgStructure*> q;
 
-    for (int i = 0; i < m_children.size(); i++) {
-        q.push(m_children[i]);
+    const std::vector<tgStructure*>& children = getChildren();
+    for (int i = 0; i < children.size(); i++) {
+        q.push(children[i]);
     }
 
     while (!q.empty()) {
@@ -259,8 +389,9 @@ tgStructure& tgStructure::findChild(const std::string& tags) {
         if (structure->hasAllTags(tags)) {
             return *structure;
         }
-        for (int i = 0; i < structure->m_children.size(); i++) {
-            q.push(structure->m_children[i]);
+        const std::vector<tgStructure*>& grandchildren = structure->getChildren();
+        for (int i = 0; i < grandchildren.size(); i++) {
+            q.push(grandchildren[i]);
         }
     }
     throw std::invalid_argument("Child structure not found: " + tags);
@@ -32,14 +32,17 @@
 #include "tgPairs.h"
 // The NTRT Core Library
 #include "core/tgTaggable.h"
+// The Bullet Physics library
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btVector3.h"
+// Boost
+#include "boost/shared_ptr.hpp"
 // The C++ Standard Library
 #include <string>
 #include <vector>
 #include <queue>
 
 // Forward declarations
-class btQuaternion;
-class btVector3;
 class tgNode;
 class tgTags;
 
@@ -50,6 +53,19 @@ class tgTags;
  * create physical representations of the structures with rods, muscles, etc.
  * Note that tags can be anything you want -- you'll specify the tags that you 
  * want to use to build things like rods or muscles during the build phase.
+ *
+ * Copies are instances: a copy shares its nodes, pairs and children with
+ * the original, and move, addRotation and scale only record a transform.
+ * The nodes and pairs of an instance are copied and transformed the
+ * first time they are read or changed, typically when tgStructureInfo
+ * builds the model. Adding many copies of a segment therefore costs
+ * memory and time for the segment's geometry once, plus a little per
+ * instance, until the model is built.
+ *
+ * Once a structure hands out a reference or pointer into itself (the
+ * getters, the find functions, or a child added by pointer) it is
+ * pinned: it applies transforms at once and is deep copied, so those
+ * references keep following it as they did before instancing.
  */
 class tgStructure : public tgTaggable
 {
@@ -57,8 +73,12 @@ public:
     
     tgStructure();
 
+    /** An instance of orig, see the class description */
     tgStructure(const tgStructure& orig);
 
+    /** Become an instance of orig */
+    tgStructure& operator=(const tgStructure& orig);
+
     tgStructure(const tgTags& tags);
 
     tgStructure(const std::string& space_separated_tags);
@@ -123,11 +143,15 @@ public:
     void scale(const btVector3& referencePoint, double scaleFactor);
 
     /**
-     * Add a child structure. Note that this will be copied rather than
-     * being a reference or a pointer.
+     * Add a child structure, taking ownership of it. The child and this
+     * structure are pinned, so the pointer stays valid.
      */
     void addChild(tgStructure* child);    
 
+    /**
+     * Add an instance of a child structure, which shares child's
+     * geometry until either of them is changed.
+     */
     void addChild(const tgStructure& child);
 
     /**
@@ -137,7 +161,8 @@ public:
      */
     const tgNodes& getNodes() const
     {
-        return m_nodes;
+        pin();
+        return m_pGeometry->nodes;
     }
 
     /**
@@ -164,7 +189,8 @@ public:
      */
     const tgPairs& getPairs() const
     {
-        return m_pairs;
+        pin();
+        return m_pGeometry->pairs;
     }
 
     /**
@@ -183,7 +209,8 @@ public:
      */
     const std::vector<tgStructure*>& getChildren() const
     {
-        return m_children;
+        pin();
+        return m_pGeometry->children;
     }
 
     /**
@@ -198,12 +225,88 @@ public:
 
 private:
 
-    tgNodes m_nodes;
+    /**
+     * The nodes, pairs and children, shared between instances until
+     * one of them changes.
+     */
+    struct Geometry
+    {
+        Geometry();
+
+        /** Copies the nodes and pairs, and instances the children */
+        Geometry(const Geometry& orig);
+
+        ~Geometry();
+
+        tgNodes nodes;
+
+        tgPairs pairs;
+
+        // we own these
+        std::vector<tgStructure*> children;
+
+    private:
+        Geometry& operator=(const Geometry&);
+    };
+
+    /**
+     * A similarity transform, p -> scale * rotation(p) + translation.
+     * move, addRotation and scale are all of this form.
+     */
+    struct Transform
+    {
+        /** The identity */
+        Transform();
+
+        bool isIdentity() const;
+
+        /** Make this the transform that applies this, then other */
+        void then(const Transform& other);
 
-    tgPairs m_pairs;
+        btVector3 apply(const btVector3& p) const;
 
-    // we own these
-    std::vector<tgStructure*> m_children;
+        btQuaternion rotation;
+        btVector3 translation;
+        double scale;
+    };
+
+    /**
+     * Make m_pGeometry unshared and apply m_transform to its nodes and
+     * pairs. The transform is passed on to the children, which apply it
+     * when they are read. Const because it does not change the
+     * structure's value.
+     */
+    void materialize() const;
+
+    /**
+     * Materialize and stop sharing or deferring from now on, since a
+     * reference into m_pGeometry is about to be handed out
+     */
+    void pin() const;
+
+    /**
+     * Record a transform to apply after any pending one. A pinned
+     * structure applies it at once.
+     */
+    void transform(const Transform& t);
+
+    /**
+     * Add the nodes of this structure and its descendants to sum and
+     * count, without pinning anything
+     */
+    void sumNodes(btVector3& sum, int& count) const;
+
+    mutable boost::shared_ptr<Geometry> m_pGeometry;
+
+    /** Not yet applied to m_pGeometry */
+    mutable Transform m_transform;
+
+    /**
+     * True once references into m_pGeometry have been handed out. A
+     * pinned structure's geometry is never shared and m_transform is
+     * always the identity.
+     */
+    mutable bool m_pinned;
     
 };
 
@@ -29,11 +29,18 @@
 // This library
 #include "tgConnectorInfo.h"
 #include "tgRigidAutoCompound.h"
+#include "tgRigidInfo.h"
 #include "tgStructure.h"
 #include "core/tgWorld.h"
+#include "core/tgWorldBulletPhysicsImpl.h"
 #include "core/tgModel.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
 // The C++ Standard Library
+#include <map>
+#include <set>
 #include <stdexcept>
+#include <utility>
 
 tgStructureInfo::tgStructureInfo(tgStructure& structure, tgBuildSpec& buildSpec) : 
     tgTaggable(),
@@ -114,6 +121,25 @@ std::vector<tgRigidInfo*> tgStructureInfo::getAllRigids() const
     return result;
 }
 
+std::vector<tgConnectorInfo*> tgStructureInfo::getAllConnectors() const
+{
+    std::vector<tgConnectorInfo*> result;
+    result.insert(result.end(), m_connectors.begin(), m_connectors.end());
+
+    // Collect child connectors
+    for (std::size_t i = 0; i < m_children.size(); i++)
+    {
+        tgStructureInfo * const pStructureInfo = m_children[i];
+    assert(pStructureInfo != NULL);
+        std::vector<tgConnectorInfo*> childConnectors =
+            pStructureInfo->getAllConnectors();
+        result.insert(result.end(), childConnectors.begin(),
+                      childConnectors.end());
+    }
+
+    return result;
+}
+
 ////////////////////////////
 // Build methods
 ////////////////////////////
@@ -129,6 +155,7 @@ void tgStructureInfo::addRigidsAndConnectors() {
     for (int i = 0; i < nodes.size(); i++) {
         tgRigidInfo* nodeRigid = initRigidInfo<tgNode>(nodes[i], rigidAgents);
         if (nodeRigid) {
+            initCollisionFilter(*nodeRigid);
             m_rigids.push_back(nodeRigid);
         }
     }
@@ -136,6 +163,7 @@ void tgStructureInfo::addRigidsAndConnectors() {
     for (int i = 0; i < pairs.size(); i++) {
         tgRigidInfo* pairRigid = initRigidInfo<tgPair>(pairs[i], rigidAgents);
         if (pairRigid) {
+	  initCollisionFilter(*pairRigid);
 	  m_rigids.push_back(pairRigid);
         }
         else {
@@ -202,10 +230,70 @@ tgConnectorInfo* tgStructureInfo::initConnectorInfo(const T& connectorCandidate,
     return 0;
 }
 
+void tgStructureInfo::initCollisionFilter(tgRigidInfo& rigid) const
+{
+    const std::vector<tgBuildSpec::CollisionFilterAgent>& agents =
+        m_buildSpec.getCollisionFilterAgents();
+    for (std::size_t i = 0; i < agents.size(); i++)
+    {
+        // Our tags are inherited, as in initRigidInfo
+        tgTagSearch tagSearch = agents[i].tagSearch;
+        tagSearch.remove(getTags());
+        if (tagSearch.matches(rigid))
+        {
+            rigid.addCollisionFilter(agents[i].group, agents[i].mask);
+        }
+    }
+}
+
 void tgStructureInfo::autoCompoundRigids()
 {
   tgRigidAutoCompound c(getAllRigids());
   m_compounded = c.execute();
+
+  // A compound is one body, so it takes the filters of all its members:
+  // the union of their groups and the intersection of their masks. Once
+  // any member has a filter, a member without one adds DefaultFilter to
+  // the group and keeps the mask at AllFilter, so it still collides
+  // with everything.
+  typedef std::map<tgRigidInfo*, std::pair<short, short> > FilterMap;
+  FilterMap filters;
+  std::set<tgRigidInfo*> unfiltered;
+  const std::vector<tgRigidInfo*> allRigids = getAllRigids();
+  for (std::size_t i = 0; i < allRigids.size(); i++)
+  {
+      tgRigidInfo * const pRigidInfo = allRigids[i];
+      tgRigidInfo * const pGroup = pRigidInfo->getRigidInfoGroup();
+      if (pGroup == NULL || pGroup == pRigidInfo)
+      {
+          continue;
+      }
+      else if (!pRigidInfo->hasCollisionFilter())
+      {
+          unfiltered.insert(pGroup);
+          continue;
+      }
+      const FilterMap::iterator it = filters.find(pGroup);
+      if (it == filters.end())
+      {
+          filters[pGroup] = std::make_pair(pRigidInfo->getCollisionGroup(),
+                                           pRigidInfo->getCollisionMask());
+      }
+      else
+      {
+          it->second.first |= pRigidInfo->getCollisionGroup();
+          it->second.second &= pRigidInfo->getCollisionMask();
+      }
+  }
+  for (FilterMap::iterator it = filters.begin(); it != filters.end(); ++it)
+  {
+      if (unfiltered.count(it->first) != 0)
+      {
+          it->second.first |= btBroadphaseProxy::DefaultFilter;
+          it->second.second = btBroadphaseProxy::AllFilter;
+      }
+      it->first->addCollisionFilter(it->second.first, it->second.second);
+  }
 }
 
 void tgStructureInfo::chooseConnectorRigids()
@@ -250,6 +338,33 @@ void tgStructureInfo::initRigidBodies(tgWorld& world)
     }
 }
 
+void tgStructureInfo::excludeConnectedCollisions(tgWorldBulletPhysicsImpl& impl)
+{
+    for (std::size_t i = 0; i < m_connectors.size(); i++)
+    {
+        tgConnectorInfo * const pConnectorInfo = m_connectors[i];
+        assert(pConnectorInfo != NULL);
+        // Connectors that found no rigid are reported when they are built
+        tgRigidInfo * const pFrom = pConnectorInfo->getFromRigidInfo();
+        tgRigidInfo * const pTo = pConnectorInfo->getToRigidInfo();
+        if (pFrom && pTo && pFrom->getRigidInfoGroup() &&
+            pTo->getRigidInfoGroup())
+        {
+            impl.excludeCollisionPair(
+                pFrom->getRigidInfoGroup()->getCollisionObject(),
+                pTo->getRigidInfoGroup()->getCollisionObject());
+        }
+    }
+
+    // Children
+    for (std::size_t i = 0; i < m_children.size(); i++)
+    {
+        tgStructureInfo * const pStructureInfo = m_children[i];
+        assert(pStructureInfo != NULL);
+        pStructureInfo->excludeConnectedCollisions(impl);
+    }
+}
+
 void tgStructureInfo::initConnectors(tgWorld& world) 
 {
     // Connectors
@@ -277,10 +392,14 @@ void tgStructureInfo::initConnectors(tgWorld& world)
 void tgStructureInfo::buildInto(tgModel& model, tgWorld& world) 
 {
     // These take care of things on a global level
-    addRigidsAndConnectors();    
-    autoCompoundRigids();    
-    chooseConnectorRigids();
+    buildInfos();
     initRigidBodies(world);
+    if (m_buildSpec.getAutoCollisionFilter())
+    {
+        tgWorldBulletPhysicsImpl& impl =
+            static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+        excludeConnectedCollisions(impl);
+    }
     // Note: Muscle2Ps won't show up yet -- 
     // they need to be part of a model to have rendering...
     initConnectors(world);
@@ -310,6 +429,13 @@ void tgStructureInfo::buildInto(tgModel& model, tgWorld& world)
     */
 }
 
+void tgStructureInfo::buildInfos()
+{
+    addRigidsAndConnectors();    
+    autoCompoundRigids();    
+    chooseConnectorRigids();
+}
+
 void tgStructureInfo::buildIntoHelper(tgModel& model, tgWorld& world,
                       tgStructureInfo& structureInfo)
 {
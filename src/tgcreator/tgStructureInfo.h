@@ -42,6 +42,7 @@ class tgModel;
 class tgRigidInfo;
 class tgStructure;
 class tgWorld;
+class tgWorldBulletPhysicsImpl;
 
 /**
  * Representation of a structure containing all info required to build it into
@@ -68,9 +69,21 @@ public:
         return m_connectors;
     }
 
+    // Return all connectors in this structure and its descendants
+    std::vector<tgConnectorInfo*> getAllConnectors() const;
+
     // Build our info into the provided model
     void buildInto(tgModel& model, tgWorld& world);
 
+    /**
+     * Create the rigid and connector infos, compound the rigids and
+     * choose the connectors' rigids, as the first part of buildInto,
+     * without building anything into a world. For analysing a
+     * structure, such as with tgFormFinder; call either this or
+     * buildInto, not both.
+     */
+    void buildInfos();
+
 private:
 
     /*
@@ -90,6 +103,12 @@ private:
     template <class T>
     tgConnectorInfo* initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents) const;
 
+    /**
+     * Give rigid the collision filters of the build spec whose tag
+     * searches match it
+     */
+    void initCollisionFilter(tgRigidInfo& rigid) const;
+
     void autoCompoundRigids();
     
     void chooseConnectorRigids();
@@ -99,6 +118,12 @@ private:
     void initRigidBodies(tgWorld& world);
     
     void initConnectors(tgWorld& world);
+
+    /**
+     * Stop the bodies at the two ends of each connector, here and in the
+     * children, from colliding with each other
+     */
+    void excludeConnectedCollisions(tgWorldBulletPhysicsImpl& impl);
     
     const std::vector<tgRigidInfo*>& getRigids() const
     {
@@ -25,6 +25,7 @@
  */
 
 #include "CPGEquations.h"
+#include "core/tgTrialFailure.h"
 
 #include "boost/array.hpp"
 #include "boost/numeric/odeint.hpp"
@@ -255,7 +256,7 @@ void CPGEquations::update(std::vector<double>& descCom, double dt)
     if (numSteps > m_maxSteps)
     {
         std::cout << "Ending trial due to inefficient equations " << numSteps << std::endl;
-        throw std::runtime_error("Inefficient CPG Parameters");
+        throw tgTrialFailure("Inefficient CPG Parameters");
     }
     
 	 #if (0)
@@ -0,0 +1,272 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgTrajectoryController_test.cpp
+* @brief Contains tests that tgTrajectoryPlayback reads CSV and binary
+* tables, rejects bad ones without leaving them mapped, and interpolates
+* and loops its setpoints
+* $Id$
+*/
+
+// This application
+#include "controllers/tgTrajectoryController.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// POSIX
+#include <unistd.h>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgTrajectoryPlaybackTest : public ::testing::Test {
+	protected:
+
+		virtual void SetUp()
+		{
+			char name[] = "/tmp/tgTrajectoryController_testXXXXXX";
+			ASSERT_TRUE(mkdtemp(name) != NULL);
+			directory = name;
+		}
+
+		virtual void TearDown()
+		{
+			const char* const files[] = {
+				"table.csv", "table.bin", "bad.csv", "bad.bin"
+			};
+			for (std::size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+			{
+				std::remove(path(files[i]).c_str());
+			}
+			rmdir(directory.c_str());
+		}
+
+		std::string path(const std::string& name) const
+		{
+			return directory + "/" + name;
+		}
+
+		void write(const std::string& filename, const std::string& contents)
+		{
+			std::ofstream out(filename.c_str(), std::ios::binary);
+			out << contents;
+		}
+
+		/**
+		 * Two columns: the first rises from 10 to 20 then falls to 0,
+		 * the second stays at 1. Times start at 1.
+		 */
+		std::string table()
+		{
+			const std::string filename = path("table.csv");
+			write(filename, "time, front left, back\n"
+						   "1.0, 10.0, 1.0\n"
+						   "\n"
+						   "2.0, 20.0, 1.0\n"
+						   "4.0,  0.0, 1.0\n");
+			return filename;
+		}
+
+		/** True if the process has filename mapped */
+		static bool mapped(const std::string& filename)
+		{
+			std::ifstream maps("/proc/self/maps");
+			std::string line;
+			while (std::getline(maps, line))
+			{
+				if (line.find(filename) != std::string::npos)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/** Overwrite the bytes of a file at offset */
+		static void patch(const std::string& filename, std::size_t offset,
+						  const void* bytes, std::size_t size)
+		{
+			std::fstream file(filename.c_str(),
+							  std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(offset);
+			file.write(static_cast<const char*>(bytes), size);
+		}
+
+		/** Where a binary table's rows start, from its header */
+		static unsigned int dataOffset(const std::string& filename)
+		{
+			std::ifstream file(filename.c_str(), std::ios::binary);
+			// After the magic, byte order, columns and rows
+			file.seekg(8 + 3 * sizeof(unsigned int));
+			unsigned int offset = 0;
+			file.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+			return offset;
+		}
+
+		std::string directory;
+	};
+
+	TEST_F(tgTrajectoryPlaybackTest, testReadsCSV) {
+		tgTrajectoryPlayback playback(table());
+		ASSERT_EQ(2u, playback.getColumns().size());
+		EXPECT_EQ("front left", playback.getColumns()[0]);
+		EXPECT_EQ("back", playback.getColumns()[1]);
+		EXPECT_EQ(3u, playback.getRows());
+		EXPECT_DOUBLE_EQ(3.0, playback.getDuration());
+		// Playback starts at the first row, whatever its time
+		ASSERT_EQ(2u, playback.getSetPoints().size());
+		EXPECT_DOUBLE_EQ(10.0, playback.getSetPoints()[0]);
+		EXPECT_DOUBLE_EQ(1.0, playback.getSetPoints()[1]);
+	}
+
+	TEST_F(tgTrajectoryPlaybackTest, testRejectsBadCSV) {
+		const std::string filename = path("bad.csv");
+		EXPECT_THROW(tgTrajectoryPlayback playback(filename), std::runtime_error);
+
+		const char* const tables[] = {
+			"",
+			"time\n1.0\n",
+			"time,a,,b\n1.0,1.0,2.0,3.0\n",
+			"time,a\n",
+			"time,a\n1.0,2.0\n2.0\n",
+			"time,a\n1.0,2.0,3.0\n",
+			"time,a\n1.0,two\n"
+		};
+		for (std::size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++)
+		{
+			write(filename, tables[i]);
+			EXPECT_THROW(tgTrajectoryPlayback playback(filename),
+						 std::runtime_error) << "table " << i;
+		}
+	}
+
+	TEST_F(tgTrajectoryPlaybackTest, testRejectsTimesNotIncreasing) {
+		const std::string filename = path("bad.csv");
+		write(filename, "time,a\n1.0,1.0\n2.0,2.0\n2.0,3.0\n");
+		EXPECT_THROW(tgTrajectoryPlayback playback(filename), std::runtime_error);
+		write(filename, "time,a\n1.0,1.0\n0.5,2.0\n");
+		EXPECT_THROW(tgTrajectoryPlayback playback(filename), std::runtime_error);
+
+		// A mapped table too, which is unmapped when rejected
+		const std::string binary = path("bad.bin");
+		tgTrajectoryPlayback(table()).save(binary);
+		const double time = 1.0;
+		// The second row's time, after the first row's three numbers
+		patch(binary, dataOffset(binary) + 3 * sizeof(double),
+			  &time, sizeof(time));
+		EXPECT_THROW(tgTrajectoryPlayback playback(binary), std::runtime_error);
+		EXPECT_FALSE(mapped(binary));
+	}
+
+	TEST_F(tgTrajectoryPlaybackTest, testBinaryRoundTrip) {
+		const std::string binary = path("table.bin");
+		tgTrajectoryPlayback csv(table());
+		csv.save(binary);
+
+		char magic[8];
+		std::ifstream file(binary.c_str(), std::ios::binary);
+		file.read(magic, sizeof(magic));
+		EXPECT_EQ(0, std::memcmp(magic, "NTRTTRAJ", sizeof(magic)));
+
+		{
+			tgTrajectoryPlayback mappedTable(binary);
+			EXPECT_TRUE(mapped(binary));
+			EXPECT_EQ(csv.getColumns(), mappedTable.getColumns());
+			EXPECT_EQ(csv.getRows(), mappedTable.getRows());
+			EXPECT_DOUBLE_EQ(csv.getDuration(), mappedTable.getDuration());
+			for (int i = 0; i < 50; i++)
+			{
+				csv.step(0.1);
+				mappedTable.step(0.1);
+				ASSERT_EQ(csv.getSetPoints(), mappedTable.getSetPoints())
+					<< "step " << i;
+			}
+		}
+		EXPECT_FALSE(mapped(binary));
+	}
+
+	TEST_F(tgTrajectoryPlaybackTest, testMalformedColumnNotMapped) {
+		const std::string binary = path("bad.bin");
+		tgTrajectoryPlayback(table()).save(binary);
+		// The first column's length, just after the fixed header, runs
+		// past the rows' start
+		const unsigned int length = 1000;
+		patch(binary, 8 + 4 * sizeof(unsigned int), &length, sizeof(length));
+		EXPECT_THROW(tgTrajectoryPlayback playback(binary), std::runtime_error);
+		EXPECT_FALSE(mapped(binary));
+	}
+
+	TEST_F(tgTrajectoryPlaybackTest, testCursorInterpolates) {
+		tgTrajectoryPlayback playback(table());
+		EXPECT_THROW(playback.step(0.0), std::invalid_argument);
+
+		// Times are since the first row, which is at 1
+		const double times[] = { 0.25, 0.5, 1.5, 2.5, 3.0, 5.0 };
+		const double expected[] = { 12.5, 15.0, 15.0, 5.0, 0.0, 0.0 };
+		double previous = 0.0;
+		for (std::size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++)
+		{
+			playback.step(times[i] - previous);
+			previous = times[i];
+			EXPECT_NEAR(times[i], playback.getTime(), 1.0e-12);
+			EXPECT_NEAR(expected[i], playback.getSetPoints()[0], 1.0e-9)
+				<< "at " << times[i];
+			EXPECT_DOUBLE_EQ(1.0, playback.getSetPoints()[1]);
+		}
+	}
+
+	TEST_F(tgTrajectoryPlaybackTest, testLoops) {
+		tgTrajectoryPlayback playback(table(),
+			tgTrajectoryPlayback::Config(tgTrajectoryPlayback::eRestLength,
+										 true));
+		// Past the end, the duration of 3 is taken off
+		playback.step(2.5);
+		EXPECT_NEAR(5.0, playback.getSetPoints()[0], 1.0e-9);
+		playback.step(1.0);
+		EXPECT_NEAR(15.0, playback.getSetPoints()[0], 1.0e-9);
+		playback.step(3.0);
+		EXPECT_NEAR(15.0, playback.getSetPoints()[0], 1.0e-9);
+		// Three whole loops land on the first row
+		playback.step(2.5);
+		EXPECT_NEAR(10.0, playback.getSetPoints()[0], 1.0e-9);
+
+		// The time restored from a checkpoint resamples
+		std::stringstream state;
+		playback.saveState(state);
+		tgTrajectoryPlayback restored(table(),
+			tgTrajectoryPlayback::Config(tgTrajectoryPlayback::eRestLength,
+										 true));
+		restored.loadState(state);
+		EXPECT_DOUBLE_EQ(playback.getTime(), restored.getTime());
+		EXPECT_EQ(playback.getSetPoints(), restored.getSetPoints());
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,214 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+
+/**
+* @file tgActuatorGroup_test.cpp
+* @brief Contains tests that tgActuatorGroup moves its actuators exactly
+* as their own motor models do
+* $Id$
+*/
+
+// This application
+#include "core/tgActuatorGroup.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgKinematicActuator.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgKinematicActuatorInfo.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgActuatorGroupTest : public ::testing::Test {
+	protected:
+
+		tgActuatorGroupTest() :
+			dt(0.001)
+		{
+		}
+
+		/**
+		 * A rod hanging from a static rod by two basic and two
+		 * kinematic actuators
+		 */
+		static void build(tgModel& model, tgWorld& world)
+		{
+			tgStructure structure;
+			structure.addNode(-1.0, 20.0, 0.0);
+			structure.addNode(1.0, 20.0, 0.0);
+			structure.addNode(-1.0, 17.0, 0.0);
+			structure.addNode(1.0, 17.0, 0.0);
+			structure.addPair(0, 1, "anchor");
+			structure.addPair(2, 3, "bob");
+			structure.addPair(0, 2, "muscle basic");
+			structure.addPair(1, 3, "muscle basic");
+			structure.addPair(0, 3, "muscle kinematic");
+			structure.addPair(1, 2, "muscle kinematic");
+
+			tgBuildSpec spec;
+			// No density, so Bullet holds the anchor still
+			spec.addBuilder("anchor", new tgRodInfo(tgRod::Config(0.5, 0.0)));
+			spec.addBuilder("bob", new tgRodInfo(tgRod::Config(0.5, 1.0)));
+			// Slow enough that the velocity limit binds
+			const tgBasicActuator::Config basicConfig(1000.0, 10.0, 0.0, false,
+													  1000.0, 0.5);
+			spec.addBuilder("basic", new tgBasicActuatorInfo(basicConfig));
+			const tgKinematicActuator::Config kinematicConfig(1000.0, 10.0, 0.0,
+															  0.1, 0.01, 0.01);
+			spec.addBuilder("kinematic",
+							new tgKinematicActuatorInfo(kinematicConfig));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+		}
+
+		/** Preferred rest length of basic actuator i at step k */
+		double length(std::size_t i, int k) const
+		{
+			return 3.0 - 0.3 * std::sin(k * dt * (2.0 + i));
+		}
+
+		/** Desired torque of kinematic actuator i at step k */
+		double torque(std::size_t i, int k) const
+		{
+			return -2.0 + 4.0 * std::sin(k * dt * (3.0 + i));
+		}
+
+		static btVector3 bob(tgModel& model)
+		{
+			const std::vector<tgRod*> bobs = model.find<tgRod>("bob");
+			return bobs.empty() ? btVector3(0.0, 0.0, 0.0) :
+				bobs[0]->getPRigidBody()->getCenterOfMassPosition();
+		}
+
+		virtual void TearDown()
+		{
+			grouped.teardown();
+			separate.teardown();
+		}
+
+		// The worlds outlive the models' bodies
+		tgWorld groupedWorld;
+		tgWorld separateWorld;
+		tgModel grouped;
+		tgModel separate;
+		const double dt;
+	};
+
+	TEST_F(tgActuatorGroupTest, testMatchesActuatorsStepForStep) {
+		build(grouped, groupedWorld);
+		build(separate, separateWorld);
+
+		tgActuatorGroup group(grouped, "muscle");
+		const std::vector<tgBasicActuator*> basic =
+			separate.find<tgBasicActuator>("basic");
+		const std::vector<tgKinematicActuator*> kinematic =
+			separate.find<tgKinematicActuator>("kinematic");
+		ASSERT_EQ(2u, group.getBasicActuators().size());
+		ASSERT_EQ(2u, group.getKinematicActuators().size());
+		ASSERT_EQ(2u, basic.size());
+		ASSERT_EQ(2u, kinematic.size());
+
+		std::vector<double> lengths(basic.size());
+		std::vector<double> torques(kinematic.size());
+		for (int k = 0; k < 2000; k++)
+		{
+			groupedWorld.step(dt);
+			separateWorld.step(dt);
+
+			for (std::size_t i = 0; i < basic.size(); i++)
+			{
+				lengths[i] = length(i, k);
+				basic[i]->setControlInput(lengths[i], dt);
+			}
+			for (std::size_t i = 0; i < kinematic.size(); i++)
+			{
+				torques[i] = torque(i, k);
+				kinematic[i]->setControlInput(torques[i]);
+			}
+			group.setRestLengths(lengths, dt);
+			group.setTorques(torques, dt);
+
+			grouped.step(dt);
+			separate.step(dt);
+
+			for (std::size_t i = 0; i < basic.size(); i++)
+			{
+				const tgBasicActuator* const pGrouped =
+					group.getBasicActuators()[i];
+				ASSERT_DOUBLE_EQ(basic[i]->getRestLength(),
+								 pGrouped->getRestLength())
+					<< "basic " << i << " step " << k;
+				ASSERT_DOUBLE_EQ(basic[i]->getTension(), pGrouped->getTension())
+					<< "basic " << i << " step " << k;
+			}
+			for (std::size_t i = 0; i < kinematic.size(); i++)
+			{
+				const tgKinematicActuator* const pGrouped =
+					group.getKinematicActuators()[i];
+				ASSERT_DOUBLE_EQ(kinematic[i]->getRestLength(),
+								 pGrouped->getRestLength())
+					<< "kinematic " << i << " step " << k;
+				ASSERT_DOUBLE_EQ(kinematic[i]->getVelocity(),
+								 pGrouped->getVelocity())
+					<< "kinematic " << i << " step " << k;
+			}
+		}
+
+		// The rest lengths moved, and the bodies followed identically
+		EXPECT_GT(std::abs(basic[0]->getRestLength() -
+						   basic[0]->getStartLength()), 0.1);
+		const btVector3 groupedBob = bob(grouped);
+		const btVector3 separateBob = bob(separate);
+		EXPECT_DOUBLE_EQ(separateBob.x(), groupedBob.x());
+		EXPECT_DOUBLE_EQ(separateBob.y(), groupedBob.y());
+		EXPECT_DOUBLE_EQ(separateBob.z(), groupedBob.z());
+	}
+
+	TEST_F(tgActuatorGroupTest, testRejectsWrongSizes) {
+		build(grouped, groupedWorld);
+		tgActuatorGroup group(grouped, "muscle");
+		EXPECT_THROW(group.setRestLengths(std::vector<double>(1, 3.0), dt),
+					 std::invalid_argument);
+		EXPECT_THROW(group.setTorques(std::vector<double>(3, 0.0), dt),
+					 std::invalid_argument);
+		EXPECT_THROW(group.setRestLengths(std::vector<double>(2, -1.0), dt),
+					 std::invalid_argument);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
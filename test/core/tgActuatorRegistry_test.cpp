@@ -0,0 +1,261 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgActuatorRegistry_test.cpp
+* @brief Contains tests that actuators stepped by tgActuatorRegistry
+* behave exactly as when the model tree steps them, and that clear()
+* hands them back to the tree
+* $Id$
+*/
+
+// This application
+#include "core/tgActuatorRegistry.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgKinematicActuator.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgSpringCableActuator.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgKinematicActuatorInfo.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cmath>
+#include <deque>
+#include <string>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgActuatorRegistryTest : public ::testing::Test {
+	protected:
+
+		tgActuatorRegistryTest() :
+			dt(0.001)
+		{
+		}
+
+		/**
+		 * A rod hanging from a static rod by two basic and two
+		 * kinematic actuators, which log their history
+		 */
+		static void build(tgModel& model, tgWorld& world)
+		{
+			tgStructure structure;
+			structure.addNode(-1.0, 20.0, 0.0);
+			structure.addNode(1.0, 20.0, 0.0);
+			structure.addNode(-1.0, 17.0, 0.0);
+			structure.addNode(1.0, 17.0, 0.0);
+			structure.addPair(0, 1, "anchor");
+			structure.addPair(2, 3, "bob");
+			structure.addPair(0, 2, "muscle basic");
+			structure.addPair(1, 3, "muscle basic");
+			structure.addPair(0, 3, "muscle kinematic");
+			structure.addPair(1, 2, "muscle kinematic");
+
+			tgBuildSpec spec;
+			// No density, so Bullet holds the anchor still
+			spec.addBuilder("anchor", new tgRodInfo(tgRod::Config(0.5, 0.0)));
+			spec.addBuilder("bob", new tgRodInfo(tgRod::Config(0.5, 1.0)));
+			const tgBasicActuator::Config basicConfig(1000.0, 10.0, 0.0, true,
+													  1000.0, 0.5);
+			spec.addBuilder("basic", new tgBasicActuatorInfo(basicConfig));
+			const tgKinematicActuator::Config kinematicConfig(1000.0, 10.0, 0.0,
+															  0.1, 0.01, 0.01,
+															  false, true);
+			spec.addBuilder("kinematic",
+							new tgKinematicActuatorInfo(kinematicConfig));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+		}
+
+		/** Sets the same inputs on model's actuators at step k */
+		void control(tgModel& model, int k) const
+		{
+			const std::vector<tgBasicActuator*> basic =
+				model.find<tgBasicActuator>("basic");
+			for (std::size_t i = 0; i < basic.size(); i++)
+			{
+				basic[i]->setControlInput(3.0 - 0.3 * std::sin(k * dt * (2.0 + i)),
+										  dt);
+			}
+			const std::vector<tgKinematicActuator*> kinematic =
+				model.find<tgKinematicActuator>("kinematic");
+			for (std::size_t i = 0; i < kinematic.size(); i++)
+			{
+				kinematic[i]->setControlInput(-2.0 + 4.0 *
+											  std::sin(k * dt * (3.0 + i)));
+			}
+		}
+
+		static std::vector<tgSpringCableActuator*> actuators(tgModel& model)
+		{
+			return model.find<tgSpringCableActuator>("muscle");
+		}
+
+		static void expectSameHistory(const std::deque<double>& expected,
+									  const std::deque<double>& actual,
+									  const std::string& name)
+		{
+			ASSERT_EQ(expected.size(), actual.size()) << name;
+			for (std::size_t i = 0; i < expected.size(); i++)
+			{
+				ASSERT_DOUBLE_EQ(expected[i], actual[i])
+					<< name << " entry " << i;
+			}
+		}
+
+		static btVector3 bob(tgModel& model)
+		{
+			const std::vector<tgRod*> bobs = model.find<tgRod>("bob");
+			return bobs.empty() ? btVector3(0.0, 0.0, 0.0) :
+				bobs[0]->getPRigidBody()->getCenterOfMassPosition();
+		}
+
+		virtual void TearDown()
+		{
+			// The actuators are about to be deleted
+			registry.clear();
+			registered.teardown();
+			tree.teardown();
+		}
+
+		// The worlds outlive the models' bodies
+		tgWorld registeredWorld;
+		tgWorld treeWorld;
+		tgModel registered;
+		tgModel tree;
+		tgActuatorRegistry registry;
+		const double dt;
+	};
+
+	TEST_F(tgActuatorRegistryTest, testMatchesTreeStepping) {
+		build(registered, registeredWorld);
+		build(tree, treeWorld);
+		registry.add(registered);
+		ASSERT_EQ(4u, registry.size());
+
+		const std::vector<tgSpringCableActuator*> expected = actuators(tree);
+		const std::vector<tgSpringCableActuator*> actual =
+			actuators(registered);
+		ASSERT_EQ(4u, expected.size());
+		ASSERT_EQ(4u, actual.size());
+
+		for (int k = 0; k < 2000; k++)
+		{
+			registeredWorld.step(dt);
+			treeWorld.step(dt);
+			control(registered, k);
+			control(tree, k);
+
+			// As tgSimulation steps them: the tree, then the registry
+			registered.step(dt);
+			registry.step(dt);
+			tree.step(dt);
+
+			for (std::size_t i = 0; i < expected.size(); i++)
+			{
+				ASSERT_DOUBLE_EQ(expected[i]->getRestLength(),
+								 actual[i]->getRestLength())
+					<< "actuator " << i << " step " << k;
+				ASSERT_DOUBLE_EQ(expected[i]->getTension(),
+								 actual[i]->getTension())
+					<< "actuator " << i << " step " << k;
+			}
+		}
+
+		for (std::size_t i = 0; i < expected.size(); i++)
+		{
+			const tgSpringCableActuator::SpringCableActuatorHistory&
+				expectedHistory = expected[i]->getHistory();
+			const tgSpringCableActuator::SpringCableActuatorHistory&
+				actualHistory = actual[i]->getHistory();
+			// One entry from construction and one for each step
+			EXPECT_EQ(2001u, actualHistory.restLengths.size());
+			expectSameHistory(expectedHistory.lastLengths,
+							  actualHistory.lastLengths, "lastLengths");
+			expectSameHistory(expectedHistory.restLengths,
+							  actualHistory.restLengths, "restLengths");
+			expectSameHistory(expectedHistory.dampingHistory,
+							  actualHistory.dampingHistory, "dampingHistory");
+			expectSameHistory(expectedHistory.lastVelocities,
+							  actualHistory.lastVelocities, "lastVelocities");
+			expectSameHistory(expectedHistory.tensionHistory,
+							  actualHistory.tensionHistory, "tensionHistory");
+		}
+
+		const btVector3 expectedBob = bob(tree);
+		const btVector3 actualBob = bob(registered);
+		EXPECT_DOUBLE_EQ(expectedBob.x(), actualBob.x());
+		EXPECT_DOUBLE_EQ(expectedBob.y(), actualBob.y());
+		EXPECT_DOUBLE_EQ(expectedBob.z(), actualBob.z());
+	}
+
+	TEST_F(tgActuatorRegistryTest, testClearHandsActuatorsBack) {
+		build(registered, registeredWorld);
+		registry.add(registered);
+		ASSERT_EQ(4u, registry.size());
+		const std::vector<tgSpringCableActuator*> muscles =
+			actuators(registered);
+		ASSERT_EQ(4u, muscles.size());
+
+		// Registered, the tree leaves them alone
+		for (int k = 0; k < 10; k++)
+		{
+			registeredWorld.step(dt);
+			registered.step(dt);
+		}
+		for (std::size_t i = 0; i < muscles.size(); i++)
+		{
+			EXPECT_EQ(1u, muscles[i]->getHistory().restLengths.size())
+				<< "actuator " << i;
+		}
+
+		registry.clear();
+		EXPECT_EQ(0u, registry.size());
+
+		// Cleared, the registry steps nothing and the tree steps them
+		for (int k = 0; k < 10; k++)
+		{
+			registeredWorld.step(dt);
+			registry.step(dt);
+			registered.step(dt);
+		}
+		for (std::size_t i = 0; i < muscles.size(); i++)
+		{
+			EXPECT_EQ(11u, muscles[i]->getHistory().restLengths.size())
+				<< "actuator " << i;
+		}
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,206 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgBulletSpringCable_test.cpp
+* @brief Contains tests that a structure at rest falls asleep in the
+* sleep mode of tgBulletSpringCable, that controllers wake it, and that
+* the state it caches after each step matches the bodies
+* $Id$
+*/
+
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgSpringCable.h"
+#include "core/tgSpringCableAnchor.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgBulletSpringCableTest : public ::testing::Test {
+	protected:
+
+		tgBulletSpringCableTest() :
+			world(tgWorld::Config(9.81)),
+			dt(0.001)
+		{
+		}
+
+		/**
+		 * Two parallel rods lying just above the box ground, tied end to
+		 * end by cables at their rest length, so nothing pulls once they
+		 * have landed
+		 */
+		void build(double sleepStretch, double sleepVelocity)
+		{
+			// The ground's top is at 1.5 and the rods' radius is 0.5
+			tgStructure structure;
+			structure.addNode(-2.0, 2.05, 0.0);
+			structure.addNode(2.0, 2.05, 0.0);
+			structure.addNode(-2.0, 2.05, 3.0);
+			structure.addNode(2.0, 2.05, 3.0);
+			structure.addPair(0, 1, "rod");
+			structure.addPair(2, 3, "rod");
+			structure.addPair(0, 2, "cable");
+			structure.addPair(1, 3, "cable");
+
+			tgBuildSpec spec;
+			spec.addBuilder("rod", new tgRodInfo(tgRod::Config(0.5, 1.0, 1.0)));
+			const tgBasicActuator::Config cableConfig(1000.0, 10.0, 0.0, false,
+													  1000.0, 100.0, 0.1, 0.1,
+													  0.0, true, true,
+													  sleepStretch, sleepVelocity);
+			spec.addBuilder("cable", new tgBasicActuatorInfo(cableConfig));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+		}
+
+		/** Simulate for the given seconds */
+		void run(double seconds)
+		{
+			const int steps = static_cast<int>(seconds / dt);
+			for (int i = 0; i < steps; i++)
+			{
+				world.step(dt);
+				model.step(dt);
+			}
+		}
+
+		std::vector<btRigidBody*> bodies() const
+		{
+			const std::vector<tgRod*> rods =
+				tgCast::filter<tgModel, tgRod>(model.getDescendants());
+			std::vector<btRigidBody*> result;
+			for (std::size_t i = 0; i < rods.size(); i++)
+			{
+				result.push_back(rods[i]->getPRigidBody());
+			}
+			return result;
+		}
+
+		virtual void TearDown()
+		{
+			model.teardown();
+		}
+
+		// The world outlives the model's bodies
+		tgWorld world;
+		tgModel model;
+		const double dt;
+	};
+
+	TEST_F(tgBulletSpringCableTest, testRestingStructureFallsAsleep) {
+		build(0.05, 0.1);
+		// Well past Bullet's two seconds of deactivation time
+		run(10.0);
+
+		const std::vector<btRigidBody*> rods = bodies();
+		ASSERT_EQ(2u, rods.size());
+		for (std::size_t i = 0; i < rods.size(); i++)
+		{
+			EXPECT_EQ(ISLAND_SLEEPING, rods[i]->getActivationState())
+				<< "rod " << i;
+		}
+
+		// A controller changing a rest length wakes both ends
+		const std::vector<tgBasicActuator*> cables =
+			tgCast::filter<tgModel, tgBasicActuator>(model.getDescendants());
+		ASSERT_EQ(2u, cables.size());
+		cables[0]->setControlInput(cables[0]->getRestLength() - 0.05, dt);
+		for (std::size_t i = 0; i < rods.size(); i++)
+		{
+			EXPECT_TRUE(rods[i]->isActive()) << "rod " << i;
+		}
+	}
+
+	TEST_F(tgBulletSpringCableTest, testStructureStaysAwakeWithoutSleepMode) {
+		build(0.0, 0.0);
+		run(10.0);
+
+		const std::vector<btRigidBody*> rods = bodies();
+		ASSERT_EQ(2u, rods.size());
+		for (std::size_t i = 0; i < rods.size(); i++)
+		{
+			EXPECT_TRUE(rods[i]->isActive()) << "rod " << i;
+		}
+	}
+
+	TEST_F(tgBulletSpringCableTest, testCachedStateMatchesBodies) {
+		build(0.0, 0.0);
+		const std::vector<tgBasicActuator*> cables =
+			tgCast::filter<tgModel, tgBasicActuator>(model.getDescendants());
+		ASSERT_EQ(2u, cables.size());
+
+		for (int i = 0; i < 100; i++)
+		{
+			world.step(dt);
+			for (std::size_t j = 0; j < cables.size(); j++)
+			{
+				// Shorten the cables so they pull while the rods fall
+				cables[j]->setControlInput(cables[j]->getRestLength() - 0.001, dt);
+				const tgSpringCable* const pCable = cables[j]->getSpringCable();
+
+				// Measured now, from the bodies
+				const std::vector<const tgSpringCableAnchor*> anchors =
+					pCable->getAnchors();
+				ASSERT_EQ(2u, anchors.size());
+				const btVector3 from = anchors[0]->getWorldPosition();
+				const btVector3 to = anchors[1]->getWorldPosition();
+				const double length = (to - from).length();
+				const double stretch = length - pCable->getRestLength();
+				const double tension =
+					(stretch > 0.0) ? stretch * pCable->getCoefK() : 0.0;
+
+				// Cached by the world after its step
+				std::vector<btVector3> positions;
+				pCable->getAnchorWorldPositions(positions);
+				ASSERT_EQ(2u, positions.size());
+				EXPECT_NEAR(0.0, (positions[0] - from).length(), 1.0e-12);
+				EXPECT_NEAR(0.0, (positions[1] - to).length(), 1.0e-12);
+				EXPECT_NEAR(length, pCable->getActualLength(), 1.0e-12);
+				EXPECT_NEAR(length, cables[j]->getCurrentLength(), 1.0e-12);
+				EXPECT_NEAR(tension, pCable->getTension(), 1.0e-9);
+				EXPECT_NEAR(tension, cables[j]->getTension(), 1.0e-9);
+			}
+			model.step(dt);
+		}
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
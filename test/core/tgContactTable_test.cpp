@@ -0,0 +1,164 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgContactTable_test.cpp
+* @brief Contains tests that tgContactTable reports the ground reaction
+* and center of pressure of a resting box, and reads the world only once
+* per revision
+* $Id$
+*/
+
+// This application
+#include "core/tgBox.h"
+#include "core/tgBulletUtil.h"
+#include "core/tgContactTable.h"
+#include "core/tgModel.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBoxInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgContactTableTest : public ::testing::Test {
+	protected:
+
+		tgContactTableTest() :
+			world(tgWorld::Config(9.81)),
+			dt(0.001),
+			pBody(NULL)
+		{
+		}
+
+		/**
+		 * A box 2 long, 1 high and 1 deep set on the box ground, whose
+		 * top is at 1.5, and left to settle
+		 */
+		virtual void SetUp()
+		{
+			tgStructure structure;
+			structure.addNode(2.0, 2.0, -2.0);
+			structure.addNode(4.0, 2.0, -2.0);
+			structure.addPair(0, 1, "box");
+
+			tgBuildSpec spec;
+			spec.addBuilder("box", new tgBoxInfo(tgBox::Config(0.5, 0.5)));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+
+			const std::vector<tgBox*> boxes = model.find<tgBox>("box");
+			ASSERT_EQ(1u, boxes.size());
+			pBody = boxes[0]->getPRigidBody();
+
+			for (int i = 0; i < 2000; i++)
+			{
+				world.step(dt);
+			}
+		}
+
+		virtual void TearDown()
+		{
+			model.teardown();
+		}
+
+		/** Forget every contact point the dispatcher holds */
+		void clearManifolds()
+		{
+			btDispatcher* const pDispatcher =
+				tgBulletUtil::worldToDynamicsWorld(world).getDispatcher();
+			for (int i = 0; i < pDispatcher->getNumManifolds(); i++)
+			{
+				pDispatcher->getManifoldByIndexInternal(i)->clearManifold();
+			}
+		}
+
+		// The world outlives the model's bodies
+		tgWorld world;
+		tgModel model;
+		const double dt;
+		btRigidBody* pBody;
+	};
+
+	TEST_F(tgContactTableTest, testRestingBoxReaction) {
+		tgContactTable table(world);
+		const tgContactTable::Contacts& contacts = table.getContacts(pBody);
+		EXPECT_GT(contacts.points, 0u);
+		EXPECT_GT(contacts.normalImpulse, 0.0);
+
+		// The ground holds the box up, and nothing pushes it sideways
+		const double weight = 9.81 / pBody->getInvMass();
+		const btVector3 force = table.getForce(pBody);
+		EXPECT_NEAR(weight, force.y(), 0.05 * weight);
+		EXPECT_NEAR(0.0, force.x(), 0.01 * weight);
+		EXPECT_NEAR(0.0, force.z(), 0.01 * weight);
+
+		// The center of pressure is on the ground, under the box
+		const btVector3 com = pBody->getCenterOfMassPosition();
+		EXPECT_NEAR(com.x(), contacts.center.x(), 0.05);
+		EXPECT_NEAR(com.z(), contacts.center.z(), 0.05);
+		EXPECT_NEAR(1.5, contacts.center.y(), 0.05);
+
+		// Bodies outside the world have no contacts
+		EXPECT_EQ(0u, table.getContacts(NULL).points);
+		EXPECT_EQ(0.0, table.getForce(NULL).length());
+	}
+
+	TEST_F(tgContactTableTest, testReadsOncePerRevision) {
+		tgContactTable table(world);
+		const std::size_t points = table.getContacts(pBody).points;
+		const double normalImpulse = table.getContacts(pBody).normalImpulse;
+		ASSERT_GT(points, 0u);
+
+		// The world has not stepped, so the table does not read it again
+		clearManifolds();
+		EXPECT_EQ(points, table.getContacts(pBody).points);
+		EXPECT_EQ(normalImpulse, table.getContacts(pBody).normalImpulse);
+		table.update();
+		EXPECT_EQ(points, table.getContacts(pBody).points);
+
+		// A table that reads now finds the manifolds empty
+		tgContactTable fresh(world);
+		EXPECT_EQ(0u, fresh.getContacts(pBody).points);
+
+		// A step makes a new revision, and the box lands again
+		world.step(dt);
+		fresh.update();
+		EXPECT_GT(table.getContacts(pBody).points, 0u);
+		EXPECT_EQ(table.getContacts(pBody).points,
+				  fresh.getContacts(pBody).points);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
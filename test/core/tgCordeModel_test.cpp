@@ -0,0 +1,135 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgCordeModel_test.cpp
+* @brief Contains tests that the forces of tgCordeModel restore its rest
+* shape, and that a pinned rod pulls on its bodies
+* $Id$
+*/
+
+// This application
+#include "core/tgCordeModel.h"
+// The Bullet Physics Library
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cmath>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgCordeModelTest : public ::testing::Test {
+	protected:
+
+		tgCordeModelTest() :
+			// Stiff enough to move noticeably within a few thousand steps
+			config(10, 0.01, 1300, 0.5, 1.0e4, 2.0e4, 1.0e5, 1.0e-5, 1.0e-6),
+			// No bending or torsion along the x axis
+			rot(0.0, std::sqrt(2.0) / 2.0, 0.0, std::sqrt(2.0) / 2.0),
+			restRod(btVector3(0.0, 0.0, 0.0), btVector3(10.0, 0.0, 0.0),
+					rot, rot, config),
+			dt(1.0e-4)
+		{
+		}
+
+		static double endToEnd(const tgCordeModel& rod)
+		{
+			const std::vector<btVector3>& positions = rod.getPositions();
+			return (positions.back() - positions.front()).length();
+		}
+
+		/** Angle between the orientations of the first and last link */
+		static double twist(const tgCordeModel& rod)
+		{
+			const std::vector<btQuaternion>& quaternions = rod.getQuaternions();
+			const double dot =
+				std::fabs(quaternions.front().dot(quaternions.back()));
+			return 2.0 * std::acos(dot < 1.0 ? dot : 1.0);
+		}
+
+		const tgCordeModel::Config config;
+		const btQuaternion rot;
+		/** Rest lengths and stiffnesses of a rod 10 long */
+		tgCordeModel restRod;
+		const double dt;
+	};
+
+	TEST_F(tgCordeModelTest, testStretchedRodContracts) {
+		tgCordeModel rod(btVector3(0.0, 0.0, 0.0), btVector3(11.0, 0.0, 0.0),
+						 rot, rot, config, restRod.getParameters());
+
+		for (std::size_t i = 0; i < 2000; i++)
+		{
+			rod.step(dt);
+		}
+		EXPECT_LT(endToEnd(rod), 11.0 - 0.01);
+	}
+
+	TEST_F(tgCordeModelTest, testTwistedRodUntwists) {
+		const btQuaternion twisted = btQuaternion(btVector3(1.0, 0.0, 0.0), 0.4) * rot;
+		tgCordeModel rod(btVector3(0.0, 0.0, 0.0), btVector3(10.0, 0.0, 0.0),
+						 rot, twisted, config, restRod.getParameters());
+
+		const double initialTwist = twist(rod);
+		for (std::size_t i = 0; i < 20000; i++)
+		{
+			rod.step(dt);
+		}
+		EXPECT_LT(twist(rod), initialTwist - 0.01);
+	}
+
+	TEST_F(tgCordeModelTest, testPinnedRodPullsBody) {
+		btSphereShape shape(0.5);
+		btVector3 inertia(0.0, 0.0, 0.0);
+		shape.calculateLocalInertia(1.0, inertia);
+
+		btTransform transform;
+		transform.setIdentity();
+		// The free end starts at the rest length, then its body is moved
+		// away so the rod is stretched
+		transform.setOrigin(btVector3(10.0, 0.0, 0.0));
+		btDefaultMotionState motionState(transform);
+		btRigidBody body(btRigidBody::btRigidBodyConstructionInfo(1.0,
+						 &motionState, &shape, inertia));
+
+		tgCordeModel rod(NULL, btVector3(0.0, 0.0, 0.0),
+						 &body, btVector3(10.0, 0.0, 0.0),
+						 rot, rot, config);
+		transform.setOrigin(btVector3(11.0, 0.0, 0.0));
+		body.setWorldTransform(transform);
+
+		for (std::size_t i = 0; i < 100; i++)
+		{
+			rod.step(dt);
+		}
+		EXPECT_LT(body.getLinearVelocity().x(), 0.0);
+		EXPECT_NEAR(rod.getPositions().back().x(), 11.0, 1.0e-9);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
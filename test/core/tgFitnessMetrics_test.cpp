@@ -0,0 +1,299 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgFitnessMetrics_test.cpp
+* @brief Contains tests that tgFitnessMetrics measures work and peak
+* tension as the actuator history did, and the path of the center of mass
+* $Id$
+*/
+
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgFitnessMetrics.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgFitnessMetricsTest : public ::testing::Test {
+	protected:
+
+		tgFitnessMetricsTest() :
+			dt(0.001),
+			stiffness(1000.0)
+		{
+		}
+
+		/**
+		 * A rod tied to a static rod by two cables that log their
+		 * history. With a static bob nothing moves, so the tension is
+		 * known from the rest length alone.
+		 */
+		void buildPendulum(tgWorld& world, double bobDensity)
+		{
+			tgStructure structure;
+			structure.addNode(-1.0, 20.0, 0.0);
+			structure.addNode(1.0, 20.0, 0.0);
+			structure.addNode(-1.0, 17.0, 0.0);
+			structure.addNode(1.0, 17.0, 0.0);
+			structure.addPair(0, 1, "anchor");
+			structure.addPair(2, 3, "bob");
+			structure.addPair(0, 2, "muscle");
+			structure.addPair(1, 3, "muscle");
+
+			tgBuildSpec spec;
+			// No density, so Bullet holds the anchor still
+			spec.addBuilder("anchor", new tgRodInfo(tgRod::Config(0.5, 0.0)));
+			spec.addBuilder("bob", new tgRodInfo(tgRod::Config(0.5, bobDensity)));
+			const tgBasicActuator::Config cableConfig(stiffness, 10.0, 0.0, true);
+			spec.addBuilder("muscle", new tgBasicActuatorInfo(cableConfig));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+		}
+
+		std::vector<tgBasicActuator*> actuators()
+		{
+			return tgCast::filter<tgModel, tgBasicActuator>(model.getDescendants());
+		}
+
+		/**
+		 * Steps the world and model as a controller's onStep would see
+		 * them, setting each cable's rest length to restLength(step)
+		 * before the metrics are taken
+		 */
+		template <typename Script>
+		void run(tgWorld& world, tgFitnessMetrics& metrics, int steps,
+				 Script restLength)
+		{
+			const std::vector<tgBasicActuator*> cables = actuators();
+			for (int i = 1; i <= steps; i++)
+			{
+				world.step(dt);
+				for (std::size_t j = 0; j < cables.size(); j++)
+				{
+					cables[j]->setControlInput(restLength(i, j), dt);
+				}
+				metrics.step(dt);
+				model.step(dt);
+			}
+		}
+
+		/**
+		 * The energy the escape controller summed from the actuator
+		 * history before tgFitnessMetrics existed. Shortening is
+		 * negative, so this is the negated work.
+		 */
+		static double historyEnergy(const std::vector<tgBasicActuator*>& cables)
+		{
+			double totalEnergySpent = 0.0;
+			for (std::size_t i = 0; i < cables.size(); i++)
+			{
+				const std::deque<double>& restLengths =
+					cables[i]->getHistory().restLengths;
+				const std::deque<double>& tensionHistory =
+					cables[i]->getHistory().tensionHistory;
+				for (std::size_t j = 1; j < tensionHistory.size(); j++)
+				{
+					double motorSpeed = restLengths[j] - restLengths[j-1];
+					if (motorSpeed > 0)
+					{
+						motorSpeed = 0;
+					}
+					totalEnergySpent += tensionHistory[j-1] * motorSpeed;
+				}
+			}
+			return totalEnergySpent;
+		}
+
+		static double historyPeakTension(const std::vector<tgBasicActuator*>& cables)
+		{
+			double peak = 0.0;
+			for (std::size_t i = 0; i < cables.size(); i++)
+			{
+				const std::deque<double>& tensionHistory =
+					cables[i]->getHistory().tensionHistory;
+				peak = std::max(peak, *std::max_element(tensionHistory.begin(),
+														tensionHistory.end()));
+			}
+			return peak;
+		}
+
+		virtual void TearDown()
+		{
+			model.teardown();
+		}
+
+		tgModel model;
+		const double dt;
+		const double stiffness;
+	};
+
+	/** Reels in by a millimetre a step, then lets the cable back out */
+	struct RampScript
+	{
+		double operator()(int step, std::size_t) const
+		{
+			const int shortened = (step <= 100) ? step : std::max(0, 200 - step);
+			return 3.0 - 0.001 * shortened;
+		}
+	};
+
+	/** Reels each cable in and out at its own rate */
+	struct SwingScript
+	{
+		double operator()(int step, std::size_t cable) const
+		{
+			const double t = step * 0.001;
+			return 2.9 - 0.2 * std::sin((2.0 + cable) * t);
+		}
+	};
+
+	TEST_F(tgFitnessMetricsTest, testWorkOfScriptedRestLengths) {
+		// Without gravity or mass the cables stay 3 long
+		tgWorld world(tgWorld::Config(0.0));
+		buildPendulum(world, 0.0);
+		tgFitnessMetrics metrics;
+		metrics.setup(model, &world);
+		run(world, metrics, 300, RampScript());
+
+		// Step i is charged the tension of step i - 1, k (i - 1) delta,
+		// for shortening by delta; lengthening costs nothing
+		const double delta = 0.001;
+		const int n = 100;
+		const std::size_t cables = actuators().size();
+		ASSERT_EQ(2u, cables);
+		const tgFitnessMetrics::Results& results = metrics.getResults();
+		EXPECT_EQ(300u, results.steps);
+		EXPECT_NEAR(0.3, results.elapsed, 1.0e-12);
+		EXPECT_NEAR(cables * stiffness * delta * delta * n * (n - 1) / 2.0,
+					results.work, 1.0e-9);
+		EXPECT_NEAR(stiffness * delta * n, results.peakTension, 1.0e-9);
+
+		// The bodies are static, so no center moves
+		EXPECT_EQ(0.0, results.pathLength);
+		EXPECT_EQ(0.0, results.displacement);
+
+		EXPECT_NEAR(-historyEnergy(actuators()), results.work, 1.0e-9);
+		EXPECT_NEAR(historyPeakTension(actuators()), results.peakTension, 1.0e-9);
+	}
+
+	TEST_F(tgFitnessMetricsTest, testWorkMatchesHistory) {
+		tgWorld world(tgWorld::Config(98.1));
+		buildPendulum(world, 1.0);
+		tgFitnessMetrics metrics;
+		metrics.setup(model);
+		run(world, metrics, 2000, SwingScript());
+
+		const tgFitnessMetrics::Results& results = metrics.getResults();
+		ASSERT_GT(results.work, 0.0);
+		EXPECT_NEAR(-historyEnergy(actuators()), results.work,
+					1.0e-9 * results.work);
+		EXPECT_NEAR(historyPeakTension(actuators()), results.peakTension,
+					1.0e-9 * results.peakTension);
+		// The bob swings, so its path is longer than its displacement
+		EXPECT_GT(results.pathLength, results.displacement);
+	}
+
+	TEST_F(tgFitnessMetricsTest, testPathOfCenterOfMass) {
+		tgWorld world(tgWorld::Config(0.0));
+		tgStructure structure;
+		structure.addNode(-1.0, 10.0, 0.0);
+		structure.addNode(1.0, 10.0, 0.0);
+		structure.addNode(-1.0, 10.0, 5.0);
+		structure.addNode(1.0, 10.0, 5.0);
+		structure.addNode(-1.0, 10.0, 10.0);
+		structure.addNode(1.0, 10.0, 10.0);
+		structure.addPair(0, 1, "light");
+		structure.addPair(2, 3, "heavy");
+		structure.addPair(4, 5, "fixed");
+
+		tgBuildSpec spec;
+		spec.addBuilder("light", new tgRodInfo(tgRod::Config(0.5, 1.0)));
+		spec.addBuilder("heavy", new tgRodInfo(tgRod::Config(0.5, 3.0)));
+		spec.addBuilder("fixed", new tgRodInfo(tgRod::Config(0.5, 0.0)));
+		tgStructureInfo structureInfo(structure, spec);
+		structureInfo.buildInto(model, world);
+		model.setup(world);
+
+		const std::vector<tgRod*> light = model.find<tgRod>("light");
+		ASSERT_EQ(1u, light.size());
+		btRigidBody* const body = light[0]->getPRigidBody();
+		const btVector3 start = light[0]->centerOfMass();
+
+		tgFitnessMetrics metrics;
+		metrics.setup(model);
+		// The heavy rod's center stays at z = 5 and the static rod is
+		// not counted
+		EXPECT_NEAR(0.0, (metrics.getResults().startCOM -
+						  btVector3(0.0, 10.0, 3.75)).length(), 1.0e-9);
+
+		// Carry the light rod 3 along x, 4 along z, then 2 up. It has a
+		// quarter of the mass, so the center goes a quarter as far.
+		const btVector3 legs[] = {
+			btVector3(3.0, 0.0, 0.0),
+			btVector3(0.0, 0.0, 4.0),
+			btVector3(0.0, 2.0, 0.0)
+		};
+		btVector3 position = start;
+		for (std::size_t i = 0; i < sizeof(legs) / sizeof(legs[0]); i++)
+		{
+			position += legs[i];
+			btTransform transform = body->getCenterOfMassTransform();
+			transform.setOrigin(position);
+			body->setCenterOfMassTransform(transform);
+			body->getMotionState()->setWorldTransform(transform);
+			metrics.step(dt);
+		}
+
+		const tgFitnessMetrics::Results& results = metrics.getResults();
+		EXPECT_NEAR(9.0 / 4.0, results.pathLength, 1.0e-9);
+		EXPECT_NEAR(std::sqrt(29.0) / 4.0, results.displacement, 1.0e-9);
+		EXPECT_NEAR(5.0 / 4.0, results.horizontalDisplacement, 1.0e-9);
+		EXPECT_NEAR(0.0, (results.currentCOM - results.startCOM -
+						  btVector3(0.75, 0.5, 1.0)).length(), 1.0e-9);
+		EXPECT_EQ(0.0, results.work);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgHeightfieldGround_test.cpp
+* @brief Contains a test that tgHeightfieldGround has the same surface
+* as the tgHillyGround it replaces
+* $Id$
+*/
+
+// This application
+#include "core/terrain/tgHeightfieldGround.h"
+#include "core/terrain/tgHillyGround.h"
+// The Bullet Physics Library
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btVector3.h"
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/**
+	 * The height of body's surface under (x, z), found by casting a ray
+	 * straight down. Sets hit to false if the ray misses.
+	 */
+	double heightAt(btRigidBody* body, double x, double z, bool& hit)
+	{
+		btTransform from;
+		from.setIdentity();
+		from.setOrigin(btVector3(x, 100.0, z));
+		btTransform to;
+		to.setIdentity();
+		to.setOrigin(btVector3(x, -100.0, z));
+
+		btCollisionWorld::ClosestRayResultCallback result(from.getOrigin(),
+		                                                  to.getOrigin());
+		btCollisionWorld::rayTestSingle(from, to, body,
+		                                body->getCollisionShape(),
+		                                body->getWorldTransform(), result);
+		hit = result.hasHit();
+		return result.m_hitPointWorld.y();
+	}
+
+	void deleteBody(btRigidBody* body)
+	{
+		delete body->getMotionState();
+		delete body;
+	}
+
+	TEST(tgHeightfieldGroundTest, testSameSurfaceAsHillyGround) {
+
+		const std::size_t nx = 12;
+		const std::size_t ny = 10;
+		const double triangleSize = 2.0;
+		const tgHillyGround::Config config(btVector3(0.0, 0.0, 0.0),
+		                                   0.5, 0.0,
+		                                   btVector3(500.0, 1.5, 500.0),
+		                                   btVector3(0.0, 0.0, 0.0),
+		                                   nx, ny, 0.05, triangleSize,
+		                                   3.0, 0.5);
+
+		{
+			tgHillyGround hilly(config);
+			tgHeightfieldGround heightfield(config);
+			btRigidBody* const hillyBody = hilly.getGroundRigidBody();
+			btRigidBody* const heightfieldBody = heightfield.getGroundRigidBody();
+
+			// Points on both sides of each quad's diagonal, so a quad split
+			// the other way shows up
+			const double fractions[][2] = {
+				{ 0.5, 0.5 }, { 0.25, 0.7 }, { 0.7, 0.25 }, { 0.1, 0.9 }
+			};
+			for (std::size_t i = 0; i + 1 < nx; i++)
+			{
+				for (std::size_t j = 0; j + 1 < ny; j++)
+				{
+					for (std::size_t k = 0; k < 4; k++)
+					{
+						const double x = (i + fractions[k][0] - nx * 0.5) * triangleSize;
+						const double z = (j + fractions[k][1] - ny * 0.5) * triangleSize;
+						bool hillyHit = false;
+						bool heightfieldHit = false;
+						const double expected = heightAt(hillyBody, x, z, hillyHit);
+						const double actual =
+							heightAt(heightfieldBody, x, z, heightfieldHit);
+						ASSERT_TRUE(hillyHit);
+						ASSERT_TRUE(heightfieldHit);
+						EXPECT_NEAR(expected, actual, 1.0e-4)
+							<< "at x " << x << " z " << z;
+					}
+				}
+			}
+
+			deleteBody(hillyBody);
+		deleteBody(heightfieldBody);
+		}
+		// Only once no ground uses the cached heights
+		tgHeightfieldGround::clearCache();
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
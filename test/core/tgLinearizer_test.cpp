@@ -0,0 +1,333 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgLinearizer_test.cpp
+* @brief Contains a test that tgLinearizer's A and B match finite
+* differences of the state after steps of a tgWorld
+* $Id$
+*/
+
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgLinearizer.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgSpringCableActuator.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMatrix3x3.h"
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/**
+	 * The structure built into a world of its own, without gravity, and
+	 * stepped once so that each cable's previous length is its actual
+	 * length and the cables' damping sees the bodies' velocities
+	 */
+	class Simulation
+	{
+	public:
+
+		Simulation(tgStructure& structure, double dt) :
+			world(tgWorld::Config(0.0)),
+			m_dt(dt)
+		{
+			tgBuildSpec spec;
+			spec.addBuilder("rod", new tgRodInfo(tgRod::Config()));
+			// Pretensioned, and lightly damped so a jump in length
+			// barely disturbs the next step
+			spec.addBuilder("cable",
+							new tgBasicActuatorInfo(tgBasicActuator::Config(1000.0, 1.0, 200.0)));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+			linearizer.setup(model);
+			step();
+		}
+
+		~Simulation()
+		{
+			model.teardown();
+		}
+
+		/** One step, in the order tgSimulation takes it */
+		void step()
+		{
+			world.step(m_dt);
+			model.step(m_dt);
+		}
+
+		// The world outlives the model's bodies
+		tgWorld world;
+		tgModel model;
+		tgLinearizer linearizer;
+
+	private:
+		const double m_dt;
+	};
+
+	class tgLinearizerTest : public ::testing::Test {
+	protected:
+
+		tgLinearizerTest() :
+			dt(1.0e-6),
+			eps(1.0e-6)
+		{
+			// Two free rods, one above and across the other, pulled
+			// together by a cable between each pair of ends. The upper
+			// one is off center so the cables also turn them.
+			structure.addNode(-5.0, 10.0, 0.0);
+			structure.addNode(5.0, 10.0, 0.0);
+			structure.addNode(1.0, 13.0, -5.0);
+			structure.addNode(1.0, 13.0, 5.0);
+			structure.addPair(0, 1, "rod");
+			structure.addPair(2, 3, "rod");
+			structure.addPair(0, 2, "cable");
+			structure.addPair(0, 3, "cable");
+			structure.addPair(1, 2, "cable");
+			structure.addPair(1, 3, "cable");
+		}
+
+		/** Find what entry j of the state describes */
+		static bool locate(const tgLinearizer& linearizer, std::size_t j,
+						   std::size_t& body, tgLinearizer::Quantity& quantity,
+						   std::size_t& axis)
+		{
+			for (body = 0; body < linearizer.getBodies().size(); body++)
+			{
+				for (int q = tgLinearizer::ePosition;
+					 q <= tgLinearizer::eAngularVelocity; q++)
+				{
+					quantity = static_cast<tgLinearizer::Quantity>(q);
+					for (axis = 0; axis < 3; axis++)
+					{
+						if (linearizer.stateIndex(body, quantity, axis) == j)
+						{
+							return true;
+						}
+					}
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * Add delta to entry j of the state, or to the rest length of
+		 * actuator j - rows once j is past the state
+		 */
+		void perturb(Simulation& simulation, std::size_t j, double delta)
+		{
+			const tgLinearizer& linearizer = simulation.linearizer;
+			const std::vector<btRigidBody*>& bodies = linearizer.getBodies();
+			const std::size_t rows = 12 * bodies.size();
+			if (j >= rows)
+			{
+				tgBasicActuator* const pActuator =
+					tgCast::cast<tgSpringCableActuator, tgBasicActuator>(
+						linearizer.getActuators()[j - rows]);
+				ASSERT_TRUE(pActuator != NULL);
+				// Within the motor's speed, so it moves there at once
+				pActuator->setControlInput(pActuator->getRestLength() + delta, dt);
+				return;
+			}
+
+			std::size_t body = 0;
+			tgLinearizer::Quantity quantity = tgLinearizer::ePosition;
+			std::size_t axis = 0;
+			ASSERT_TRUE(locate(linearizer, j, body, quantity, axis));
+			btRigidBody* const pBody = bodies[body];
+			btVector3 unit(0.0, 0.0, 0.0);
+			unit[axis] = 1.0;
+			btTransform transform = pBody->getCenterOfMassTransform();
+			switch (quantity)
+			{
+			case tgLinearizer::ePosition:
+				transform.setOrigin(transform.getOrigin() + unit * delta);
+				pBody->setCenterOfMassTransform(transform);
+				break;
+			case tgLinearizer::eRotation:
+				transform.setBasis(btMatrix3x3(btQuaternion(unit, delta)) *
+								   transform.getBasis());
+				pBody->setCenterOfMassTransform(transform);
+				break;
+			case tgLinearizer::eVelocity:
+				pBody->setLinearVelocity(pBody->getLinearVelocity() + unit * delta);
+				break;
+			case tgLinearizer::eAngularVelocity:
+				pBody->setAngularVelocity(pBody->getAngularVelocity() + unit * delta);
+				break;
+			}
+		}
+
+		/**
+		 * The state's rate of change over one step of simulation, which
+		 * follows a step that lets the cables catch up with a change
+		 */
+		std::vector<double> rate(Simulation& simulation)
+		{
+			simulation.step();
+			const tgLinearizer& linearizer = simulation.linearizer;
+			const std::vector<btRigidBody*>& bodies = linearizer.getBodies();
+			std::vector<btTransform> transforms;
+			std::vector<btVector3> velocities;
+			std::vector<btVector3> angularVelocities;
+			for (std::size_t i = 0; i < bodies.size(); i++)
+			{
+				transforms.push_back(bodies[i]->getCenterOfMassTransform());
+				velocities.push_back(bodies[i]->getLinearVelocity());
+				angularVelocities.push_back(bodies[i]->getAngularVelocity());
+			}
+
+			simulation.step();
+			std::vector<double> result(12 * bodies.size());
+			for (std::size_t i = 0; i < bodies.size(); i++)
+			{
+				const btTransform& transform = bodies[i]->getCenterOfMassTransform();
+				const btVector3 velocity =
+					(transform.getOrigin() - transforms[i].getOrigin()) / dt;
+				// The small rotation in world coordinates
+				const btQuaternion turn =
+					transform.getRotation() * transforms[i].getRotation().inverse();
+				const double sign = turn.getW() < 0.0 ? -2.0 : 2.0;
+				const btVector3 angularVelocity =
+					btVector3(turn.getX(), turn.getY(), turn.getZ()) * (sign / dt);
+				const btVector3 acceleration =
+					(bodies[i]->getLinearVelocity() - velocities[i]) / dt;
+				const btVector3 angularAcceleration =
+					(bodies[i]->getAngularVelocity() - angularVelocities[i]) / dt;
+				for (std::size_t axis = 0; axis < 3; axis++)
+				{
+					result[linearizer.stateIndex(i, tgLinearizer::ePosition, axis)] =
+						velocity[axis];
+					result[linearizer.stateIndex(i, tgLinearizer::eRotation, axis)] =
+						angularVelocity[axis];
+					result[linearizer.stateIndex(i, tgLinearizer::eVelocity, axis)] =
+						acceleration[axis];
+					result[linearizer.stateIndex(i, tgLinearizer::eAngularVelocity, axis)] =
+						angularAcceleration[axis];
+				}
+			}
+			return result;
+		}
+
+		/** Central difference of the rate by entry j, as for perturb() */
+		std::vector<double> difference(std::size_t j)
+		{
+			Simulation above(structure, dt);
+			perturb(above, j, eps);
+			const std::vector<double> rateAbove = rate(above);
+
+			Simulation below(structure, dt);
+			perturb(below, j, -eps);
+			const std::vector<double> rateBelow = rate(below);
+
+			std::vector<double> result(rateAbove.size());
+			for (std::size_t i = 0; i < result.size(); i++)
+			{
+				result[i] = (rateAbove[i] - rateBelow[i]) / (2.0 * eps);
+			}
+			return result;
+		}
+
+		/**
+		 * Compare rows first to last of a column of A or B with the
+		 * finite difference, to a fraction of the column's largest entry
+		 */
+		static void expectColumn(const tgLinearizer::SparseMatrix& matrix,
+								 std::size_t column,
+								 const std::vector<double>& expected,
+								 std::size_t first, std::size_t last)
+		{
+			double scale = 0.0;
+			for (std::size_t i = 0; i < expected.size(); i++)
+			{
+				scale = std::max(scale, std::fabs(expected[i]));
+			}
+			ASSERT_GT(scale, 0.0) << "column " << column;
+			for (std::size_t i = first; i < last; i++)
+			{
+				EXPECT_NEAR(expected[i], matrix(i, column), 1.0e-2 * scale)
+					<< "row " << i << " column " << column;
+			}
+		}
+
+		const double dt;
+		const double eps;
+		tgStructure structure;
+	};
+
+	TEST_F(tgLinearizerTest, testMatchesFiniteDifferencesOfWorldStep) {
+		Simulation simulation(structure, dt);
+		tgLinearizer& linearizer = simulation.linearizer;
+		linearizer.linearize();
+		const tgLinearizer::SparseMatrix& A = linearizer.getA();
+		const tgLinearizer::SparseMatrix& B = linearizer.getB();
+
+		ASSERT_EQ(2u, linearizer.getBodies().size());
+		ASSERT_EQ(4u, linearizer.getActuators().size());
+		EXPECT_EQ(0u, linearizer.getSkippedCables());
+		const std::size_t rows = 24;
+		const std::size_t half = rows / 2;
+		ASSERT_EQ(rows, A.rows);
+		ASSERT_EQ(rows, A.cols);
+		ASSERT_EQ(rows, B.rows);
+		ASSERT_EQ(4u, B.cols);
+
+		for (std::size_t j = 0; j < rows; j++)
+		{
+			const std::vector<double> expected = difference(j);
+			std::size_t body = 0;
+			tgLinearizer::Quantity quantity = tgLinearizer::ePosition;
+			std::size_t axis = 0;
+			ASSERT_TRUE(locate(linearizer, j, body, quantity, axis));
+			const bool isVelocity = quantity == tgLinearizer::eVelocity ||
+				quantity == tgLinearizer::eAngularVelocity;
+			// A jump in position reaches the next step's damping as a
+			// length rate, and so the positions, but not the
+			// accelerations, which the stiffness dominates
+			expectColumn(A, j, expected, isVelocity ? 0 : half, rows);
+		}
+		for (std::size_t j = 0; j < B.cols; j++)
+		{
+			expectColumn(B, j, difference(rows + j), 0, rows);
+		}
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,274 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgMeshGround_test.cpp
+* @brief Contains tests that tgMeshGround parses STL and OBJ files and
+* reuses its BVH sidecar only while the mesh file is unchanged
+* $Id$
+*/
+
+// This application
+#include "core/terrain/tgMeshGround.h"
+// The Bullet Physics Library
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <stdint.h>
+// POSIX
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/**
+	 * A ground whose meshes are squares from -1 to 1 in x and z, at some
+	 * height, written to a directory of its own
+	 */
+	class tgMeshGroundTest : public ::testing::Test {
+	protected:
+
+		virtual void SetUp()
+		{
+			char name[] = "/tmp/tgMeshGround_testXXXXXX";
+			ASSERT_TRUE(mkdtemp(name) != NULL);
+			directory = name;
+		}
+
+		virtual void TearDown()
+		{
+			tgMeshGround::clearCache();
+			const char* const files[] = {
+				"ascii.stl", "binary.stl", "square.obj", "square.obj.bvh"
+			};
+			for (std::size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+			{
+				std::remove(path(files[i]).c_str());
+			}
+			rmdir(directory.c_str());
+		}
+
+		std::string path(const std::string& name) const
+		{
+			return directory + "/" + name;
+		}
+
+		/** The square at height y as a quad, which is split into a fan */
+		void writeOBJ(const std::string& filename, const std::string& y)
+		{
+			std::ofstream out(filename.c_str());
+			out << "# A square\n"
+				<< "v -1 " << y << " -1\n"
+				<< "v 1 " << y << " -1\n"
+				<< "v 1 " << y << " 1\n"
+				<< "v -1 " << y << " 1\n"
+				<< "f 1/1 2//2 3 -1\n";
+		}
+
+		void writeAsciiSTL(const std::string& filename, double y)
+		{
+			std::ofstream out(filename.c_str());
+			out << "solid square\n";
+			const double corners[2][3][2] = {
+				{ { -1.0, -1.0 }, { 1.0, -1.0 }, { 1.0, 1.0 } },
+				{ { -1.0, -1.0 }, { 1.0, 1.0 }, { -1.0, 1.0 } }
+			};
+			for (int t = 0; t < 2; t++)
+			{
+				out << " facet normal 0 1 0\n  outer loop\n";
+				for (int k = 0; k < 3; k++)
+				{
+					out << "   vertex " << corners[t][k][0] << " " << y << " "
+						<< corners[t][k][1] << "\n";
+				}
+				out << "  endloop\n endfacet\n";
+			}
+			out << "endsolid square\n";
+		}
+
+		void writeBinarySTL(const std::string& filename, float y)
+		{
+			std::ofstream out(filename.c_str(), std::ios::binary);
+			// A header that starts like an ASCII file
+			char header[80];
+			std::memset(header, ' ', sizeof(header));
+			std::memcpy(header, "solid", 5);
+			out.write(header, sizeof(header));
+			const uint32_t count = 2;
+			out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+			const float triangles[2][12] = {
+				{ 0, 1, 0, -1, y, -1, 1, y, -1, 1, y, 1 },
+				{ 0, 1, 0, -1, y, -1, 1, y, 1, -1, y, 1 }
+			};
+			const uint16_t attributes = 0;
+			for (int t = 0; t < 2; t++)
+			{
+				out.write(reinterpret_cast<const char*>(triangles[t]),
+						  sizeof(triangles[t]));
+				out.write(reinterpret_cast<const char*>(&attributes),
+						  sizeof(attributes));
+			}
+		}
+
+		static void setModificationTime(const std::string& filename, time_t t)
+		{
+			struct utimbuf times;
+			times.actime = t;
+			times.modtime = t;
+			ASSERT_EQ(0, utime(filename.c_str(), &times));
+		}
+
+		static bool exists(const std::string& filename)
+		{
+			struct stat info;
+			return stat(filename.c_str(), &info) == 0;
+		}
+
+		/**
+		 * The height of the ground under (x, z), found by casting a ray
+		 * straight down. Sets hit to false if the ray misses.
+		 */
+		static double heightAt(const std::string& filename,
+							   const tgMeshGround::Config& config,
+							   double x, double z, bool& hit)
+		{
+			tgMeshGround ground(filename, config);
+			btRigidBody* const body = ground.getGroundRigidBody();
+
+			btTransform from;
+			from.setIdentity();
+			from.setOrigin(btVector3(x, 100.0, z));
+			btTransform to;
+			to.setIdentity();
+			to.setOrigin(btVector3(x, -100.0, z));
+			btCollisionWorld::ClosestRayResultCallback result(from.getOrigin(),
+															  to.getOrigin());
+			btCollisionWorld::rayTestSingle(from, to, body,
+											body->getCollisionShape(),
+											body->getWorldTransform(), result);
+			hit = result.hasHit();
+
+			delete body->getMotionState();
+			delete body;
+			return result.m_hitPointWorld.y();
+		}
+
+		/** The height at a point off the square's diagonal */
+		static double heightAt(const std::string& filename,
+							   const tgMeshGround::Config& config)
+		{
+			bool hit = false;
+			const double y = heightAt(filename, config, 0.3, -0.6, hit);
+			EXPECT_TRUE(hit) << filename;
+			return y;
+		}
+
+		/** No margin, so rays hit the triangles themselves */
+		static tgMeshGround::Config config(double scale, bool useBvhFile)
+		{
+			return tgMeshGround::Config(btVector3(0.0, 0.0, 0.0), 0.5, 0.0,
+										btVector3(0.0, 0.0, 0.0), scale, 0.0,
+										useBvhFile);
+		}
+
+		std::string directory;
+	};
+
+	TEST_F(tgMeshGroundTest, testParsesStlAndObj) {
+		writeAsciiSTL(path("ascii.stl"), 1.5);
+		writeBinarySTL(path("binary.stl"), 2.5f);
+		writeOBJ(path("square.obj"), "3.5");
+
+		EXPECT_NEAR(1.5, heightAt(path("ascii.stl"), config(1.0, false)), 1.0e-6);
+		EXPECT_NEAR(2.5, heightAt(path("binary.stl"), config(1.0, false)), 1.0e-6);
+		EXPECT_NEAR(3.5, heightAt(path("square.obj"), config(1.0, false)), 1.0e-6);
+		// Both triangles of the fan, and nothing outside the square
+		bool hit = false;
+		EXPECT_NEAR(3.5, heightAt(path("square.obj"), config(1.0, false),
+								  -0.6, 0.3, hit), 1.0e-6);
+		EXPECT_TRUE(hit);
+		heightAt(path("square.obj"), config(1.0, false), 1.5, 0.0, hit);
+		EXPECT_FALSE(hit);
+
+		// The scale applies to every coordinate
+		tgMeshGround::clearCache();
+		bool scaledHit = false;
+		EXPECT_NEAR(7.0, heightAt(path("square.obj"), config(2.0, false),
+								  1.5, 0.0, scaledHit), 1.0e-6);
+		EXPECT_TRUE(scaledHit);
+		EXPECT_FALSE(exists(path("square.obj.bvh")));
+	}
+
+	TEST_F(tgMeshGroundTest, testSidecarSkipsUnchangedMesh) {
+		writeOBJ(path("square.obj"), "1");
+		setModificationTime(path("square.obj"), 1000000000);
+		EXPECT_NEAR(1.0, heightAt(path("square.obj"), config(1.0, true)), 1.0e-6);
+		ASSERT_TRUE(exists(path("square.obj.bvh")));
+
+		// Same size and time: the sidecar's mesh is used, and the mesh
+		// file is not read
+		tgMeshGround::clearCache();
+		writeOBJ(path("square.obj"), "7");
+		setModificationTime(path("square.obj"), 1000000000);
+		EXPECT_NEAR(1.0, heightAt(path("square.obj"), config(1.0, true)), 1.0e-6);
+	}
+
+	TEST_F(tgMeshGroundTest, testStaleSidecarRejected) {
+		writeOBJ(path("square.obj"), "1");
+		setModificationTime(path("square.obj"), 1000000000);
+		EXPECT_NEAR(1.0, heightAt(path("square.obj"), config(1.0, true)), 1.0e-6);
+		ASSERT_TRUE(exists(path("square.obj.bvh")));
+
+		// Only touched: the hash still matches
+		tgMeshGround::clearCache();
+		setModificationTime(path("square.obj"), 1100000000);
+		EXPECT_NEAR(1.0, heightAt(path("square.obj"), config(1.0, true)), 1.0e-6);
+
+		// Same size, new contents and time
+		tgMeshGround::clearCache();
+		writeOBJ(path("square.obj"), "3");
+		setModificationTime(path("square.obj"), 1200000000);
+		EXPECT_NEAR(3.0, heightAt(path("square.obj"), config(1.0, true)), 1.0e-6);
+
+		// New size, same time
+		tgMeshGround::clearCache();
+		writeOBJ(path("square.obj"), "15");
+		setModificationTime(path("square.obj"), 1200000000);
+		EXPECT_NEAR(15.0, heightAt(path("square.obj"), config(1.0, true)), 1.0e-6);
+
+		// New scale
+		tgMeshGround::clearCache();
+		EXPECT_NEAR(30.0, heightAt(path("square.obj"), config(2.0, true)), 1.0e-6);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
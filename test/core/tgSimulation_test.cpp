@@ -0,0 +1,243 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+
+/**
+* @file tgSimulation_test.cpp
+* @brief Contains tests that Config::modelPeriod slows the controllers
+* but not the models, actuators and cables stepped with the world, and
+* that a run resumed from a checkpoint continues exactly
+* $Id$
+*/
+
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgModel.h"
+#include "core/tgObserver.h"
+#include "core/tgRod.h"
+#include "core/tgSimulation.h"
+#include "core/tgSimView.h"
+#include "core/tgSubject.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+// POSIX
+#include <unistd.h>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/**
+	 * A rod hanging from a static rod by two cables, released off to
+	 * the side so it swings and bounces
+	 */
+	class SpringModel : public tgSubject<SpringModel>, public tgModel
+	{
+	public:
+
+		virtual void setup(tgWorld& world)
+		{
+			tgStructure structure;
+			structure.addNode(-1.0, 20.0, 0.0);
+			structure.addNode(1.0, 20.0, 0.0);
+			structure.addNode(2.0, 17.0, 0.0);
+			structure.addNode(4.0, 17.0, 0.0);
+			structure.addPair(0, 1, "anchor");
+			structure.addPair(2, 3, "bob");
+			structure.addPair(0, 2, "cable");
+			structure.addPair(1, 3, "cable");
+
+			tgBuildSpec spec;
+			// No density, so Bullet holds the anchor still
+			spec.addBuilder("anchor", new tgRodInfo(tgRod::Config(0.5, 0.0)));
+			spec.addBuilder("bob", new tgRodInfo(tgRod::Config(0.5, 1.0)));
+			spec.addBuilder("cable",
+							new tgBasicActuatorInfo(tgBasicActuator::Config(100.0, 1.0)));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(*this, world);
+
+			notifySetup();
+			tgModel::setup(world);
+		}
+
+		virtual void step(double dt)
+		{
+			notifyStep(dt);
+			tgModel::step(dt);
+		}
+
+		virtual void teardown()
+		{
+			notifyTeardown();
+			tgModel::teardown();
+		}
+
+		btVector3 bobPosition()
+		{
+			const std::vector<tgRod*> bobs = find<tgRod>("bob");
+			return bobs.empty() ? btVector3(0.0, 0.0, 0.0) :
+				bobs[0]->getPRigidBody()->getCenterOfMassPosition();
+		}
+	};
+
+	/** Counts its steps and the time they covered, and does nothing */
+	class CountingController : public tgObserver<SpringModel>
+	{
+	public:
+
+		CountingController() : steps(0), time(0.0) { }
+
+		virtual void onStep(SpringModel& subject, double dt)
+		{
+			steps++;
+			time += dt;
+		}
+
+		int steps;
+		double time;
+	};
+
+	class tgSimulationTest : public ::testing::Test {
+	protected:
+
+		/**
+		 * Run the spring model for the given steps of dt. Returns where
+		 * the bob ends up.
+		 */
+		static btVector3 swing(const tgSimulation::Config& config,
+							   double dt, int steps,
+							   CountingController& controller)
+		{
+			tgWorld world;
+			tgSimView view(world, dt);
+			tgSimulation simulation(view, config);
+			// The simulation deletes its models
+			SpringModel* const pModel = new SpringModel();
+			pModel->attach(&controller);
+			simulation.addModel(pModel);
+
+			for (int i = 0; i < steps; i++)
+			{
+				simulation.step(dt);
+			}
+			return pModel->bobPosition();
+		}
+	};
+
+	TEST_F(tgSimulationTest, testTrajectoryIgnoresModelPeriod) {
+		CountingController everyStep;
+		const btVector3 reference =
+			swing(tgSimulation::Config(), 0.001, 1000, everyStep);
+		EXPECT_EQ(1000, everyStep.steps);
+		// It did swing
+		EXPECT_GT((reference - btVector3(3.0, 17.0, 0.0)).length(), 0.5);
+
+		CountingController decimated;
+		const btVector3 position =
+			swing(tgSimulation::Config(1, 0.05), 0.001, 1000, decimated);
+		EXPECT_EQ(20, decimated.steps);
+		EXPECT_NEAR(1.0, decimated.time, 1.0e-9);
+		EXPECT_NEAR(reference.x(), position.x(), 1.0e-9);
+		EXPECT_NEAR(reference.y(), position.y(), 1.0e-9);
+		EXPECT_NEAR(reference.z(), position.z(), 1.0e-9);
+	}
+
+	TEST_F(tgSimulationTest, testSubstepsStepModelsWithWorld) {
+		CountingController halfSteps;
+		const btVector3 reference =
+			swing(tgSimulation::Config(), 0.0005, 2000, halfSteps);
+
+		// Two substeps per step step the cables as often as half steps
+		CountingController substeps;
+		const btVector3 position =
+			swing(tgSimulation::Config(2, 0.001), 0.001, 1000, substeps);
+		EXPECT_EQ(2000, halfSteps.steps);
+		EXPECT_EQ(1000, substeps.steps);
+		EXPECT_NEAR(reference.x(), position.x(), 1.0e-9);
+		EXPECT_NEAR(reference.y(), position.y(), 1.0e-9);
+		EXPECT_NEAR(reference.z(), position.z(), 1.0e-9);
+	}
+
+	TEST_F(tgSimulationTest, testCheckpointResumesExactly) {
+		char name[] = "/tmp/tgSimulation_testXXXXXX";
+		const int fd = mkstemp(name);
+		ASSERT_NE(-1, fd);
+		close(fd);
+		const std::string filename = name;
+
+		const double dt = 0.001;
+		tgWorld world;
+		tgSimView view(world, dt);
+		tgSimulation simulation(view);
+		CountingController controller;
+		// The simulation deletes its models
+		SpringModel* const pModel = new SpringModel();
+		pModel->attach(&controller);
+		simulation.addModel(pModel);
+
+		for (int i = 0; i < 500; i++)
+		{
+			simulation.step(dt);
+		}
+
+		// Saving leaves the C library generator alone
+		std::srand(7);
+		const int expected = std::rand();
+		std::srand(7);
+		simulation.saveCheckpoint(filename);
+		EXPECT_EQ(expected, std::rand());
+
+		for (int i = 0; i < 500; i++)
+		{
+			simulation.step(dt);
+		}
+		const btVector3 uninterrupted = pModel->bobPosition();
+
+		// Resume in a fresh trial and take the same steps again
+		simulation.reset();
+		simulation.loadCheckpoint(filename);
+		for (int i = 0; i < 500; i++)
+		{
+			simulation.step(dt);
+		}
+		const btVector3 resumed = pModel->bobPosition();
+
+		EXPECT_NEAR(uninterrupted.x(), resumed.x(), 1.0e-9);
+		EXPECT_NEAR(uninterrupted.y(), resumed.y(), 1.0e-9);
+		EXPECT_NEAR(uninterrupted.z(), resumed.z(), 1.0e-9);
+		std::remove(filename.c_str());
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,348 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgTrialWatchdog_test.cpp
+* @brief Contains tests that tgTrialWatchdog ends a trial on each of its
+* limits, on its predicates and on tgTrialFailure, and that a reset
+* clears it
+* $Id$
+*/
+
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgModel.h"
+#include "core/tgObserver.h"
+#include "core/tgRod.h"
+#include "core/tgSimulation.h"
+#include "core/tgSimView.h"
+#include "core/tgSubject.h"
+#include "core/tgTrialFailure.h"
+#include "core/tgTrialWatchdog.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <string>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/**
+	 * A rod hanging from a static rod by two cables, released off to
+	 * the side so it swings down and stretches them
+	 */
+	class SwingModel : public tgSubject<SwingModel>, public tgModel
+	{
+	public:
+
+		virtual void setup(tgWorld& world)
+		{
+			tgStructure structure;
+			structure.addNode(-1.0, 20.0, 0.0);
+			structure.addNode(1.0, 20.0, 0.0);
+			structure.addNode(2.0, 17.0, 0.0);
+			structure.addNode(4.0, 17.0, 0.0);
+			structure.addPair(0, 1, "anchor");
+			structure.addPair(2, 3, "bob");
+			structure.addPair(0, 2, "cable");
+			structure.addPair(1, 3, "cable");
+
+			tgBuildSpec spec;
+			// No density, so Bullet holds the anchor still
+			spec.addBuilder("anchor", new tgRodInfo(tgRod::Config(0.5, 0.0)));
+			spec.addBuilder("bob", new tgRodInfo(tgRod::Config(0.5, 1.0)));
+			spec.addBuilder("cable",
+							new tgBasicActuatorInfo(tgBasicActuator::Config(100.0, 1.0)));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(*this, world);
+
+			notifySetup();
+			tgModel::setup(world);
+		}
+
+		virtual void step(double dt)
+		{
+			notifyStep(dt);
+			tgModel::step(dt);
+		}
+
+		virtual void teardown()
+		{
+			notifyTeardown();
+			tgModel::teardown();
+		}
+
+		btVector3 bobPosition()
+		{
+			const std::vector<tgRod*> bobs = find<tgRod>("bob");
+			return bobs.empty() ? btVector3(0.0, 0.0, 0.0) :
+				bobs[0]->getPRigidBody()->getCenterOfMassPosition();
+		}
+	};
+
+	/**
+	 * Counts the steps of the trial, throws tgTrialFailure on step
+	 * failAt if that is positive, and reads the watchdog's reason at
+	 * teardown
+	 */
+	class FailingController : public tgObserver<SwingModel>
+	{
+	public:
+
+		FailingController(const tgSimulation& simulation, int failAt = 0) :
+			steps(0),
+			teardownReason(tgTrialWatchdog::eNone),
+			m_simulation(simulation),
+			m_failAt(failAt)
+		{
+		}
+
+		virtual void onSetup(SwingModel& subject)
+		{
+			steps = 0;
+		}
+
+		virtual void onStep(SwingModel& subject, double dt)
+		{
+			steps++;
+			if (steps == m_failAt)
+			{
+				throw tgTrialFailure("cable snapped");
+			}
+		}
+
+		virtual void onTeardown(SwingModel& subject)
+		{
+			const tgTrialWatchdog* const pWatchdog = m_simulation.getWatchdog();
+			teardownReason = pWatchdog ? pWatchdog->getStatus().reason :
+				tgTrialWatchdog::eNone;
+		}
+
+		int steps;
+		tgTrialWatchdog::Reason teardownReason;
+
+	private:
+
+		const tgSimulation& m_simulation;
+		const int m_failAt;
+	};
+
+	/** Fails once the trial has run for a given time */
+	class TimePredicate : public tgTrialWatchdog::Predicate
+	{
+	public:
+
+		explicit TimePredicate(double limit) : m_limit(limit) { }
+
+		virtual bool failed(double time) const
+		{
+			return time >= m_limit - 1.0e-9;
+		}
+
+	private:
+
+		const double m_limit;
+	};
+
+	class tgTrialWatchdogTest : public ::testing::Test {
+	protected:
+
+		tgTrialWatchdogTest() :
+			dt(0.001),
+			view(world, dt),
+			simulation(view)
+		{
+		}
+
+		/** Adds a swing model that controller observes */
+		SwingModel* addModel(FailingController& controller)
+		{
+			// The simulation deletes its models
+			SwingModel* const pModel = new SwingModel();
+			pModel->attach(&controller);
+			simulation.addModel(pModel);
+			return pModel;
+		}
+
+		/** Steps until the trial is over or steps have been taken */
+		int run(int steps)
+		{
+			int i = 0;
+			for (; i < steps && !simulation.isTrialOver(); i++)
+			{
+				simulation.step(dt);
+			}
+			return i;
+		}
+
+		const double dt;
+		tgWorld world;
+		tgSimView view;
+		tgSimulation simulation;
+	};
+
+	TEST_F(tgTrialWatchdogTest, testEnergyTrips) {
+		FailingController controller(simulation);
+		addModel(controller);
+		simulation.setWatchdog(new tgTrialWatchdog(
+			tgTrialWatchdog::Config(0.0, 1.0)));
+
+		run(2000);
+		ASSERT_TRUE(simulation.isTrialOver());
+		const tgTrialWatchdog::Status& status =
+			simulation.getWatchdog()->getStatus();
+		EXPECT_EQ(tgTrialWatchdog::eEnergy, status.reason);
+		EXPECT_GT(status.value, 1.0);
+		EXPECT_GT(status.time, 0.0);
+		EXPECT_LT(status.time, 2.0);
+	}
+
+	TEST_F(tgTrialWatchdogTest, testStrainTrips) {
+		FailingController controller(simulation);
+		addModel(controller);
+		simulation.setWatchdog(new tgTrialWatchdog(
+			tgTrialWatchdog::Config(0.0, 0.0, 0.005)));
+
+		run(2000);
+		ASSERT_TRUE(simulation.isTrialOver());
+		const tgTrialWatchdog::Status& status =
+			simulation.getWatchdog()->getStatus();
+		EXPECT_EQ(tgTrialWatchdog::eCableStrain, status.reason);
+		EXPECT_GT(status.value, 0.005);
+	}
+
+	TEST_F(tgTrialWatchdogTest, testLimitsOffDoNotTrip) {
+		FailingController controller(simulation);
+		addModel(controller);
+		simulation.setWatchdog(new tgTrialWatchdog());
+
+		EXPECT_EQ(2000, run(2000));
+		EXPECT_FALSE(simulation.isTrialOver());
+		EXPECT_EQ(2000, controller.steps);
+	}
+
+	TEST_F(tgTrialWatchdogTest, testPredicateTripsAndStopsStepping) {
+		FailingController controller(simulation);
+		SwingModel* const pModel = addModel(controller);
+		tgTrialWatchdog* const pWatchdog = new tgTrialWatchdog();
+		EXPECT_EQ(0u, pWatchdog->addPredicate(new TimePredicate(1.0)));
+		EXPECT_EQ(1u, pWatchdog->addPredicate(new TimePredicate(0.05)));
+		EXPECT_THROW(pWatchdog->addPredicate(NULL), std::invalid_argument);
+		simulation.setWatchdog(pWatchdog);
+
+		EXPECT_EQ(50, run(2000));
+		const tgTrialWatchdog::Status& status = pWatchdog->getStatus();
+		EXPECT_EQ(tgTrialWatchdog::ePredicate, status.reason);
+		EXPECT_EQ(1.0, status.value);
+		EXPECT_NEAR(0.05, status.time, 1.0e-9);
+		// The models are not stepped into the failed state
+		EXPECT_EQ(49, controller.steps);
+
+		// Nothing moves until the reset
+		const btVector3 stopped = pModel->bobPosition();
+		simulation.step(dt);
+		EXPECT_EQ(49, controller.steps);
+		EXPECT_EQ(stopped, pModel->bobPosition());
+	}
+
+	TEST_F(tgTrialWatchdogTest, testFailureTrips) {
+		FailingController controller(simulation, 20);
+		addModel(controller);
+		simulation.setWatchdog(new tgTrialWatchdog());
+
+		EXPECT_EQ(20, run(2000));
+		const tgTrialWatchdog::Status& status =
+			simulation.getWatchdog()->getStatus();
+		EXPECT_EQ(tgTrialWatchdog::eException, status.reason);
+		EXPECT_EQ(std::string("cable snapped"), status.message);
+		EXPECT_NEAR(0.02, status.time, 1.0e-9);
+	}
+
+	TEST_F(tgTrialWatchdogTest, testFailurePropagatesWithoutWatchdog) {
+		FailingController controller(simulation, 20);
+		addModel(controller);
+
+		for (int i = 1; i < 20; i++)
+		{
+			simulation.step(dt);
+		}
+		EXPECT_THROW(simulation.step(dt), tgTrialFailure);
+		EXPECT_FALSE(simulation.isTrialOver());
+	}
+
+	TEST_F(tgTrialWatchdogTest, testResetClearsStatus) {
+		FailingController controller(simulation, 20);
+		addModel(controller);
+		simulation.setWatchdog(new tgTrialWatchdog());
+		run(2000);
+		ASSERT_TRUE(simulation.isTrialOver());
+
+		simulation.reset();
+		// The controllers saw why the trial ended
+		EXPECT_EQ(tgTrialWatchdog::eException, controller.teardownReason);
+
+		const tgTrialWatchdog::Status& status =
+			simulation.getWatchdog()->getStatus();
+		EXPECT_FALSE(simulation.isTrialOver());
+		EXPECT_EQ(tgTrialWatchdog::eNone, status.reason);
+		EXPECT_EQ(0.0, status.time);
+		EXPECT_EQ(0.0, status.value);
+		EXPECT_TRUE(status.message.empty());
+
+		// The next trial runs until the controller fails again
+		EXPECT_EQ(0, controller.steps);
+		EXPECT_EQ(20, run(2000));
+		EXPECT_TRUE(simulation.isTrialOver());
+	}
+
+	TEST_F(tgTrialWatchdogTest, testTripKeepsFirstReason) {
+		tgTrialWatchdog watchdog;
+		EXPECT_FALSE(watchdog.isTripped());
+		watchdog.trip(tgTrialWatchdog::eNone);
+		EXPECT_FALSE(watchdog.isTripped());
+
+		watchdog.trip(tgTrialWatchdog::eCableStrain, 0.5);
+		watchdog.trip(tgTrialWatchdog::eEnergy, 100.0);
+		EXPECT_TRUE(watchdog.isTripped());
+		EXPECT_EQ(tgTrialWatchdog::eCableStrain, watchdog.getStatus().reason);
+		EXPECT_EQ(0.5, watchdog.getStatus().value);
+
+		watchdog.reset();
+		EXPECT_FALSE(watchdog.isTripped());
+		EXPECT_EQ(tgTrialWatchdog::eNone, watchdog.getStatus().reason);
+
+		const tgTrialWatchdog::Config negativePeriod(-1.0);
+		EXPECT_THROW(tgTrialWatchdog bad(negativePeriod), std::invalid_argument);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,136 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgWorld_test.cpp
+* @brief Contains tests that cable forces applied in Bullet's internal
+* ticks converge as the world takes more substeps per step
+* $Id$
+*/
+
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgWorldTest : public ::testing::Test {
+	protected:
+
+		/**
+		 * A pendulum held only by cables: a rod hanging from a static
+		 * rod by two cables, released off to the side so it swings.
+		 * Returns where the swinging rod is after the given seconds.
+		 */
+		static btVector3 swing(const tgWorld::Config& config, double dt,
+							   double seconds)
+		{
+			tgWorld world(config);
+			tgModel model;
+
+			tgStructure structure;
+			structure.addNode(-1.0, 20.0, 0.0);
+			structure.addNode(1.0, 20.0, 0.0);
+			structure.addNode(2.0, 17.0, 0.0);
+			structure.addNode(4.0, 17.0, 0.0);
+			structure.addPair(0, 1, "anchor");
+			structure.addPair(2, 3, "bob");
+			structure.addPair(0, 2, "cable");
+			structure.addPair(1, 3, "cable");
+
+			tgBuildSpec spec;
+			// No density, so Bullet holds the anchor still
+			spec.addBuilder("anchor", new tgRodInfo(tgRod::Config(0.5, 0.0)));
+			spec.addBuilder("bob", new tgRodInfo(tgRod::Config(0.5, 1.0)));
+			spec.addBuilder("cable",
+							new tgBasicActuatorInfo(tgBasicActuator::Config(100.0, 1.0)));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+
+			const int steps = static_cast<int>(seconds / dt + 0.5);
+			for (int i = 0; i < steps; i++)
+			{
+				world.step(dt);
+				model.step(dt);
+			}
+
+			btVector3 position(0.0, 0.0, 0.0);
+			const std::vector<tgRod*> rods =
+				tgCast::filter<tgModel, tgRod>(model.getDescendants());
+			for (std::size_t i = 0; i < rods.size(); i++)
+			{
+				if (rods[i]->hasTag("bob"))
+				{
+					position = rods[i]->getPRigidBody()->getCenterOfMassPosition();
+				}
+			}
+
+			model.teardown();
+			return position;
+		}
+	};
+
+	TEST_F(tgWorldTest, testSubstepsMatchSmallerSteps) {
+		const double seconds = 1.0;
+		// Forces recomputed every millisecond, whether by steps or by ticks
+		const btVector3 reference =
+			swing(tgWorld::Config(9.81, 1000.0, true, 1), 0.001, seconds);
+		const btVector3 substepped =
+			swing(tgWorld::Config(9.81, 1000.0, true, 10), 0.01, seconds);
+
+		// It did swing
+		EXPECT_GT((reference - btVector3(3.0, 17.0, 0.0)).length(), 0.5);
+		EXPECT_NEAR(reference.x(), substepped.x(), 1.0e-3);
+		EXPECT_NEAR(reference.y(), substepped.y(), 1.0e-3);
+		EXPECT_NEAR(reference.z(), substepped.z(), 1.0e-3);
+
+		// Impulses once per step lag the ticks they are applied over
+		const btVector3 impulses =
+			swing(tgWorld::Config(9.81, 1000.0, false, 10), 0.01, seconds);
+		EXPECT_GT((impulses - reference).length(),
+				  10.0 * (substepped - reference).length());
+	}
+
+	TEST_F(tgWorldTest, testSubstepsMustBePositive) {
+		EXPECT_THROW(tgWorld::Config(9.81, 1000.0, true, 0),
+					 std::invalid_argument);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
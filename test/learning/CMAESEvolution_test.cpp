@@ -0,0 +1,95 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file CMAESEvolution_test.cpp
+* @brief Contains a test that CMAESEvolution converges on an
+* ill-conditioned quadratic of 30 parameters
+* $Id$
+*/
+
+// This application
+#include "learning/CMAESEvolution/CMAESEvolution.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/**
+	 * Minus an ellipsoid centered inside the unit cube, with axis
+	 * scales from 1 to 1e6, so the best score is zero
+	 */
+	double score(const std::vector<double>& x)
+	{
+		double sum = 0.0;
+		for (std::size_t i = 0; i < x.size(); i++)
+		{
+			const double scale = std::pow(1.0e6, i / (x.size() - 1.0));
+			sum += scale * (x[i] - 0.3) * (x[i] - 0.3);
+		}
+		return -sum;
+	}
+
+	TEST(CMAESEvolutionTest, testConvergesOnIllConditionedQuadratic) {
+		const std::string config = "CMAESEvolution_test.ini";
+		{
+			std::ofstream ini(config.c_str());
+			ini << "numberOfControllers=1\n"
+				<< "numberOfActions=30\n"
+				<< "numberOfSubtests=1\n"
+				<< "populationSize=0\n"
+				<< "startSeed=0\n"
+				<< "learning=0\n";
+		}
+		CMAESEvolution evolution("test", config);
+		std::remove(config.c_str());
+
+		double best = -HUGE_VAL;
+		std::size_t evaluations = 0;
+		while (best < -1.0e-8 && evaluations < 60000)
+		{
+			const std::vector< std::vector< std::vector<double> > > generation =
+				evolution.nextGeneration();
+			std::vector<double> scores(generation.size());
+			for (std::size_t k = 0; k < generation.size(); k++)
+			{
+				scores[k] = score(generation[k][0]);
+				best = std::max(best, scores[k]);
+			}
+			evaluations += generation.size();
+			evolution.updateGeneration(scores);
+		}
+		// About 38000 evaluations are typical
+		EXPECT_GE(best, -1.0e-8) << "after " << evaluations << " evaluations";
+		std::cout << evaluations << " evaluations" << std::endl;
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,109 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file EvaluationCache_test.cpp
+* @brief Contains tests that EvaluationCache matches candidates by their
+* parameters and keeps its entries across runs
+* $Id$
+*/
+
+// This application
+#include "learning/EvaluationCache/EvaluationCache.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <string>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	typedef std::vector< std::vector<double> > Candidate;
+
+	Candidate candidate(double a, double b)
+	{
+		Candidate result(1);
+		result[0].push_back(a);
+		result[0].push_back(b);
+		return result;
+	}
+
+	TEST(EvaluationCacheTest, testLookupByParameters) {
+		EvaluationCache cache("scenario", 1);
+		cache.store(candidate(0.0, 0.5), std::vector<double>(2, 3.0));
+
+		std::vector<double> scores;
+		// -0.0 is the same parameter as 0.0
+		ASSERT_TRUE(cache.lookup(candidate(-0.0, 0.5), 0, scores));
+		EXPECT_EQ(std::vector<double>(2, 3.0), scores);
+		// A deterministic scenario gives every subtest the same scores
+		EXPECT_TRUE(cache.lookup(candidate(0.0, 0.5), 3, scores));
+		EXPECT_FALSE(cache.lookup(candidate(0.5, 0.0), 0, scores));
+
+		// Controller boundaries are part of the candidate
+		Candidate split(2);
+		split[0].push_back(0.0);
+		split[1].push_back(0.5);
+		EXPECT_FALSE(cache.lookup(split, 0, scores));
+
+		// Candidates without parameters are never cached
+		cache.store(Candidate(), std::vector<double>(2, 1.0));
+		EXPECT_FALSE(cache.lookup(Candidate(), 0, scores));
+	}
+
+	TEST(EvaluationCacheTest, testStochasticKeepsEachSample) {
+		EvaluationCache cache("scenario", 2);
+		cache.store(candidate(1.0, 2.0), std::vector<double>(1, 1.0));
+
+		std::vector<double> scores;
+		EXPECT_TRUE(cache.lookup(candidate(1.0, 2.0), 0, scores));
+		EXPECT_FALSE(cache.lookup(candidate(1.0, 2.0), 1, scores));
+
+		cache.store(candidate(1.0, 2.0), std::vector<double>(1, 2.0));
+		cache.store(candidate(1.0, 2.0), std::vector<double>(1, 3.0));
+		ASSERT_TRUE(cache.lookup(candidate(1.0, 2.0), 1, scores));
+		EXPECT_EQ(2.0, scores[0]);
+	}
+
+	TEST(EvaluationCacheTest, testEntriesPersistPerScenario) {
+		const std::string filename = "EvaluationCache_test.csv";
+		std::remove(filename.c_str());
+		// Not exactly representable in decimal
+		const double score = 0.1 + 0.2;
+		{
+			EvaluationCache cache("first", 1, filename);
+			cache.store(candidate(1.0, 2.0), std::vector<double>(1, score));
+		}
+
+		std::vector<double> scores;
+		EvaluationCache reloaded("first", 1, filename);
+		ASSERT_TRUE(reloaded.lookup(candidate(1.0, 2.0), 0, scores));
+		EXPECT_EQ(score, scores[0]);
+
+		EvaluationCache other("second", 1, filename);
+		EXPECT_FALSE(other.lookup(candidate(1.0, 2.0), 0, scores));
+		std::remove(filename.c_str());
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,290 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file ResultsStore_test.cpp
+* @brief Contains tests that ResultsStore keeps whole records under
+* concurrent appends, answers its queries, and indexes lazily through its
+* sidecar
+* $Id$
+*/
+
+// This application
+#include "learning/ResultsStore/ResultsStore.h"
+// The C++ Standard Library
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+// POSIX
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/** A trial whose fields all follow from its generation and number */
+	ResultsStore::Trial trial(int generation, int number, double score)
+	{
+		ResultsStore::Trial result;
+		std::ostringstream scenario;
+		scenario << "writer " << generation << " trial " << number;
+		result.scenario = scenario.str();
+		result.generation = generation;
+		result.seed = 1000 * generation + number;
+		result.timestamp = 1.0e9 + number;
+		result.duration = 0.5 * number;
+		for (int i = 0; i <= number % 5; i++)
+		{
+			result.parameters.push_back(generation + 0.01 * i);
+		}
+		result.scores.push_back(score);
+		result.scores.push_back(-score);
+		return result;
+	}
+
+	void expectSameTrial(const ResultsStore::Trial& expected,
+						 const ResultsStore::Trial& actual)
+	{
+		EXPECT_EQ(expected.scenario, actual.scenario);
+		EXPECT_EQ(expected.generation, actual.generation);
+		EXPECT_EQ(expected.seed, actual.seed);
+		EXPECT_EQ(expected.timestamp, actual.timestamp);
+		EXPECT_EQ(expected.duration, actual.duration);
+		EXPECT_EQ(expected.parameters, actual.parameters);
+		EXPECT_EQ(expected.scores, actual.scores);
+	}
+
+	class ResultsStoreTest : public ::testing::Test {
+	protected:
+
+		virtual void SetUp()
+		{
+			char name[] = "/tmp/ResultsStore_testXXXXXX";
+			ASSERT_TRUE(mkdtemp(name) != NULL);
+			directory = name;
+			filename = directory + "/trials.bin";
+		}
+
+		virtual void TearDown()
+		{
+			std::remove(filename.c_str());
+			std::remove((filename + ".index").c_str());
+			rmdir(directory.c_str());
+		}
+
+		static long long sizeOf(const std::string& path)
+		{
+			struct stat info;
+			return stat(path.c_str(), &info) == 0 ? info.st_size : -1;
+		}
+
+		std::string directory;
+		std::string filename;
+	};
+
+	TEST_F(ResultsStoreTest, testReadsBack) {
+		ResultsStore store(filename);
+		EXPECT_EQ(0u, store.size());
+		store.append(trial(3, 7, 1.5));
+		ResultsStore::Trial empty;
+		empty.scenario = "no scores";
+		store.append(empty);
+
+		ASSERT_EQ(2u, store.size());
+		expectSameTrial(trial(3, 7, 1.5), store.read(0));
+		expectSameTrial(empty, store.read(1));
+		EXPECT_THROW(store.read(2), std::out_of_range);
+	}
+
+	TEST_F(ResultsStoreTest, testBestAndGeneration) {
+		ResultsStore store(filename);
+		const double scores[] = { 2.0, 5.0, -1.0, 5.0, 3.0 };
+		for (int i = 0; i < 5; i++)
+		{
+			store.append(trial(i % 2, i, scores[i]));
+		}
+		ResultsStore::Trial unscored;
+		unscored.generation = 1;
+		store.append(unscored);
+
+		// Ties keep the order appended; unscored trials rank last
+		const std::vector<std::size_t> top = store.best(3);
+		ASSERT_EQ(3u, top.size());
+		EXPECT_EQ(1u, top[0]);
+		EXPECT_EQ(3u, top[1]);
+		EXPECT_EQ(4u, top[2]);
+		const std::vector<std::size_t> all = store.best(100);
+		ASSERT_EQ(6u, all.size());
+		EXPECT_EQ(2u, all[4]);
+		EXPECT_EQ(5u, all[5]);
+
+		const std::vector<std::size_t> even = store.generation(0);
+		ASSERT_EQ(3u, even.size());
+		EXPECT_EQ(0u, even[0]);
+		EXPECT_EQ(2u, even[1]);
+		EXPECT_EQ(4u, even[2]);
+		const std::vector<std::size_t> odd = store.generation(1);
+		ASSERT_EQ(3u, odd.size());
+		EXPECT_EQ(5u, odd[2]);
+		EXPECT_TRUE(store.generation(7).empty());
+	}
+
+	TEST_F(ResultsStoreTest, testConcurrentAppends) {
+		// Opened before the others write, so its index is behind
+		ResultsStore reader(filename);
+		EXPECT_EQ(0u, reader.size());
+
+		const int writers = 4;
+		const int trials = 250;
+		std::vector<pid_t> children;
+		for (int w = 0; w < writers; w++)
+		{
+			const pid_t pid = fork();
+			ASSERT_NE(-1, pid);
+			if (pid == 0)
+			{
+				// Each process has its own store, and queries as it goes
+				// so the sidecar is extended concurrently too
+				ResultsStore store(filename);
+				for (int i = 0; i < trials; i++)
+				{
+					store.append(trial(w, i, w * trials + i));
+					if (i % 50 == 0)
+					{
+						store.size();
+					}
+				}
+				_exit(0);
+			}
+			children.push_back(pid);
+		}
+		for (std::size_t i = 0; i < children.size(); i++)
+		{
+			int status = 0;
+			ASSERT_EQ(children[i], waitpid(children[i], &status, 0));
+			ASSERT_TRUE(WIFEXITED(status));
+			ASSERT_EQ(0, WEXITSTATUS(status));
+		}
+
+		// Every record is whole, and each writer's are in its order
+		ResultsStore fresh(filename);
+		const std::size_t total = writers * trials;
+		ASSERT_EQ(total, reader.size());
+		ASSERT_EQ(total, fresh.size());
+		for (int w = 0; w < writers; w++)
+		{
+			const std::vector<std::size_t> indices = fresh.generation(w);
+			ASSERT_EQ(static_cast<std::size_t>(trials), indices.size());
+			EXPECT_EQ(indices, reader.generation(w));
+			for (int i = 0; i < trials; i++)
+			{
+				expectSameTrial(trial(w, i, w * trials + i),
+								fresh.read(indices[i]));
+			}
+		}
+		const std::vector<std::size_t> top = fresh.best(2);
+		ASSERT_EQ(2u, top.size());
+		EXPECT_EQ(trial(writers - 1, trials - 1, 0.0).scenario,
+				  fresh.read(top[0]).scenario);
+		EXPECT_EQ(trial(writers - 1, trials - 2, 0.0).scenario,
+				  fresh.read(top[1]).scenario);
+	}
+
+	TEST_F(ResultsStoreTest, testIndexesLazilyThroughSidecar) {
+		const std::string sidecar = filename + ".index";
+		long long header = 0;
+		{
+			ResultsStore store(filename);
+			header = sizeOf(sidecar);
+			ASSERT_GT(header, 0);
+			for (int i = 0; i < 10; i++)
+			{
+				store.append(trial(0, i, i));
+			}
+		}
+		// Neither appending nor opening indexes
+		EXPECT_EQ(header, sizeOf(sidecar));
+		ResultsStore first(filename);
+		EXPECT_EQ(header, sizeOf(sidecar));
+		EXPECT_EQ(10u, first.size());
+		const long long tenEntries = sizeOf(sidecar);
+		EXPECT_GT(tenEntries, header);
+
+		// Extended from where it was, by whichever store queries
+		ResultsStore second(filename);
+		second.append(trial(1, 0, 100.0));
+		EXPECT_EQ(tenEntries, sizeOf(sidecar));
+		EXPECT_EQ(11u, second.size());
+		EXPECT_EQ((tenEntries - header) / 10 * 11 + header, sizeOf(sidecar));
+		EXPECT_EQ(11u, first.size());
+		EXPECT_EQ(10u, first.best(1)[0]);
+		expectSameTrial(trial(1, 0, 100.0), first.read(10));
+	}
+
+	TEST_F(ResultsStoreTest, testStaleSidecarIgnored) {
+		{
+			ResultsStore store(filename);
+			for (int i = 0; i < 5; i++)
+			{
+				store.append(trial(0, i, i));
+			}
+			EXPECT_EQ(5u, store.size());
+		}
+
+		// A new file of the same name, whose records have the same sizes
+		// but other contents
+		std::remove(filename.c_str());
+		ResultsStore store(filename);
+		for (int i = 0; i < 5; i++)
+		{
+			store.append(trial(2, i, 10.0 - i));
+		}
+		ASSERT_EQ(5u, store.size());
+		EXPECT_TRUE(store.generation(0).empty());
+		EXPECT_EQ(5u, store.generation(2).size());
+		expectSameTrial(trial(2, 4, 6.0), store.read(4));
+
+		// Records of other sizes
+		std::remove(filename.c_str());
+		ResultsStore shorter(filename);
+		shorter.append(trial(3, 0, 1.0));
+		shorter.append(trial(3, 3, 2.0));
+		ASSERT_EQ(2u, shorter.size());
+		EXPECT_EQ(1u, shorter.best(1)[0]);
+
+		// A sidecar that is not one is replaced
+		std::FILE* pFile = std::fopen((filename + ".index").c_str(), "w");
+		ASSERT_TRUE(pFile != NULL);
+		std::fputs("garbage", pFile);
+		std::fclose(pFile);
+		ResultsStore reopened(filename);
+		EXPECT_EQ(2u, reopened.size());
+		EXPECT_EQ(1u, reopened.best(1)[0]);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
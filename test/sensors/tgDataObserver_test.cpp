@@ -0,0 +1,414 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgDataObserver_test.cpp
+* @brief Contains tests of the decimation and deadband of tgDataObserver,
+* of its rows against its header, and that flush() and the destructor
+* leave every queued row in the file
+* $Id$
+*/
+
+// This application
+#include "sensors/tgDataObserver.h"
+#include "core/abstractMarker.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+// POSIX
+#include <dirent.h>
+#include <unistd.h>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/**
+	 * A rod hanging by two cables from a fixed rod, with a marker on the
+	 * hanging rod, logged to a directory of its own
+	 */
+	class tgDataObserverTest : public ::testing::Test {
+	protected:
+
+		tgDataObserverTest() :
+			world(tgWorld::Config(9.81)),
+			dt(0.001)
+		{
+		}
+
+		virtual void SetUp()
+		{
+			char name[] = "/tmp/tgDataObserver_testXXXXXX";
+			ASSERT_TRUE(mkdtemp(name) != NULL);
+			directory = name;
+
+			tgStructure structure;
+			structure.addNode(0.0, 5.0, 0.0);
+			structure.addNode(2.0, 5.0, 0.0);
+			structure.addNode(0.0, 3.0, 0.0);
+			structure.addNode(2.0, 3.0, 0.0);
+			structure.addPair(0, 1, "anchor");
+			structure.addPair(2, 3, "bob");
+			structure.addPair(0, 2, "cable");
+			structure.addPair(1, 3, "cable");
+
+			tgBuildSpec spec;
+			// A density of zero makes the rod static
+			spec.addBuilder("anchor", new tgRodInfo(tgRod::Config(0.1, 0.0)));
+			spec.addBuilder("bob", new tgRodInfo(tgRod::Config(0.1, 1.0)));
+			const tgBasicActuator::Config cableConfig(1000.0, 10.0, 0.0, false,
+													  1000.0, 100.0, 0.1, 0.1);
+			spec.addBuilder("cable", new tgBasicActuatorInfo(cableConfig));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+
+			rods = tgCast::filter<tgModel, tgRod>(model.getDescendants());
+			cables = tgCast::filter<tgModel, tgBasicActuator>(model.getDescendants());
+			ASSERT_EQ(2u, rods.size());
+			ASSERT_EQ(2u, cables.size());
+			const btRigidBody* const pBob =
+				(rods[0]->mass() > 0.0) ? rods[0]->getPRigidBody()
+										: rods[1]->getPRigidBody();
+			model.addMarker(abstractMarker(pBob, btVector3(0.5, 0.0, 0.0),
+										   btVector3(1.0, 0.0, 0.0), 0));
+		}
+
+		virtual void TearDown()
+		{
+			model.teardown();
+			const std::vector<std::string> files = list();
+			for (std::size_t i = 0; i < files.size(); i++)
+			{
+				std::remove((directory + "/" + files[i]).c_str());
+			}
+			rmdir(directory.c_str());
+		}
+
+		std::string prefix() const
+		{
+			return directory + "/log_";
+		}
+
+		/** The names in the directory */
+		std::vector<std::string> list() const
+		{
+			std::vector<std::string> names;
+			DIR* const pDir = opendir(directory.c_str());
+			if (pDir == NULL)
+			{
+				return names;
+			}
+			const struct dirent* pEntry;
+			while ((pEntry = readdir(pDir)) != NULL)
+			{
+				const std::string name(pEntry->d_name);
+				if (name != "." && name != "..")
+				{
+					names.push_back(name);
+				}
+			}
+			closedir(pDir);
+			return names;
+		}
+
+		/** The lines of the one log in the directory, header first */
+		std::vector<std::string> lines() const
+		{
+			std::vector<std::string> result;
+			const std::vector<std::string> files = list();
+			EXPECT_EQ(1u, files.size());
+			if (files.size() != 1)
+			{
+				return result;
+			}
+			std::ifstream input((directory + "/" + files[0]).c_str());
+			std::string line;
+			while (std::getline(input, line))
+			{
+				result.push_back(line);
+			}
+			return result;
+		}
+
+		/** The fields of a line; every field ends in a comma */
+		static std::vector<std::string> split(const std::string& line)
+		{
+			EXPECT_FALSE(line.empty());
+			EXPECT_EQ(',', line[line.size() - 1]) << line;
+			std::vector<std::string> fields;
+			std::istringstream input(line);
+			std::string field;
+			while (std::getline(input, field, ','))
+			{
+				fields.push_back(field);
+			}
+			return fields;
+		}
+
+		static std::vector<double> values(const std::string& line)
+		{
+			const std::vector<std::string> fields = split(line);
+			std::vector<double> result;
+			for (std::size_t i = 0; i < fields.size(); i++)
+			{
+				result.push_back(std::atof(fields[i].c_str()));
+			}
+			return result;
+		}
+
+		static bool endsWith(const std::string& s, const std::string& suffix)
+		{
+			return s.size() >= suffix.size() &&
+				s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+		}
+
+		/** Simulate, logging each step */
+		void run(tgDataObserver& observer, int steps)
+		{
+			for (int i = 0; i < steps; i++)
+			{
+				world.step(dt);
+				model.step(dt);
+				observer.onStep(model, dt);
+			}
+		}
+
+		/** Log steps without simulating, so nothing moves */
+		void log(tgDataObserver& observer, int steps)
+		{
+			for (int i = 0; i < steps; i++)
+			{
+				observer.onStep(model, dt);
+			}
+		}
+
+		// The world outlives the model's bodies
+		tgWorld world;
+		tgModel model;
+		const double dt;
+		std::string directory;
+		std::vector<tgRod*> rods;
+		std::vector<tgBasicActuator*> cables;
+	};
+
+	TEST_F(tgDataObserverTest, testDecimation) {
+		tgDataObserver observer(prefix(), tgDataObserver::Config(5));
+		observer.onSetup(model);
+		run(observer, 23);
+		observer.flush();
+
+		// Steps 5, 10, 15 and 20, stamped with the time since setup
+		const std::vector<std::string> rows = lines();
+		ASSERT_EQ(5u, rows.size());
+		for (std::size_t i = 1; i < rows.size(); i++)
+		{
+			EXPECT_NEAR(5.0 * i * dt, values(rows[i])[0], 1.0e-9) << rows[i];
+		}
+
+		// Setup starts the count again, in a new file
+		std::remove((directory + "/" + list()[0]).c_str());
+		observer.onSetup(model);
+		log(observer, 4);
+		observer.flush();
+		EXPECT_EQ(1u, lines().size());
+	}
+
+	TEST_F(tgDataObserverTest, testDeadband) {
+		tgDataObserver observer(prefix(), tgDataObserver::Config(1, 0.1));
+		observer.onSetup(model);
+
+		// The first row is always written, then nothing has changed
+		log(observer, 3);
+
+		// A slack cable's rest length is the only column that changes.
+		// Steps of 0.06 are within the deadband, so every second one is
+		// written.
+		const double restLength = cables[0]->getRestLength();
+		cables[0]->setControlInput(restLength + 0.06, 1.0);
+		log(observer, 1);
+		cables[0]->setControlInput(restLength + 0.12, 1.0);
+		log(observer, 1);
+		cables[0]->setControlInput(restLength + 0.18, 1.0);
+		log(observer, 1);
+		observer.flush();
+
+		const std::vector<std::string> rows = lines();
+		ASSERT_EQ(3u, rows.size());
+		EXPECT_NEAR(dt, values(rows[1])[0], 1.0e-9);
+		EXPECT_NEAR(5.0 * dt, values(rows[2])[0], 1.0e-9);
+		const std::vector<double> first = values(rows[1]);
+		const std::vector<double> second = values(rows[2]);
+		ASSERT_EQ(first.size(), second.size());
+		std::size_t changes = 0;
+		for (std::size_t i = 1; i < first.size(); i++)
+		{
+			if (first[i] != second[i])
+			{
+				EXPECT_NEAR(0.12, second[i] - first[i], 1.0e-5);
+				changes++;
+			}
+		}
+		EXPECT_EQ(1u, changes);
+	}
+
+	TEST_F(tgDataObserverTest, testZeroDeadbandWritesEveryRow) {
+		tgDataObserver observer(prefix(), tgDataObserver::Config(1, 0.0));
+		observer.onSetup(model);
+		log(observer, 7);
+		observer.flush();
+		EXPECT_EQ(8u, lines().size());
+	}
+
+	TEST_F(tgDataObserverTest, testRowsMatchHeader) {
+		tgDataObserver observer(prefix());
+		observer.onSetup(model);
+		run(observer, 200);
+		observer.flush();
+
+		const std::vector<std::string> rows = lines();
+		ASSERT_EQ(201u, rows.size());
+		const std::vector<std::string> header = split(rows[0]);
+		// Time, the marker, two cables and two rods
+		ASSERT_EQ(1u + 3u + 2 * 3u + 2 * 4u, header.size());
+		for (std::size_t i = 1; i < rows.size(); i++)
+		{
+			EXPECT_EQ(header.size(), split(rows[i]).size()) << "row " << i;
+		}
+
+		// The last row is the state now, in the header's order. Rows
+		// have six significant digits.
+		const std::vector<double> row = values(rows.back());
+		EXPECT_EQ("Time", header[0]);
+		EXPECT_NEAR(200 * dt, row[0], 1.0e-9);
+		std::size_t column = 1;
+
+		const btVector3 marker = model.getMarkers()[0].getWorldPosition();
+		const char* const axes[] = { "_X", "_Y", "_Z" };
+		for (int j = 0; j < 3; j++, column++)
+		{
+			EXPECT_EQ(0u, header[column].find("Marker")) << header[column];
+			EXPECT_TRUE(endsWith(header[column], axes[j])) << header[column];
+			EXPECT_NEAR(marker[j], row[column], 1.0e-5) << header[column];
+		}
+
+		const std::vector<tgModel*> children = model.getDescendants();
+		std::size_t cablesSeen = 0;
+		std::size_t rodsSeen = 0;
+		for (std::size_t i = 0; i < children.size(); i++)
+		{
+			// Columns are named for the component's tags
+			std::ostringstream tags;
+			tags << children[i]->getTags() << " ";
+			const tgSpringCableActuator* const pCable =
+				tgCast::cast<tgModel, tgSpringCableActuator>(children[i]);
+			const tgRod* const pRod = tgCast::cast<tgModel, tgRod>(children[i]);
+			if (pCable != NULL)
+			{
+				const char* const names[] = { "_RL", "_AL", "_Ten" };
+				const double expected[] = {
+					pCable->getRestLength(), pCable->getCurrentLength(),
+					pCable->getTension()
+				};
+				for (int j = 0; j < 3; j++, column++)
+				{
+					EXPECT_EQ(0u, header[column].find(tags.str())) << header[column];
+					EXPECT_TRUE(endsWith(header[column], names[j]))
+						<< header[column];
+					EXPECT_NEAR(expected[j], row[column],
+								1.0e-5 * (1.0 + std::fabs(expected[j])))
+						<< header[column];
+				}
+				cablesSeen++;
+			}
+			else if (pRod != NULL)
+			{
+				const char* const names[] = { "_X", "_Y", "_Z", "_mass" };
+				const btVector3 com = pRod->centerOfMass();
+				const double expected[] = {
+					com.x(), com.y(), com.z(), pRod->mass()
+				};
+				for (int j = 0; j < 4; j++, column++)
+				{
+					EXPECT_EQ(0u, header[column].find(tags.str())) << header[column];
+					EXPECT_TRUE(endsWith(header[column], names[j]))
+						<< header[column];
+					EXPECT_NEAR(expected[j], row[column],
+								1.0e-5 * (1.0 + std::fabs(expected[j])))
+						<< header[column];
+				}
+				rodsSeen++;
+			}
+		}
+		EXPECT_EQ(header.size(), column);
+		EXPECT_EQ(2u, cablesSeen);
+		EXPECT_EQ(2u, rodsSeen);
+
+		// The bob has fallen onto its cables, so they pull
+		EXPECT_GT(cables[0]->getTension(), 0.0);
+	}
+
+	TEST_F(tgDataObserverTest, testFlushDrainsQueue) {
+		// Far more rows than the queue holds
+		tgDataObserver observer(prefix(), tgDataObserver::Config(1, 0.0, 2));
+		observer.onSetup(model);
+		log(observer, 500);
+		observer.flush();
+		EXPECT_EQ(501u, lines().size());
+
+		log(observer, 250);
+		observer.flush();
+		EXPECT_EQ(751u, lines().size());
+	}
+
+	TEST_F(tgDataObserverTest, testDestructorDrainsQueue) {
+		{
+			tgDataObserver* const pObserver =
+				new tgDataObserver(prefix(), tgDataObserver::Config(1, 0.0, 2));
+			pObserver->onSetup(model);
+			log(*pObserver, 1000);
+			delete pObserver;
+		}
+		const std::vector<std::string> rows = lines();
+		ASSERT_EQ(1001u, rows.size());
+		EXPECT_NEAR(1000 * dt, values(rows.back())[0], 1.0e-9);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
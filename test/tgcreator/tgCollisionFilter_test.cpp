@@ -0,0 +1,182 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgCollisionFilter_test.cpp
+* @brief Contains tests of the collision filters set through tgBuildSpec,
+* on compounds and between bodies joined by a cable
+* $Id$
+*/
+
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgBulletUtil.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/** A group of our own, beyond Bullet's predefined ones */
+	const short customFilter = 64;
+
+	class tgCollisionFilterTest : public ::testing::Test {
+	protected:
+
+		/** Build structure into model, return the rods' bodies */
+		std::vector<btRigidBody*> build(tgStructure& structure, tgBuildSpec& spec)
+		{
+			spec.addBuilder("rod", new tgRodInfo(tgRod::Config()));
+			spec.addBuilder("cable", new tgBasicActuatorInfo(tgBasicActuator::Config()));
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+
+			const std::vector<tgRod*> rods =
+				tgCast::filter<tgModel, tgRod>(model.getDescendants());
+			std::vector<btRigidBody*> result;
+			for (std::size_t i = 0; i < rods.size(); i++)
+			{
+				result.push_back(rods[i]->getPRigidBody());
+			}
+			return result;
+		}
+
+		/** Two rods joined at a node, so they form one compound */
+		static void addBentRod(tgStructure& structure)
+		{
+			structure.addNode(0.0, 10.0, 0.0);
+			structure.addNode(0.0, 12.0, 0.0);
+			structure.addNode(2.0, 12.0, 0.0);
+			structure.addPair(0, 1, "rod first");
+			structure.addPair(1, 2, "rod second");
+		}
+
+		/** Two crossing rods with a cable between their ends */
+		static void addCrossedRods(tgStructure& structure)
+		{
+			structure.addNode(-1.0, 10.0, 0.0);
+			structure.addNode(1.0, 10.0, 0.0);
+			structure.addNode(0.0, 10.0, -1.0);
+			structure.addNode(0.0, 10.0, 1.0);
+			structure.addPair(0, 1, "rod");
+			structure.addPair(2, 3, "rod");
+			structure.addPair(0, 2, "cable");
+		}
+
+		/** True if the broadphase has paired the two bodies */
+		bool paired(btRigidBody* pBody0, btRigidBody* pBody1)
+		{
+			btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
+			dynamicsWorld.performDiscreteCollisionDetection();
+			return dynamicsWorld.getBroadphase()->getOverlappingPairCache()->
+				findPair(pBody0->getBroadphaseHandle(),
+						 pBody1->getBroadphaseHandle()) != NULL;
+		}
+
+		// The world outlives the model's bodies
+		tgWorld world;
+		tgModel model;
+	};
+
+	TEST_F(tgCollisionFilterTest, testUnfilteredCompoundKeepsDefaults) {
+		tgStructure structure;
+		addBentRod(structure);
+		tgBuildSpec spec;
+		const std::vector<btRigidBody*> bodies = build(structure, spec);
+
+		ASSERT_EQ(2u, bodies.size());
+		EXPECT_EQ(bodies[0], bodies[1]);
+		const btBroadphaseProxy* const pProxy = bodies[0]->getBroadphaseHandle();
+		EXPECT_EQ(btBroadphaseProxy::DefaultFilter, pProxy->m_collisionFilterGroup);
+		EXPECT_EQ(btBroadphaseProxy::AllFilter, pProxy->m_collisionFilterMask);
+	}
+
+	TEST_F(tgCollisionFilterTest, testFilteredCompoundMergesMembers) {
+		tgStructure structure;
+		addBentRod(structure);
+		tgBuildSpec spec;
+		spec.addCollisionFilter("first", customFilter,
+								btBroadphaseProxy::AllFilter);
+		spec.addCollisionFilter("second", btBroadphaseProxy::DebrisFilter,
+								customFilter);
+		const std::vector<btRigidBody*> bodies = build(structure, spec);
+
+		ASSERT_EQ(2u, bodies.size());
+		const btBroadphaseProxy* const pProxy = bodies[0]->getBroadphaseHandle();
+		EXPECT_EQ(customFilter | btBroadphaseProxy::DebrisFilter,
+				  pProxy->m_collisionFilterGroup);
+		EXPECT_EQ(customFilter, pProxy->m_collisionFilterMask);
+	}
+
+	TEST_F(tgCollisionFilterTest, testMixedCompoundKeepsUnfilteredMember) {
+		tgStructure structure;
+		addBentRod(structure);
+		tgBuildSpec spec;
+		spec.addCollisionFilter("first", customFilter, customFilter);
+		const std::vector<btRigidBody*> bodies = build(structure, spec);
+
+		ASSERT_EQ(2u, bodies.size());
+		const btBroadphaseProxy* const pProxy = bodies[0]->getBroadphaseHandle();
+		EXPECT_EQ(customFilter | btBroadphaseProxy::DefaultFilter,
+				  pProxy->m_collisionFilterGroup);
+		EXPECT_EQ(btBroadphaseProxy::AllFilter, pProxy->m_collisionFilterMask);
+	}
+
+	TEST_F(tgCollisionFilterTest, testCrossedRodsCollideByDefault) {
+		tgStructure structure;
+		addCrossedRods(structure);
+		tgBuildSpec spec;
+		const std::vector<btRigidBody*> bodies = build(structure, spec);
+
+		ASSERT_EQ(2u, bodies.size());
+		EXPECT_TRUE(paired(bodies[0], bodies[1]));
+	}
+
+	TEST_F(tgCollisionFilterTest, testAutoFilterExcludesConnectedRods) {
+		tgStructure structure;
+		addCrossedRods(structure);
+		tgBuildSpec spec;
+		spec.setAutoCollisionFilter(true);
+		const std::vector<btRigidBody*> bodies = build(structure, spec);
+
+		ASSERT_EQ(2u, bodies.size());
+		EXPECT_FALSE(paired(bodies[0], bodies[1]));
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
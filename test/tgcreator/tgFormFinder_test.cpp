@@ -0,0 +1,166 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgFormFinder_test.cpp
+* @brief Contains tests that tgFormFinder finds the pose Bullet settles
+* a hanging structure into, and rejects structures that would fall
+* $Id$
+*/
+
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgFormFinder.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics Library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgFormFinderTest : public ::testing::Test {
+	protected:
+
+		tgFormFinderTest() :
+			gravity(9.81)
+		{
+			// A static bar with a rod hung 5 below it by a vertical
+			// cable at each end and two crossed ones, so it can't swing
+			structure.addNode(-2.0, 20.0, 0.0);
+			structure.addNode(2.0, 20.0, 0.0);
+			structure.addNode(-2.0, 15.0, 0.0);
+			structure.addNode(2.0, 15.0, 0.0);
+			structure.addPair(0, 1, "anchor");
+			structure.addPair(2, 3, "rod");
+			structure.addPair(0, 2, "cable");
+			structure.addPair(1, 3, "cable");
+			structure.addPair(0, 3, "cable");
+			structure.addPair(1, 2, "cable");
+		}
+
+		static void addBuilders(tgBuildSpec& spec)
+		{
+			// Zero density makes the anchor static
+			spec.addBuilder("anchor", new tgRodInfo(tgRod::Config(0.5, 0.0)));
+			spec.addBuilder("rod", new tgRodInfo(tgRod::Config(0.5, 1.0)));
+			spec.addBuilder("cable",
+							new tgBasicActuatorInfo(tgBasicActuator::Config(1000.0, 10.0)));
+		}
+
+		/** Build the structure into model and set it up */
+		void build(tgModel& model, tgWorld& world)
+		{
+			tgBuildSpec spec;
+			addBuilders(spec);
+			tgStructureInfo structureInfo(structure, spec);
+			structureInfo.buildInto(model, world);
+			model.setup(world);
+		}
+
+		/** The center of mass of the hanging rod */
+		static btVector3 hangingRod(const tgModel& model)
+		{
+			const std::vector<tgRod*> rods =
+				tgCast::filter<tgModel, tgRod>(model.getDescendants());
+			for (std::size_t i = 0; i < rods.size(); i++)
+			{
+				if (rods[i]->mass() > 0.0)
+				{
+					return rods[i]->centerOfMass();
+				}
+			}
+			ADD_FAILURE() << "No rod has mass";
+			return btVector3(0.0, 0.0, 0.0);
+		}
+
+		const double gravity;
+		tgStructure structure;
+	};
+
+	TEST_F(tgFormFinderTest, testRelaxedFormMatchesSettledModel) {
+		tgBuildSpec spec;
+		addBuilders(spec);
+		tgFormFinder formFinder(structure, spec, tgFormFinder::Config(gravity));
+		const tgFormFinder::Result result = formFinder.solve();
+		ASSERT_TRUE(result.converged);
+		EXPECT_EQ(0u, result.ignoredConnectors);
+
+		tgWorld relaxedWorld(tgWorld::Config(gravity));
+		tgModel relaxedModel;
+		build(relaxedModel, relaxedWorld);
+		formFinder.apply(relaxedModel, relaxedWorld);
+		const btVector3 relaxed = hangingRod(relaxedModel);
+		// The cables stretch under the rod's weight
+		EXPECT_LT(relaxed.y(), 15.0 - 1.0e-3);
+
+		// Let damping settle the same structure in Bullet
+		tgWorld settledWorld(tgWorld::Config(gravity));
+		tgModel settledModel;
+		build(settledModel, settledWorld);
+		const double dt = 0.001;
+		for (std::size_t i = 0; i < 20000; i++)
+		{
+			settledWorld.step(dt);
+			settledModel.step(dt);
+		}
+		const btVector3 settled = hangingRod(settledModel);
+
+		EXPECT_NEAR(settled.x(), relaxed.x(), 1.0e-3);
+		EXPECT_NEAR(settled.y(), relaxed.y(), 1.0e-3);
+		EXPECT_NEAR(settled.z(), relaxed.z(), 1.0e-3);
+
+		relaxedModel.teardown();
+		settledModel.teardown();
+	}
+
+	TEST_F(tgFormFinderTest, testRejectsFreeStructureUnderGravity) {
+		tgStructure loose;
+		loose.addNode(-2.0, 15.0, 0.0);
+		loose.addNode(2.0, 15.0, 0.0);
+		loose.addPair(0, 1, "rod");
+		tgBuildSpec spec;
+		addBuilders(spec);
+
+		EXPECT_THROW({
+			tgFormFinder formFinder(loose, spec, tgFormFinder::Config(gravity));
+		}, std::invalid_argument);
+		// A ground holds it up
+		EXPECT_NO_THROW({
+			tgFormFinder formFinder(loose, spec,
+									tgFormFinder::Config(gravity, 0.0, 1000.0));
+		});
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
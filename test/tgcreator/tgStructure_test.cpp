@@ -0,0 +1,126 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgStructure_test.cpp
+* @brief Contains tests that references into a tgStructure follow it
+* through moves and copies, as they did before structures were instanced
+* $Id$
+*/
+
+// This application
+#include "tgcreator/tgNode.h"
+#include "tgcreator/tgStructure.h"
+// The Bullet Physics Library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cmath>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgStructureTest : public ::testing::Test {
+	protected:
+
+		tgStructureTest()
+		{
+			segment.addNode(0.0, 0.0, 0.0, "bottom");
+			segment.addNode(0.0, 1.0, 0.0, "top");
+			segment.addPair(0, 1, "rod");
+		}
+
+		static void expectAt(const btVector3& actual, const btVector3& expected)
+		{
+			EXPECT_NEAR(expected.x(), actual.x(), 1.0e-12);
+			EXPECT_NEAR(expected.y(), actual.y(), 1.0e-12);
+			EXPECT_NEAR(expected.z(), actual.z(), 1.0e-12);
+		}
+
+		tgStructure segment;
+	};
+
+	TEST_F(tgStructureTest, testFoundNodeFollowsMove) {
+		tgNode& top = segment.findNode("top");
+		segment.move(btVector3(2.0, 0.0, 0.0));
+		expectAt(top, btVector3(2.0, 1.0, 0.0));
+
+		segment.addRotation(btVector3(0.0, 0.0, 0.0),
+							btVector3(0.0, 0.0, 1.0), M_PI);
+		expectAt(top, btVector3(-2.0, -1.0, 0.0));
+	}
+
+	TEST_F(tgStructureTest, testFoundNodeStaysWithOriginalAfterCopy) {
+		tgNode& top = segment.findNode("top");
+		tgStructure copy(segment);
+		segment.move(btVector3(0.0, 0.0, 3.0));
+
+		expectAt(top, btVector3(0.0, 1.0, 3.0));
+		expectAt(copy.getNodes()[1], btVector3(0.0, 1.0, 0.0));
+	}
+
+	TEST_F(tgStructureTest, testFoundNodeInChildFollowsParentMove) {
+		tgStructure parent;
+		parent.addChild(segment);
+		tgNode& top = parent.findNode("top");
+		tgStructure copy(parent);
+		parent.move(btVector3(1.0, 0.0, 0.0));
+
+		expectAt(top, btVector3(1.0, 1.0, 0.0));
+		expectAt(copy.findNode("top"), btVector3(0.0, 1.0, 0.0));
+	}
+
+	TEST_F(tgStructureTest, testChildPointerStaysWithParent) {
+		tgStructure parent;
+		tgStructure* const pChild = new tgStructure(segment);
+		parent.addChild(pChild);
+		tgStructure copy(parent);
+
+		pChild->move(btVector3(0.0, 5.0, 0.0));
+		ASSERT_EQ(parent.getChildren()[0], pChild);
+		expectAt(parent.findNode("bottom"), btVector3(0.0, 5.0, 0.0));
+		expectAt(copy.findNode("bottom"), btVector3(0.0, 0.0, 0.0));
+	}
+
+	TEST_F(tgStructureTest, testInstancesMoveIndependently) {
+		tgStructure spine;
+		for (int i = 0; i < 3; i++)
+		{
+			tgStructure vertebra(segment);
+			vertebra.move(btVector3(0.0, i * 2.0, 0.0));
+			spine.addChild(vertebra);
+		}
+		spine.scale(btVector3(0.0, 0.0, 0.0), 2.0);
+
+		expectAt(spine.getCentroid(), btVector3(0.0, 5.0, 0.0));
+		for (int i = 0; i < 3; i++)
+		{
+			const tgStructure& vertebra = *spine.getChildren()[i];
+			expectAt(vertebra.getNodes()[0], btVector3(0.0, i * 4.0, 0.0));
+			expectAt(vertebra.getPairs().getPairs()[0].getTo(),
+					 btVector3(0.0, i * 4.0 + 2.0, 0.0));
+		}
+		expectAt(segment.getNodes()[1], btVector3(0.0, 1.0, 0.0));
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -32,6 +32,7 @@
 #include "core/tgSimulation.h"
 #include "core/tgWorld.h"
 #include "helpers/FileHelpers.h"
+#include "sensors/tgBodyTrajectoryLogger.h"
 // The C++ Standard Library
 #include <iostream>
 #include <fstream>
@@ -87,6 +88,14 @@ namespace {
 				// Third create the simulation
 				tgSimulation simulation(view);
 
+				// Record the bodies for bin/utilities/comparePrecision.py
+				tgBodyTrajectoryLogger* const pTrajectory =
+				  tgBodyTrajectoryLogger::fromEnvironment(world, "ICRA2015Static", 0.01);
+				if (pTrajectory)
+				{
+					simulation.addDataManager(pTrajectory);
+				}
+
 				// Fourth create the models with their controllers and add the models to the
 				// simulation
 				const int segments = 3;
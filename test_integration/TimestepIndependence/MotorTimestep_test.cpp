@@ -36,6 +36,7 @@
 #include "core/tgSimulation.h"
 #include "core/tgWorld.h"
 #include "helpers/FileHelpers.h"
+#include "sensors/tgBodyTrajectoryLogger.h"
 // The C++ Standard Library
 #include <iostream>
 #include <fstream>
@@ -91,6 +92,14 @@ namespace {
 				// Third create the simulation
 				tgSimulation simulation(view);
 
+				// Record the bodies for bin/utilities/comparePrecision.py
+				tgBodyTrajectoryLogger* const pTrajectory =
+				  tgBodyTrajectoryLogger::fromEnvironment(world, "KinematicMotor", 0.01);
+				if (pTrajectory)
+				{
+					simulation.addDataManager(pTrajectory);
+				}
+
 				// Fourth create the models with their controllers and add the models to the
 				// simulation
 				bool useKinematic = true;
@@ -159,6 +168,14 @@ namespace {
 				// Third create the simulation
 				tgSimulation simulation(view);
 
+				// Record the bodies for bin/utilities/comparePrecision.py
+				tgBodyTrajectoryLogger* const pTrajectory =
+				  tgBodyTrajectoryLogger::fromEnvironment(world, "LinearMotor", 0.01);
+				if (pTrajectory)
+				{
+					simulation.addDataManager(pTrajectory);
+				}
+
 				// Fourth create the models with their controllers and add the models to the
 				// simulation
 				bool useKinematic = false;